@@ -0,0 +1,42 @@
+// Copyright (c) 2015, 2017 The ComPWA Team.
+// This file is part of the ComPWA framework, check
+// https://github.com/ComPWA/ComPWA/license.txt for details.
+
+#include <algorithm>
+#include <future>
+#include <thread>
+#include <vector>
+
+#include "Core/Concurrency.hpp"
+
+namespace ComPWA {
+
+void runConcurrently(size_t NumberOfTasks,
+                     const std::function<void(size_t)> &Task) {
+  if (NumberOfTasks < 2) {
+    for (size_t i = 0; i < NumberOfTasks; ++i)
+      Task(i);
+    return;
+  }
+  std::vector<std::future<void>> Results;
+  Results.reserve(NumberOfTasks);
+  for (size_t i = 0; i < NumberOfTasks; ++i)
+    Results.push_back(std::async(std::launch::async, Task, i));
+  // wait for all threads before a possible exception leaves this scope
+  for (auto &x : Results)
+    x.wait();
+  for (auto &x : Results)
+    x.get();
+}
+
+void runOnRanges(size_t Size, size_t MinimalRangeSize,
+                 const std::function<void(size_t, size_t)> &Task) {
+  size_t NumberOfRanges(std::max<size_t>(
+      1, std::min<size_t>(std::thread::hardware_concurrency(),
+                          Size / std::max<size_t>(1, MinimalRangeSize))));
+  runConcurrently(NumberOfRanges, [&](size_t i) {
+    Task(i * Size / NumberOfRanges, (i + 1) * Size / NumberOfRanges);
+  });
+}
+
+} // namespace ComPWA
@@ -0,0 +1,33 @@
+// Copyright (c) 2015, 2017 The ComPWA Team.
+// This file is part of the ComPWA framework, check
+// https://github.com/ComPWA/ComPWA/license.txt for details.
+
+///
+/// \file
+/// Helpers for the concurrent execution of independent tasks.
+///
+
+#ifndef COMPWA_CONCURRENCY_HPP_
+#define COMPWA_CONCURRENCY_HPP_
+
+#include <cstddef>
+#include <functional>
+
+namespace ComPWA {
+
+/// Executes \p Task(i) for i in [0, \p NumberOfTasks), each on its own
+/// thread. A single task is executed in the calling thread. All tasks are
+/// finished before an exception of a task is rethrown in the calling thread.
+void runConcurrently(size_t NumberOfTasks,
+                     const std::function<void(size_t)> &Task);
+
+/// Splits [0, \p Size) into contiguous ranges of at least \p MinimalRangeSize
+/// elements (at most one per hardware thread) and executes
+/// \p Task(Begin, End) for each range concurrently.
+/// \see runConcurrently()
+void runOnRanges(size_t Size, size_t MinimalRangeSize,
+                 const std::function<void(size_t, size_t)> &Task);
+
+} // namespace ComPWA
+
+#endif
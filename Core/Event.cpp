@@ -53,4 +53,44 @@ std::ostream &operator<<(std::ostream &os, const DataPoint &p) {
   return os;
 }
 
+PackedEvents::PackedEvents(const std::vector<Event> &Events)
+    : NumberOfParticles(0) {
+  if (Events.empty())
+    return;
+  NumberOfParticles = Events.front().ParticleList.size();
+  Momenta.reserve(Events.size() * NumberOfParticles);
+  Pids.reserve(Events.size() * NumberOfParticles);
+  Charges.reserve(Events.size() * NumberOfParticles);
+  Weights.reserve(Events.size());
+  for (auto const &evt : Events) {
+    if (evt.ParticleList.size() != NumberOfParticles)
+      throw std::runtime_error("PackedEvents::PackedEvents(): all events need "
+                               "the same number of particles!");
+    for (auto const &x : evt.ParticleList) {
+      Momenta.push_back(x.fourVector());
+      Pids.push_back(x.pid());
+      Charges.push_back(x.charge());
+    }
+    Weights.push_back(evt.Weight);
+  }
+}
+
+std::vector<Event> PackedEvents::unpack() const {
+  bool HasPids(Pids.size() == Momenta.size());
+  bool HasCharges(Charges.size() == Momenta.size());
+  std::vector<Event> Events(size());
+  for (size_t i = 0; i < Events.size(); ++i) {
+    Events[i].ParticleList.reserve(NumberOfParticles);
+    for (size_t k = i * NumberOfParticles; k < (i + 1) * NumberOfParticles;
+         ++k) {
+      const FourVector &p(Momenta[k]);
+      Events[i].ParticleList.push_back(Particle(p.Px, p.Py, p.Pz, p.E,
+                                                HasPids ? Pids[k] : 0,
+                                                HasCharges ? Charges[k] : 0));
+    }
+    Events[i].Weight = Weights[i];
+  }
+  return Events;
+}
+
 } // namespace ComPWA
@@ -27,6 +27,35 @@ double calculateInvariantMass(const Event &ev);
 
 double getMaximumSampleWeight(const std::vector<Event> &sample);
 
+///
+/// \struct PackedEvents
+/// Events with the same number of particles in one contiguous array of
+/// FourVectors. The four momentum of particle j in event i is
+/// Momenta[i * NumberOfParticles + j]. Pids and Charges are indexed in the
+/// same way, they may be left empty if they are not known.
+///
+struct PackedEvents {
+  PackedEvents() : NumberOfParticles(0) {}
+  PackedEvents(const std::vector<Event> &Events);
+
+  unsigned int NumberOfParticles;
+  std::vector<FourVector> Momenta;
+  std::vector<int> Pids;
+  std::vector<int> Charges;
+  std::vector<double> Weights;
+
+  size_t size() const { return Weights.size(); }
+
+  /// Four momenta of the particles of event \p i
+  const FourVector *event(size_t i) const {
+    return Momenta.data() + i * NumberOfParticles;
+  }
+
+  /// Creates the Events. The pid and charge of the particles are 0 if they are
+  /// not stored.
+  std::vector<Event> unpack() const;
+};
+
 ///
 /// Data structure which contains a reduced set of the kinematic information of
 /// an Event. Only the variables that are needed to evaluate a specific
@@ -0,0 +1,141 @@
+// Copyright (c) 2015, 2017 The ComPWA Team.
+// This file is part of the ComPWA framework, check
+// https://github.com/ComPWA/ComPWA/license.txt for details.
+
+///
+/// \file
+/// Lightweight Lorentz vector for the inner loops of the kinematics
+/// calculation and the event generation.
+///
+
+#ifndef COMPWA_FOURVECTOR_HPP_
+#define COMPWA_FOURVECTOR_HPP_
+
+#include <cmath>
+#include <ostream>
+#include <type_traits>
+
+namespace ComPWA {
+
+///
+/// \struct FourVector
+/// Lorentz vector (px, py, pz, E) without virtual functions or bounds checks.
+/// It is trivially copyable, so that arrays of FourVectors can be copied and
+/// vectorized like plain doubles. The boosts and rotations follow the
+/// conventions of the qft++ Vector4 (active transformations).
+///
+/// FourMomentum and Particle are the polymorphic interface of the framework,
+/// see FourMomentum::vector() and Particle::fourVector() for the conversion.
+///
+struct FourVector {
+  double Px, Py, Pz, E;
+
+  FourVector() = default;
+
+  constexpr FourVector(double px, double py, double pz, double e)
+      : Px(px), Py(py), Pz(pz), E(e) {}
+
+  FourVector &operator+=(const FourVector &p) {
+    Px += p.Px;
+    Py += p.Py;
+    Pz += p.Pz;
+    E += p.E;
+    return *this;
+  }
+
+  FourVector &operator-=(const FourVector &p) {
+    Px -= p.Px;
+    Py -= p.Py;
+    Pz -= p.Pz;
+    E -= p.E;
+    return *this;
+  }
+
+  constexpr FourVector operator+(const FourVector &p) const {
+    return FourVector(Px + p.Px, Py + p.Py, Pz + p.Pz, E + p.E);
+  }
+
+  constexpr FourVector operator-(const FourVector &p) const {
+    return FourVector(Px - p.Px, Py - p.Py, Pz - p.Pz, E - p.E);
+  }
+
+  constexpr bool operator==(const FourVector &p) const {
+    return Px == p.Px && Py == p.Py && Pz == p.Pz && E == p.E;
+  }
+
+  constexpr double threeMomentumSq() const {
+    return Px * Px + Py * Py + Pz * Pz;
+  }
+
+  double threeMomentum() const { return std::sqrt(threeMomentumSq()); }
+
+  /// Invariant mass squared, calculated in the same way as
+  /// FourMomentum::invariantMass()
+  constexpr double invMassSq() const {
+    return -(Px * Px + Py * Py + Pz * Pz - E * E);
+  }
+
+  double invMass() const { return std::sqrt(invMassSq()); }
+
+  double cosTheta() const { return Pz / threeMomentum(); }
+
+  double theta() const {
+    if (0 == Pz)
+      return std::acos(0.0);
+    return std::acos(Pz / threeMomentum());
+  }
+
+  /// Azimuthal angle in \f$ (-\pi,\pi] \f$
+  double phi() const { return std::atan2(Py, Px); }
+
+  /// Boost by the velocity \f$ \vec{\beta} = (bx, by, bz) \f$.
+  void boost(double bx, double by, double bz) {
+    double gamma = 1.0 / std::sqrt(1.0 - bx * bx - by * by - bz * bz);
+    double gamFact = (gamma * gamma) / (gamma + 1.0);
+    double t(E), x(Px), y(Py), z(Pz);
+    E = gamma * t + gamma * bx * x + gamma * by * y + gamma * bz * z;
+    Px = gamma * bx * t + ((bx * bx * gamFact) + 1) * x + bx * by * gamFact * y +
+         bx * bz * gamFact * z;
+    Py = gamma * by * t + bx * by * gamFact * x + ((by * by * gamFact) + 1) * y +
+         by * bz * gamFact * z;
+    Pz = gamma * bz * t + bx * bz * gamFact * x + by * bz * gamFact * y +
+         ((bz * bz * gamFact) + 1) * z;
+  }
+
+  /// Boost into the rest frame of \p p.
+  void boostToRestFrame(const FourVector &p) {
+    boost(-(p.Px / p.E), -(p.Py / p.E), -(p.Pz / p.E));
+  }
+
+  /// Rotation by \p alpha around the z-axis.
+  void rotateZ(double alpha) {
+    double ca = std::cos(alpha);
+    double sa = std::sin(alpha);
+    double x(Px);
+    Px = ca * x + -sa * Py;
+    Py = sa * x + ca * Py;
+  }
+
+  /// Rotation by \p alpha around the y-axis.
+  void rotateY(double alpha) {
+    double ca = std::cos(alpha);
+    double sa = std::sin(alpha);
+    double x(Px);
+    Px = ca * x + sa * Pz;
+    Pz = -sa * x + ca * Pz;
+  }
+
+  friend std::ostream &operator<<(std::ostream &stream, const FourVector &p) {
+    stream << "(" << p.Px << "," << p.Py << "," << p.Pz << "," << p.E << ")";
+    return stream;
+  }
+};
+
+static_assert(std::is_trivially_copyable<FourVector>::value,
+              "FourVector has to be trivially copyable");
+static_assert(sizeof(FourVector) == 4 * sizeof(double),
+              "FourVector has to be packed");
+
+} // namespace ComPWA
+
+#endif
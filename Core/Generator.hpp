@@ -10,16 +10,34 @@
 #ifndef GENERATOR_HPP_
 #define GENERATOR_HPP_
 
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
 #include "Core/Event.hpp"
+#include "Core/RandomStream.hpp"
 
 namespace ComPWA {
 
 /**
  *  \class Generator
  *  \brief Virtual class for PHSP generators
+ *
+ *  Besides the sequential generate() and uniform(), a generator can support
+ *  counter-based random number streams (see RandomStream). Then the event
+ *  with a given index only depends on the seed and the index and events can
+ *  be generated in parallel, with identical results for any number of
+ *  threads.
  */
 class Generator {
 public:
+  /// Substreams of the random number streams of an event index
+  static const uint32_t EventSubstream = 0;
+  static const uint32_t AcceptanceSubstream = 1;
+  /// Substreams ThinningSubstream + n are used for the n-th thinning of a
+  /// written hit-and-miss sample, see Tools::generate().
+  static const uint32_t ThinningSubstream = 2;
+
   virtual ~Generator() {};
 
   virtual ComPWA::Event generate() = 0;
@@ -31,6 +49,45 @@ public:
   virtual double uniform(double min, double max) = 0;
   
   virtual double gauss(double mu, double sigma) const { return 0; }
+
+  /// True if generateEvent() is supported.
+  virtual bool hasRandomStreams() const { return false; }
+
+  /// Generates the event with index \p Index from the random number stream
+  /// (getSeed(), \p Index, EventSubstream). Has to be thread safe.
+  virtual ComPWA::Event generateEvent(uint64_t /*Index*/) const {
+    throw std::runtime_error("Generator::generateEvent(): counter-based "
+                             "random number streams are not supported!");
+  }
+
+  /// Generates the events \p FirstIndex, \p FirstIndex + 1, ... into
+  /// [\p First, \p Last). Has to be thread safe.
+  virtual void generateEvents(uint64_t FirstIndex,
+                              std::vector<ComPWA::Event>::iterator First,
+                              std::vector<ComPWA::Event>::iterator Last) const {
+    for (; First != Last; ++First, ++FirstIndex)
+      *First = generateEvent(FirstIndex);
+  }
+
+  /// Number of uniform random numbers an event is generated from, if the
+  /// generator can map points of the unit hypercube to events, 0 otherwise.
+  virtual unsigned int unitHypercubeDimension() const { return 0; }
+
+  /// Maps points of the unit hypercube of dimension unitHypercubeDimension()
+  /// to the events [\p First, \p Last). Coordinate k of point i is
+  /// \p Points[i * unitHypercubeDimension() + k]. Uniformly distributed points
+  /// give the same distribution as generate(). Has to be thread safe.
+  virtual void
+  mapUnitHypercube(const std::vector<double> & /*Points*/,
+                   std::vector<ComPWA::Event>::iterator /*First*/,
+                   std::vector<ComPWA::Event>::iterator /*Last*/) const {
+    throw std::runtime_error("Generator::mapUnitHypercube(): not supported!");
+  }
+
+  /// Random number stream (getSeed(), \p Index, \p Substream)
+  RandomStream randomStream(uint64_t Index, uint32_t Substream) const {
+    return RandomStream(getSeed(), Index, Substream);
+  }
 };
 
 } // ns::ComPWA
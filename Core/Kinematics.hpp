@@ -5,10 +5,12 @@
 #ifndef COMPWA_KINEMATICS_HPP_
 #define COMPWA_KINEMATICS_HPP_
 
-namespace ComPWA {
+#include <string>
+#include <vector>
+
+#include "Core/Event.hpp"
 
-struct DataPoint;
-struct Event;
+namespace ComPWA {
 
 /// The Kinematics interface is responsible for converting an Event into a
 /// DataPoint.
@@ -18,8 +20,71 @@ public:
 
   virtual DataPoint convert(const ComPWA::Event &event) const = 0;
 
+  /// Converts all \p Events directly into \p Columns (one column per
+  /// kinematic variable, in the order of getKinematicVariableNames()) and
+  /// \p Weights. The default implementation calls convert() for each event;
+  /// implementations can provide a faster batch conversion.
+  virtual void convert(const std::vector<ComPWA::Event> &Events,
+                       std::vector<std::vector<double>> &Columns,
+                       std::vector<double> &Weights) const {
+    Columns.assign(getKinematicVariableNames().size(), {});
+    for (auto &x : Columns)
+      x.reserve(Events.size());
+    Weights.clear();
+    Weights.reserve(Events.size());
+    for (auto const &evt : Events) {
+      DataPoint point(convert(evt));
+      for (size_t i = 0; i < Columns.size(); ++i)
+        Columns[i].push_back(point.KinematicVariableList[i]);
+      Weights.push_back(point.Weight);
+    }
+  }
+
+  /// Converts only the variables with set flag in \p Variables (in the order
+  /// of getKinematicVariableNames()), the other columns are left empty.
+  /// The default implementation converts all variables and drops the others.
+  virtual void convert(const std::vector<ComPWA::Event> &Events,
+                       const std::vector<bool> &Variables,
+                       std::vector<std::vector<double>> &Columns,
+                       std::vector<double> &Weights) const {
+    convert(Events, Columns, Weights);
+    for (size_t i = 0; i < Columns.size() && i < Variables.size(); ++i) {
+      if (!Variables[i])
+        std::vector<double>().swap(Columns[i]);
+    }
+  }
+
+  /// Like convert(const std::vector<Event> &, const std::vector<bool> &, ...)
+  /// for events in the packed layout, e.g. read from a columnar file. The
+  /// default implementation unpacks the events.
+  virtual void convert(const PackedEvents &Events,
+                       const std::vector<bool> &Variables,
+                       std::vector<std::vector<double>> &Columns,
+                       std::vector<double> &Weights) const {
+    convert(Events.unpack(), Variables, Columns, Weights);
+  }
+
   virtual std::vector<std::string> getKinematicVariableNames() const = 0;
 
+  /// Description of all settings (besides the variable names) which affect
+  /// the values of the kinematic variables, e.g. the masses of the particles.
+  /// It identifies cached variables, see Data::KinematicsCache.
+  virtual std::string configuration() const { return ""; }
+
+  /// Flags of the variables (in the order of getKinematicVariableNames())
+  /// which are used by the model. Code which only evaluates the model can
+  /// pass them to the batch convert() with variable flags to skip the other
+  /// variables.
+  virtual std::vector<bool> getUsedKinematicVariables() const {
+    return std::vector<bool>(getKinematicVariableNames().size(), true);
+  }
+
+  /// Replaces the flags of getUsedKinematicVariables(), e.g. by the ones which
+  /// are derived from the FunctionTree of the model (see
+  /// Data::findUsedKinematicVariables()). The default implementation ignores
+  /// them, so that all variables are calculated.
+  virtual void setUsedKinematicVariables(const std::vector<bool> &Variables) {}
+
   /// checks if DataPoint is within phase space boundaries
   virtual bool isWithinPhaseSpace(const DataPoint &point) const = 0;
 
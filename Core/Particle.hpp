@@ -20,6 +20,8 @@
 
 #include <boost/property_tree/ptree.hpp>
 
+#include "Core/FourVector.hpp"
+
 namespace ComPWA {
 
 /// Check of numbers \p x and \p are equal within \p nEpsion times the numerical
@@ -33,6 +35,8 @@ inline bool equal(double x, double y, int nEpsilon) {
 ///
 /// \class FourMomentum
 /// ComPWA four momentum class.
+/// The polymorphic interface is kept for compatibility. Performance critical
+/// code should use the non-virtual FourVector, see vector().
 ///
 class FourMomentum {
 
@@ -42,6 +46,9 @@ public:
 
   FourMomentum(std::array<double, 4> p4) : P4(p4) {}
 
+  FourMomentum(const FourVector &p4)
+      : P4(std::array<double, 4>{{p4.Px, p4.Py, p4.Pz, p4.E}}) {}
+
   FourMomentum(std::vector<double> p4) {
     if (p4.size() != 4)
       throw std::runtime_error(
@@ -49,14 +56,14 @@ public:
     P4 = std::array<double, 4>{{p4.at(0), p4.at(1), p4.at(2), p4.at(3)}};
   }
 
-  virtual void setPx(double px) { P4.at(0) = px; }
-  virtual void setPy(double py) { P4.at(1) = py; }
-  virtual void setPz(double pz) { P4.at(2) = pz; }
-  virtual void setE(double E) { P4.at(3) = E; }
-  virtual double px() const { return P4.at(0); }
-  virtual double py() const { return P4.at(1); }
-  virtual double pz() const { return P4.at(2); }
-  virtual double e() const { return P4.at(3); }
+  virtual void setPx(double px) { P4[0] = px; }
+  virtual void setPy(double py) { P4[1] = py; }
+  virtual void setPz(double pz) { P4[2] = pz; }
+  virtual void setE(double E) { P4[3] = E; }
+  virtual double px() const { return P4[0]; }
+  virtual double py() const { return P4[1]; }
+  virtual double pz() const { return P4[2]; }
+  virtual double e() const { return P4[3]; }
 
   FourMomentum operator+(const FourMomentum &pB) const {
     FourMomentum newP(*this);
@@ -65,10 +72,15 @@ public:
   }
 
   void operator+=(const FourMomentum &pB) {
-    std::transform(P4.begin(), P4.end(), pB.P4.begin(), P4.begin(),
-                   std::plus<double>());
+    P4[0] += pB.P4[0];
+    P4[1] += pB.P4[1];
+    P4[2] += pB.P4[2];
+    P4[3] += pB.P4[3];
   }
 
+  /// Non-virtual copy of the four momentum
+  FourVector vector() const { return FourVector(P4[0], P4[1], P4[2], P4[3]); }
+
   operator std::vector<double>() {
     return std::vector<double>(P4.begin(), P4.end());
   }
@@ -104,15 +116,11 @@ public:
   }
 
   static double invariantMass(const FourMomentum &p4) {
-    auto vec = p4.value();
-    return ((-1) * (vec.at(0) * vec.at(0) + vec.at(1) * vec.at(1) +
-                    vec.at(2) * vec.at(2) - vec.at(3) * vec.at(3)));
+    return p4.vector().invMassSq();
   }
 
   static double threeMomentumSq(const FourMomentum &p4) {
-    auto vec = p4.value();
-    return (vec.at(0) * vec.at(0) + vec.at(1) * vec.at(1) +
-            vec.at(2) * vec.at(2));
+    return p4.vector().threeMomentumSq();
   }
 
 protected:
@@ -154,6 +162,9 @@ public:
 
   virtual const FourMomentum &fourMomentum() const { return P4; }
 
+  /// Non-virtual copy of the four momentum
+  FourVector fourVector() const { return P4.vector(); }
+
   friend std::ostream &operator<<(std::ostream &stream, const Particle &p) {
     stream << "Particle id=" << p.pid() << " charge=" << p.charge()
            << " p4=" << p.fourMomentum();
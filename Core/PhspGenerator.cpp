@@ -0,0 +1,375 @@
+// Copyright (c) 2015, 2017 The ComPWA Team.
+// This file is part of the ComPWA framework, check
+// https://github.com/ComPWA/ComPWA/license.txt for details.
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+
+#include "Core/Logging.hpp"
+#include "Core/PhspGenerator.hpp"
+
+namespace ComPWA {
+
+/// Momentum of the daughters with masses \p b and \p c in the rest frame of
+/// \p a (copied from ROOT)
+static inline double PDK(double a, double b, double c) {
+  double x = (a - b - c) * (a + b + c) * (a - b + c) * (a + b - c);
+  return std::sqrt(x) / (2.0 * a);
+}
+
+/// Sine and cosine of \f$ 2 \pi u \f$ for \f$ 0 \le u < 1 \f$. In contrast to
+/// std::sin() and std::cos() it is inlined, so that loops over it are
+/// vectorized. The argument is reduced to \f$ |x| \le \pi / 4 \f$, where the
+/// Taylor series up to \f$ x^{16} \f$ is accurate to a few ulp.
+static inline void sinCosTwoPi(double u, double &Sin, double &Cos) {
+  int Quadrant = int(4.0 * u + 0.5);
+  double x = 2.0 * M_PI * (u - 0.25 * Quadrant);
+  double x2 = x * x;
+  double s =
+      x *
+      (1.0 +
+       x2 * (-1.0 / 6 +
+             x2 * (1.0 / 120 +
+                   x2 * (-1.0 / 5040 +
+                         x2 * (1.0 / 362880 +
+                               x2 * (-1.0 / 39916800 +
+                                     x2 * (1.0 / 6227020800 +
+                                           x2 * (-1.0 / 1307674368000))))))));
+  double c =
+      1.0 +
+      x2 * (-1.0 / 2 +
+            x2 * (1.0 / 24 +
+                  x2 * (-1.0 / 720 +
+                        x2 * (1.0 / 40320 +
+                              x2 * (-1.0 / 3628800 +
+                                    x2 * (1.0 / 479001600 +
+                                          x2 * (-1.0 / 87178291200 +
+                                                x2 / 20922789888000)))))));
+  // rotate by the quadrant: (s, c) -> (c, -s) -> (-s, -c) -> (-c, s)
+  int q = Quadrant & 3;
+  double s1 = (q & 1) ? c : s;
+  double c1 = (q & 1) ? -s : c;
+  Sin = (q & 2) ? -s1 : s1;
+  Cos = (q & 2) ? -c1 : c1;
+}
+
+PhspGenerator::PhspGenerator(const ComPWA::FourMomentum &CMSP4_,
+                             const std::vector<double> &FinalStateMasses_,
+                             int Seed_)
+    : FinalStateMasses(FinalStateMasses_), CMSP4(CMSP4_.vector()),
+      UniformStream(0, 0) {
+  if (Seed_ == -1)
+    setSeed(std::random_device()());
+  else
+    setSeed(Seed_);
+
+  unsigned int NumberOfParticles = FinalStateMasses.size();
+  if (NumberOfParticles < 2)
+    throw std::runtime_error(
+        "PhspGenerator::PhspGenerator(): one particle is not enough!");
+  if (NumberOfParticles == 2)
+    LOG(INFO) << "PhspGenerator::PhspGenerator(): only 2 particles in the "
+                 "final state! There are no degrees of freedom!";
+
+  CMSEnergyMinusMasses = CMSP4.invMass();
+  for (double m : FinalStateMasses)
+    CMSEnergyMinusMasses -= m;
+  if (CMSEnergyMinusMasses <= 0)
+    throw std::runtime_error(
+        "PhspGenerator::PhspGenerator(): not enough energy for this decay");
+
+  double emmax = CMSEnergyMinusMasses + FinalStateMasses[0];
+  double emmin = 0.0;
+  double wtmax = 1.0;
+  for (unsigned int n = 1; n < NumberOfParticles; ++n) {
+    emmin += FinalStateMasses[n - 1];
+    emmax += FinalStateMasses[n];
+    wtmax *= PDK(emmax, emmin, FinalStateMasses[n]);
+  }
+  MaximumWeight = 1.0 / wtmax;
+
+  CMSBeta[0] = CMSP4.Px / CMSP4.E;
+  CMSBeta[1] = CMSP4.Py / CMSP4.E;
+  CMSBeta[2] = CMSP4.Pz / CMSP4.E;
+}
+
+void PhspGenerator::setSeed(unsigned int Seed_) {
+  Seed = Seed_;
+  NextIndex = 0;
+  EventBuffer.clear();
+  EventBufferPosition = 0;
+  UniformStream = RandomStream(Seed, 0, UniformSubstream);
+}
+
+double PhspGenerator::uniform(double min, double max) {
+  return UniformStream.uniform(min, max);
+}
+
+double PhspGenerator::gauss(double mu, double sigma) const {
+  // Box-Muller transformation
+  double r = std::sqrt(-2.0 * std::log(1.0 - UniformStream.uniform()));
+  return mu + sigma * r * std::cos(2.0 * M_PI * UniformStream.uniform());
+}
+
+ComPWA::Event PhspGenerator::generate() {
+  if (EventBufferPosition == EventBuffer.size()) {
+    EventBuffer.resize(BlockSize);
+    generateEvents(NextIndex, EventBuffer.begin(), EventBuffer.end());
+    NextIndex += BlockSize;
+    EventBufferPosition = 0;
+  }
+  return EventBuffer[EventBufferPosition++];
+}
+
+ComPWA::Event PhspGenerator::generateEvent(uint64_t Index) const {
+  std::vector<ComPWA::Event> Events(1);
+  generateEvents(Index, Events.begin(), Events.end());
+  return Events.front();
+}
+
+void PhspGenerator::generateEvents(
+    uint64_t FirstIndex, std::vector<ComPWA::Event>::iterator First,
+    std::vector<ComPWA::Event>::iterator Last) const {
+  Block Events;
+  while (First != Last) {
+    unsigned int Size = std::min<size_t>(BlockSize, Last - First);
+    generateBlock(FirstIndex, Size, Events);
+    copyBlock(Events, Size, First);
+    First += Size;
+    FirstIndex += Size;
+  }
+}
+
+unsigned int PhspGenerator::unitHypercubeDimension() const {
+  return 3 * FinalStateMasses.size() - 4;
+}
+
+void PhspGenerator::mapUnitHypercube(
+    const std::vector<double> &Points,
+    std::vector<ComPWA::Event>::iterator First,
+    std::vector<ComPWA::Event>::iterator Last) const {
+  const unsigned int Dimension(unitHypercubeDimension());
+  if (Points.size() != Dimension * size_t(Last - First))
+    throw std::runtime_error("PhspGenerator::mapUnitHypercube(): number of "
+                             "coordinates does not match the events!");
+  Block Events;
+  std::vector<double> Random(Dimension * BlockSize);
+  const double *Point = Points.data();
+  while (First != Last) {
+    unsigned int Size = std::min<size_t>(BlockSize, Last - First);
+    for (unsigned int i = 0; i < Size; ++i, Point += Dimension)
+      for (unsigned int k = 0; k < Dimension; ++k)
+        Random[k * BlockSize + i] = Point[k];
+    mapBlock(Random, Size, Events);
+    copyBlock(Events, Size, First);
+    First += Size;
+  }
+}
+
+void PhspGenerator::copyBlock(
+    const Block &Events, unsigned int Size,
+    std::vector<ComPWA::Event>::iterator First) const {
+  unsigned int NumberOfParticles(FinalStateMasses.size());
+  for (unsigned int i = 0; i < Size; ++i, ++First) {
+    First->ParticleList.clear();
+    First->ParticleList.reserve(NumberOfParticles);
+    for (unsigned int j = 0; j < NumberOfParticles; ++j) {
+      const double *p = &Events.Momenta[4 * j * BlockSize + i];
+      First->ParticleList.push_back(
+          Particle(p[0], p[BlockSize], p[2 * BlockSize], p[3 * BlockSize]));
+    }
+    First->Weight = Events.Weights[i];
+  }
+}
+
+void PhspGenerator::generate(uint64_t FirstIndex, size_t NumberOfEvents,
+                             PackedEvents &Events) const {
+  unsigned int NumberOfParticles(FinalStateMasses.size());
+  Events.NumberOfParticles = NumberOfParticles;
+  Events.Momenta.resize(NumberOfEvents * NumberOfParticles);
+  Events.Pids.clear();
+  Events.Charges.clear();
+  Events.Weights.resize(NumberOfEvents);
+  Block Buffer;
+  for (size_t Offset = 0; Offset < NumberOfEvents; Offset += BlockSize) {
+    unsigned int Size = std::min<size_t>(BlockSize, NumberOfEvents - Offset);
+    generateBlock(FirstIndex + Offset, Size, Buffer);
+    for (unsigned int i = 0; i < Size; ++i) {
+      FourVector *Event = &Events.Momenta[(Offset + i) * NumberOfParticles];
+      for (unsigned int j = 0; j < NumberOfParticles; ++j) {
+        const double *p = &Buffer.Momenta[4 * j * BlockSize + i];
+        Event[j] =
+            FourVector(p[0], p[BlockSize], p[2 * BlockSize], p[3 * BlockSize]);
+      }
+      Events.Weights[Offset + i] = Buffer.Weights[i];
+    }
+  }
+}
+
+void PhspGenerator::generateBlock(uint64_t FirstIndex, unsigned int Size,
+                                  Block &Events) const {
+  const unsigned int N(FinalStateMasses.size());
+  const unsigned int BS(BlockSize);
+
+  // random numbers of the event i: N-2 for the invariant masses and two for
+  // the direction of each of the N-1 two-body decays, in the same order as in
+  // RootGenerator. Random number k of event i is Random[k * BS + i].
+  // The streams are generated block by block for all events, so that the
+  // Philox rounds are vectorized.
+  const unsigned int NumberOfRandomNumbers(N - 2 + 2 * (N - 1));
+  std::vector<double> Random((NumberOfRandomNumbers + 1) * BS);
+  const Philox4x32::Key Key(RandomStream::key(getSeed()));
+  for (unsigned int k = 0; k < NumberOfRandomNumbers; k += 2) {
+    double *First = &Random[k * BS];
+    double *Second = First + BS;
+    for (unsigned int i = 0; i < Size; ++i) {
+      Philox4x32::Counter Bits(
+          RandomStream::counter(FirstIndex + i, EventSubstream, k / 2));
+      uint32_t c0(Bits[0]), c1(Bits[1]), c2(Bits[2]), c3(Bits[3]);
+      Philox4x32::generate(c0, c1, c2, c3, Key[0], Key[1]);
+      First[i] = RandomStream::toUniform(c0, c1);
+      Second[i] = RandomStream::toUniform(c2, c3);
+    }
+  }
+  mapBlock(Random, Size, Events);
+}
+
+void PhspGenerator::mapBlock(const std::vector<double> &Random,
+                             unsigned int Size, Block &Events) const {
+  const unsigned int N(FinalStateMasses.size());
+  const unsigned int BS(BlockSize);
+  Events.Momenta.resize(4 * N * BS);
+  Events.Weights.assign(BS, MaximumWeight);
+
+  // invariant masses of the subsystems of the first n+1 particles
+  std::vector<double> InvariantMasses(N * BS);
+  std::vector<double> Ordered(N);
+  for (unsigned int i = 0; i < Size; ++i) {
+    // insertion sort of the N-2 random numbers, N is small
+    Ordered[0] = 0.0;
+    for (unsigned int n = 1; n < N - 1; ++n) {
+      double x = Random[(n - 1) * BS + i];
+      unsigned int k = n;
+      for (; k > 1 && Ordered[k - 1] > x; --k)
+        Ordered[k] = Ordered[k - 1];
+      Ordered[k] = x;
+    }
+    Ordered[N - 1] = 1.0;
+    double Sum(0.0);
+    for (unsigned int n = 0; n < N; ++n) {
+      Sum += FinalStateMasses[n];
+      InvariantMasses[n * BS + i] = Ordered[n] * CMSEnergyMinusMasses + Sum;
+    }
+  }
+
+  // two-body momenta and weights
+  std::vector<double> Momenta((N - 1) * BS);
+  double *Weight = Events.Weights.data();
+  for (unsigned int n = 0; n < N - 1; ++n) {
+    const double *a = &InvariantMasses[(n + 1) * BS];
+    const double *b = &InvariantMasses[n * BS];
+    const double c = FinalStateMasses[n + 1];
+    double *pd = &Momenta[n * BS];
+    for (unsigned int i = 0; i < Size; ++i) {
+      pd[i] = PDK(a[i], b[i], c);
+      Weight[i] *= pd[i];
+    }
+  }
+
+  auto Px = [&Events, BS](unsigned int j) {
+    return &Events.Momenta[4 * j * BS];
+  };
+  auto Py = [&Events, BS](unsigned int j) {
+    return &Events.Momenta[(4 * j + 1) * BS];
+  };
+  auto Pz = [&Events, BS](unsigned int j) {
+    return &Events.Momenta[(4 * j + 2) * BS];
+  };
+  auto E = [&Events, BS](unsigned int j) {
+    return &Events.Momenta[(4 * j + 3) * BS];
+  };
+
+  // complete specification of event (Raubold-Lynch method)
+  for (unsigned int i = 0; i < Size; ++i) {
+    double p = Momenta[i];
+    Px(0)[i] = 0.0;
+    Py(0)[i] = p;
+    Pz(0)[i] = 0.0;
+    E(0)[i] = std::sqrt(p * p + FinalStateMasses[0] * FinalStateMasses[0]);
+  }
+  std::vector<double> CosZ(BS), SinZ(BS), CosY(BS), SinY(BS);
+  for (unsigned int n = 1; n < N; ++n) {
+    const double *pd = &Momenta[(n - 1) * BS];
+    const double m(FinalStateMasses[n]);
+    for (unsigned int i = 0; i < Size; ++i) {
+      Px(n)[i] = 0.0;
+      Py(n)[i] = -pd[i];
+      Pz(n)[i] = 0.0;
+      E(n)[i] = std::sqrt(pd[i] * pd[i] + m * m);
+    }
+
+    const double *RandomZ = &Random[(N - 2 + 2 * (n - 1)) * BS];
+    const double *RandomY = RandomZ + BS;
+    for (unsigned int i = 0; i < Size; ++i) {
+      CosZ[i] = 2.0 * RandomZ[i] - 1.0;
+      SinZ[i] = std::sqrt(1.0 - CosZ[i] * CosZ[i]);
+      sinCosTwoPi(RandomY[i], SinY[i], CosY[i]);
+    }
+    // rotation around Z and Y
+    for (unsigned int j = 0; j <= n; ++j) {
+      double *x = Px(j), *y = Py(j), *z = Pz(j);
+      for (unsigned int i = 0; i < Size; ++i) {
+        double xr = CosZ[i] * x[i] - SinZ[i] * y[i];
+        double yr = SinZ[i] * x[i] + CosZ[i] * y[i];
+        double zr = z[i];
+        x[i] = CosY[i] * xr - SinY[i] * zr;
+        y[i] = yr;
+        z[i] = SinY[i] * xr + CosY[i] * zr;
+      }
+    }
+    if (n == N - 1)
+      break;
+
+    // boost along y into the rest frame of the subsystem of the first n+2
+    // particles
+    const double *InvariantMass = &InvariantMasses[n * BS];
+    const double *p = &Momenta[n * BS];
+    double *Gamma = CosZ.data(), *BetaGamma = SinZ.data();
+    for (unsigned int i = 0; i < Size; ++i) {
+      double r = InvariantMass[i] / p[i];
+      double BetaSq = 1.0 / (1.0 + r * r);
+      Gamma[i] = 1.0 / std::sqrt(1.0 - BetaSq);
+      BetaGamma[i] = 1.0 / std::sqrt((1.0 - BetaSq) / BetaSq);
+    }
+    for (unsigned int j = 0; j <= n; ++j) {
+      double *y = Py(j), *t = E(j);
+      for (unsigned int i = 0; i < Size; ++i) {
+        double yb = Gamma[i] * y[i] + BetaGamma[i] * t[i];
+        t[i] = Gamma[i] * t[i] + BetaGamma[i] * y[i];
+        y[i] = yb;
+      }
+    }
+  }
+
+  // final boost of all particles
+  double bx(CMSBeta[0]), by(CMSBeta[1]), bz(CMSBeta[2]);
+  double BetaSq = bx * bx + by * by + bz * bz;
+  if (BetaSq > 0.0) {
+    double Gamma = 1.0 / std::sqrt(1.0 - BetaSq);
+    double Gamma2 = (Gamma - 1.0) / BetaSq;
+    for (unsigned int j = 0; j < N; ++j) {
+      double *x = Px(j), *y = Py(j), *z = Pz(j), *t = E(j);
+      for (unsigned int i = 0; i < Size; ++i) {
+        double bp = bx * x[i] + by * y[i] + bz * z[i];
+        x[i] += Gamma2 * bp * bx + Gamma * bx * t[i];
+        y[i] += Gamma2 * bp * by + Gamma * by * t[i];
+        z[i] += Gamma2 * bp * bz + Gamma * bz * t[i];
+        t[i] = Gamma * (t[i] + bp);
+      }
+    }
+  }
+}
+
+} // namespace ComPWA
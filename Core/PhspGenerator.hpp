@@ -0,0 +1,128 @@
+// Copyright (c) 2015, 2017 The ComPWA Team.
+// This file is part of the ComPWA framework, check
+// https://github.com/ComPWA/ComPWA/license.txt for details.
+
+///
+/// \file
+/// Phase space generator without ROOT dependency.
+///
+
+#ifndef COMPWA_PHSPGENERATOR_HPP_
+#define COMPWA_PHSPGENERATOR_HPP_
+
+#include <cstdint>
+#include <vector>
+
+#include "Core/Event.hpp"
+#include "Core/FourVector.hpp"
+#include "Core/Generator.hpp"
+#include "Core/Particle.hpp"
+#include "Core/RandomStream.hpp"
+
+namespace ComPWA {
+
+///
+/// \class PhspGenerator
+/// Phase space generator using the Raubold-Lynch method, as GENBOD and
+/// TGenPhaseSpace. The events are generated in blocks, whose momenta are
+/// stored as structure of arrays (one array per particle and component), so
+/// that the two-body momenta, rotations and boosts are vectorized over the
+/// events of a block.
+///
+/// Each event is generated from its own random number stream (see
+/// RandomStream), so an event only depends on the seed and its index but not
+/// on the block it is generated in. The events are the same as the ones of
+/// RootGenerator::generateEvent() with the same seed, up to rounding.
+///
+class PhspGenerator : public Generator {
+public:
+  /// Number of events which are generated at once
+  static const unsigned int BlockSize = 256;
+
+  /// Substream of the random numbers of uniform() and gauss()
+  static const uint32_t UniformSubstream = 2;
+
+  /// A random seed is used if \p Seed is -1.
+  PhspGenerator(const ComPWA::FourMomentum &CMSP4,
+                const std::vector<double> &FinalStateMasses, int Seed = -1);
+
+  virtual ~PhspGenerator() {}
+
+  /// Next event of the sequence generateEvent(0), generateEvent(1), ...
+  ComPWA::Event generate();
+
+  /// Sets the seed and restarts the sequence of generate() and uniform().
+  void setSeed(unsigned int Seed);
+
+  unsigned int getSeed() const { return Seed; }
+
+  double uniform(double min, double max);
+
+  double gauss(double mu, double sigma) const;
+
+  bool hasRandomStreams() const { return true; }
+
+  ComPWA::Event generateEvent(uint64_t Index) const;
+
+  void generateEvents(uint64_t FirstIndex,
+                      std::vector<ComPWA::Event>::iterator First,
+                      std::vector<ComPWA::Event>::iterator Last) const;
+
+  /// 3 N - 4 for N final state particles: N - 2 numbers for the invariant
+  /// masses and two for the direction of each two-body decay
+  unsigned int unitHypercubeDimension() const;
+
+  void mapUnitHypercube(const std::vector<double> &Points,
+                        std::vector<ComPWA::Event>::iterator First,
+                        std::vector<ComPWA::Event>::iterator Last) const;
+
+  /// Generates the events \p FirstIndex, ..., \p FirstIndex + \p
+  /// NumberOfEvents - 1 into \p Events.
+  void generate(uint64_t FirstIndex, size_t NumberOfEvents,
+                PackedEvents &Events) const;
+
+private:
+  /// Momenta and weights of a block of events. Component c of particle j in
+  /// event i is stored in Momenta[(4 * j + c) * BlockSize + i].
+  struct Block {
+    std::vector<double> Momenta;
+    std::vector<double> Weights;
+  };
+
+  /// Generates the events \p FirstIndex, ..., \p FirstIndex + \p Size - 1
+  /// (\p Size <= BlockSize) into \p Events.
+  void generateBlock(uint64_t FirstIndex, unsigned int Size,
+                     Block &Events) const;
+
+  /// Generates \p Size <= BlockSize events from the unit hypercube
+  /// coordinates \p Random. Coordinate k of event i is Random[k * BlockSize +
+  /// i].
+  void mapBlock(const std::vector<double> &Random, unsigned int Size,
+                Block &Events) const;
+
+  /// Copies the first \p Size events of \p Events to \p First, ...
+  void copyBlock(const Block &Events, unsigned int Size,
+                 std::vector<ComPWA::Event>::iterator First) const;
+
+  unsigned int Seed;
+
+  std::vector<double> FinalStateMasses;
+  FourVector CMSP4;
+  /// Velocity of the CMS
+  double CMSBeta[3];
+  /// Total energy in the CMS minus the sum of the masses
+  double CMSEnergyMinusMasses;
+  double MaximumWeight;
+
+  /// Index of the next event of generate() and the events which are already
+  /// generated
+  uint64_t NextIndex;
+  std::vector<ComPWA::Event> EventBuffer;
+  size_t EventBufferPosition;
+
+  mutable RandomStream UniformStream;
+};
+
+} // namespace ComPWA
+
+#endif
@@ -0,0 +1,111 @@
+// Copyright (c) 2015, 2017 The ComPWA Team.
+// This file is part of the ComPWA framework, check
+// https://github.com/ComPWA/ComPWA/license.txt for details.
+
+///
+/// \file
+/// Counter-based random number streams.
+///
+
+#ifndef COMPWA_RANDOMSTREAM_HPP_
+#define COMPWA_RANDOMSTREAM_HPP_
+
+#include <array>
+#include <cstdint>
+
+namespace ComPWA {
+
+///
+/// \struct Philox4x32
+/// Counter-based random number generator Philox4x32-10 (Salmon et al.,
+/// "Parallel random numbers: as easy as 1, 2, 3", SC11). The output is a
+/// bijective function of the counter for a given key, so that random numbers
+/// can be generated for any counter without a sequential state.
+///
+struct Philox4x32 {
+  typedef std::array<uint32_t, 4> Counter;
+  typedef std::array<uint32_t, 2> Key;
+
+  static Counter generate(Counter Ctr, const Key &K) {
+    generate(Ctr[0], Ctr[1], Ctr[2], Ctr[3], K[0], K[1]);
+    return Ctr;
+  }
+
+  /// Replaces the counter (\p c0, \p c1, \p c2, \p c3) by the output.
+  /// Loops over this function are vectorized.
+  static void generate(uint32_t &c0, uint32_t &c1, uint32_t &c2, uint32_t &c3,
+                       uint32_t k0, uint32_t k1) {
+    for (unsigned int i = 0; i < 10; ++i) {
+      if (i > 0) {
+        k0 += 0x9E3779B9;
+        k1 += 0xBB67AE85;
+      }
+      uint64_t Product0 = uint64_t(0xD2511F53) * c0;
+      uint64_t Product1 = uint64_t(0xCD9E8D57) * c2;
+      c0 = uint32_t(Product1 >> 32) ^ c1 ^ k0;
+      c1 = uint32_t(Product1);
+      c2 = uint32_t(Product0 >> 32) ^ c3 ^ k1;
+      c3 = uint32_t(Product0);
+    }
+  }
+};
+
+///
+/// \class RandomStream
+/// Sequence of random numbers which is addressed by (\p Seed, \p Index,
+/// \p Substream), e.g. the event index and the purpose of the random numbers
+/// (phase space generation, hit-and-miss, ...). The numbers only depend on
+/// this address, so that e.g. events can be generated in any order and by any
+/// number of threads with identical results.
+///
+class RandomStream {
+public:
+  RandomStream(uint64_t Seed, uint64_t Index, uint32_t Substream = 0)
+      : K(key(Seed)), Ctr(counter(Index, Substream, 0)), Position(4) {}
+
+  /// Uniform random number in [0, 1) with 53 bit resolution
+  double uniform() {
+    if (Position == 4) {
+      Block = Philox4x32::generate(Ctr, K);
+      ++Ctr[3];
+      Position = 0;
+    }
+    double x = toUniform(Block[Position], Block[Position + 1]);
+    Position += 2;
+    return x;
+  }
+
+  /// Philox key of the streams with seed \p Seed. Together with counter()
+  /// and toUniform() it can be used to generate many streams at once.
+  static Philox4x32::Key key(uint64_t Seed) {
+    return {{uint32_t(Seed), uint32_t(Seed >> 32)}};
+  }
+  /// Philox counter of the random numbers 2 * \p BlockIndex and
+  /// 2 * \p BlockIndex + 1 of a stream
+  static Philox4x32::Counter counter(uint64_t Index, uint32_t Substream,
+                                     uint32_t BlockIndex) {
+    return {{uint32_t(Index), uint32_t(Index >> 32), Substream, BlockIndex}};
+  }
+
+  /// Uniform random number in [0, 1) from two words of a Philox block
+  static double toUniform(uint32_t High, uint32_t Low) {
+    // same as ((High << 21) | (Low >> 11)) / 2^53, but without a 64 bit
+    // integer conversion, which is not vectorized
+    return High * (1.0 / 4294967296.0) +
+           (Low >> 11) * (1.0 / 9007199254740992.0);
+  }
+
+  double uniform(double min, double max) {
+    return min + (max - min) * uniform();
+  }
+
+private:
+  Philox4x32::Key K;
+  Philox4x32::Counter Ctr;
+  Philox4x32::Counter Block;
+  unsigned int Position;
+};
+
+} // namespace ComPWA
+
+#endif
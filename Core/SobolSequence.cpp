@@ -0,0 +1,120 @@
+// Copyright (c) 2015, 2017 The ComPWA Team.
+// This file is part of the ComPWA framework, check
+// https://github.com/ComPWA/ComPWA/license.txt for details.
+
+#include <stdexcept>
+#include <string>
+
+#include "Core/RandomStream.hpp"
+#include "Core/SobolSequence.hpp"
+
+namespace ComPWA {
+
+/// Primitive polynomial of degree S with the coefficients A and the initial
+/// direction numbers M of a dimension
+struct SobolDirectionNumbers {
+  unsigned int S;
+  unsigned int A;
+  uint32_t M[7];
+};
+
+/// Direction numbers of the dimensions 2, 3, ... from new-joe-kuo-6.21201
+static const SobolDirectionNumbers
+    JoeKuoDirectionNumbers[SobolSequence::MaximumDimension - 1] = {
+        {1, 0, {1}},
+        {2, 1, {1, 3}},
+        {3, 1, {1, 3, 1}},
+        {3, 2, {1, 1, 1}},
+        {4, 1, {1, 1, 3, 3}},
+        {4, 4, {1, 3, 5, 13}},
+        {5, 2, {1, 1, 5, 5, 17}},
+        {5, 4, {1, 1, 5, 5, 5}},
+        {5, 7, {1, 1, 7, 11, 19}},
+        {5, 11, {1, 1, 5, 1, 1}},
+        {5, 13, {1, 1, 1, 3, 11}},
+        {5, 14, {1, 3, 5, 5, 31}},
+        {6, 1, {1, 3, 3, 9, 7, 49}},
+        {6, 13, {1, 1, 1, 15, 21, 21}},
+        {6, 16, {1, 3, 1, 13, 27, 49}},
+        {6, 19, {1, 1, 1, 15, 7, 5}},
+        {6, 22, {1, 3, 1, 15, 13, 25}},
+        {6, 25, {1, 1, 5, 5, 19, 61}},
+        {7, 1, {1, 3, 7, 11, 23, 15, 103}},
+        {7, 4, {1, 3, 7, 13, 13, 15, 69}}};
+
+static inline uint32_t reverseBits(uint32_t x) {
+  x = ((x >> 1) & 0x55555555u) | ((x & 0x55555555u) << 1);
+  x = ((x >> 2) & 0x33333333u) | ((x & 0x33333333u) << 2);
+  x = ((x >> 4) & 0x0F0F0F0Fu) | ((x & 0x0F0F0F0Fu) << 4);
+  x = ((x >> 8) & 0x00FF00FFu) | ((x & 0x00FF00FFu) << 8);
+  return (x >> 16) | (x << 16);
+}
+
+/// Nested uniform scrambling of the bits of \p x. The hash of Laine and
+/// Karras only lets the lower bits depend on the higher ones, so it is
+/// applied to the reversed bits.
+static inline uint32_t scramble(uint32_t x, uint32_t Seed) {
+  x = reverseBits(x);
+  x += Seed;
+  x ^= x * 0x6c50b47cu;
+  x ^= x * 0xb82f1e52u;
+  x ^= x * 0xc7afe638u;
+  x ^= x * 0x8d22f6e6u;
+  return reverseBits(x);
+}
+
+SobolSequence::SobolSequence(unsigned int Dimension_, uint64_t Seed)
+    : Dimension(Dimension_), Directions(32 * Dimension_),
+      Scrambles(Dimension_) {
+  if (Dimension == 0 || Dimension > MaximumDimension)
+    throw std::runtime_error("SobolSequence::SobolSequence(): dimension " +
+                             std::to_string(Dimension) + " not supported!");
+  for (unsigned int j = 0; j < 32; ++j)
+    Directions[j] = 1u << (31 - j);
+  for (unsigned int d = 1; d < Dimension; ++d) {
+    auto const &Numbers = JoeKuoDirectionNumbers[d - 1];
+    uint32_t *V = &Directions[32 * d];
+    for (unsigned int j = 0; j < 32; ++j) {
+      if (j < Numbers.S) {
+        V[j] = Numbers.M[j] << (31 - j);
+        continue;
+      }
+      V[j] = V[j - Numbers.S] ^ (V[j - Numbers.S] >> Numbers.S);
+      for (unsigned int k = 1; k < Numbers.S; ++k)
+        if ((Numbers.A >> (Numbers.S - 1 - k)) & 1)
+          V[j] ^= V[j - k];
+    }
+  }
+  RandomStream Stream(Seed, 0);
+  for (auto &x : Scrambles)
+    x = uint32_t(Stream.uniform() * 4294967296.0);
+}
+
+void SobolSequence::generate(uint64_t FirstIndex, size_t NumberOfPoints,
+                             double *Points) const {
+  if (FirstIndex + NumberOfPoints > (uint64_t(1) << 32))
+    throw std::runtime_error("SobolSequence::generate(): index out of range!");
+  // the point with index i is the sum of the direction numbers of the bits of
+  // the Gray code of i, consecutive Gray codes differ in a single bit
+  std::vector<uint32_t> X(Dimension, 0);
+  uint32_t Gray(FirstIndex ^ (FirstIndex >> 1));
+  for (unsigned int d = 0; d < Dimension; ++d)
+    for (unsigned int j = 0; j < 32; ++j)
+      if ((Gray >> j) & 1)
+        X[d] ^= Directions[32 * d + j];
+
+  for (size_t i = 0; i < NumberOfPoints; ++i) {
+    for (unsigned int d = 0; d < Dimension; ++d)
+      Points[i * Dimension + d] =
+          (scramble(X[d], Scrambles[d]) + 0.5) * (1.0 / 4294967296.0);
+    uint64_t Next(FirstIndex + i + 1);
+    unsigned int Bit(0);
+    while (!((Next >> Bit) & 1))
+      ++Bit;
+    if (Bit < 32)
+      for (unsigned int d = 0; d < Dimension; ++d)
+        X[d] ^= Directions[32 * d + Bit];
+  }
+}
+
+} // namespace ComPWA
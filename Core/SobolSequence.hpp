@@ -0,0 +1,54 @@
+// Copyright (c) 2015, 2017 The ComPWA Team.
+// This file is part of the ComPWA framework, check
+// https://github.com/ComPWA/ComPWA/license.txt for details.
+
+///
+/// \file
+/// Scrambled Sobol low-discrepancy sequence.
+///
+
+#ifndef COMPWA_SOBOLSEQUENCE_HPP_
+#define COMPWA_SOBOLSEQUENCE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ComPWA {
+
+///
+/// \class SobolSequence
+/// Sobol sequence with the direction numbers of S. Joe and F. Y. Kuo (SIAM J.
+/// Sci. Comput. 30 (2008) 2635). The points are randomized by a nested
+/// uniform (Owen) scrambling, implemented with the hash of Laine and Karras
+/// as proposed by B. Burley (JCGT 9 (2020) 4). The scrambled points keep the
+/// low discrepancy of the sequence, and the sequences of different seeds are
+/// independent randomizations. So the spread of quasi Monte Carlo estimates
+/// of several seeds estimates their error.
+///
+class SobolSequence {
+public:
+  static const unsigned int MaximumDimension = 21;
+
+  SobolSequence(unsigned int Dimension, uint64_t Seed);
+
+  unsigned int dimension() const { return Dimension; }
+
+  /// Generates the points \p FirstIndex, ..., \p FirstIndex + \p
+  /// NumberOfPoints - 1 in (0, 1)^dimension(). Coordinate k of point i is
+  /// stored in \p Points[i * dimension() + k]. At most 2^32 points are
+  /// supported.
+  void generate(uint64_t FirstIndex, size_t NumberOfPoints,
+                double *Points) const;
+
+private:
+  unsigned int Dimension;
+  /// 32 direction numbers per dimension
+  std::vector<uint32_t> Directions;
+  /// Seeds of the scrambling of each dimension
+  std::vector<uint32_t> Scrambles;
+};
+
+} // namespace ComPWA
+
+#endif
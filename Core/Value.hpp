@@ -11,6 +11,7 @@
 #define ParameterT_hpp
 
 #include <iterator>
+#include <utility>
 #include "Core/FitParameter.hpp"
 namespace ComPWA {
 
@@ -34,9 +35,9 @@ template <class T> class Value : public ComPWA::Parameter {
 public:
   Value(std::string name = "") : Parameter(name) { Type = typeName<T>(); }
 
-  Value(T val) : Parameter(""), Val(val) { Type = typeName<T>(); }
+  Value(T val) : Parameter(""), Val(std::move(val)) { Type = typeName<T>(); }
 
-  Value(std::string name, T val) : Parameter(name), Val(val) {
+  Value(std::string name, T val) : Parameter(name), Val(std::move(val)) {
     Type = typeName<T>();
   }
 
@@ -121,7 +122,8 @@ MComplex(std::string name, size_t s,
 inline std::shared_ptr<Value<std::vector<std::complex<double>>>>
 MComplex(std::string name, std::vector<std::complex<double>> v) {
 
-  return std::make_shared<Value<std::vector<std::complex<double>>>>(name, v);
+  return std::make_shared<Value<std::vector<std::complex<double>>>>(name,
+                                                                  std::move(v));
 }
 
 inline std::shared_ptr<Value<std::vector<double>>>
@@ -134,7 +136,7 @@ MDouble(std::string name, size_t s, double el = 0.) {
 inline std::shared_ptr<Value<std::vector<double>>>
 MDouble(std::string name, std::vector<double> v) {
 
-  return std::make_shared<Value<std::vector<double>>>(name, v);
+  return std::make_shared<Value<std::vector<double>>>(name, std::move(v));
 }
 
 inline std::shared_ptr<Value<std::vector<int>>>
@@ -147,7 +149,7 @@ MInteger(std::string name, size_t s, int el = 0.) {
 inline std::shared_ptr<Value<std::vector<int>>>
 MInteger(std::string name, std::vector<int> v) {
 
-  return std::make_shared<Value<std::vector<int>>>(name,v);
+  return std::make_shared<Value<std::vector<int>>>(name, std::move(v));
 }
 
 } // ns::ComPWA
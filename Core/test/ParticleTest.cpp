@@ -29,6 +29,29 @@ BOOST_AUTO_TEST_CASE(FourMomentum) {
   BOOST_CHECK_EQUAL(pSum.invMassSq(), 25.0);
 }
   
+BOOST_AUTO_TEST_CASE(FourVector) {
+  ComPWA::FourVector p4(1, 2, 3, 4);
+  BOOST_CHECK_EQUAL(p4.invMassSq(), 2.0);
+  BOOST_CHECK_EQUAL(p4.threeMomentumSq(), 14.0);
+  BOOST_CHECK_EQUAL(ComPWA::FourMomentum(1, 2, 3, 4).vector(), p4);
+
+  auto pTot = p4 + ComPWA::FourVector(1, 2, 3, 5);
+  BOOST_CHECK_EQUAL(pTot.invMassSq(), 25.0);
+
+  // the momentum vanishes in the own rest frame, the mass is conserved
+  ComPWA::FourVector p4Rest(p4);
+  p4Rest.boostToRestFrame(p4);
+  BOOST_CHECK_SMALL(p4Rest.threeMomentum(), 1e-12);
+  BOOST_CHECK_CLOSE(p4Rest.E, std::sqrt(2.0), 1e-10);
+
+  ComPWA::FourVector p4Rot(1, 0, 0, 4);
+  p4Rot.rotateZ(M_PI / 2);
+  BOOST_CHECK_CLOSE(p4Rot.phi(), M_PI / 2, 1e-10);
+  p4Rot.rotateY(M_PI / 2);
+  BOOST_CHECK_CLOSE(p4Rot.threeMomentum(), 1.0, 1e-10);
+  BOOST_CHECK_CLOSE(p4Rot.invMassSq(), 15.0, 1e-10);
+}
+
 BOOST_AUTO_TEST_CASE(Particle) {
   ComPWA::Particle part(1,2,3,4);
   BOOST_CHECK_EQUAL(part.massSq(), 2.0);
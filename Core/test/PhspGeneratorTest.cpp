@@ -0,0 +1,179 @@
+
+#define BOOST_TEST_MODULE Core
+
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+#include <Core/PhspGenerator.hpp>
+
+namespace ComPWA {
+
+BOOST_AUTO_TEST_SUITE(PhspGeneratorTest);
+
+void checkScenario(const ComPWA::FourMomentum &CMSP4,
+                   const std::vector<double> &Masses) {
+  ComPWA::PhspGenerator Generator(CMSP4, Masses, 1234);
+  double Epsilon(std::numeric_limits<double>::epsilon());
+
+  PackedEvents Events;
+  Generator.generate(0, 10000, Events);
+  BOOST_CHECK_EQUAL(Events.size(), 10000);
+  for (size_t i = 0; i < Events.size(); ++i) {
+    FourVector Sum(0.0, 0.0, 0.0, 0.0);
+    for (unsigned int j = 0; j < Masses.size(); ++j) {
+      FourVector p = Events.event(i)[j];
+      Sum += p;
+      double MassSq(p.invMassSq());
+      BOOST_CHECK_SMALL(MassSq - Masses[j] * Masses[j],
+                        1000 * Epsilon * p.E * p.E);
+    }
+    BOOST_CHECK_SMALL(Sum.E - CMSP4.e(), 100 * Epsilon * CMSP4.e());
+    BOOST_CHECK_SMALL(Sum.Pz - CMSP4.pz(), 100 * Epsilon * CMSP4.e());
+    BOOST_CHECK(Events.Weights[i] > 0.0 && Events.Weights[i] <= 1.0);
+  }
+
+  // the events only depend on the seed and the index
+  for (size_t i = 0; i < 300; i += 37) {
+    Event Single = Generator.generateEvent(i);
+    for (unsigned int j = 0; j < Masses.size(); ++j)
+      BOOST_CHECK_EQUAL(Single.ParticleList[j].fourVector(),
+                        Events.event(i)[j]);
+  }
+  Generator.setSeed(1234);
+  for (size_t i = 0; i < 300; ++i) {
+    Event Next = Generator.generate();
+    BOOST_CHECK_EQUAL(Next.ParticleList[0].fourVector(), Events.event(i)[0]);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(Precision) {
+  checkScenario(ComPWA::FourMomentum(0.0, 0.0, 0.0, 3.0), {0.2, 0.0});
+  checkScenario(ComPWA::FourMomentum(0.0, 0.0, 0.0, 3.0), {0.9, 0.9, 0.9});
+  checkScenario(ComPWA::FourMomentum(0.0, 0.0, 0.0, 4.0),
+                {0.1, 0.5, 0.2, 0.3, 0.1, 0.2});
+  checkScenario(ComPWA::FourMomentum(0.0, 0.0, 1.0, std::sqrt(17.0)),
+                {0.1, 0.5, 0.2, 0.3});
+}
+
+/// Källén function
+double lambda(double x, double y, double z) {
+  return x * x + y * y + z * z - 2.0 * (x * y + x * z + y * z);
+}
+
+/// Phase space density of the invariant mass squared \p s of the particles
+/// with masses \p m1 and \p m2 in the three-body decay of a particle with
+/// mass \p M: the flat Dalitz plot projected onto \p s.
+double massSqDensity(double s, double M, double m1, double m2, double m3) {
+  double a = lambda(s, m1 * m1, m2 * m2);
+  double b = lambda(M * M, s, m3 * m3);
+  if (a <= 0.0 || b <= 0.0)
+    return 0.0;
+  return std::sqrt(a * b) / s;
+}
+
+BOOST_AUTO_TEST_CASE(DalitzProjections) {
+  // boosted CMS, the invariant masses do not depend on the boost
+  const ComPWA::FourMomentum CMSP4(0.0, 0.5, 1.0, std::sqrt(10.25));
+  const double M(3.0);
+  const std::vector<double> Masses{0.5, 0.3, 0.2};
+  ComPWA::PhspGenerator Generator(CMSP4, Masses, 4321);
+  PackedEvents Events;
+  Generator.generate(0, 200000, Events);
+
+  // weighted histograms of the invariant masses squared of the pairs (0, 1),
+  // (1, 2) and (0, 2) compared with the analytic projections
+  const unsigned int Pairs[3][3] = {{0, 1, 2}, {1, 2, 0}, {0, 2, 1}};
+  const unsigned int NumberOfBins(40);
+  for (auto Pair : Pairs) {
+    double m1(Masses[Pair[0]]), m2(Masses[Pair[1]]), m3(Masses[Pair[2]]);
+    double Min((m1 + m2) * (m1 + m2)), Max((M - m3) * (M - m3));
+    double BinWidth((Max - Min) / NumberOfBins);
+    std::vector<double> Sum(NumberOfBins), SumSq(NumberOfBins);
+    double TotalWeight(0.0);
+    for (size_t i = 0; i < Events.size(); ++i) {
+      const FourVector *Event = Events.event(i);
+      double s = (Event[Pair[0]] + Event[Pair[1]]).invMassSq();
+      unsigned int Bin = std::min<unsigned int>((s - Min) / BinWidth,
+                                                NumberOfBins - 1);
+      double w = Events.Weights[i];
+      Sum[Bin] += w;
+      SumSq[Bin] += w * w;
+      TotalWeight += w;
+    }
+
+    // expected bin contents by Simpson integration of the density
+    std::vector<double> Expected(NumberOfBins);
+    double Norm(0.0);
+    const unsigned int Steps(20);
+    for (unsigned int Bin = 0; Bin < NumberOfBins; ++Bin) {
+      double h = BinWidth / Steps;
+      for (unsigned int k = 0; k < Steps; ++k) {
+        double a = Min + Bin * BinWidth + k * h;
+        Expected[Bin] += h / 6.0 *
+                         (massSqDensity(a, M, m1, m2, m3) +
+                          4.0 * massSqDensity(a + h / 2, M, m1, m2, m3) +
+                          massSqDensity(a + h, M, m1, m2, m3));
+      }
+      Norm += Expected[Bin];
+    }
+
+    double ChiSq(0.0);
+    for (unsigned int Bin = 0; Bin < NumberOfBins; ++Bin) {
+      double Difference = Sum[Bin] - Expected[Bin] / Norm * TotalWeight;
+      ChiSq += Difference * Difference / SumSq[Bin];
+    }
+    // the 99.9% quantile of the chi^2 distribution with 40 degrees of
+    // freedom is 73.4
+    BOOST_TEST_MESSAGE("chi^2 of the pair (" << Pair[0] << ", " << Pair[1]
+                                             << "): " << ChiSq);
+    BOOST_CHECK_LT(ChiSq, 73.4);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(UnitHypercube) {
+  const ComPWA::FourMomentum CMSP4(0.0, 0.0, 1.0, std::sqrt(17.0));
+  const std::vector<double> Masses{0.1, 0.5, 0.2, 0.3};
+  ComPWA::PhspGenerator Generator(CMSP4, Masses, 1234);
+  const unsigned int Dimension(Generator.unitHypercubeDimension());
+  BOOST_CHECK_EQUAL(Dimension, 8);
+
+  // the random numbers of the event streams are the coordinates of the
+  // events of generateEvent()
+  const size_t NumberOfEvents(600);
+  std::vector<double> Points;
+  Points.reserve(Dimension * NumberOfEvents);
+  for (size_t i = 0; i < NumberOfEvents; ++i) {
+    RandomStream Stream(
+        Generator.randomStream(i, ComPWA::Generator::EventSubstream));
+    for (unsigned int k = 0; k < Dimension; ++k)
+      Points.push_back(Stream.uniform());
+  }
+  std::vector<Event> Events(NumberOfEvents);
+  Generator.mapUnitHypercube(Points, Events.begin(), Events.end());
+  for (size_t i = 0; i < NumberOfEvents; i += 7) {
+    Event Single = Generator.generateEvent(i);
+    BOOST_CHECK_EQUAL(Single.Weight, Events[i].Weight);
+    for (unsigned int j = 0; j < Masses.size(); ++j)
+      BOOST_CHECK_EQUAL(Single.ParticleList[j].fourVector(),
+                        Events[i].ParticleList[j].fourVector());
+  }
+
+  // the corners of the hypercube are mapped to the boundary of the phase
+  // space, the invariant masses of the subsystems are at their thresholds
+  std::vector<double> Corner(Dimension, 0.0);
+  std::vector<Event> CornerEvent(1);
+  Generator.mapUnitHypercube(Corner, CornerEvent.begin(), CornerEvent.end());
+  BOOST_CHECK_SMALL(CornerEvent[0].Weight, 1e-12);
+
+  Points.pop_back();
+  BOOST_CHECK_THROW(
+      Generator.mapUnitHypercube(Points, Events.begin(), Events.end()),
+      std::runtime_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
+
+} // namespace ComPWA
@@ -0,0 +1,54 @@
+
+#define BOOST_TEST_MODULE Core
+
+#include <boost/test/unit_test.hpp>
+#include <Core/RandomStream.hpp>
+
+namespace ComPWA {
+
+BOOST_AUTO_TEST_SUITE(RandomStreamTest);
+
+BOOST_AUTO_TEST_CASE(Philox4x32KnownAnswers) {
+  // known answer tests of the Random123 reference implementation
+  auto Result = Philox4x32::generate({{0, 0, 0, 0}}, {{0, 0}});
+  BOOST_CHECK_EQUAL(Result[0], 0x6627e8d5u);
+  BOOST_CHECK_EQUAL(Result[1], 0xe169c58du);
+  BOOST_CHECK_EQUAL(Result[2], 0xbc57ac4cu);
+  BOOST_CHECK_EQUAL(Result[3], 0x9b00dbd8u);
+
+  Result = Philox4x32::generate(
+      {{0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff}},
+      {{0xffffffff, 0xffffffff}});
+  BOOST_CHECK_EQUAL(Result[0], 0x408f276du);
+  BOOST_CHECK_EQUAL(Result[1], 0x41c83b0eu);
+  BOOST_CHECK_EQUAL(Result[2], 0xa20bc7c6u);
+  BOOST_CHECK_EQUAL(Result[3], 0x6d5451fdu);
+
+  Result = Philox4x32::generate(
+      {{0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}},
+      {{0xa4093822, 0x299f31d0}});
+  BOOST_CHECK_EQUAL(Result[0], 0xd16cfe09u);
+  BOOST_CHECK_EQUAL(Result[1], 0x94fdccebu);
+  BOOST_CHECK_EQUAL(Result[2], 0x5001e420u);
+  BOOST_CHECK_EQUAL(Result[3], 0x24126ea1u);
+}
+
+BOOST_AUTO_TEST_CASE(Streams) {
+  RandomStream A(123, 42, 1), B(123, 42, 1), C(123, 43, 1), D(123, 42, 0);
+  double Sum(0.0);
+  unsigned int NumberOfDifferences(0);
+  for (unsigned int i = 0; i < 10000; ++i) {
+    double x = A.uniform();
+    BOOST_CHECK(x >= 0.0 && x < 1.0);
+    BOOST_CHECK_EQUAL(x, B.uniform());
+    if (x != C.uniform() && x != D.uniform())
+      ++NumberOfDifferences;
+    Sum += x;
+  }
+  BOOST_CHECK_EQUAL(NumberOfDifferences, 10000);
+  BOOST_CHECK_CLOSE(Sum / 10000, 0.5, 2.0);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
+
+} // namespace ComPWA
@@ -0,0 +1,51 @@
+
+#define BOOST_TEST_MODULE Core
+
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+#include <Core/SobolSequence.hpp>
+
+namespace ComPWA {
+
+BOOST_AUTO_TEST_SUITE(SobolSequenceTest);
+
+BOOST_AUTO_TEST_CASE(Stratification) {
+  // the first 2^m points of each dimension lie in different intervals of
+  // length 2^-m, which the scrambling preserves
+  const unsigned int Dimension(SobolSequence::MaximumDimension);
+  const size_t NumberOfPoints(1024);
+  SobolSequence Sequence(Dimension, 1234);
+  std::vector<double> Points(NumberOfPoints * Dimension);
+  Sequence.generate(0, NumberOfPoints, Points.data());
+  for (unsigned int d = 0; d < Dimension; ++d) {
+    std::vector<int> Counts(NumberOfPoints, 0);
+    for (size_t i = 0; i < NumberOfPoints; ++i) {
+      double x = Points[i * Dimension + d];
+      BOOST_REQUIRE(x > 0.0 && x < 1.0);
+      ++Counts[size_t(x * NumberOfPoints)];
+    }
+    for (auto c : Counts)
+      BOOST_CHECK_EQUAL(c, 1);
+  }
+  // the first two dimensions are a (0, m, 2)-net
+  std::vector<int> Counts(NumberOfPoints, 0);
+  for (size_t i = 0; i < NumberOfPoints; ++i)
+    ++Counts[size_t(Points[i * Dimension] * 32) * 32 +
+             size_t(Points[i * Dimension + 1] * 32)];
+  for (auto c : Counts)
+    BOOST_CHECK_EQUAL(c, 1);
+}
+
+BOOST_AUTO_TEST_CASE(IndependentOfPartition) {
+  SobolSequence Sequence(5, 1);
+  std::vector<double> All(5 * 100), Parts(5 * 100);
+  Sequence.generate(0, 100, All.data());
+  Sequence.generate(0, 37, Parts.data());
+  Sequence.generate(37, 63, Parts.data() + 5 * 37);
+  BOOST_CHECK(All == Parts);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
+
+} // namespace ComPWA
@@ -2,50 +2,260 @@
 // This file is part of the ComPWA framework, check
 // https://github.com/ComPWA/ComPWA/license.txt for details.
 
-#include <fstream>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <locale>
+#include <numeric>
 #include <sstream>
+#include <thread>
 #include <utility>
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include "AsciiReader.hpp"
+#include "Core/Concurrency.hpp"
 #include "Core/Exceptions.hpp"
+#include "Core/Logging.hpp"
 
 namespace ComPWA {
 namespace Data {
 
-// Constructors and destructors
-AsciiReader::AsciiReader(unsigned int NumberOfParticles_)
-    : NumberOfParticles(NumberOfParticles_) {}
+static inline bool isWhitespace(char c) {
+  return ' ' == c || '\n' == c || '\t' == c || '\r' == c || '\f' == c ||
+         '\v' == c;
+}
+
+/// Parses the number in [\p Begin, \p End) independent of the locale. Numbers
+/// with at most 19 significant digits and a small exponent are converted
+/// exactly, all others are passed to a stream with the classic locale.
+static double parseDouble(const char *Begin, const char *End) {
+  static const double PowersOfTen[] = {
+      1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+      1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+  const char *c = Begin;
+  bool Negative(false);
+  if (c != End && ('-' == *c || '+' == *c)) {
+    Negative = ('-' == *c);
+    ++c;
+  }
+  uint64_t Mantissa(0);
+  int Digits(0);
+  int Exponent(0);
+  bool HasDigits(false);
+  for (; c != End && *c >= '0' && *c <= '9'; ++c) {
+    HasDigits = true;
+    if (0 == Mantissa && '0' == *c)
+      continue;
+    if (Digits < 19) {
+      Mantissa = 10 * Mantissa + (*c - '0');
+      ++Digits;
+    } else {
+      ++Exponent;
+      Digits = 20; // mark precision loss
+    }
+  }
+  if (c != End && '.' == *c) {
+    ++c;
+    for (; c != End && *c >= '0' && *c <= '9'; ++c) {
+      HasDigits = true;
+      if (0 == Mantissa && '0' == *c) {
+        --Exponent;
+        continue;
+      }
+      if (Digits < 19) {
+        Mantissa = 10 * Mantissa + (*c - '0');
+        ++Digits;
+        --Exponent;
+      } else {
+        Digits = 20;
+      }
+    }
+  }
+  bool Valid(HasDigits);
+  if (Valid && c != End && ('e' == *c || 'E' == *c)) {
+    ++c;
+    bool NegativeExponent(false);
+    if (c != End && ('-' == *c || '+' == *c)) {
+      NegativeExponent = ('-' == *c);
+      ++c;
+    }
+    int ExplicitExponent(0);
+    bool HasExponentDigits(false);
+    for (; c != End && *c >= '0' && *c <= '9'; ++c) {
+      HasExponentDigits = true;
+      if (ExplicitExponent < 100000)
+        ExplicitExponent = 10 * ExplicitExponent + (*c - '0');
+    }
+    Valid = HasExponentDigits;
+    Exponent += NegativeExponent ? -ExplicitExponent : ExplicitExponent;
+  }
+  if (c != End)
+    Valid = false;
+
+  // fast path: mantissa and power of ten are exactly representable
+  if (Valid && Digits <= 19 && Mantissa < (uint64_t(1) << 53) &&
+      std::abs(Exponent) <= 22) {
+    double Value(Mantissa);
+    Value = Exponent < 0 ? Value / PowersOfTen[-Exponent]
+                         : Value * PowersOfTen[Exponent];
+    return Negative ? -Value : Value;
+  }
+
+  // slow path for long mantissas, large exponents, inf and nan
+  std::istringstream Stream(std::string(Begin, End));
+  Stream.imbue(std::locale::classic());
+  double Value;
+  Stream >> Value;
+  if (Stream.fail() || !Stream.eof())
+    throw ComPWA::BadConfig("AsciiReader::readData(): can not parse \"" +
+                            std::string(Begin, End) + "\" as number!");
+  return Value;
+}
+
+/// Calls \p Function for all tokens (whitespace separated words) in
+/// [\p Begin, \p End).
+static void
+forEachToken(const char *Begin, const char *End,
+             const std::function<void(const char *, const char *)> &Function) {
+  const char *c = Begin;
+  while (c != End) {
+    while (c != End && isWhitespace(*c))
+      ++c;
+    const char *TokenBegin = c;
+    while (c != End && !isWhitespace(*c))
+      ++c;
+    if (c != TokenBegin)
+      Function(TokenBegin, c);
+  }
+}
+
+/// Sets the momentum \p Component (0=px, 1=py, 2=pz, 3=E) of \p Part.
+static void setMomentum(ComPWA::Particle &Part, size_t Component,
+                        double Value) {
+  switch (Component) {
+  case 0:
+    Part.px(Value);
+    break;
+  case 1:
+    Part.py(Value);
+    break;
+  case 2:
+    Part.pz(Value);
+    break;
+  default:
+    Part.e(Value);
+  }
+}
+
+AsciiReader::AsciiReader(unsigned int NumberOfParticles_,
+                         unsigned int NumberOfThreads_)
+    : NumberOfParticles(NumberOfParticles_), NumberOfThreads(NumberOfThreads_) {
+  if (0 == NumberOfThreads)
+    NumberOfThreads = std::max(1u, std::thread::hardware_concurrency());
+}
 
 AsciiReader::~AsciiReader() {}
 
 std::shared_ptr<std::vector<ComPWA::Event>>
 AsciiReader::readData(const std::string &InputFilePath) const {
+  int FileDescriptor = open(InputFilePath.c_str(), O_RDONLY);
+  if (FileDescriptor < 0)
+    throw ComPWA::BadConfig("Can not open " + InputFilePath);
+  struct stat FileStatus;
+  if (fstat(FileDescriptor, &FileStatus) < 0) {
+    close(FileDescriptor);
+    throw ComPWA::BadConfig("Can not open " + InputFilePath);
+  }
+  size_t FileSize(FileStatus.st_size);
+  if (0 == FileSize || 0 == NumberOfParticles) {
+    close(FileDescriptor);
+    return std::make_shared<std::vector<ComPWA::Event>>();
+  }
+  void *Data =
+      mmap(nullptr, FileSize, PROT_READ, MAP_PRIVATE, FileDescriptor, 0);
+  close(FileDescriptor);
+  if (MAP_FAILED == Data)
+    throw ComPWA::BadConfig("Can not map " + InputFilePath);
+  madvise(Data, FileSize, MADV_SEQUENTIAL);
+  const char *Begin = static_cast<const char *>(Data);
+  const char *End = Begin + FileSize;
 
-  std::ifstream currentStream;
-  currentStream.open(InputFilePath);
+  // split the file at line boundaries, at least 1MB per chunk
+  size_t NumberOfChunks(
+      std::max<size_t>(1, std::min<size_t>(NumberOfThreads, FileSize >> 20)));
+  std::vector<const char *> ChunkBoundaries(1, Begin);
+  for (size_t i = 1; i < NumberOfChunks; ++i) {
+    const char *Boundary = std::max(Begin + i * FileSize / NumberOfChunks,
+                                    ChunkBoundaries.back());
+    Boundary = std::find(Boundary, End, '\n');
+    if (Boundary != End)
+      ++Boundary;
+    ChunkBoundaries.push_back(Boundary);
+  }
+  ChunkBoundaries.push_back(End);
 
-  if (!currentStream)
-    throw ComPWA::BadConfig("Can not open " + InputFilePath);
+  auto releaseFile = [Data, FileSize]() { munmap(Data, FileSize); };
 
-  std::vector<ComPWA::Event> Events;
+  size_t ValuesPerEvent(4 * NumberOfParticles);
+  std::shared_ptr<std::vector<ComPWA::Event>> Events;
+  try {
+    // count the numbers in each chunk to know where the chunk starts
+    std::vector<size_t> Counts(NumberOfChunks, 0);
+    runConcurrently(NumberOfChunks, [&](size_t i) {
+      forEachToken(ChunkBoundaries[i], ChunkBoundaries[i + 1],
+                   [&Counts, i](const char *, const char *) { ++Counts[i]; });
+    });
+    std::vector<size_t> Offsets(NumberOfChunks + 1, 0);
+    std::partial_sum(Counts.begin(), Counts.end(), Offsets.begin() + 1);
 
-  while (!currentStream.eof()) {
-    double e, px, py, pz;
-    ComPWA::Event newEvent;
+    size_t NumberOfEvents(Offsets.back() / ValuesPerEvent);
+    if (Offsets.back() % ValuesPerEvent)
+      LOG(WARNING) << "AsciiReader::readData(): " << InputFilePath
+                   << " contains an incomplete event at the end, which is "
+                      "skipped!";
 
-    for (unsigned int ipart = 0; ipart < NumberOfParticles; ++ipart) {
-      currentStream >> px >> py >> pz >> e;
-      newEvent.ParticleList.push_back(ComPWA::Particle(px, py, pz, e));
-    }
+    Events = std::make_shared<std::vector<ComPWA::Event>>(NumberOfEvents);
+    size_t NumberOfTasks(std::max<size_t>(
+        1, std::min<size_t>(NumberOfThreads, NumberOfEvents / 10000)));
+    runConcurrently(NumberOfTasks, [&](size_t i) {
+      for (size_t j = i * NumberOfEvents / NumberOfTasks;
+           j < (i + 1) * NumberOfEvents / NumberOfTasks; ++j)
+        (*Events)[j].ParticleList.resize(NumberOfParticles);
+    });
 
-    if (!currentStream.fail()) {
-      Events.push_back(newEvent);
-      // for ( parts = 0; parts < linesToSkip; parts++ )
-      //   currentStream >> px >> py >> pz >> e;
-    }
+    // the numbers are written directly into the particles, a chunk may end
+    // within an event
+    size_t NumberOfValues(NumberOfEvents * ValuesPerEvent);
+    runConcurrently(NumberOfChunks, [&](size_t i) {
+      size_t Index(Offsets[i]);
+      forEachToken(ChunkBoundaries[i], ChunkBoundaries[i + 1],
+                   [&](const char *TokenBegin, const char *TokenEnd) {
+                     double Value(parseDouble(TokenBegin, TokenEnd));
+                     if (Index < NumberOfValues) {
+                       size_t Offset(Index % ValuesPerEvent);
+                       setMomentum((*Events)[Index / ValuesPerEvent]
+                                       .ParticleList[Offset / 4],
+                                   Offset % 4, Value);
+                     }
+                     ++Index;
+                   });
+    });
+  } catch (...) {
+    releaseFile();
+    throw;
   }
-  currentStream.close();
-  return std::make_shared<std::vector<ComPWA::Event>>(Events);
+  releaseFile();
+
+  LOG(DEBUG) << "AsciiReader::readData(): read " << Events->size()
+             << " events from " << InputFilePath << " using " << NumberOfChunks
+             << " threads.";
+  return Events;
 }
 
 } // namespace Data
@@ -16,15 +16,28 @@ namespace Data {
 ///
 /// \class AsciiReader
 /// Reader for data in ASCII-Format. This class reads event-based data from
-/// ascii-files in the same syntax.
+/// ascii-files in the same syntax. The file contains whitespace separated
+/// numbers px py pz E for each particle of each event.
+///
+/// The file is memory mapped and split at line boundaries into chunks, which
+/// are parsed concurrently with a locale independent number parser. The
+/// numbers are written directly into a preallocated event list.
+///
+/// readData() throws BadConfig if the file can not be read or contains a
+/// word which is not a number. An incomplete event at the end of the file is
+/// skipped with a warning.
 ///
 class AsciiReader {
   unsigned int NumberOfParticles;
+  unsigned int NumberOfThreads;
 
 public:
   virtual ~AsciiReader();
 
-  AsciiReader(unsigned int NumberOfParticles_);
+  /// \param NumberOfThreads_ Number of parser threads. If zero, the number of
+  /// hardware threads is used.
+  AsciiReader(unsigned int NumberOfParticles_,
+              unsigned int NumberOfThreads_ = 0);
 
   std::shared_ptr<std::vector<ComPWA::Event>>
   readData(const std::string &InputFilePath) const;
@@ -0,0 +1,90 @@
+// Copyright (c) 2013, 2017 The ComPWA Team.
+// This file is part of the ComPWA framework, check
+// https://github.com/ComPWA/ComPWA/license.txt for details.
+
+#define BOOST_TEST_MODULE Data_AsciiReaderTest
+
+#include <array>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <string>
+
+#include <boost/test/unit_test.hpp>
+
+#include "Core/Exceptions.hpp"
+#include "Core/Logging.hpp"
+#include "Data/AsciiReader/AsciiReader.hpp"
+
+namespace ComPWA {
+namespace Data {
+
+BOOST_AUTO_TEST_SUITE(AsciiReaderSuite);
+
+BOOST_AUTO_TEST_CASE(WriteReadCheck) {
+  ComPWA::Logging log("", "trace");
+
+  std::mt19937 Generator(4711);
+  std::uniform_real_distribution<double> Uniform(-10.0, 10.0);
+  std::vector<std::array<double, 4>> Momenta(3 * 50000);
+  for (auto &x : Momenta)
+    x = {{Uniform(Generator), Uniform(Generator), Uniform(Generator),
+          Uniform(Generator)}};
+
+  // one particle per line, so that the file is also split within events,
+  // with all digits and in different notations
+  std::ofstream File("AsciiReaderTest.txt");
+  File.precision(std::numeric_limits<double>::max_digits10);
+  for (size_t i = 0; i < Momenta.size(); ++i) {
+    if (i % 2)
+      File << std::scientific;
+    else
+      File << std::defaultfloat;
+    File << Momenta[i][0] << " " << Momenta[i][1] << "\t" << Momenta[i][2]
+         << "  " << Momenta[i][3] << "\n";
+  }
+  File.close();
+
+  for (unsigned int NumberOfThreads : {1, 4}) {
+    AsciiReader Reader(3, NumberOfThreads);
+    auto Events = Reader.readData("AsciiReaderTest.txt");
+    BOOST_REQUIRE_EQUAL(Events->size(), 50000);
+    for (size_t i = 0; i < Momenta.size(); ++i) {
+      auto const &Part = Events->at(i / 3).ParticleList.at(i % 3);
+      BOOST_CHECK_EQUAL(Part.px(), Momenta[i][0]);
+      BOOST_CHECK_EQUAL(Part.py(), Momenta[i][1]);
+      BOOST_CHECK_EQUAL(Part.pz(), Momenta[i][2]);
+      BOOST_CHECK_EQUAL(Part.e(), Momenta[i][3]);
+    }
+  }
+  std::remove("AsciiReaderTest.txt");
+}
+
+BOOST_AUTO_TEST_CASE(MalformedInputCheck) {
+  ComPWA::Logging log("", "trace");
+
+  // the incomplete event at the end is skipped
+  std::ofstream File("AsciiReaderTest-incomplete.txt");
+  File << "1 2 3 4\n5 6 7 8\n1 2 3\n";
+  File.close();
+  auto Events = AsciiReader(2).readData("AsciiReaderTest-incomplete.txt");
+  BOOST_REQUIRE_EQUAL(Events->size(), 1);
+  BOOST_CHECK_EQUAL(Events->front().ParticleList.at(1).e(), 8.0);
+  std::remove("AsciiReaderTest-incomplete.txt");
+
+  File.open("AsciiReaderTest-malformed.txt");
+  File << "1 2 3 4\n5 6 x7 8\n";
+  File.close();
+  BOOST_CHECK_THROW(AsciiReader(2).readData("AsciiReaderTest-malformed.txt"),
+                    ComPWA::BadConfig);
+  std::remove("AsciiReaderTest-malformed.txt");
+
+  BOOST_CHECK_THROW(AsciiReader(2).readData("AsciiReaderTest-missing.txt"),
+                    ComPWA::BadConfig);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace Data
+} // namespace ComPWA
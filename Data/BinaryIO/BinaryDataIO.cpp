@@ -0,0 +1,582 @@
+// Copyright (c) 2013, 2017 The ComPWA Team.
+// This file is part of the ComPWA framework, check
+// https://github.com/ComPWA/ComPWA/license.txt for details.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "BinaryDataIO.hpp"
+#include "Core/Concurrency.hpp"
+#include "Core/Kinematics.hpp"
+#include "Core/Logging.hpp"
+#include "Data/DataSet.hpp"
+
+namespace ComPWA {
+namespace Data {
+
+static const char BinaryFormatMagic[8] = {'C', 'O', 'M', 'P',
+                                          'W', 'A', 'E', 'V'};
+static const uint32_t BinaryFormatByteOrderMark = 0x01020304;
+
+static_assert(sizeof(BinaryEventFileHeader) == 64,
+              "BinaryEventFileHeader has to be 64 bytes");
+
+/// Size of the file with the given number of events and particles.
+static size_t binaryFileSize(uint64_t NumberOfEvents,
+                             uint32_t NumberOfParticles) {
+  return sizeof(BinaryEventFileHeader) +
+         NumberOfEvents * ((4 * NumberOfParticles + 1) * sizeof(double) +
+                           2 * NumberOfParticles * sizeof(int32_t));
+}
+
+MappedEventFile::MappedEventFile(const std::string &FilePath)
+    : Data(nullptr), FileSize(0), Header(nullptr) {
+  int FileDescriptor = open(FilePath.c_str(), O_RDONLY);
+  if (FileDescriptor < 0)
+    throw std::runtime_error("MappedEventFile::MappedEventFile(): can't open "
+                             "data file: " +
+                             FilePath);
+  struct stat FileStatus;
+  if (fstat(FileDescriptor, &FileStatus) < 0 ||
+      FileStatus.st_size < (off_t)sizeof(BinaryEventFileHeader)) {
+    close(FileDescriptor);
+    throw std::runtime_error("MappedEventFile::MappedEventFile(): " + FilePath +
+                             " is not a valid event file!");
+  }
+  FileSize = FileStatus.st_size;
+  Data = mmap(nullptr, FileSize, PROT_READ, MAP_SHARED, FileDescriptor, 0);
+  close(FileDescriptor);
+  if (MAP_FAILED == Data)
+    throw std::runtime_error("MappedEventFile::MappedEventFile(): can't map "
+                             "data file: " +
+                             FilePath);
+  Header = static_cast<const BinaryEventFileHeader *>(Data);
+  std::string Error;
+  if (std::memcmp(Header->Magic, BinaryFormatMagic, 8))
+    Error = " is not a ComPWA event file!";
+  else if (Header->ByteOrderMark != BinaryFormatByteOrderMark)
+    Error = " was written with a different byte order!";
+  else if (Header->Version != BinaryDataIO::FormatVersion)
+    Error = " has the unsupported format version " +
+            std::to_string(Header->Version) + "!";
+  else if (FileSize !=
+           binaryFileSize(Header->NumberOfEvents, Header->NumberOfParticles))
+    Error = " is corrupted (file size does not match header)!";
+  if (Error.size()) {
+    munmap(Data, FileSize);
+    throw std::runtime_error("MappedEventFile::MappedEventFile(): " + FilePath +
+                             Error);
+  }
+}
+
+MappedEventFile::~MappedEventFile() { munmap(Data, FileSize); }
+
+const double *MappedEventFile::momentum(unsigned int Particle,
+                                        unsigned int Component) const {
+  if (Particle >= numberOfParticles() || Component > 3)
+    throw std::out_of_range("MappedEventFile::momentum(): column out of "
+                            "range!");
+  auto Begin = reinterpret_cast<const double *>(Header + 1);
+  return Begin + (4 * Particle + Component) * numberOfEvents();
+}
+
+const double *MappedEventFile::weights() const {
+  auto Begin = reinterpret_cast<const double *>(Header + 1);
+  return Begin + 4 * numberOfParticles() * numberOfEvents();
+}
+
+const int32_t *MappedEventFile::pids(unsigned int Particle) const {
+  if (Particle >= numberOfParticles())
+    throw std::out_of_range("MappedEventFile::pids(): column out of range!");
+  auto Begin = reinterpret_cast<const int32_t *>(weights() + numberOfEvents());
+  return Begin + Particle * numberOfEvents();
+}
+
+const int32_t *MappedEventFile::charges(unsigned int Particle) const {
+  if (Particle >= numberOfParticles())
+    throw std::out_of_range("MappedEventFile::charges(): column out of "
+                            "range!");
+  auto Begin = reinterpret_cast<const int32_t *>(weights() + numberOfEvents());
+  return Begin + (numberOfParticles() + Particle) * numberOfEvents();
+}
+
+ComPWA::Event MappedEventFile::event(size_t i) const {
+  Event evt;
+  evt.ParticleList.reserve(numberOfParticles());
+  for (unsigned int j = 0; j < numberOfParticles(); ++j) {
+    evt.ParticleList.push_back(
+        Particle(momentum(j, 0)[i], momentum(j, 1)[i], momentum(j, 2)[i],
+                 momentum(j, 3)[i], pids(j)[i], charges(j)[i]));
+  }
+  evt.Weight = weights()[i];
+  return evt;
+}
+
+void MappedEventFile::willNeed(size_t First, size_t Number) const {
+  if (0 == Number)
+    return;
+  // madvise() requires page aligned addresses
+  const uintptr_t PageSize(sysconf(_SC_PAGESIZE));
+  auto adviseColumn = [&](const void *Column, size_t ValueSize) {
+    uintptr_t Begin(reinterpret_cast<uintptr_t>(Column) + First * ValueSize);
+    uintptr_t End(Begin + Number * ValueSize);
+    Begin -= Begin % PageSize;
+    madvise(reinterpret_cast<void *>(Begin), End - Begin, MADV_WILLNEED);
+  };
+  for (unsigned int j = 0; j < numberOfParticles(); ++j) {
+    for (unsigned int k = 0; k < 4; ++k)
+      adviseColumn(momentum(j, k), sizeof(double));
+    adviseColumn(pids(j), sizeof(int32_t));
+    adviseColumn(charges(j), sizeof(int32_t));
+  }
+  adviseColumn(weights(), sizeof(double));
+}
+
+/// Writes the column of values \p GetValue(evt) of all \p Events. The values
+/// are written in blocks to avoid many small writes.
+template <typename T>
+static void writeColumn(std::ofstream &File, const std::vector<Event> &Events,
+                        std::function<T(const Event &)> GetValue) {
+  const size_t BlockSize(1 << 16);
+  std::vector<T> Block;
+  Block.reserve(BlockSize);
+  for (auto const &evt : Events) {
+    Block.push_back(GetValue(evt));
+    if (Block.size() == BlockSize) {
+      File.write(reinterpret_cast<const char *>(Block.data()),
+                 Block.size() * sizeof(T));
+      Block.clear();
+    }
+  }
+  File.write(reinterpret_cast<const char *>(Block.data()),
+             Block.size() * sizeof(T));
+}
+
+const size_t BinaryDataIO::ChunkSize;
+
+BinaryDataIO::BinaryDataIO(int NumberEventsToProcess_)
+    : NumberEventsToProcess(NumberEventsToProcess_) {}
+
+size_t BinaryDataIO::numberOfEventsToRead(const MappedEventFile &File) const {
+  if (NumberEventsToProcess <= 0 ||
+      (size_t)NumberEventsToProcess > File.numberOfEvents())
+    return File.numberOfEvents();
+  return NumberEventsToProcess;
+}
+
+std::shared_ptr<DataSet>
+BinaryDataIO::readData(const std::string &InputFilePath) const {
+  MappedEventFile File(InputFilePath);
+  size_t NumberEventsToRead(numberOfEventsToRead(File));
+
+  File.willNeed(0, NumberEventsToRead);
+  std::vector<ComPWA::Event> Events;
+  Events.reserve(NumberEventsToRead);
+  for (size_t i = 0; i < NumberEventsToRead; ++i)
+    Events.push_back(File.event(i));
+
+  return std::make_shared<DataSet>(Events);
+}
+
+std::shared_ptr<DataSet>
+BinaryDataIO::readData(const std::string &InputFilePath,
+                       std::shared_ptr<ComPWA::Kinematics> Kinematics) const {
+  MappedEventFile File(InputFilePath);
+  size_t NumberEventsToRead(numberOfEventsToRead(File));
+  unsigned int NumberOfParticles(File.numberOfParticles());
+
+  auto VariableNames = Kinematics->getKinematicVariableNames();
+  std::vector<bool> Variables(VariableNames.size(), true);
+  std::vector<std::vector<double>> Columns(VariableNames.size());
+  std::vector<double> Weights;
+  Weights.reserve(NumberEventsToRead);
+
+  // the momentum columns are packed directly, no Events are created
+  PackedEvents Events;
+  std::vector<std::vector<double>> ChunkColumns;
+  std::vector<double> ChunkWeights;
+  for (size_t First = 0; First < NumberEventsToRead; First += ChunkSize) {
+    size_t Number(std::min(ChunkSize, NumberEventsToRead - First));
+    File.willNeed(First, Number);
+    Events.NumberOfParticles = NumberOfParticles;
+    Events.Momenta.resize(Number * NumberOfParticles);
+    Events.Pids.resize(Number * NumberOfParticles);
+    Events.Charges.resize(Number * NumberOfParticles);
+    Events.Weights.assign(File.weights() + First,
+                          File.weights() + First + Number);
+    runOnRanges(Number, 10000, [&](size_t Begin, size_t End) {
+      for (unsigned int j = 0; j < NumberOfParticles; ++j) {
+        const double *Px(File.momentum(j, 0) + First);
+        const double *Py(File.momentum(j, 1) + First);
+        const double *Pz(File.momentum(j, 2) + First);
+        const double *E(File.momentum(j, 3) + First);
+        const int32_t *Pid(File.pids(j) + First);
+        const int32_t *Charge(File.charges(j) + First);
+        for (size_t i = Begin; i < End; ++i) {
+          size_t k(i * NumberOfParticles + j);
+          Events.Momenta[k] = FourVector(Px[i], Py[i], Pz[i], E[i]);
+          Events.Pids[k] = Pid[i];
+          Events.Charges[k] = Charge[i];
+        }
+      }
+    });
+
+    Kinematics->convert(Events, Variables, ChunkColumns, ChunkWeights);
+    if (ChunkColumns.size() != Columns.size())
+      throw std::runtime_error("BinaryDataIO::readData(): number of "
+                               "kinematic variables does not match!");
+    // columns of unused variables stay empty
+    for (size_t k = 0; k < Columns.size(); ++k) {
+      if (ChunkColumns[k].empty())
+        continue;
+      if (Columns[k].empty())
+        Columns[k].reserve(NumberEventsToRead);
+      Columns[k].insert(Columns[k].end(), ChunkColumns[k].begin(),
+                        ChunkColumns[k].end());
+    }
+    Weights.insert(Weights.end(), ChunkWeights.begin(), ChunkWeights.end());
+  }
+
+  return std::make_shared<DataSet>(std::move(Columns), std::move(Weights),
+                                   VariableNames);
+}
+
+void BinaryDataIO::writeData(std::shared_ptr<const DataSet> DataSample,
+                             const std::string &OutputFilePath) const {
+  LOG(INFO) << "BinaryDataIO::writeData(): writing current "
+               "vector of events to file "
+            << OutputFilePath;
+
+  auto const &Events = DataSample->getEventList();
+  if (0 == Events.size()) {
+    LOG(ERROR) << "BinaryDataIO::writeData(): no events given!";
+    return;
+  }
+  size_t NumberOfParticles(Events.front().ParticleList.size());
+  for (auto const &evt : Events) {
+    if (evt.ParticleList.size() != NumberOfParticles)
+      throw std::runtime_error("BinaryDataIO::writeData(): all events need "
+                               "the same number of particles!");
+  }
+
+  std::ofstream File(OutputFilePath, std::ios::binary | std::ios::trunc);
+  if (!File)
+    throw std::runtime_error(
+        "BinaryDataIO::writeData(): can't open data file: " + OutputFilePath);
+
+  BinaryEventFileHeader Header;
+  std::memset(&Header, 0, sizeof(Header));
+  std::memcpy(Header.Magic, BinaryFormatMagic, 8);
+  Header.Version = FormatVersion;
+  Header.ByteOrderMark = BinaryFormatByteOrderMark;
+  Header.NumberOfEvents = Events.size();
+  Header.NumberOfParticles = NumberOfParticles;
+  File.write(reinterpret_cast<const char *>(&Header), sizeof(Header));
+
+  for (size_t j = 0; j < NumberOfParticles; ++j) {
+    writeColumn<double>(File, Events, [j](const Event &evt) {
+      return evt.ParticleList[j].px();
+    });
+    writeColumn<double>(File, Events, [j](const Event &evt) {
+      return evt.ParticleList[j].py();
+    });
+    writeColumn<double>(File, Events, [j](const Event &evt) {
+      return evt.ParticleList[j].pz();
+    });
+    writeColumn<double>(File, Events, [j](const Event &evt) {
+      return evt.ParticleList[j].e();
+    });
+  }
+  writeColumn<double>(File, Events,
+                      [](const Event &evt) { return evt.Weight; });
+  for (size_t j = 0; j < NumberOfParticles; ++j)
+    writeColumn<int32_t>(File, Events, [j](const Event &evt) {
+      return evt.ParticleList[j].pid();
+    });
+  for (size_t j = 0; j < NumberOfParticles; ++j)
+    writeColumn<int32_t>(File, Events, [j](const Event &evt) {
+      return evt.ParticleList[j].charge();
+    });
+
+  if (!File)
+    throw std::runtime_error("BinaryDataIO::writeData(): writing to " +
+                             OutputFilePath + " failed!");
+}
+
+BinaryEventChunkReader::BinaryEventChunkReader(const std::string &InputFilePath)
+    : FilePath(InputFilePath), File(InputFilePath) {}
+
+std::vector<Event> BinaryEventChunkReader::readEvents(size_t First,
+                                                      size_t Number) const {
+  if (First + Number > numberOfEvents())
+    throw std::out_of_range("BinaryEventChunkReader::readEvents(): events "
+                            "out of range!");
+  File.willNeed(First, Number);
+  std::vector<Event> Events;
+  Events.reserve(Number);
+  for (size_t i = First; i < First + Number; ++i)
+    Events.push_back(File.event(i));
+  return Events;
+}
+
+/// Writes \p Size bytes at \p Offset of the file, returns false on failure.
+static bool writeAt(int FileDescriptor, const void *Data, size_t Size,
+                    off_t Offset) {
+  auto Bytes = static_cast<const char *>(Data);
+  while (Size > 0) {
+    ssize_t Written = pwrite(FileDescriptor, Bytes, Size, Offset);
+    if (Written <= 0)
+      return false;
+    Bytes += Written;
+    Size -= Written;
+    Offset += Written;
+  }
+  return true;
+}
+
+BinaryEventChunkWriter::BinaryEventChunkWriter(
+    const std::string &OutputFilePath, size_t NumberOfEvents_,
+    std::shared_ptr<ComPWA::Kinematics> Kinematics)
+    : FilePath(OutputFilePath), NumberOfEvents(NumberOfEvents_),
+      NumberOfWrittenEvents(0), NumberOfStoredEvents(0), NumberOfParticles(0),
+      FileDescriptor(-1) {
+  FileDescriptor = open(FilePath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (FileDescriptor < 0)
+    throw std::runtime_error("BinaryEventChunkWriter::BinaryEventChunkWriter()"
+                             ": can't open data file: " +
+                             FilePath);
+  if (Kinematics)
+    CacheWriter.reset(new KinematicsCacheWriter(
+        KinematicsCache::defaultFilePath(FilePath), FilePath, Kinematics,
+        NumberOfEvents));
+}
+
+BinaryEventChunkWriter::~BinaryEventChunkWriter() {
+  if (FileDescriptor >= 0) {
+    ::close(FileDescriptor);
+    std::remove(FilePath.c_str());
+  }
+}
+
+void BinaryEventChunkWriter::writeEvents(const std::vector<Event> &Events) {
+  writeColumns(Events);
+  if (CacheWriter)
+    CacheWriter->write(Events);
+  NumberOfWrittenEvents += Events.size();
+  NumberOfStoredEvents = std::max(NumberOfStoredEvents, NumberOfWrittenEvents);
+}
+
+void BinaryEventChunkWriter::writeEvents(const std::vector<Event> &Events,
+                                         const std::vector<DataPoint> &Points) {
+  if (Points.size() != Events.size())
+    throw std::runtime_error("BinaryEventChunkWriter::writeEvents(): number "
+                             "of points and events do not match!");
+  writeColumns(Events);
+  if (CacheWriter && !Events.empty()) {
+    std::vector<std::vector<double>> Columns(
+        Points.front().KinematicVariableList.size(),
+        std::vector<double>(Points.size()));
+    std::vector<double> Weights(Events.size());
+    for (size_t i = 0; i < Points.size(); ++i) {
+      if (Points[i].KinematicVariableList.size() != Columns.size())
+        throw std::runtime_error("BinaryEventChunkWriter::writeEvents(): all "
+                                 "points need the same number of variables!");
+      for (size_t k = 0; k < Columns.size(); ++k)
+        Columns[k][i] = Points[i].KinematicVariableList[k];
+      Weights[i] = Events[i].Weight;
+    }
+    CacheWriter->write(Events, Columns, Weights);
+  }
+  NumberOfWrittenEvents += Events.size();
+  NumberOfStoredEvents = std::max(NumberOfStoredEvents, NumberOfWrittenEvents);
+}
+
+void BinaryEventChunkWriter::writeColumns(const std::vector<Event> &Events) {
+  if (FileDescriptor < 0)
+    throw std::runtime_error("BinaryEventChunkWriter::writeEvents(): " +
+                             FilePath + " is already closed!");
+  if (Events.empty())
+    return;
+  if (NumberOfWrittenEvents + Events.size() > NumberOfEvents)
+    throw std::runtime_error("BinaryEventChunkWriter::writeEvents(): more "
+                             "than " +
+                             std::to_string(NumberOfEvents) +
+                             " events written to " + FilePath + "!");
+  // the file layout is fixed by the number of particles of the first chunk
+  if (0 == NumberOfParticles) {
+    NumberOfParticles = Events.front().ParticleList.size();
+    if (ftruncate(FileDescriptor,
+                  binaryFileSize(NumberOfEvents, NumberOfParticles)))
+      throw std::runtime_error("BinaryEventChunkWriter::writeEvents(): can't "
+                               "allocate " +
+                               FilePath + "!");
+  }
+  for (auto const &evt : Events) {
+    if (evt.ParticleList.size() != NumberOfParticles)
+      throw std::runtime_error("BinaryEventChunkWriter::writeEvents(): all "
+                               "events need the same number of particles!");
+  }
+
+  // write the chunk of each column, the integer columns follow the doubles
+  bool Success(true);
+  auto writeColumnChunk = [&](const void *Data, size_t ValueSize,
+                              off_t ColumnOffset) {
+    Success = Success &&
+              writeAt(FileDescriptor, Data, Events.size() * ValueSize,
+                      ColumnOffset + NumberOfWrittenEvents * ValueSize);
+  };
+  off_t Offset(sizeof(BinaryEventFileHeader));
+  std::vector<std::vector<double>> Momenta(4,
+                                           std::vector<double>(Events.size()));
+  for (unsigned int j = 0; j < NumberOfParticles; ++j) {
+    for (size_t i = 0; i < Events.size(); ++i) {
+      const Particle &x(Events[i].ParticleList[j]);
+      Momenta[0][i] = x.px();
+      Momenta[1][i] = x.py();
+      Momenta[2][i] = x.pz();
+      Momenta[3][i] = x.e();
+    }
+    for (auto const &Column : Momenta) {
+      writeColumnChunk(Column.data(), sizeof(double), Offset);
+      Offset += NumberOfEvents * sizeof(double);
+    }
+  }
+  std::vector<double> Weights(Events.size());
+  for (size_t i = 0; i < Events.size(); ++i)
+    Weights[i] = Events[i].Weight;
+  writeColumnChunk(Weights.data(), sizeof(double), Offset);
+  Offset += NumberOfEvents * sizeof(double);
+  std::vector<int32_t> Integers(Events.size());
+  for (unsigned int j = 0; j < NumberOfParticles; ++j) {
+    for (size_t i = 0; i < Events.size(); ++i)
+      Integers[i] = Events[i].ParticleList[j].pid();
+    writeColumnChunk(Integers.data(), sizeof(int32_t), Offset);
+    Offset += NumberOfEvents * sizeof(int32_t);
+  }
+  for (unsigned int j = 0; j < NumberOfParticles; ++j) {
+    for (size_t i = 0; i < Events.size(); ++i)
+      Integers[i] = Events[i].ParticleList[j].charge();
+    writeColumnChunk(Integers.data(), sizeof(int32_t), Offset);
+    Offset += NumberOfEvents * sizeof(int32_t);
+  }
+  if (!Success)
+    throw std::runtime_error("BinaryEventChunkWriter::writeEvents(): writing "
+                             "to " +
+                             FilePath + " failed!");
+}
+
+void BinaryEventChunkWriter::rewind() {
+  NumberOfWrittenEvents = 0;
+  if (CacheWriter)
+    CacheWriter->rewind();
+}
+
+/// Reads \p Size bytes at \p Offset, the counterpart of writeAt().
+static bool readAt(int FileDescriptor, void *Data, size_t Size, off_t Offset) {
+  auto Bytes = static_cast<char *>(Data);
+  while (Size > 0) {
+    ssize_t Read = pread(FileDescriptor, Bytes, Size, Offset);
+    if (Read <= 0)
+      return false;
+    Bytes += Read;
+    Size -= Read;
+    Offset += Read;
+  }
+  return true;
+}
+
+std::vector<Event> BinaryEventChunkWriter::readEvents(size_t First,
+                                                      size_t Number) const {
+  if (FileDescriptor < 0)
+    throw std::runtime_error("BinaryEventChunkWriter::readEvents(): " +
+                             FilePath + " is already closed!");
+  if (First + Number > NumberOfStoredEvents)
+    throw std::out_of_range("BinaryEventChunkWriter::readEvents(): only " +
+                            std::to_string(NumberOfStoredEvents) +
+                            " events were written to " + FilePath + "!");
+  std::vector<Event> Events(Number);
+  if (0 == Number)
+    return Events;
+
+  // the same column layout as in writeColumns()
+  bool Success(true);
+  auto readColumnChunk = [&](void *Data, size_t ValueSize, off_t ColumnOffset) {
+    Success = Success && readAt(FileDescriptor, Data, Number * ValueSize,
+                                ColumnOffset + First * ValueSize);
+  };
+  off_t Offset(sizeof(BinaryEventFileHeader));
+  std::vector<std::vector<double>> Momenta(4 * NumberOfParticles,
+                                           std::vector<double>(Number));
+  for (auto &Column : Momenta) {
+    readColumnChunk(Column.data(), sizeof(double), Offset);
+    Offset += NumberOfEvents * sizeof(double);
+  }
+  std::vector<double> Weights(Number);
+  readColumnChunk(Weights.data(), sizeof(double), Offset);
+  Offset += NumberOfEvents * sizeof(double);
+  std::vector<std::vector<int32_t>> Integers(2 * NumberOfParticles,
+                                             std::vector<int32_t>(Number));
+  for (auto &Column : Integers) {
+    readColumnChunk(Column.data(), sizeof(int32_t), Offset);
+    Offset += NumberOfEvents * sizeof(int32_t);
+  }
+  if (!Success)
+    throw std::runtime_error("BinaryEventChunkWriter::readEvents(): reading "
+                             "from " +
+                             FilePath + " failed!");
+
+  for (size_t i = 0; i < Number; ++i) {
+    Events[i].ParticleList.reserve(NumberOfParticles);
+    for (unsigned int j = 0; j < NumberOfParticles; ++j) {
+      Events[i].ParticleList.push_back(
+          Particle(Momenta[4 * j][i], Momenta[4 * j + 1][i],
+                   Momenta[4 * j + 2][i], Momenta[4 * j + 3][i],
+                   Integers[j][i], Integers[NumberOfParticles + j][i]));
+    }
+    Events[i].Weight = Weights[i];
+  }
+  return Events;
+}
+
+void BinaryEventChunkWriter::close() {
+  if (FileDescriptor < 0)
+    return;
+  if (NumberOfWrittenEvents != NumberOfEvents)
+    throw std::runtime_error("BinaryEventChunkWriter::close(): only " +
+                             std::to_string(NumberOfWrittenEvents) + " of " +
+                             std::to_string(NumberOfEvents) +
+                             " events were written to " + FilePath + "!");
+  if (0 == NumberOfEvents &&
+      ftruncate(FileDescriptor, binaryFileSize(0, 0)))
+    throw std::runtime_error("BinaryEventChunkWriter::close(): writing to " +
+                             FilePath + " failed!");
+
+  BinaryEventFileHeader Header;
+  std::memset(&Header, 0, sizeof(Header));
+  std::memcpy(Header.Magic, BinaryFormatMagic, 8);
+  Header.Version = BinaryDataIO::FormatVersion;
+  Header.ByteOrderMark = BinaryFormatByteOrderMark;
+  Header.NumberOfEvents = NumberOfEvents;
+  Header.NumberOfParticles = NumberOfParticles;
+  bool Success(writeAt(FileDescriptor, &Header, sizeof(Header), 0));
+  Success = (0 == ::close(FileDescriptor)) && Success;
+  FileDescriptor = -1;
+  if (!Success)
+    throw std::runtime_error("BinaryEventChunkWriter::close(): writing to " +
+                             FilePath + " failed!");
+  if (CacheWriter)
+    CacheWriter->close();
+  LOG(INFO) << "BinaryEventChunkWriter::close(): wrote " << NumberOfEvents
+            << " events to " << FilePath;
+}
+
+} // namespace Data
+} // namespace ComPWA
@@ -0,0 +1,199 @@
+// Copyright (c) 2013, 2017 The ComPWA Team.
+// This file is part of the ComPWA framework, check
+// https://github.com/ComPWA/ComPWA/license.txt for details.
+
+#ifndef COMPWA_DATA_BINARYDATAIO_HPP_
+#define COMPWA_DATA_BINARYDATAIO_HPP_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "Core/Event.hpp"
+#include "Data/ChunkedDataSet.hpp"
+#include "Data/KinematicsCache.hpp"
+
+namespace ComPWA {
+class Kinematics;
+namespace Data {
+
+class DataSet;
+
+///
+/// Header of the native binary event format. All numbers are stored in the
+/// byte order of the writing machine, which is checked via ByteOrderMark.
+///
+/// The header is followed by the columns (each with NumberOfEvents entries)
+///   - px, py, pz, E (double) of particle 0, then of particle 1, ...
+///   - event weights (double)
+///   - pid (int32) of particle 0, 1, ...
+///   - charge (int32) of particle 0, 1, ...
+///
+struct BinaryEventFileHeader {
+  char Magic[8];
+  uint32_t Version;
+  uint32_t ByteOrderMark;
+  uint64_t NumberOfEvents;
+  uint32_t NumberOfParticles;
+  uint32_t Reserved0;
+  uint64_t Reserved[4];
+};
+
+///
+/// \class MappedEventFile
+/// Read only access to an event file in the native binary format. The file is
+/// memory mapped and the columns are exposed as pointers into the mapping.
+/// They are valid as long as the MappedEventFile exists, so anything which is
+/// kept beyond that (Events, kinematic variables) is copied out of the file.
+///
+class MappedEventFile {
+public:
+  MappedEventFile(const std::string &FilePath);
+  ~MappedEventFile();
+
+  MappedEventFile(const MappedEventFile &) = delete;
+  MappedEventFile &operator=(const MappedEventFile &) = delete;
+
+  size_t numberOfEvents() const { return Header->NumberOfEvents; }
+
+  unsigned int numberOfParticles() const { return Header->NumberOfParticles; }
+
+  /// Column of the momentum \p Component (0=px, 1=py, 2=pz, 3=E) of
+  /// particle \p Particle.
+  const double *momentum(unsigned int Particle, unsigned int Component) const;
+
+  const double *weights() const;
+
+  const int32_t *pids(unsigned int Particle) const;
+
+  const int32_t *charges(unsigned int Particle) const;
+
+  /// Creates the Event with index \p i.
+  ComPWA::Event event(size_t i) const;
+
+  /// Advises the operating system to load the pages of all columns which
+  /// belong to the events [\p First, \p First + \p Number).
+  void willNeed(size_t First, size_t Number) const;
+
+private:
+  void *Data;
+  size_t FileSize;
+  const BinaryEventFileHeader *Header;
+};
+
+///
+/// \class BinaryDataIO
+/// Class for reading/writing Physics Events from/to files in the native
+/// columnar binary format. See BinaryEventFileHeader for the layout.
+///
+class BinaryDataIO {
+  int NumberEventsToProcess;
+
+public:
+  /// Version of the format which is written
+  static const uint32_t FormatVersion = 1;
+
+  /// \param NumberEventsToProcess_	-1 processes all events
+  BinaryDataIO(int NumberEventsToProcess_ = -1);
+
+  /// Reads the events of \p InputFilePath.
+  std::shared_ptr<DataSet> readData(const std::string &InputFilePath) const;
+
+  /// Reads the events of \p InputFilePath and converts them directly into the
+  /// kinematic variables of \p Kinematics. No Events are created. The momenta
+  /// are packed chunk by chunk from the mapped file and each chunk is
+  /// converted in one batch, so that apart from the kinematic variables only
+  /// one chunk of momenta is held in memory.
+  std::shared_ptr<DataSet>
+  readData(const std::string &InputFilePath,
+           std::shared_ptr<ComPWA::Kinematics> Kinematics) const;
+
+  void writeData(std::shared_ptr<const DataSet> DataSample,
+                 const std::string &OutputFilePath) const;
+
+  /// Number of events which are packed and converted at once by
+  /// readData(const std::string &, std::shared_ptr<ComPWA::Kinematics>)
+  static const size_t ChunkSize = 1 << 16;
+
+private:
+  size_t numberOfEventsToRead(const MappedEventFile &File) const;
+};
+
+///
+/// \class BinaryEventChunkReader
+/// Reads chunks of events from a file in the native binary format, e.g. for a
+/// ChunkedDataSet. Only the pages of the mapped file which are accessed are
+/// loaded and they can be reclaimed by the operating system at any time.
+///
+class BinaryEventChunkReader : public EventChunkReader {
+public:
+  BinaryEventChunkReader(const std::string &InputFilePath);
+
+  size_t numberOfEvents() const final { return File.numberOfEvents(); }
+
+  unsigned int numberOfParticles() const final {
+    return File.numberOfParticles();
+  }
+
+  std::vector<Event> readEvents(size_t First, size_t Number) const final;
+
+  std::string filePath() const final { return FilePath; }
+
+private:
+  std::string FilePath;
+  MappedEventFile File;
+};
+
+///
+/// \class BinaryEventChunkWriter
+/// Writes a file in the native binary format chunk by chunk, e.g. for the
+/// streaming Tools::generate(). The number of events has to be known in
+/// advance, since the columns are stored one after the other. The header is
+/// written by close(), so an incomplete file is never a valid event file.
+///
+/// If \p Kinematics is given, the kinematic variables are written to the
+/// cache file KinematicsCache::defaultFilePath() alongside, so that they do
+/// not have to be calculated again when the sample is read.
+///
+class BinaryEventChunkWriter : public EventChunkWriter {
+public:
+  BinaryEventChunkWriter(const std::string &OutputFilePath,
+                         size_t NumberOfEvents,
+                         std::shared_ptr<ComPWA::Kinematics> Kinematics = {});
+
+  /// Removes the file if close() was not called.
+  ~BinaryEventChunkWriter();
+
+  void writeEvents(const std::vector<Event> &Events) final;
+
+  /// The kinematic variables of the cache file are taken from \p Points.
+  void writeEvents(const std::vector<Event> &Events,
+                   const std::vector<DataPoint> &Points) final;
+
+  void rewind() final;
+
+  bool canReadEvents() const final { return true; }
+
+  std::vector<Event> readEvents(size_t First, size_t Number) const final;
+
+  void close() final;
+
+private:
+  /// Writes the columns of \p Events behind the events written so far.
+  void writeColumns(const std::vector<Event> &Events);
+
+  std::string FilePath;
+  size_t NumberOfEvents;
+  size_t NumberOfWrittenEvents;
+  /// Number of events which were written at least once, see readEvents()
+  size_t NumberOfStoredEvents;
+  /// Number of particles of the events, which is known after the first chunk
+  unsigned int NumberOfParticles;
+  int FileDescriptor;
+  std::unique_ptr<KinematicsCacheWriter> CacheWriter;
+};
+
+} // namespace Data
+} // namespace ComPWA
+
+#endif
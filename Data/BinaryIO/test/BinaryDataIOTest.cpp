@@ -0,0 +1,259 @@
+// Copyright (c) 2013, 2017 The ComPWA Team.
+// This file is part of the ComPWA framework, check
+// https://github.com/ComPWA/ComPWA/license.txt for details.
+
+#define BOOST_TEST_MODULE Data_BinaryDataIOTest
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+
+#include <boost/test/unit_test.hpp>
+
+#include "Core/Kinematics.hpp"
+#include "Core/Logging.hpp"
+#include "Data/BinaryIO/BinaryDataIO.hpp"
+#include "Data/ChunkedDataSet.hpp"
+#include "Data/DataSet.hpp"
+#include "Data/KinematicsCache.hpp"
+
+namespace ComPWA {
+namespace Data {
+
+/// Simple kinematics which uses the energies of the particles as variables.
+class EnergyKinematics : public ComPWA::Kinematics {
+public:
+  EnergyKinematics() : NumberOfConversions(0) {}
+  DataPoint convert(const ComPWA::Event &event) const {
+    ++NumberOfConversions;
+    DataPoint point;
+    for (auto const &x : event.ParticleList)
+      point.KinematicVariableList.push_back(x.e());
+    point.Weight = event.Weight;
+    return point;
+  }
+  std::vector<std::string> getKinematicVariableNames() const {
+    return {"E0", "E1", "E2"};
+  }
+  bool isWithinPhaseSpace(const DataPoint &point) const { return true; }
+  double phspVolume() const { return 1.0; }
+
+  mutable std::atomic<size_t> NumberOfConversions;
+};
+
+/// Kinematics which uses the pids and charges of the particles as variables.
+class PidKinematics : public ComPWA::Kinematics {
+public:
+  DataPoint convert(const ComPWA::Event &event) const {
+    DataPoint point;
+    for (auto const &x : event.ParticleList) {
+      point.KinematicVariableList.push_back(x.pid());
+      point.KinematicVariableList.push_back(x.charge());
+    }
+    point.Weight = event.Weight;
+    return point;
+  }
+  std::vector<std::string> getKinematicVariableNames() const {
+    return {"pid0", "charge0", "pid1", "charge1", "pid2", "charge2"};
+  }
+  bool isWithinPhaseSpace(const DataPoint &point) const { return true; }
+  double phspVolume() const { return 1.0; }
+};
+
+BOOST_AUTO_TEST_SUITE(BinaryDataIOSuite);
+
+BOOST_AUTO_TEST_CASE(SimpleWriteReadCheck) {
+  ComPWA::Logging log("", "trace");
+
+  std::vector<Event> Events;
+  for (unsigned int i = 0; i < 100000; ++i) {
+    Event evt;
+    for (int j = 0; j < 3; ++j)
+      evt.ParticleList.push_back(
+          Particle(0.1 * i, 0.2 * j, -0.3, 1.0 + i + j, 211 * (j - 1), j - 1));
+    evt.Weight = 0.5 + 0.001 * i;
+    Events.push_back(evt);
+  }
+  auto sample = std::make_shared<DataSet>(Events);
+
+  BinaryDataIO BinaryIO;
+  BinaryIO.writeData(sample, "BinaryDataIOTest-output.bin");
+
+  auto sampleIn = BinaryIO.readData("BinaryDataIOTest-output.bin");
+  BOOST_REQUIRE_EQUAL(sampleIn->getEventList().size(), Events.size());
+  for (size_t i = 0; i < Events.size(); i += 999) {
+    auto const &evt = sampleIn->getEventList()[i];
+    BOOST_CHECK_EQUAL(evt.Weight, Events[i].Weight);
+    for (size_t j = 0; j < 3; ++j) {
+      BOOST_CHECK(evt.ParticleList[j].fourMomentum() ==
+                  Events[i].ParticleList[j].fourMomentum());
+      BOOST_CHECK_EQUAL(evt.ParticleList[j].pid(),
+                        Events[i].ParticleList[j].pid());
+      BOOST_CHECK_EQUAL(evt.ParticleList[j].charge(),
+                        Events[i].ParticleList[j].charge());
+    }
+  }
+
+  // direct conversion into the kinematic variables
+  auto Kin = std::make_shared<EnergyKinematics>();
+  auto pointsIn = BinaryDataIO(1000).readData("BinaryDataIOTest-output.bin", Kin);
+  BOOST_CHECK_EQUAL(pointsIn->getEventList().size(), 0);
+  BOOST_REQUIRE_EQUAL(pointsIn->getDataPointList().size(), 1000);
+  BOOST_CHECK_EQUAL(pointsIn->getDataPointList()[10].KinematicVariableList[2],
+                    13.0);
+  pointsIn->convertEventsToParameterList(Kin);
+  BOOST_CHECK_EQUAL(
+      pointsIn->getParameterList().mDoubleValue(0)->values().size(), 1000);
+
+  // all events, packed in parallel chunk by chunk
+  BOOST_CHECK_LT(BinaryDataIO::ChunkSize, Events.size());
+  auto allPointsIn = BinaryIO.readData("BinaryDataIOTest-output.bin", Kin);
+  auto const &Columns = allPointsIn->getParameterList().mDoubleValues();
+  BOOST_REQUIRE_EQUAL(Columns.size(), 4);
+  BOOST_REQUIRE_EQUAL(Columns[0]->values().size(), Events.size());
+  for (size_t i = 0; i < Events.size(); i += 997) {
+    DataPoint point(Kin->convert(Events[i]));
+    for (size_t j = 0; j < 3; ++j)
+      BOOST_CHECK_EQUAL(Columns[j]->values()[i],
+                        point.KinematicVariableList[j]);
+    BOOST_CHECK_EQUAL(Columns[3]->values()[i], Events[i].Weight);
+  }
+
+  // the pids and charges are packed as well
+  auto pidsIn = BinaryIO.readData("BinaryDataIOTest-output.bin",
+                                  std::make_shared<PidKinematics>());
+  auto const &PidColumns = pidsIn->getParameterList().mDoubleValues();
+  BOOST_REQUIRE_EQUAL(PidColumns.size(), 7);
+  for (size_t j = 0; j < 3; ++j) {
+    BOOST_CHECK_EQUAL(PidColumns[2 * j]->values()[77777],
+                      Events[77777].ParticleList[j].pid());
+    BOOST_CHECK_EQUAL(PidColumns[2 * j + 1]->values()[77777],
+                      Events[77777].ParticleList[j].charge());
+  }
+
+  std::remove("BinaryDataIOTest-output.bin"); // delete file
+}
+
+BOOST_AUTO_TEST_CASE(InvalidFileCheck) {
+  std::ofstream("BinaryDataIOTest-invalid.bin") << "not an event file";
+  BOOST_CHECK_THROW(BinaryDataIO().readData("BinaryDataIOTest-invalid.bin"),
+                    std::runtime_error);
+  std::remove("BinaryDataIOTest-invalid.bin");
+}
+
+BOOST_AUTO_TEST_CASE(ChunkedReadCheck) {
+  ComPWA::Logging log("", "trace");
+
+  std::vector<Event> Events;
+  for (unsigned int i = 0; i < 10000; ++i) {
+    Event evt;
+    for (int j = 0; j < 3; ++j)
+      evt.ParticleList.push_back(Particle(0.1, 0.2, -0.3, 1.0 + i + j));
+    evt.Weight = 0.5 + 0.001 * i;
+    Events.push_back(evt);
+  }
+  BinaryDataIO().writeData(std::make_shared<DataSet>(Events),
+                           "BinaryDataIOTest-chunked.bin");
+
+  // budget for 1000 events per chunk, see ChunkedDataSet::ChunkedDataSet()
+  auto Kin = std::make_shared<EnergyKinematics>();
+  ChunkedDataSet Sample(
+      std::make_shared<BinaryEventChunkReader>("BinaryDataIOTest-chunked.bin"),
+      Kin, 2000 * (sizeof(Event) + 3 * sizeof(Particle) + 4 * sizeof(double)));
+  BOOST_CHECK_EQUAL(Sample.numberOfEvents(), Events.size());
+  BOOST_CHECK_EQUAL(Sample.chunkSize(), 1000);
+  BOOST_CHECK_EQUAL(Sample.numberOfChunks(), 10);
+
+  size_t i(0);
+  Sample.forEachDataPoint([&](const DataPoint &point) {
+    BOOST_REQUIRE_EQUAL(point.KinematicVariableList.size(), 3);
+    BOOST_CHECK_EQUAL(point.KinematicVariableList[0], 1.0 + i);
+    BOOST_CHECK_EQUAL(point.Weight, Events[i].Weight);
+    ++i;
+  });
+  BOOST_CHECK_EQUAL(i, Events.size());
+
+  std::remove("BinaryDataIOTest-chunked.bin");
+}
+
+BOOST_AUTO_TEST_CASE(ChunkedWriteCheck) {
+  ComPWA::Logging log("", "trace");
+
+  std::vector<Event> Events;
+  for (unsigned int i = 0; i < 10000; ++i) {
+    Event evt;
+    for (int j = 0; j < 3; ++j)
+      evt.ParticleList.push_back(
+          Particle(0.1 * i, 0.2 * j, -0.3, 1.0 + i + j, 211 * (j - 1), j - 1));
+    evt.Weight = 0.5 + 0.001 * i;
+    Events.push_back(evt);
+  }
+
+  auto Kin = std::make_shared<EnergyKinematics>();
+  std::string CacheFilePath(
+      KinematicsCache::defaultFilePath("BinaryDataIOTest-written.bin"));
+  {
+    BinaryEventChunkWriter Writer("BinaryDataIOTest-written.bin",
+                                  Events.size(), Kin);
+    // discarded chunk
+    Writer.writeEvents(std::vector<Event>(Events.rbegin(), Events.rbegin() + 10));
+    Writer.rewind();
+    for (size_t i = 0; i < 6000; i += 3000)
+      Writer.writeEvents(std::vector<Event>(Events.begin() + i,
+                                            Events.begin() + i + 3000));
+    // the last chunk with its kinematic variables, which are not calculated
+    // again for the cache
+    std::vector<Event> Chunk(Events.begin() + 6000, Events.end());
+    std::vector<DataPoint> Points;
+    for (auto const &evt : Chunk)
+      Points.push_back(Kin->convert(evt));
+    size_t NumberOfConversions(Kin->NumberOfConversions);
+    Writer.writeEvents(Chunk, Points);
+    BOOST_CHECK_EQUAL(Kin->NumberOfConversions, NumberOfConversions);
+    Writer.close();
+  }
+
+  auto sampleIn = BinaryDataIO().readData("BinaryDataIOTest-written.bin");
+  BOOST_REQUIRE_EQUAL(sampleIn->getEventList().size(), Events.size());
+  for (size_t i = 0; i < Events.size(); i += 99) {
+    auto const &evt = sampleIn->getEventList()[i];
+    BOOST_CHECK_EQUAL(evt.Weight, Events[i].Weight);
+    for (size_t j = 0; j < 3; ++j) {
+      BOOST_CHECK(evt.ParticleList[j].fourMomentum() ==
+                  Events[i].ParticleList[j].fourMomentum());
+      BOOST_CHECK_EQUAL(evt.ParticleList[j].pid(),
+                        Events[i].ParticleList[j].pid());
+    }
+  }
+
+  // the cache of the kinematic variables matches the events
+  std::vector<std::vector<double>> Columns;
+  std::vector<double> Weights;
+  BOOST_REQUIRE(KinematicsCache(CacheFilePath)
+                    .read(KinematicsCache::key("BinaryDataIOTest-written.bin",
+                                               *Kin),
+                          Kin->getUsedKinematicVariables(), Columns, Weights));
+  BOOST_REQUIRE_EQUAL(Weights.size(), Events.size());
+  BOOST_CHECK_EQUAL(Columns[1][123], Events[123].ParticleList[1].e());
+  BOOST_CHECK_EQUAL(Columns[2][8765], Events[8765].ParticleList[2].e());
+  BOOST_CHECK_EQUAL(Weights[9999], Events[9999].Weight);
+
+  // an incomplete file is not written
+  {
+    BinaryEventChunkWriter Writer("BinaryDataIOTest-incomplete.bin", 10);
+    Writer.writeEvents(std::vector<Event>(Events.begin(), Events.begin() + 5));
+    BOOST_CHECK_THROW(Writer.close(), std::runtime_error);
+  }
+  BOOST_CHECK(!std::ifstream("BinaryDataIOTest-incomplete.bin"));
+
+  std::remove("BinaryDataIOTest-written.bin");
+  std::remove(CacheFilePath.c_str());
+}
+
+BOOST_AUTO_TEST_SUITE_END();
+
+} // namespace Data
+} // namespace ComPWA
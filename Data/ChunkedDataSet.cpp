@@ -0,0 +1,175 @@
+// Copyright (c) 2013, 2017 The ComPWA Team.
+// This file is part of the ComPWA framework, check
+// https://github.com/ComPWA/ComPWA/license.txt for details.
+
+#include <algorithm>
+#include <future>
+
+#include "ChunkedDataSet.hpp"
+#include "Core/Kinematics.hpp"
+#include "Core/Logging.hpp"
+#include "Data/DataSet.hpp"
+#include "Data/KinematicsCache.hpp"
+
+namespace ComPWA {
+namespace Data {
+
+ChunkedDataSet::ChunkedDataSet(std::shared_ptr<EventChunkReader> Reader_,
+                               std::shared_ptr<ComPWA::Kinematics> Kinematics_,
+                               size_t MemoryBudget,
+                               std::vector<bool> Variables_,
+                               const std::string &CacheFilePath_)
+    : Reader(Reader_), Kinematics(Kinematics_), Variables(Variables_),
+      CacheFilePath(CacheFilePath_), CacheChecked(false) {
+  if (!Reader || !Kinematics)
+    throw std::runtime_error("ChunkedDataSet::ChunkedDataSet(): reader and "
+                             "kinematics are required!");
+  size_t NumberOfVariables(Kinematics->getKinematicVariableNames().size());
+  if (Variables.empty())
+    Variables.resize(NumberOfVariables, true);
+  if (Variables.size() != NumberOfVariables)
+    throw std::runtime_error("ChunkedDataSet::ChunkedDataSet(): number of "
+                             "variable flags does not match!");
+  size_t NumberOfColumns(std::count(Variables.begin(), Variables.end(), true));
+  // the variables which are not calculated share one column
+  if (NumberOfColumns < NumberOfVariables)
+    ++NumberOfColumns;
+  size_t BytesPerEvent = sizeof(Event) +
+                         Reader->numberOfParticles() * sizeof(Particle) +
+                         (NumberOfColumns + 1) * sizeof(double);
+  // the current and the prefetched chunk are in memory at the same time
+  ChunkSize = std::max<size_t>(1, MemoryBudget / (2 * BytesPerEvent));
+  LOG(INFO) << "ChunkedDataSet::ChunkedDataSet(): " << numberOfEvents()
+            << " events in " << numberOfChunks() << " chunks of " << ChunkSize
+            << " events.";
+}
+
+ChunkedDataSet::~ChunkedDataSet() = default;
+
+std::shared_ptr<DataSet> ChunkedDataSet::readChunk(size_t i) const {
+  return readChunk(i, nullptr);
+}
+
+std::shared_ptr<DataSet>
+ChunkedDataSet::readChunk(size_t i, KinematicsCacheWriter *Writer) const {
+  if (i >= numberOfChunks())
+    throw std::out_of_range("ChunkedDataSet::readChunk(): chunk " +
+                            std::to_string(i) + " does not exist!");
+  size_t First(i * ChunkSize);
+  size_t Number(std::min(ChunkSize, numberOfEvents() - First));
+
+  std::vector<std::vector<double>> Columns(Variables.size());
+  std::vector<double> Weights;
+  if (Cache) {
+    for (size_t j = 0; j < Variables.size(); ++j) {
+      if (Variables[j])
+        Columns[j].assign(Cache->column(j) + First,
+                          Cache->column(j) + First + Number);
+    }
+    Weights.assign(Cache->weights() + First, Cache->weights() + First + Number);
+  } else {
+    std::vector<Event> Events(Reader->readEvents(First, Number));
+    Kinematics->convert(Events, Variables, Columns, Weights);
+    if (Writer)
+      Writer->write(Events, Columns, Weights);
+  }
+  return std::make_shared<DataSet>(std::move(Columns), std::move(Weights),
+                                   Kinematics->getKinematicVariableNames());
+}
+
+void ChunkedDataSet::openCache() const {
+  std::unique_ptr<MappedKinematicsCache> File(
+      new MappedKinematicsCache(CacheFilePath, Variables));
+  if (!File->isValid() || File->numberOfEvents() != numberOfEvents())
+    return;
+  if (File->key() != KinematicsCache::key(Reader->filePath(), *Kinematics)) {
+    LOG(INFO) << "ChunkedDataSet::openCache(): ignoring " << CacheFilePath
+              << ", because the events or the kinematics have changed.";
+    return;
+  }
+  LOG(INFO) << "ChunkedDataSet::openCache(): reading the kinematic variables "
+               "from "
+            << CacheFilePath;
+  Cache = std::move(File);
+}
+
+void ChunkedDataSet::forEachChunk(
+    const std::function<void(const DataSet &Chunk)> &Function) const {
+  if (CacheFilePath.size()) {
+    std::lock_guard<std::mutex> Lock(CacheMutex);
+    if (!CacheChecked) {
+      CacheChecked = true;
+      if (Reader->filePath().empty()) {
+        LOG(WARNING) << "ChunkedDataSet::forEachChunk(): the events are not "
+                        "read from a file, so they are not cached!";
+      } else {
+        openCache();
+      }
+      if (!Cache && Reader->filePath().size()) {
+        // the variables are cached while they are calculated in this pass
+        try {
+          KinematicsCacheWriter Writer(CacheFilePath, Reader->filePath(),
+                                       Kinematics, numberOfEvents());
+          forEachChunk(Function, &Writer);
+          Writer.close();
+        } catch (...) {
+          CacheChecked = false;
+          throw;
+        }
+        openCache();
+        return;
+      }
+    }
+  }
+  forEachChunk(Function, nullptr);
+}
+
+void ChunkedDataSet::forEachChunk(
+    const std::function<void(const DataSet &Chunk)> &Function,
+    KinematicsCacheWriter *Writer) const {
+  size_t NumberOfChunks(numberOfChunks());
+  if (0 == NumberOfChunks)
+    return;
+  // the chunks are read one after the other in order, which the cache writer
+  // requires
+  auto read = [this, Writer](size_t i) { return readChunk(i, Writer); };
+  std::future<std::shared_ptr<DataSet>> NextChunk =
+      std::async(std::launch::async, read, 0);
+  for (size_t i = 0; i < NumberOfChunks; ++i) {
+    std::shared_ptr<DataSet> Chunk = NextChunk.get();
+    if (i + 1 < NumberOfChunks)
+      NextChunk = std::async(std::launch::async, read, i + 1);
+    try {
+      Function(*Chunk);
+    } catch (...) {
+      // do not leave the prefetch running in the background
+      if (NextChunk.valid())
+        NextChunk.wait();
+      throw;
+    }
+  }
+}
+
+void ChunkedDataSet::forEachDataPoint(
+    const std::function<void(const DataPoint &Point)> &Function) const {
+  // the row is assembled from the columns, without creating the DataPoint
+  // list of the chunk
+  DataPoint Point;
+  forEachChunk([&](const DataSet &Chunk) {
+    auto const &Columns = Chunk.getParameterList().mDoubleValues();
+    if (Columns.empty())
+      return;
+    size_t NumberOfVariables(Columns.size() - 1);
+    auto const &Weights = Columns.back()->values();
+    Point.KinematicVariableList.resize(NumberOfVariables);
+    for (size_t i = 0; i < Weights.size(); ++i) {
+      for (size_t j = 0; j < NumberOfVariables; ++j)
+        Point.KinematicVariableList[j] = Columns[j]->values()[i];
+      Point.Weight = Weights[i];
+      Function(Point);
+    }
+  });
+}
+
+} // namespace Data
+} // namespace ComPWA
@@ -0,0 +1,173 @@
+// Copyright (c) 2013, 2017 The ComPWA Team.
+// This file is part of the ComPWA framework, check
+// https://github.com/ComPWA/ComPWA/license.txt for details.
+
+#ifndef DATA_CHUNKEDDATASET_HPP_
+#define DATA_CHUNKEDDATASET_HPP_
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Core/Event.hpp"
+
+namespace ComPWA {
+class Kinematics;
+namespace Data {
+
+class DataSet;
+class KinematicsCacheWriter;
+class MappedKinematicsCache;
+
+///
+/// \class EventChunkReader
+/// Interface for random access reading of consecutive events from a file.
+/// Implementations only have to support one read at a time, but the reads may
+/// be performed from different threads.
+///
+class EventChunkReader {
+public:
+  virtual ~EventChunkReader() = default;
+
+  virtual size_t numberOfEvents() const = 0;
+
+  virtual unsigned int numberOfParticles() const = 0;
+
+  /// Reads the events [\p First, \p First + \p Number).
+  virtual std::vector<Event> readEvents(size_t First, size_t Number) const = 0;
+
+  /// Path of the file which is read. It identifies the events of a cache file
+  /// (see KinematicsCache::key()), so the kinematic variables are not cached
+  /// if it is empty.
+  virtual std::string filePath() const { return ""; }
+};
+
+///
+/// \class EventChunkWriter
+/// Interface for writing an event sample to a file in consecutive chunks, so
+/// that the sample never has to be kept in memory.
+///
+class EventChunkWriter {
+public:
+  virtual ~EventChunkWriter() = default;
+
+  /// Appends \p Events to the file.
+  virtual void writeEvents(const std::vector<Event> &Events) = 0;
+
+  /// Appends \p Events, whose kinematic variables \p Points were already
+  /// calculated, e.g. for the evaluation of the model. Writers which store the
+  /// kinematic variables alongside the events use them instead of converting
+  /// the events again.
+  virtual void writeEvents(const std::vector<Event> &Events,
+                           const std::vector<DataPoint> & /*Points*/) {
+    writeEvents(Events);
+  }
+
+  /// Discards all events written so far.
+  virtual void rewind() = 0;
+
+  /// True if readEvents() is supported.
+  virtual bool canReadEvents() const { return false; }
+
+  /// Reads the events at the positions \p First, ..., \p First + \p Number - 1
+  /// of the file, which were written before, also if the writer was rewound
+  /// afterwards. Events which are overwritten after a rewind() are read with
+  /// their new content. So the written events can be filtered by rewinding the
+  /// writer and writing them again chunk by chunk.
+  virtual std::vector<Event> readEvents(size_t /*First*/,
+                                        size_t /*Number*/) const {
+    throw std::runtime_error("EventChunkWriter::readEvents(): reading the "
+                             "written events is not supported!");
+  }
+
+  /// Completes the file. No events can be written afterwards.
+  virtual void close() = 0;
+};
+
+///
+/// \class ChunkedDataSet
+/// Event sample which is not kept in memory. The events are read chunk by chunk
+/// from an EventChunkReader and converted to the kinematic variables of
+/// \p Kinematics. Each chunk is a DataSet with columnar storage only. As for
+/// DataSet, the conversion can be restricted to the variables which are used
+/// by the model.
+///
+/// The chunk size is chosen such that two chunks (the chunk which is processed
+/// and the next chunk, which is read on a background thread meanwhile) including
+/// the temporary events fit into the memory budget.
+///
+/// If a cache file is given, the kinematic variables are written to it (see
+/// KinematicsCache) during the first pass over the sample. All further passes
+/// read the chunks from the memory mapped cache instead of reading and
+/// converting the events again. An existing cache file is only used, if it
+/// was written for the same file of the reader (see
+/// EventChunkReader::filePath()) and the same kinematics.
+///
+class ChunkedDataSet {
+public:
+  /// \param MemoryBudget	Maximal memory (bytes) used for the chunks
+  /// \param Variables	Flags of the variables which are calculated, e.g.
+  /// Kinematics::getUsedKinematicVariables(). All variables if empty.
+  /// \param CacheFilePath	Cache file of the kinematic variables, e.g.
+  /// KinematicsCache::defaultFilePath(). No cache is used if empty.
+  ChunkedDataSet(std::shared_ptr<EventChunkReader> Reader,
+                 std::shared_ptr<ComPWA::Kinematics> Kinematics,
+                 size_t MemoryBudget = 256 * 1024 * 1024,
+                 std::vector<bool> Variables = {},
+                 const std::string &CacheFilePath = "");
+  ~ChunkedDataSet();
+
+  size_t numberOfEvents() const { return Reader->numberOfEvents(); }
+
+  size_t chunkSize() const { return ChunkSize; }
+
+  size_t numberOfChunks() const {
+    return (numberOfEvents() + ChunkSize - 1) / ChunkSize;
+  }
+
+  /// Reads and converts the chunk with index \p i, or reads it from the
+  /// cache.
+  std::shared_ptr<DataSet> readChunk(size_t i) const;
+
+  /// Calls \p Function for all chunks in order. The next chunk is read while
+  /// \p Function processes the current one.
+  void forEachChunk(
+      const std::function<void(const DataSet &Chunk)> &Function) const;
+
+  /// Calls \p Function for all events of the sample in order. The DataPoint
+  /// is only valid during the call.
+  void forEachDataPoint(
+      const std::function<void(const DataPoint &Point)> &Function) const;
+
+private:
+  /// Like readChunk(size_t), the converted variables are passed to \p Writer
+  /// if it is given.
+  std::shared_ptr<DataSet> readChunk(size_t i,
+                                     KinematicsCacheWriter *Writer) const;
+
+  void forEachChunk(const std::function<void(const DataSet &Chunk)> &Function,
+                    KinematicsCacheWriter *Writer) const;
+
+  /// Maps the cache file, if it matches the file of the reader and the
+  /// kinematics.
+  void openCache() const;
+
+  std::shared_ptr<EventChunkReader> Reader;
+  std::shared_ptr<ComPWA::Kinematics> Kinematics;
+  std::vector<bool> Variables;
+  size_t ChunkSize;
+
+  std::string CacheFilePath;
+  /// Guards the check and the writing of the cache in the first pass
+  mutable std::mutex CacheMutex;
+  mutable bool CacheChecked;
+  mutable std::unique_ptr<MappedKinematicsCache> Cache;
+};
+
+} // namespace Data
+} // namespace ComPWA
+
+#endif
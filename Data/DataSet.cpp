@@ -2,17 +2,139 @@
 // This file is part of the ComPWA framework, check
 // https://github.com/ComPWA/ComPWA/license.txt for details.
 
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <set>
+
 #include "DataSet.hpp"
+#include "Core/FunctionTree.hpp"
 #include "Core/Kinematics.hpp"
+#include "Data/KinematicsCache.hpp"
 
 namespace ComPWA {
 namespace Data {
 
 DataSet::DataSet(const std::vector<Event> &Events) : EventList(Events) {}
 
-DataSet::DataSet(const std::vector<DataPoint> &DataPoints)
-    : DataPointList(DataPoints) {
-  convertDataPointsToParameterList();
+DataSet::DataSet(const std::vector<DataPoint> &DataPoints) {
+  // only the columnar storage is filled, the row-wise list is recreated on
+  // demand
+  convertDataPointsToParameterList(DataPoints);
+}
+
+DataSet::DataSet(std::vector<std::vector<double>> Columns,
+                 std::vector<double> Weights,
+                 std::vector<std::string> VariableNames)
+    : KinematicVariableNames(VariableNames) {
+  for (auto const &x : Columns) {
+    if (x.size() && x.size() != Weights.size())
+      throw std::runtime_error("DataSet::DataSet(): size of columns and "
+                               "weights do not match!");
+    UsedKinematicVariables.push_back(x.size() || Weights.empty());
+  }
+  setColumns(std::move(Columns), std::move(Weights));
+}
+
+DataSet::DataSet(std::vector<Event> Events,
+                 const std::vector<DataPoint> &DataPoints,
+                 std::vector<std::string> VariableNames)
+    : EventList(std::move(Events)), KinematicVariableNames(VariableNames),
+      UsedKinematicVariables(VariableNames.size(), true) {
+  if (DataPoints.size() != EventList.size())
+    throw std::runtime_error("DataSet::DataSet(): number of events and data "
+                             "points do not match!");
+  std::vector<std::vector<double>> Columns(KinematicVariableNames.size());
+  for (auto &x : Columns)
+    x.reserve(DataPoints.size());
+  std::vector<double> Weights;
+  Weights.reserve(EventList.size());
+  for (size_t i = 0; i < DataPoints.size(); ++i) {
+    if (DataPoints[i].KinematicVariableList.size() != Columns.size())
+      throw std::runtime_error("DataSet::DataSet(): number of kinematic "
+                               "variables and names do not match!");
+    for (size_t k = 0; k < Columns.size(); ++k)
+      Columns[k].push_back(DataPoints[i].KinematicVariableList[k]);
+    Weights.push_back(EventList[i].Weight);
+  }
+  setColumns(std::move(Columns), std::move(Weights));
+}
+
+bool DataSet::hasKinematicVariables(const std::vector<std::string> &VarNames,
+                                    const std::vector<bool> &UsedVars) const {
+  if (VarNames != KinematicVariableNames ||
+      UsedVars.size() != UsedKinematicVariables.size())
+    return false;
+  for (size_t i = 0; i < UsedVars.size(); ++i) {
+    if (UsedVars[i] && !UsedKinematicVariables[i])
+      return false;
+  }
+  return true;
+}
+
+void DataSet::appendKinematicVariables(
+    std::shared_ptr<ComPWA::Kinematics> Kinematics,
+    const std::vector<std::string> &VarNames,
+    const std::vector<bool> &UsedVars) {
+  std::vector<bool> MissingVars(VarNames.size(), false);
+  for (size_t i = 0; i < VarNames.size(); ++i) {
+    MissingVars[i] = UsedVars[i] && (i >= UsedKinematicVariables.size() ||
+                                     !UsedKinematicVariables[i]);
+  }
+  LOG(INFO) << "DataSet::appendKinematicVariables(): calculating "
+            << std::count(MissingVars.begin(), MissingVars.end(), true)
+            << " new kinematic variables.";
+
+  std::vector<std::vector<double>> Columns;
+  std::vector<double> Weights;
+  Kinematics->convert(EventList, MissingVars, Columns, Weights);
+
+  // the existing columns are kept, so that FunctionTrees which were created
+  // from this DataSet stay valid
+  auto OldColumns = HorizontalDataList.mDoubleValues();
+  auto OldWeights = OldColumns.back();
+  OldColumns.pop_back();
+  std::shared_ptr<Value<std::vector<double>>> UnusedColumn;
+  for (size_t i = 0; i < OldColumns.size(); ++i) {
+    if (!UsedKinematicVariables[i])
+      UnusedColumn = OldColumns[i];
+  }
+  UsedKinematicVariables.resize(VarNames.size(), false);
+
+  HorizontalDataList = ParameterList();
+  for (size_t i = 0; i < VarNames.size(); ++i) {
+    if (MissingVars[i]) {
+      HorizontalDataList.addValue(MDouble("", std::move(Columns[i])));
+      UsedKinematicVariables[i] = true;
+    } else if (i < OldColumns.size()) {
+      HorizontalDataList.addValue(OldColumns[i]);
+    } else {
+      if (!UnusedColumn)
+        UnusedColumn = MDouble("", OldWeights->values().size(),
+                               std::numeric_limits<double>::quiet_NaN());
+      HorizontalDataList.addValue(UnusedColumn);
+    }
+  }
+  HorizontalDataList.addValue(OldWeights);
+  KinematicVariableNames = VarNames;
+  DataPointList.clear();
+}
+
+void DataSet::setColumns(std::vector<std::vector<double>> Columns,
+                         std::vector<double> Weights) {
+  HorizontalDataList = ParameterList();
+  std::shared_ptr<Value<std::vector<double>>> UnusedColumn;
+  for (auto &x : Columns) {
+    if (x.size() == Weights.size()) {
+      HorizontalDataList.addValue(MDouble("", std::move(x)));
+      continue;
+    }
+    if (!UnusedColumn)
+      UnusedColumn = MDouble("", Weights.size(),
+                             std::numeric_limits<double>::quiet_NaN());
+    HorizontalDataList.addValue(UnusedColumn);
+  }
+  HorizontalDataList.addValue(MDouble("Weight", std::move(Weights)));
 }
 
 void DataSet::reduceToPhaseSpace(
@@ -41,36 +163,135 @@ void DataSet::reduceToPhaseSpace(
 void DataSet::convertEventsToDataPoints(
     std::shared_ptr<ComPWA::Kinematics> Kinematics) {
   auto VarNames = Kinematics->getKinematicVariableNames();
-  if (VarNames == KinematicVariableNames &&
-      DataPointList.size() == EventList.size()) {
-    // nothing has changed, the cached values are fine
+  if (0 == EventList.size() && 0 < columnSize()) {
+    LOG(DEBUG) << "DataSet::convertEventsToDataPoints(): no events stored, "
+                  "keeping the kinematic variables.";
+    getDataPointList();
     return;
   }
-  if (VarNames != KinematicVariableNames) {
-    if (0 < KinematicVariableNames.size())
-      LOG(INFO) << "DataSet::convertEventsToDataPoints(): the kinematic "
-                   "variables have changed! recalculating...";
-  } else if (DataPointList.size() != EventList.size()) {
+  if (hasKinematicVariables(VarNames,
+                            std::vector<bool>(VarNames.size(), true))) {
+    if (DataPointList.size() == EventList.size()) {
+      // nothing has changed, the cached values are fine
+      return;
+    }
+    if (columnSize() == EventList.size()) {
+      // the columns are up to date, no need to convert the events again
+      convertParameterListToDataPoints();
+      return;
+    }
     LOG(INFO) << "DataSet::convertEventsToDataPoints(): the event list "
                  "size has changed! recalculating...";
+  } else if (0 < KinematicVariableNames.size()) {
+    LOG(INFO) << "DataSet::convertEventsToDataPoints(): the kinematic "
+                 "variables have changed! recalculating...";
   }
 
+  // the (batch) conversion fills the columns, the rows are created from them
+  convertEventsToParameterList(Kinematics);
+  convertParameterListToDataPoints();
+}
+
+void DataSet::convertEventsToParameterList(
+    std::shared_ptr<ComPWA::Kinematics> Kinematics) {
+  convertEventsToParameterList(
+      Kinematics,
+      std::vector<bool>(Kinematics->getKinematicVariableNames().size(), true));
+}
+
+void DataSet::convertEventsToParameterList(
+    std::shared_ptr<ComPWA::Kinematics> Kinematics,
+    const std::vector<bool> &Variables) {
+  auto VarNames = Kinematics->getKinematicVariableNames();
+  if (Variables.size() != VarNames.size())
+    throw std::runtime_error("DataSet::convertEventsToParameterList(): "
+                             "number of variable flags does not match!");
+  if (0 == EventList.size() && 0 < columnSize()) {
+    LOG(DEBUG) << "DataSet::convertEventsToParameterList(): no events stored, "
+                  "keeping the kinematic variables.";
+    return;
+  }
+  auto const &UsedVars = Variables;
+  bool ColumnsAvailable(columnSize() == EventList.size() &&
+                        HorizontalDataList.mDoubleValues().size());
+  if (hasKinematicVariables(VarNames, UsedVars)) {
+    if (ColumnsAvailable)
+      return;
+    if (DataPointList.size() == EventList.size()) {
+      convertDataPointsToParameterList(DataPointList);
+      return;
+    }
+  } else if (ColumnsAvailable &&
+             UsedKinematicVariables.size() == KinematicVariableNames.size() &&
+             VarNames.size() >= KinematicVariableNames.size() &&
+             std::equal(KinematicVariableNames.begin(),
+                        KinematicVariableNames.end(), VarNames.begin())) {
+    // variables were only appended (e.g. a SubSystem was added) or are
+    // requested now, only those are calculated
+    appendKinematicVariables(Kinematics, VarNames, UsedVars);
+    return;
+  } else if (0 < KinematicVariableNames.size()) {
+    LOG(INFO) << "DataSet::convertEventsToParameterList(): the kinematic "
+                 "variables have changed! recalculating...";
+  }
+
+  // convert the events directly into the columns, without intermediate
+  // DataPoint list
   KinematicVariableNames = VarNames;
+  UsedKinematicVariables = UsedVars;
   DataPointList.clear();
-  DataPointList.reserve(EventList.size());
-  for (auto const &evt : EventList) {
-    DataPointList.push_back(Kinematics->convert(evt));
-  }
+  HorizontalDataList = ParameterList();
+  if (0 == EventList.size())
+    return;
+
+  std::vector<std::vector<double>> Columns;
+  std::vector<double> Weights;
+  Kinematics->convert(EventList, UsedVars, Columns, Weights);
+  setColumns(std::move(Columns), std::move(Weights));
 }
 
 void DataSet::convertEventsToParameterList(
-    std::shared_ptr<ComPWA::Kinematics> Kinematics) {
-  convertEventsToDataPoints(Kinematics);
-  convertDataPointsToParameterList();
+    std::shared_ptr<ComPWA::Kinematics> Kinematics,
+    const std::string &InputFilePath, std::vector<bool> Variables) {
+  auto VarNames = Kinematics->getKinematicVariableNames();
+  if (Variables.empty())
+    Variables.resize(VarNames.size(), true);
+  auto const &UsedVars = Variables;
+  if (0 == EventList.size() ||
+      (hasKinematicVariables(VarNames, UsedVars) &&
+       columnSize() == EventList.size() &&
+       HorizontalDataList.mDoubleValues().size())) {
+    convertEventsToParameterList(Kinematics, UsedVars);
+    return;
+  }
+
+  uint64_t Key(KinematicsCache::key(InputFilePath, *Kinematics));
+  if (!Key) {
+    LOG(WARNING) << "DataSet::convertEventsToParameterList(): can't access "
+                 << InputFilePath << ", so the kinematic variables are not "
+                                     "cached!";
+    convertEventsToParameterList(Kinematics, UsedVars);
+    return;
+  }
+  KinematicsCache Cache(KinematicsCache::defaultFilePath(InputFilePath));
+  std::vector<std::vector<double>> Columns;
+  std::vector<double> Weights;
+  if (!Cache.read(Key, UsedVars, Columns, Weights) ||
+      Weights.size() != EventList.size()) {
+    Kinematics->convert(EventList, UsedVars, Columns, Weights);
+    Cache.write(Key, Columns, Weights);
+  }
+
+  KinematicVariableNames = VarNames;
+  UsedKinematicVariables = UsedVars;
+  DataPointList.clear();
+  setColumns(std::move(Columns), std::move(Weights));
 }
 
 const std::vector<Event> &DataSet::getEventList() const { return EventList; }
 const std::vector<DataPoint> &DataSet::getDataPointList() const {
+  if (DataPointList.empty())
+    convertParameterListToDataPoints();
   return DataPointList;
 }
 const ParameterList &DataSet::getParameterList() const {
@@ -81,39 +302,53 @@ const std::vector<std::string> &DataSet::getKinematicVariableNames() const {
   return KinematicVariableNames;
 }
 
-void DataSet::convertDataPointsToParameterList() {
-  if (0 < DataPointList.size()) {
-    // reset old parameter list
-    HorizontalDataList = ParameterList();
+const std::vector<bool> &DataSet::getUsedKinematicVariables() const {
+  return UsedKinematicVariables;
+}
+
+size_t DataSet::columnSize() const {
+  if (0 == HorizontalDataList.mDoubleValues().size())
+    return 0;
+  return HorizontalDataList.mDoubleValue(0)->values().size();
+}
+
+void DataSet::convertDataPointsToParameterList(
+    const std::vector<DataPoint> &DataPoints) {
+  // reset old parameter list
+  HorizontalDataList = ParameterList();
+  if (0 < DataPoints.size()) {
     size_t NumberOfKinematicVariables =
-        DataPointList[0].KinematicVariableList.size();
-    std::vector<std::vector<double>> Data(NumberOfKinematicVariables,
-                                          std::vector<double>());
+        DataPoints[0].KinematicVariableList.size();
+    std::vector<std::vector<double>> Data(NumberOfKinematicVariables);
+    for (auto &x : Data)
+      x.reserve(DataPoints.size());
     std::vector<double> Weights;
-    Weights.reserve(DataPointList.size());
+    Weights.reserve(DataPoints.size());
 
-    for (auto const &point : DataPointList) {
+    for (auto const &point : DataPoints) {
       Weights.push_back(point.Weight);
       for (unsigned int i = 0; i < NumberOfKinematicVariables; ++i)
         Data[i].push_back(point.KinematicVariableList[i]);
     }
 
     // Add data vector to ParameterList
-    for (auto x : Data)
-      HorizontalDataList.addValue(MDouble("", x));
+    for (auto &x : Data)
+      HorizontalDataList.addValue(MDouble("", std::move(x)));
     // Adding weight at the end
-    HorizontalDataList.addValue(MDouble("Weight", Weights));
+    HorizontalDataList.addValue(MDouble("Weight", std::move(Weights)));
   }
 }
 
-void DataSet::convertParameterListToDataPoints() {
-  if (0 < HorizontalDataList.mDoubleValues().size() - 1) {
+void DataSet::convertParameterListToDataPoints() const {
+  DataPointList.clear();
+  if (0 < HorizontalDataList.mDoubleValues().size()) {
     unsigned int NumberOfKinematicVariables =
         HorizontalDataList.mDoubleValues().size() - 1;
-    for (unsigned int evt_index = 0;
-         evt_index < HorizontalDataList.mDoubleValues()[0]->values().size();
-         ++evt_index) {
+    size_t NumberOfEvents(columnSize());
+    DataPointList.reserve(NumberOfEvents);
+    for (unsigned int evt_index = 0; evt_index < NumberOfEvents; ++evt_index) {
       DataPoint dp;
+      dp.KinematicVariableList.reserve(NumberOfKinematicVariables);
       for (unsigned int j = 0; j < NumberOfKinematicVariables; ++j)
         dp.KinematicVariableList.push_back(
             HorizontalDataList.mDoubleValue(j)->values()[evt_index]);
@@ -125,5 +360,48 @@ void DataSet::convertParameterListToDataPoints() {
   }
 }
 
+std::vector<bool>
+findUsedKinematicVariables(const ComPWA::FunctionTreeInterface &Model,
+                           const ComPWA::Kinematics &Kinematics,
+                           const ComPWA::Event &Event) {
+  // the trees are evaluated during their construction, so the values have to
+  // be physical
+  DataPoint Point(Kinematics.convert(Event));
+  size_t NumberOfVariables(Point.KinematicVariableList.size());
+  // each variable gets its own column, so that the leaves identify it
+  ParameterList Sample;
+  std::map<const Parameter *, size_t> Positions;
+  for (size_t i = 0; i < NumberOfVariables; ++i) {
+    auto Column = MDouble("", 1, Point.KinematicVariableList[i]);
+    Positions[Column.get()] = i;
+    Sample.addValue(Column);
+  }
+  Sample.addValue(MDouble("Weight", 1, 1.0));
+
+  auto Tree = Model.createFunctionTree(Sample, "");
+  std::vector<bool> UsedVariables(NumberOfVariables, false);
+  if (!Tree)
+    return std::vector<bool>(NumberOfVariables, true);
+
+  // nodes can be shared by several parents, each one is visited once
+  std::vector<std::shared_ptr<TreeNode>> Nodes{Tree->head()};
+  std::set<const TreeNode *> Visited;
+  while (!Nodes.empty()) {
+    auto Node = Nodes.back();
+    Nodes.pop_back();
+    if (!Visited.insert(Node.get()).second)
+      continue;
+    if (Node->childNodes().empty()) {
+      auto Position = Positions.find(Node->parameter().get());
+      if (Position != Positions.end())
+        UsedVariables[Position->second] = true;
+      continue;
+    }
+    Nodes.insert(Nodes.end(), Node->childNodes().begin(),
+                 Node->childNodes().end());
+  }
+  return UsedVariables;
+}
+
 } // namespace Data
 } // namespace ComPWA
@@ -13,31 +13,105 @@
 
 namespace ComPWA {
 class Kinematics;
+class FunctionTreeInterface;
 namespace Data {
 
+///
+/// \class DataSet
+/// Container of an event sample and its kinematic variables.
+///
+/// The kinematic variables are stored column-wise: one contiguous
+/// MultiDouble per variable and the event weights as last column (see
+/// getParameterList()). The columns are shared (not copied) with the leaves of
+/// the FunctionTrees which are created from this DataSet. The row-wise
+/// DataPoint list is only created on request via getDataPointList() or
+/// convertEventsToDataPoints().
+///
+/// By default all kinematic variables are calculated. If the DataSet is only
+/// used to evaluate the model, the calculation can be restricted to the
+/// variables which are used by the model (see
+/// Kinematics::getUsedKinematicVariables() and findUsedKinematicVariables()).
+/// The columns of the other variables then all share one column filled with
+/// NaN, so that the positions of the variables do not change.
+///
 class DataSet {
 public:
   virtual ~DataSet() = default;
   DataSet(const std::vector<Event> &Events);
   DataSet(const std::vector<DataPoint> &DataPoints);
 
+  /// Creates a DataSet from the columns of the kinematic variables and the
+  /// event weights. The columns are moved into the DataSet. Empty columns
+  /// mark unused variables.
+  DataSet(std::vector<std::vector<double>> Columns,
+          std::vector<double> Weights,
+          std::vector<std::string> VariableNames = {});
+
+  /// Creates a DataSet from \p Events and their kinematic variables
+  /// \p DataPoints with the names \p VariableNames, which were already
+  /// calculated, e.g. for the evaluation of the model. The events are not
+  /// converted again. The weights are taken from the events.
+  DataSet(std::vector<Event> Events, const std::vector<DataPoint> &DataPoints,
+          std::vector<std::string> VariableNames);
+
   void reduceToPhaseSpace(std::shared_ptr<ComPWA::Kinematics> Kinematics);
 
   void convertEventsToDataPoints(std::shared_ptr<Kinematics> Kinematics);
   void convertEventsToParameterList(std::shared_ptr<Kinematics> Kinematics);
 
+  /// Calculates only the variables with set flag in \p Variables, e.g.
+  /// Kinematics::getUsedKinematicVariables() if the DataSet is only passed to
+  /// the model. Variables which are not calculated are NaN.
+  void convertEventsToParameterList(std::shared_ptr<Kinematics> Kinematics,
+                                    const std::vector<bool> &Variables);
+
+  /// Like convertEventsToParameterList(std::shared_ptr<Kinematics>), but the
+  /// columns are read from the cache file of \p InputFilePath (see
+  /// KinematicsCache::defaultFilePath()), the file from which the events were
+  /// read, if it was written for the same file and kinematics. Otherwise the
+  /// variables are calculated and the cache file is written. If \p Variables
+  /// is not empty, only the variables with set flag are calculated or read.
+  void convertEventsToParameterList(std::shared_ptr<Kinematics> Kinematics,
+                                    const std::string &InputFilePath,
+                                    std::vector<bool> Variables = {});
+
   const std::vector<Event> &getEventList() const;
   const std::vector<DataPoint> &getDataPointList() const;
   const ParameterList &getParameterList() const;
 
   const std::vector<std::string> &getKinematicVariableNames() const;
 
+  /// Flags of the variables which are calculated
+  const std::vector<bool> &getUsedKinematicVariables() const;
+
 private:
-  void convertDataPointsToParameterList();
-  void convertParameterListToDataPoints();
+  /// Checks if the variables \p VarNames are stored and all variables with
+  /// set flag in \p UsedVars are calculated.
+  bool hasKinematicVariables(const std::vector<std::string> &VarNames,
+                             const std::vector<bool> &UsedVars) const;
+
+  /// Calculates the variables which were appended to or are newly used in
+  /// \p VarNames and keeps the existing columns.
+  void appendKinematicVariables(std::shared_ptr<ComPWA::Kinematics> Kinematics,
+                                const std::vector<std::string> &VarNames,
+                                const std::vector<bool> &UsedVars);
+
+  /// Stores \p Columns and \p Weights in the columnar storage. Empty columns
+  /// are replaced by the shared NaN column.
+  void setColumns(std::vector<std::vector<double>> Columns,
+                  std::vector<double> Weights);
+
+  void convertDataPointsToParameterList(
+      const std::vector<DataPoint> &DataPoints);
+  void convertParameterListToDataPoints() const;
+
+  /// Number of events in the columnar storage
+  size_t columnSize() const;
 
   std::vector<Event> EventList;
-  std::vector<DataPoint> DataPointList;
+
+  /// Row-wise copy of the kinematic variables, created on demand
+  mutable std::vector<DataPoint> DataPointList;
 
   /// A 'horizontal' list of the kinematic variables. For each variable
   /// (e.g. m23sq, m13sq ...) a MultiDouble is added to ParameterList.
@@ -45,8 +119,21 @@ private:
   ParameterList HorizontalDataList;
 
   std::vector<std::string> KinematicVariableNames;
+
+  std::vector<bool> UsedKinematicVariables;
 };
 
+/// Flags of the kinematic variables of \p Kinematics which are read by the
+/// FunctionTree of \p Model. The tree is created for a sample which only
+/// contains the (physical) \p Event, and its leaves are compared with the
+/// columns of this sample. The result can be passed to
+/// Kinematics::setUsedKinematicVariables() before the data and phase space
+/// samples are converted.
+std::vector<bool>
+findUsedKinematicVariables(const ComPWA::FunctionTreeInterface &Model,
+                           const ComPWA::Kinematics &Kinematics,
+                           const ComPWA::Event &Event);
+
 } // namespace Data
 } // namespace ComPWA
 
@@ -0,0 +1,388 @@
+// Copyright (c) 2013, 2017 The ComPWA Team.
+// This file is part of the ComPWA framework, check
+// https://github.com/ComPWA/ComPWA/license.txt for details.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "Core/Kinematics.hpp"
+#include "Core/Logging.hpp"
+#include "Data/KinematicsCache.hpp"
+
+namespace ComPWA {
+namespace Data {
+
+static const char CacheFormatMagic[8] = {'C', 'O', 'M', 'P',
+                                         'W', 'A', 'K', 'C'};
+static const uint32_t CacheFormatByteOrderMark = 0x01020304;
+
+static_assert(sizeof(KinematicsCacheHeader) == 64,
+              "KinematicsCacheHeader has to be 64 bytes");
+
+/// 64 bit FNV-1a hash, which is continued from \p Hash.
+static uint64_t hashBytes(const void *Data, size_t Size, uint64_t Hash) {
+  auto Bytes = static_cast<const unsigned char *>(Data);
+  for (size_t i = 0; i < Size; ++i) {
+    Hash ^= Bytes[i];
+    Hash *= 0x100000001b3ULL;
+  }
+  return Hash;
+}
+
+static uint64_t hashWord(uint64_t Word, uint64_t Hash) {
+  return hashBytes(&Word, sizeof(Word), Hash);
+}
+
+KinematicsCache::KinematicsCache(const std::string &FilePath_)
+    : FilePath(FilePath_) {}
+
+std::string KinematicsCache::defaultFilePath(const std::string &InputFilePath) {
+  return InputFilePath + ".kinematics";
+}
+
+uint64_t KinematicsCache::key(const std::string &InputFilePath,
+                              const ComPWA::Kinematics &Kinematics) {
+  struct stat FileStatus;
+  if (InputFilePath.empty() || stat(InputFilePath.c_str(), &FileStatus) < 0)
+    return 0;
+  // the same file can be given by different paths
+  std::string Path(InputFilePath);
+  if (char *RealPath = realpath(InputFilePath.c_str(), nullptr)) {
+    Path = RealPath;
+    std::free(RealPath);
+  }
+#ifdef __APPLE__
+  const struct timespec &ModificationTime(FileStatus.st_mtimespec);
+#else
+  const struct timespec &ModificationTime(FileStatus.st_mtim);
+#endif
+
+  uint64_t Hash(0xcbf29ce484222325ULL);
+  Hash = hashBytes(Path.data(), Path.size() + 1, Hash);
+  Hash = hashWord(FileStatus.st_size, Hash);
+  Hash = hashWord(ModificationTime.tv_sec, Hash);
+  Hash = hashWord(ModificationTime.tv_nsec, Hash);
+  for (auto const &x : Kinematics.getKinematicVariableNames())
+    Hash = hashBytes(x.data(), x.size() + 1, Hash);
+  std::string Configuration(Kinematics.configuration());
+  Hash = hashBytes(Configuration.data(), Configuration.size(), Hash);
+  // 0 is reserved for files which can't be accessed
+  return Hash ? Hash : 1;
+}
+
+bool KinematicsCache::read(uint64_t Key, const std::vector<bool> &UsedVariables,
+                           std::vector<std::vector<double>> &Columns,
+                           std::vector<double> &Weights) const {
+  MappedKinematicsCache File(FilePath, UsedVariables);
+  if (!File.isValid())
+    return false;
+  if (File.key() != Key) {
+    LOG(INFO) << "KinematicsCache::read(): ignoring " << FilePath
+              << ", because the events or the kinematics have changed.";
+    return false;
+  }
+
+  // only the requested columns are copied out of the mapping, the others are
+  // never loaded
+  size_t NumberOfEvents(File.numberOfEvents());
+  size_t NumberOfReadColumns(0);
+  Columns.assign(UsedVariables.size(), std::vector<double>());
+  for (size_t i = 0; i < UsedVariables.size(); ++i) {
+    if (!UsedVariables[i])
+      continue;
+    Columns[i].assign(File.column(i), File.column(i) + NumberOfEvents);
+    ++NumberOfReadColumns;
+  }
+  Weights.assign(File.weights(), File.weights() + NumberOfEvents);
+
+  LOG(INFO) << "KinematicsCache::read(): read " << NumberOfReadColumns
+            << " kinematic variables of " << NumberOfEvents << " events from "
+            << FilePath;
+  return true;
+}
+
+MappedKinematicsCache::MappedKinematicsCache(
+    const std::string &FilePath, const std::vector<bool> &UsedVariables)
+    : Data(nullptr), FileSize(0), Header(nullptr), Weights(nullptr) {
+  int FileDescriptor = open(FilePath.c_str(), O_RDONLY);
+  if (FileDescriptor < 0)
+    return;
+  struct stat FileStatus;
+  if (fstat(FileDescriptor, &FileStatus) < 0 ||
+      FileStatus.st_size < (off_t)sizeof(KinematicsCacheHeader)) {
+    close(FileDescriptor);
+    return;
+  }
+  FileSize = FileStatus.st_size;
+  Data = mmap(nullptr, FileSize, PROT_READ, MAP_SHARED, FileDescriptor, 0);
+  close(FileDescriptor);
+  if (MAP_FAILED == Data) {
+    Data = nullptr;
+    return;
+  }
+
+  auto FileHeader = static_cast<const KinematicsCacheHeader *>(Data);
+  auto Flags = reinterpret_cast<const uint64_t *>(FileHeader + 1);
+  std::string Reason;
+  if (std::memcmp(FileHeader->Magic, CacheFormatMagic, 8) ||
+      FileHeader->ByteOrderMark != CacheFormatByteOrderMark ||
+      FileHeader->Version != KinematicsCache::FormatVersion)
+    Reason = "it is not a compatible cache file";
+  else if (FileHeader->NumberOfVariables != UsedVariables.size())
+    Reason = "the events or the kinematics have changed";
+  else if (FileSize < sizeof(KinematicsCacheHeader) +
+                          FileHeader->NumberOfVariables * sizeof(uint64_t))
+    Reason = "it is corrupted";
+
+  size_t NumberOfStoredColumns(0);
+  if (Reason.empty()) {
+    for (size_t i = 0; i < UsedVariables.size(); ++i) {
+      if (Flags[i])
+        ++NumberOfStoredColumns;
+      else if (UsedVariables[i])
+        Reason = "variables are missing";
+    }
+  }
+  size_t NumberOfEvents(FileHeader->NumberOfEvents);
+  if (Reason.empty() &&
+      FileSize != sizeof(KinematicsCacheHeader) +
+                      UsedVariables.size() * sizeof(uint64_t) +
+                      (NumberOfStoredColumns + 1) * NumberOfEvents *
+                          sizeof(double))
+    Reason = "it is corrupted";
+  if (Reason.size()) {
+    LOG(INFO) << "MappedKinematicsCache::MappedKinematicsCache(): ignoring "
+              << FilePath << ", because " << Reason << ".";
+    return;
+  }
+
+  auto Column = reinterpret_cast<const double *>(Flags + UsedVariables.size());
+  for (size_t i = 0; i < UsedVariables.size(); ++i) {
+    if (!Flags[i]) {
+      Columns.push_back(nullptr);
+      continue;
+    }
+    Columns.push_back(Column);
+    Column += NumberOfEvents;
+  }
+  Weights = Column;
+  Header = FileHeader;
+}
+
+MappedKinematicsCache::~MappedKinematicsCache() {
+  if (Data)
+    munmap(Data, FileSize);
+}
+
+void KinematicsCache::write(uint64_t Key,
+                            const std::vector<std::vector<double>> &Columns,
+                            const std::vector<double> &Weights) const {
+  // write to a temporary file first, renaming is atomic
+  std::string TemporaryFilePath(FilePath + ".tmp" + std::to_string(getpid()));
+  std::ofstream File(TemporaryFilePath, std::ios::binary | std::ios::trunc);
+  if (!File) {
+    LOG(WARNING) << "KinematicsCache::write(): can't open " << FilePath
+                 << ", the kinematic variables are not cached!";
+    return;
+  }
+
+  KinematicsCacheHeader Header;
+  std::memset(&Header, 0, sizeof(Header));
+  std::memcpy(Header.Magic, CacheFormatMagic, 8);
+  Header.Version = FormatVersion;
+  Header.ByteOrderMark = CacheFormatByteOrderMark;
+  Header.Key = Key;
+  Header.NumberOfEvents = Weights.size();
+  Header.NumberOfVariables = Columns.size();
+  File.write(reinterpret_cast<const char *>(&Header), sizeof(Header));
+
+  for (auto const &x : Columns) {
+    uint64_t Flag(x.size() == Weights.size() ? 1 : 0);
+    File.write(reinterpret_cast<const char *>(&Flag), sizeof(Flag));
+  }
+  for (auto const &x : Columns) {
+    if (x.size() == Weights.size())
+      File.write(reinterpret_cast<const char *>(x.data()),
+                 x.size() * sizeof(double));
+  }
+  File.write(reinterpret_cast<const char *>(Weights.data()),
+             Weights.size() * sizeof(double));
+  File.close();
+
+  if (!File || std::rename(TemporaryFilePath.c_str(), FilePath.c_str())) {
+    LOG(WARNING) << "KinematicsCache::write(): writing " << FilePath
+                 << " failed, the kinematic variables are not cached!";
+    std::remove(TemporaryFilePath.c_str());
+    return;
+  }
+  LOG(INFO) << "KinematicsCache::write(): wrote kinematic variables of "
+            << Weights.size() << " events to " << FilePath;
+}
+
+/// Writes \p Size bytes at \p Offset of the file, returns false on failure.
+static bool writeAt(int FileDescriptor, const void *Data, size_t Size,
+                    off_t Offset) {
+  auto Bytes = static_cast<const char *>(Data);
+  while (Size > 0) {
+    ssize_t Written = pwrite(FileDescriptor, Bytes, Size, Offset);
+    if (Written <= 0)
+      return false;
+    Bytes += Written;
+    Size -= Written;
+    Offset += Written;
+  }
+  return true;
+}
+
+KinematicsCacheWriter::KinematicsCacheWriter(
+    const std::string &FilePath_, const std::string &InputFilePath_,
+    std::shared_ptr<ComPWA::Kinematics> Kinematics_, size_t NumberOfEvents_)
+    : FilePath(FilePath_),
+      TemporaryFilePath(FilePath_ + ".tmp" + std::to_string(getpid())),
+      InputFilePath(InputFilePath_), Kinematics(Kinematics_),
+      NumberOfEvents(NumberOfEvents_), NumberOfWrittenEvents(0),
+      FileDescriptor(-1) {
+  FileDescriptor =
+      open(TemporaryFilePath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (FileDescriptor < 0)
+    LOG(WARNING) << "KinematicsCacheWriter::KinematicsCacheWriter(): can't "
+                    "open "
+                 << FilePath << ", the kinematic variables are not cached!";
+}
+
+KinematicsCacheWriter::~KinematicsCacheWriter() {
+  if (FileDescriptor >= 0) {
+    ::close(FileDescriptor);
+    std::remove(TemporaryFilePath.c_str());
+  }
+}
+
+void KinematicsCacheWriter::fail(const std::string &Reason) {
+  LOG(WARNING) << "KinematicsCacheWriter: writing " << FilePath
+               << " failed (" << Reason
+               << "), the kinematic variables are not cached!";
+  ::close(FileDescriptor);
+  FileDescriptor = -1;
+  std::remove(TemporaryFilePath.c_str());
+}
+
+void KinematicsCacheWriter::write(const std::vector<Event> &Events) {
+  if (FileDescriptor < 0 || Events.empty())
+    return;
+  if (NumberOfWrittenEvents + Events.size() > NumberOfEvents) {
+    fail("too many events");
+    return;
+  }
+  std::vector<std::vector<double>> Columns;
+  std::vector<double> Weights;
+  Kinematics->convert(Events, Columns, Weights);
+  write(Events, Columns, Weights);
+}
+
+void KinematicsCacheWriter::write(
+    const std::vector<Event> &Events,
+    const std::vector<std::vector<double>> &Columns,
+    const std::vector<double> &Weights) {
+  if (FileDescriptor < 0 || Events.empty())
+    return;
+  if (NumberOfWrittenEvents + Events.size() > NumberOfEvents) {
+    fail("too many events");
+    return;
+  }
+  if (Weights.size() != Events.size()) {
+    fail("the variables do not match the events");
+    return;
+  }
+
+  // the stored columns and hence the file layout are fixed by the first chunk
+  if (Flags.empty()) {
+    for (auto const &x : Columns)
+      Flags.push_back(x.size() == Weights.size() ? 1 : 0);
+    size_t NumberOfStoredColumns(std::count(Flags.begin(), Flags.end(), 1));
+    off_t FileSize(sizeof(KinematicsCacheHeader) +
+                   Flags.size() * sizeof(uint64_t) +
+                   (NumberOfStoredColumns + 1) * NumberOfEvents *
+                       sizeof(double));
+    if (!writeAt(FileDescriptor, Flags.data(), Flags.size() * sizeof(uint64_t),
+                 sizeof(KinematicsCacheHeader)) ||
+        ftruncate(FileDescriptor, FileSize)) {
+      fail("can't allocate the file");
+      return;
+    }
+  }
+
+  off_t Offset(sizeof(KinematicsCacheHeader) + Flags.size() * sizeof(uint64_t) +
+               NumberOfWrittenEvents * sizeof(double));
+  for (size_t i = 0; i < Columns.size(); ++i) {
+    if (!Flags[i])
+      continue;
+    if (Columns[i].size() != Weights.size()) {
+      fail("the stored variables changed");
+      return;
+    }
+    if (!writeAt(FileDescriptor, Columns[i].data(),
+                 Columns[i].size() * sizeof(double), Offset)) {
+      fail("write error");
+      return;
+    }
+    Offset += NumberOfEvents * sizeof(double);
+  }
+  if (!writeAt(FileDescriptor, Weights.data(), Weights.size() * sizeof(double),
+               Offset)) {
+    fail("write error");
+    return;
+  }
+
+  NumberOfWrittenEvents += Events.size();
+}
+
+void KinematicsCacheWriter::rewind() { NumberOfWrittenEvents = 0; }
+
+void KinematicsCacheWriter::close() {
+  if (FileDescriptor < 0)
+    return;
+  if (NumberOfWrittenEvents != NumberOfEvents) {
+    fail("only " + std::to_string(NumberOfWrittenEvents) + " of " +
+         std::to_string(NumberOfEvents) + " events were written");
+    return;
+  }
+  uint64_t Key(KinematicsCache::key(InputFilePath, *Kinematics));
+  if (!Key) {
+    fail("can't access " + InputFilePath);
+    return;
+  }
+  KinematicsCacheHeader Header;
+  std::memset(&Header, 0, sizeof(Header));
+  std::memcpy(Header.Magic, CacheFormatMagic, 8);
+  Header.Version = KinematicsCache::FormatVersion;
+  Header.ByteOrderMark = CacheFormatByteOrderMark;
+  Header.Key = Key;
+  Header.NumberOfEvents = NumberOfEvents;
+  Header.NumberOfVariables = Flags.size();
+  if (!writeAt(FileDescriptor, &Header, sizeof(Header), 0)) {
+    fail("write error");
+    return;
+  }
+  if (::close(FileDescriptor) ||
+      std::rename(TemporaryFilePath.c_str(), FilePath.c_str())) {
+    FileDescriptor = -1;
+    LOG(WARNING) << "KinematicsCacheWriter::close(): writing " << FilePath
+                 << " failed, the kinematic variables are not cached!";
+    std::remove(TemporaryFilePath.c_str());
+    return;
+  }
+  FileDescriptor = -1;
+  LOG(INFO) << "KinematicsCacheWriter::close(): wrote kinematic variables of "
+            << NumberOfEvents << " events to " << FilePath;
+}
+
+} // namespace Data
+} // namespace ComPWA
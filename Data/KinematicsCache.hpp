@@ -0,0 +1,173 @@
+// Copyright (c) 2013, 2017 The ComPWA Team.
+// This file is part of the ComPWA framework, check
+// https://github.com/ComPWA/ComPWA/license.txt for details.
+
+#ifndef DATA_KINEMATICSCACHE_HPP_
+#define DATA_KINEMATICSCACHE_HPP_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Core/Event.hpp"
+
+namespace ComPWA {
+class Kinematics;
+namespace Data {
+
+///
+/// Header of the kinematics cache file. All numbers are stored in the byte
+/// order of the writing machine, which is checked via ByteOrderMark.
+///
+/// The header is followed by
+///   - one flag (uint64) per variable: 1 if the column is stored, else 0
+///   - the stored columns (double, each with NumberOfEvents entries)
+///   - event weights (double)
+///
+struct KinematicsCacheHeader {
+  char Magic[8];
+  uint32_t Version;
+  uint32_t ByteOrderMark;
+  uint64_t Key;
+  uint64_t NumberOfEvents;
+  uint64_t NumberOfVariables;
+  uint64_t Reserved[3];
+};
+
+///
+/// \class KinematicsCache
+/// File cache of the kinematic variables of an event sample. The cache is
+/// identified by a key, which is a hash of the identity of the file the events
+/// are read from (its path, size and modification time), the kinematic
+/// variable names and Kinematics::configuration(). So the events do not have
+/// to be read to check the cache, but it must only be used for the events of
+/// this file. A cache with a different key is ignored and overwritten.
+///
+class KinematicsCache {
+public:
+  /// Version of the format which is written
+  static const uint32_t FormatVersion = 1;
+
+  KinematicsCache(const std::string &FilePath);
+
+  /// Cache file which is used for the events read from \p InputFilePath.
+  static std::string defaultFilePath(const std::string &InputFilePath);
+
+  /// Key of the kinematic variables of the events of \p InputFilePath. It is
+  /// 0 if the file can't be accessed, such events are not cached.
+  static uint64_t key(const std::string &InputFilePath,
+                      const ComPWA::Kinematics &Kinematics);
+
+  /// Reads the columns of the variables with set flag in \p UsedVariables
+  /// (the other columns are empty) and the weights. Returns false if the
+  /// cache file does not exist, has a different key or misses one of these
+  /// variables.
+  bool read(uint64_t Key, const std::vector<bool> &UsedVariables,
+            std::vector<std::vector<double>> &Columns,
+            std::vector<double> &Weights) const;
+
+  /// Writes the columns (empty columns are not stored) and weights. The file
+  /// is replaced atomically, so that concurrent jobs never see a partially
+  /// written cache.
+  void write(uint64_t Key, const std::vector<std::vector<double>> &Columns,
+             const std::vector<double> &Weights) const;
+
+private:
+  std::string FilePath;
+};
+
+///
+/// \class MappedKinematicsCache
+/// Read only access to a kinematics cache file. The file is memory mapped, so
+/// that ranges of the columns can be read without loading the whole file, e.g.
+/// for the chunks of a ChunkedDataSet.
+///
+class MappedKinematicsCache {
+public:
+  /// Maps \p FilePath. The cache is invalid if the file does not exist, is
+  /// not a cache file or misses one of the variables with set flag in
+  /// \p UsedVariables. The key is not checked, see key().
+  MappedKinematicsCache(const std::string &FilePath,
+                        const std::vector<bool> &UsedVariables);
+  ~MappedKinematicsCache();
+
+  MappedKinematicsCache(const MappedKinematicsCache &) = delete;
+  MappedKinematicsCache &operator=(const MappedKinematicsCache &) = delete;
+
+  bool isValid() const { return nullptr != Header; }
+
+  uint64_t key() const { return Header->Key; }
+
+  size_t numberOfEvents() const { return Header->NumberOfEvents; }
+
+  /// Column of the variable with index \p i, nullptr if it is not stored.
+  const double *column(size_t i) const { return Columns[i]; }
+
+  const double *weights() const { return Weights; }
+
+private:
+  void *Data;
+  size_t FileSize;
+  const KinematicsCacheHeader *Header;
+  std::vector<const double *> Columns;
+  const double *Weights;
+};
+
+///
+/// \class KinematicsCacheWriter
+/// Writes the cache file of an event sample chunk by chunk, so that neither
+/// the events nor the kinematic variables have to be kept in memory. The key
+/// is calculated by close(), so the file of the events can be written at the
+/// same time. As KinematicsCache::write(), the writer only logs a warning if
+/// the file can't be written, since the cache is optional.
+///
+class KinematicsCacheWriter {
+public:
+  /// The sample of the file \p InputFilePath has \p NumberOfEvents events.
+  KinematicsCacheWriter(const std::string &FilePath,
+                        const std::string &InputFilePath,
+                        std::shared_ptr<ComPWA::Kinematics> Kinematics,
+                        size_t NumberOfEvents);
+
+  /// Removes the temporary file if close() was not called.
+  ~KinematicsCacheWriter();
+
+  KinematicsCacheWriter(const KinematicsCacheWriter &) = delete;
+  KinematicsCacheWriter &operator=(const KinematicsCacheWriter &) = delete;
+
+  /// Converts \p Events and appends their kinematic variables.
+  void write(const std::vector<Event> &Events);
+
+  /// Appends the kinematic variables \p Columns and \p Weights, which were
+  /// already converted from \p Events (e.g. for the evaluation of the model).
+  void write(const std::vector<Event> &Events,
+             const std::vector<std::vector<double>> &Columns,
+             const std::vector<double> &Weights);
+
+  /// Discards all events written so far.
+  void rewind();
+
+  /// Writes the header and moves the file into place atomically, if all
+  /// events were written. The file of the events has to be complete, since
+  /// the key is derived from it.
+  void close();
+
+private:
+  void fail(const std::string &Reason);
+
+  std::string FilePath;
+  std::string TemporaryFilePath;
+  std::string InputFilePath;
+  std::shared_ptr<ComPWA::Kinematics> Kinematics;
+  size_t NumberOfEvents;
+  size_t NumberOfWrittenEvents;
+  /// Flags of the stored columns, which are known after the first write()
+  std::vector<uint64_t> Flags;
+  int FileDescriptor;
+};
+
+} // namespace Data
+} // namespace ComPWA
+
+#endif
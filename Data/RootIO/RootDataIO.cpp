@@ -2,20 +2,26 @@
 // This file is part of the ComPWA framework, check
 // https://github.com/ComPWA/ComPWA/license.txt for details.
 
+#include <algorithm>
+
 // Root-Headers
 #include "RootDataIO.hpp"
 
+#include "TBranch.h"
 #include "TClonesArray.h"
 #include "TFile.h"
 #include "TLorentzVector.h"
 #include "TParticle.h"
 #include "TParticlePDG.h"
+#include "TROOT.h"
 #include "TTree.h"
 
+#include "Core/Concurrency.hpp"
 #include "Core/Generator.hpp"
 #include "Core/Kinematics.hpp"
 #include "Core/Logging.hpp"
 #include "Core/Properties.hpp"
+#include "Data/BinaryIO/BinaryDataIO.hpp"
 #include "Data/DataSet.hpp"
 
 namespace ComPWA {
@@ -139,5 +145,423 @@ void RootDataIO::writeData(std::shared_ptr<const DataSet> DataSample,
   File.Close();
 }
 
+RootFlatDataIO::RootFlatDataIO(const std::string TreeName_,
+                               int NumberEventsToProcess_)
+    : TreeName(TreeName_), NumberEventsToProcess(NumberEventsToProcess_) {}
+
+static std::string flatBranchName(unsigned int Particle,
+                                  const std::string &Variable) {
+  return "p" + std::to_string(Particle) + "_" + Variable;
+}
+
+/// Number of particles with flat branches in \p Tree
+static unsigned int numberOfFlatParticles(TTree *Tree) {
+  unsigned int NumberOfParticles(0);
+  while (Tree->GetBranch(flatBranchName(NumberOfParticles, "E").c_str()))
+    ++NumberOfParticles;
+  if (0 == NumberOfParticles)
+    throw std::runtime_error("numberOfFlatParticles() | Tree \"" +
+                             std::string(Tree->GetName()) +
+                             "\" contains no flat particle branches!");
+  return NumberOfParticles;
+}
+
+/// Enables only the flat particle branches and the weight branch of \p Tree
+/// and connects them to \p Buffers and \p Weight.
+static void setFlatBranchAddresses(TTree *Tree,
+                                   std::vector<FlatParticleBranches> &Buffers,
+                                   double &Weight) {
+  unsigned int NumberOfParticles(numberOfFlatParticles(Tree));
+
+  // only the used branches are read
+  Tree->SetBranchStatus("*", false);
+  Buffers.resize(NumberOfParticles);
+  auto setAddress = [&](const std::string &Name, void *Address) {
+    if (!Tree->GetBranch(Name.c_str()))
+      return;
+    Tree->SetBranchStatus(Name.c_str(), true);
+    Tree->SetBranchAddress(Name.c_str(), Address);
+  };
+  for (unsigned int i = 0; i < NumberOfParticles; ++i) {
+    Buffers[i].Pid = 0;
+    Buffers[i].Charge = 0;
+    setAddress(flatBranchName(i, "px"), &Buffers[i].Px);
+    setAddress(flatBranchName(i, "py"), &Buffers[i].Py);
+    setAddress(flatBranchName(i, "pz"), &Buffers[i].Pz);
+    setAddress(flatBranchName(i, "E"), &Buffers[i].E);
+    setAddress(flatBranchName(i, "pid"), &Buffers[i].Pid);
+    setAddress(flatBranchName(i, "charge"), &Buffers[i].Charge);
+  }
+  Weight = 1.0;
+  setAddress("weight", &Weight);
+}
+
+/// Creates the flat particle branches and the event level branches of \p Tree
+/// with the addresses \p Buffers and \p EventBuffer.
+static void createFlatBranches(TTree *Tree,
+                               std::vector<FlatParticleBranches> &Buffers,
+                               FlatEventBranches &EventBuffer) {
+  for (unsigned int i = 0; i < Buffers.size(); ++i) {
+    Tree->Branch(flatBranchName(i, "px").c_str(), &Buffers[i].Px,
+                 (flatBranchName(i, "px") + "/D").c_str());
+    Tree->Branch(flatBranchName(i, "py").c_str(), &Buffers[i].Py,
+                 (flatBranchName(i, "py") + "/D").c_str());
+    Tree->Branch(flatBranchName(i, "pz").c_str(), &Buffers[i].Pz,
+                 (flatBranchName(i, "pz") + "/D").c_str());
+    Tree->Branch(flatBranchName(i, "E").c_str(), &Buffers[i].E,
+                 (flatBranchName(i, "E") + "/D").c_str());
+    Tree->Branch(flatBranchName(i, "pid").c_str(), &Buffers[i].Pid,
+                 (flatBranchName(i, "pid") + "/I").c_str());
+    Tree->Branch(flatBranchName(i, "charge").c_str(), &Buffers[i].Charge,
+                 (flatBranchName(i, "charge") + "/I").c_str());
+  }
+  Tree->Branch("weight", &EventBuffer.Weight, "weight/D");
+  Tree->Branch("charge", &EventBuffer.Charge, "charge/I");
+  Tree->Branch("flavour", &EventBuffer.Flavour, "flavour/I");
+}
+
+/// Reads the entries [\p First, \p End) of the branch \p Name, whose address
+/// is \p Buffer, and passes each value to \p Store.
+template <typename T, typename StoreFunction>
+static void readFlatBranch(TTree *Tree, const std::string &Name,
+                           const T &Buffer, Long64_t First, Long64_t End,
+                           StoreFunction Store) {
+  TBranch *Branch(Tree->GetBranch(Name.c_str()));
+  if (!Branch)
+    return;
+  for (Long64_t i = First; i < End; ++i) {
+    Branch->GetEntry(i);
+    Store(i, Buffer);
+  }
+}
+
+/// Reads the entries [\p Begin, \p End) of the flat branches (connected to
+/// \p Buffers and \p Weight, see setFlatBranchAddresses()) directly into the
+/// columns \p Events, which start with the entry \p First. The branches are
+/// read one after the other within each cluster of the tree, so that the tree
+/// cache holds all baskets which are needed.
+static void readFlatClusters(TTree *Tree,
+                             const std::vector<FlatParticleBranches> &Buffers,
+                             const double &Weight, Long64_t First,
+                             Long64_t Begin, Long64_t End,
+                             PackedEvents &Events) {
+  unsigned int NumberOfParticles(Buffers.size());
+  auto Clusters = Tree->GetClusterIterator(Begin);
+  Long64_t ClusterBegin;
+  while ((ClusterBegin = Clusters()) < End) {
+    Long64_t CBegin(std::max<Long64_t>(ClusterBegin, Begin));
+    Long64_t CEnd(std::min(Clusters.GetNextEntry(), End));
+    for (unsigned int j = 0; j < NumberOfParticles; ++j) {
+      auto index = [&](Long64_t i) {
+        return (i - First) * NumberOfParticles + j;
+      };
+      readFlatBranch(Tree, flatBranchName(j, "px"), Buffers[j].Px, CBegin,
+                     CEnd, [&](Long64_t i, double x) {
+                       Events.Momenta[index(i)].Px = x;
+                     });
+      readFlatBranch(Tree, flatBranchName(j, "py"), Buffers[j].Py, CBegin,
+                     CEnd, [&](Long64_t i, double x) {
+                       Events.Momenta[index(i)].Py = x;
+                     });
+      readFlatBranch(Tree, flatBranchName(j, "pz"), Buffers[j].Pz, CBegin,
+                     CEnd, [&](Long64_t i, double x) {
+                       Events.Momenta[index(i)].Pz = x;
+                     });
+      readFlatBranch(Tree, flatBranchName(j, "E"), Buffers[j].E, CBegin, CEnd,
+                     [&](Long64_t i, double x) {
+                       Events.Momenta[index(i)].E = x;
+                     });
+      readFlatBranch(Tree, flatBranchName(j, "pid"), Buffers[j].Pid, CBegin,
+                     CEnd,
+                     [&](Long64_t i, int x) { Events.Pids[index(i)] = x; });
+      readFlatBranch(Tree, flatBranchName(j, "charge"), Buffers[j].Charge,
+                     CBegin, CEnd,
+                     [&](Long64_t i, int x) { Events.Charges[index(i)] = x; });
+    }
+    readFlatBranch(
+        Tree, "weight", Weight, CBegin, CEnd,
+        [&](Long64_t i, double x) { Events.Weights[i - First] = x; });
+  }
+}
+
+/// The tree \p TreeName of \p File.
+static TTree *getFlatTree(TFile &File, const std::string &InputFilePath,
+                          const std::string &TreeName) {
+  if (File.IsZombie())
+    throw std::runtime_error("RootFlatDataIO::readData() | "
+                             "Can't open data file: " +
+                             InputFilePath);
+
+  TTree *fTree = (TTree *)File.Get(TreeName.c_str());
+  if (!fTree)
+    throw std::runtime_error("RootFlatDataIO::readData() | Tree \"" +
+                             TreeName + "\" can not be opened from file " +
+                             InputFilePath + "! ");
+  return fTree;
+}
+
+/// Reads the entries [\p First, \p First + \p Number) of the flat tree
+/// \p TreeName (\p Tree in the file \p InputFilePath) into \p Events.
+///
+/// The clusters of the tree are distributed over the hardware threads. Each
+/// thread opens the file on its own and reads its clusters through its own
+/// tree cache, so that the baskets are read and decompressed in parallel.
+/// This requires ROOT::EnableThreadSafety(), but not ROOT's implicit
+/// multithreading, which is a process wide setting of the caller.
+static void readFlatBranches(const std::string &InputFilePath,
+                             const std::string &TreeName, TTree *Tree,
+                             unsigned int NumberOfParticles, size_t First,
+                             size_t Number, PackedEvents &Events) {
+  Events.NumberOfParticles = NumberOfParticles;
+  Events.Momenta.assign(Number * NumberOfParticles,
+                        FourVector(0.0, 0.0, 0.0, 0.0));
+  Events.Pids.assign(Number * NumberOfParticles, 0);
+  Events.Charges.assign(Number * NumberOfParticles, 0);
+  Events.Weights.assign(Number, 1.0);
+
+  Long64_t End(First + Number);
+  std::vector<Long64_t> ClusterBoundaries;
+  auto Clusters = Tree->GetClusterIterator(First);
+  Long64_t ClusterBegin;
+  while ((ClusterBegin = Clusters()) < End)
+    ClusterBoundaries.push_back(std::max<Long64_t>(ClusterBegin, First));
+  ClusterBoundaries.push_back(End);
+
+  ROOT::EnableThreadSafety();
+  runOnRanges(ClusterBoundaries.size() - 1, 1,
+              [&](size_t FirstCluster, size_t LastCluster) {
+                TFile File(InputFilePath.c_str());
+                TTree *ThreadTree = getFlatTree(File, InputFilePath, TreeName);
+                std::vector<FlatParticleBranches> Buffers;
+                double Weight;
+                setFlatBranchAddresses(ThreadTree, Buffers, Weight);
+                if (Buffers.size() != NumberOfParticles)
+                  throw std::runtime_error("readFlatBranches() | Number of "
+                                           "particles of " +
+                                           InputFilePath + " changed!");
+                // read the baskets of all branches in large blocks
+                Long64_t Begin(ClusterBoundaries[FirstCluster]);
+                Long64_t RangeEnd(ClusterBoundaries[LastCluster]);
+                ThreadTree->SetCacheSize(32 * 1024 * 1024);
+                ThreadTree->AddBranchToCache("*", true);
+                ThreadTree->SetCacheEntryRange(Begin, RangeEnd);
+                readFlatClusters(ThreadTree, Buffers, Weight, First, Begin,
+                                 RangeEnd, Events);
+                File.Close();
+              });
+}
+
+/// Creates the Events from the columns which were read by readFlatBranches().
+static std::vector<Event> createEvents(const PackedEvents &Events) {
+  std::vector<Event> Result(Events.size());
+  runOnRanges(Result.size(), 10000, [&](size_t Begin, size_t End) {
+    for (size_t i = Begin; i < End; ++i) {
+      Event &evt(Result[i]);
+      evt.ParticleList.reserve(Events.NumberOfParticles);
+      for (unsigned int j = 0; j < Events.NumberOfParticles; ++j) {
+        size_t k(i * Events.NumberOfParticles + j);
+        const FourVector &p(Events.Momenta[k]);
+        evt.ParticleList.push_back(Particle(p.Px, p.Py, p.Pz, p.E,
+                                            Events.Pids[k],
+                                            Events.Charges[k]));
+      }
+      evt.Weight = Events.Weights[i];
+    }
+  });
+  return Result;
+}
+
+/// Copies \p evt into the branch buffers.
+static void fillFlatBranches(const Event &evt,
+                             std::vector<FlatParticleBranches> &Buffers,
+                             FlatEventBranches &EventBuffer) {
+  EventBuffer.Charge = 0;
+  for (unsigned int i = 0; i < Buffers.size(); ++i) {
+    const Particle &x(evt.ParticleList[i]);
+    Buffers[i].Px = x.px();
+    Buffers[i].Py = x.py();
+    Buffers[i].Pz = x.pz();
+    Buffers[i].E = x.e();
+    Buffers[i].Pid = x.pid();
+    Buffers[i].Charge = x.charge();
+    EventBuffer.Charge += x.charge();
+  }
+  EventBuffer.Weight = evt.Weight;
+  // Event does not carry a flavour
+  EventBuffer.Flavour = 0;
+}
+
+/// Reads the events of the flat tree \p TreeName of \p InputFilePath (at
+/// most \p NumberEventsToProcess if it is positive) into \p Events.
+static void readFlatTree(const std::string &InputFilePath,
+                         const std::string &TreeName,
+                         int NumberEventsToProcess, PackedEvents &Events) {
+  TFile File(InputFilePath.c_str());
+  TTree *fTree = getFlatTree(File, InputFilePath, TreeName);
+
+  size_t NumberEventsToRead(NumberEventsToProcess);
+  if (NumberEventsToProcess <= 0 || NumberEventsToProcess > fTree->GetEntries())
+    NumberEventsToRead = fTree->GetEntries();
+
+  readFlatBranches(InputFilePath, TreeName, fTree,
+                   numberOfFlatParticles(fTree), 0, NumberEventsToRead, Events);
+  File.Close();
+}
+
+std::shared_ptr<DataSet>
+RootFlatDataIO::readData(const std::string &InputFilePath) const {
+  PackedEvents Events;
+  readFlatTree(InputFilePath, TreeName, NumberEventsToProcess, Events);
+  return std::make_shared<DataSet>(createEvents(Events));
+}
+
+std::shared_ptr<DataSet>
+RootFlatDataIO::readData(const std::string &InputFilePath,
+                         std::shared_ptr<ComPWA::Kinematics> Kinematics) const {
+  PackedEvents Events;
+  readFlatTree(InputFilePath, TreeName, NumberEventsToProcess, Events);
+
+  auto VariableNames = Kinematics->getKinematicVariableNames();
+  std::vector<std::vector<double>> Columns;
+  std::vector<double> Weights;
+  Kinematics->convert(Events, std::vector<bool>(VariableNames.size(), true),
+                      Columns, Weights);
+  return std::make_shared<DataSet>(std::move(Columns), std::move(Weights),
+                                   VariableNames);
+}
+
+void RootFlatDataIO::writeData(std::shared_ptr<const DataSet> DataSample,
+                               const std::string &OutputFilePath) const {
+  LOG(INFO) << "RootFlatDataIO::writeData(): writing current "
+               "vector of events to file "
+            << OutputFilePath;
+
+  auto const &Events = DataSample->getEventList();
+  if (0 == Events.size()) {
+    LOG(ERROR) << "RootFlatDataIO::writeData(): no events given!";
+    return;
+  }
+  unsigned int NumberOfParticles = Events[0].ParticleList.size();
+
+  TFile File(OutputFilePath.c_str(), "RECREATE");
+  if (File.IsZombie())
+    throw std::runtime_error(
+        "RootFlatDataIO::writeData(): can't open data file: " +
+        OutputFilePath);
+
+  TTree Tree(TreeName.c_str(), TreeName.c_str());
+  std::vector<FlatParticleBranches> Buffers(NumberOfParticles);
+  FlatEventBranches EventBuffer;
+  createFlatBranches(&Tree, Buffers, EventBuffer);
+
+  for (auto const &evt : Events) {
+    if (evt.ParticleList.size() != NumberOfParticles)
+      throw std::runtime_error("RootFlatDataIO::writeData(): all events need "
+                               "the same number of particles!");
+    fillFlatBranches(evt, Buffers, EventBuffer);
+    Tree.Fill();
+  }
+  Tree.Write("", TObject::kOverwrite, 0);
+  File.Close();
+}
+
+void convertRootToBinary(const std::string &InputFilePath,
+                         const std::string &OutputFilePath,
+                         const std::string &TreeName) {
+  auto DataSample = RootDataIO(TreeName).readData(InputFilePath);
+  BinaryDataIO().writeData(DataSample, OutputFilePath);
+}
+
+RootFlatEventChunkReader::RootFlatEventChunkReader(
+    const std::string &InputFilePath, const std::string &TreeName_)
+    : FilePath(InputFilePath), TreeName(TreeName_),
+      File(new TFile(InputFilePath.c_str())) {
+  if (File->IsZombie())
+    throw std::runtime_error("RootFlatEventChunkReader::"
+                             "RootFlatEventChunkReader() | Can't open data "
+                             "file: " +
+                             InputFilePath);
+  Tree = (TTree *)File->Get(TreeName.c_str());
+  if (!Tree)
+    throw std::runtime_error("RootFlatEventChunkReader::"
+                             "RootFlatEventChunkReader() | Tree \"" +
+                             TreeName + "\" can not be opened from file " +
+                             InputFilePath + "! ");
+  // the events are read by the threads of readEvents(), this tree only
+  // provides the number of events and particles and the clusters
+  NumberOfParticles = numberOfFlatParticles(Tree);
+}
+
+RootFlatEventChunkReader::~RootFlatEventChunkReader() = default;
+
+size_t RootFlatEventChunkReader::numberOfEvents() const {
+  return Tree->GetEntries();
+}
+
+std::vector<Event> RootFlatEventChunkReader::readEvents(size_t First,
+                                                        size_t Number) const {
+  if (First + Number > numberOfEvents())
+    throw std::out_of_range("RootFlatEventChunkReader::readEvents(): events "
+                            "out of range!");
+  PackedEvents Events;
+  readFlatBranches(FilePath, TreeName, Tree, NumberOfParticles, First, Number,
+                   Events);
+  return createEvents(Events);
+}
+
+RootFlatEventChunkWriter::RootFlatEventChunkWriter(
+    const std::string &OutputFilePath, const std::string &TreeName_)
+    : FilePath(OutputFilePath), TreeName(TreeName_),
+      File(new TFile(OutputFilePath.c_str(), "RECREATE")), Tree(nullptr) {
+  if (File->IsZombie())
+    throw std::runtime_error("RootFlatEventChunkWriter::"
+                             "RootFlatEventChunkWriter() | Can't open data "
+                             "file: " +
+                             OutputFilePath);
+}
+
+RootFlatEventChunkWriter::~RootFlatEventChunkWriter() = default;
+
+void RootFlatEventChunkWriter::writeEvents(const std::vector<Event> &Events) {
+  if (!File)
+    throw std::runtime_error("RootFlatEventChunkWriter::writeEvents(): " +
+                             FilePath + " is already closed!");
+  if (Events.empty())
+    return;
+  // the branches are created with the number of particles of the first chunk
+  if (!Tree) {
+    File->cd();
+    Tree = new TTree(TreeName.c_str(), TreeName.c_str());
+    Buffers.resize(Events.front().ParticleList.size());
+    createFlatBranches(Tree, Buffers, EventBuffer);
+  }
+  for (auto const &evt : Events) {
+    if (evt.ParticleList.size() != Buffers.size())
+      throw std::runtime_error("RootFlatEventChunkWriter::writeEvents(): all "
+                               "events need the same number of particles!");
+    fillFlatBranches(evt, Buffers, EventBuffer);
+    Tree->Fill();
+  }
+}
+
+void RootFlatEventChunkWriter::rewind() {
+  if (!Tree)
+    return;
+  // remove the baskets and the cycles of the tree which were already saved
+  Tree->Reset();
+  File->Delete((TreeName + ";*").c_str());
+}
+
+void RootFlatEventChunkWriter::close() {
+  if (!File)
+    return;
+  if (Tree)
+    Tree->Write("", TObject::kOverwrite, 0);
+  File->Close();
+  // the tree is owned by the file
+  Tree = nullptr;
+  File.reset();
+}
+
 } // namespace Data
 } // namespace ComPWA
@@ -7,10 +7,15 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
+#include "Data/ChunkedDataSet.hpp"
+
+class TFile;
 class TTree;
 
 namespace ComPWA {
+class Kinematics;
 namespace Data {
 
 class DataSet;
@@ -35,6 +40,124 @@ public:
                  const std::string &OutputFilePath) const;
 };
 
+///
+/// \class RootFlatDataIO
+/// Class for reading/writing Physics Events from/to ROOT files with flat
+/// numeric branches. For each final state particle i the branches
+/// pi_px, pi_py, pi_pz, pi_E (double) and pi_pid, pi_charge (int) are used.
+/// The event level branches are the weight (double) and, as in RootDataIO,
+/// charge and flavour (int). The event charge is the sum of the particle
+/// charges. Event does not carry a flavour, it is written as 0. The event
+/// level charge and flavour are not read.
+///
+/// In contrast to RootDataIO no TParticle objects are created. The clusters
+/// of the tree are read in parallel: each thread opens the file on its own
+/// and reads the branches of its clusters one after the other through its
+/// own tree cache directly into the momentum columns. This calls
+/// ROOT::EnableThreadSafety(). ROOT's implicit multithreading is not touched,
+/// since it is a process wide setting of the caller.
+///
+class RootFlatDataIO {
+  std::string TreeName;
+  int NumberEventsToProcess;
+
+public:
+  /// \param TreeName_	Name of tree in input or output file
+  /// \param NumberEventsToProcess_	-1 processes all events
+  RootFlatDataIO(const std::string TreeName_ = "data",
+                 int NumberEventsToProcess_ = -1);
+
+  std::shared_ptr<DataSet> readData(const std::string &InputFilePath) const;
+
+  /// Reads the events of \p InputFilePath and converts them directly into the
+  /// kinematic variables of \p Kinematics. No Events are created.
+  std::shared_ptr<DataSet>
+  readData(const std::string &InputFilePath,
+           std::shared_ptr<ComPWA::Kinematics> Kinematics) const;
+
+  void writeData(std::shared_ptr<const DataSet> DataSample,
+                 const std::string &OutputFilePath) const;
+};
+
+/// Branch buffers of a single particle of the flat tree format
+struct FlatParticleBranches {
+  double Px, Py, Pz, E;
+  int Pid, Charge;
+};
+
+/// Event level branch buffers of the flat tree format
+struct FlatEventBranches {
+  double Weight;
+  int Charge, Flavour;
+};
+
+///
+/// \class RootFlatEventChunkReader
+/// Reads chunks of events from a ROOT file with flat numeric branches (see
+/// RootFlatDataIO), e.g. for a ChunkedDataSet. The file stays open as long as
+/// the reader exists. The clusters of each chunk are read in parallel like in
+/// RootFlatDataIO::readData().
+///
+class RootFlatEventChunkReader : public EventChunkReader {
+public:
+  RootFlatEventChunkReader(const std::string &InputFilePath,
+                           const std::string &TreeName_ = "data");
+  ~RootFlatEventChunkReader();
+
+  size_t numberOfEvents() const final;
+
+  unsigned int numberOfParticles() const final { return NumberOfParticles; }
+
+  std::vector<Event> readEvents(size_t First, size_t Number) const final;
+
+  std::string filePath() const final { return FilePath; }
+
+private:
+  std::string FilePath;
+  std::string TreeName;
+  std::unique_ptr<TFile> File;
+  TTree *Tree;
+  unsigned int NumberOfParticles;
+};
+
+///
+/// \class RootFlatEventChunkWriter
+/// Writes events chunk by chunk to a ROOT file with flat numeric branches (see
+/// RootFlatDataIO), e.g. for the streaming Tools::generate(). The baskets of
+/// the tree are written to the file when they are full, so only the current
+/// baskets are kept in memory.
+///
+class RootFlatEventChunkWriter : public EventChunkWriter {
+public:
+  RootFlatEventChunkWriter(const std::string &OutputFilePath,
+                           const std::string &TreeName = "data");
+  ~RootFlatEventChunkWriter();
+
+  using EventChunkWriter::writeEvents;
+
+  void writeEvents(const std::vector<Event> &Events) final;
+
+  void rewind() final;
+
+  void close() final;
+
+private:
+  std::string FilePath;
+  std::string TreeName;
+  std::unique_ptr<TFile> File;
+  /// The tree is created with the first chunk, when the number of particles
+  /// is known
+  TTree *Tree;
+  std::vector<FlatParticleBranches> Buffers;
+  FlatEventBranches EventBuffer;
+};
+
+/// Converts the events of the tree \p TreeName in the ROOT file
+/// \p InputFilePath to the native binary format (see BinaryDataIO).
+void convertRootToBinary(const std::string &InputFilePath,
+                         const std::string &OutputFilePath,
+                         const std::string &TreeName = "data");
+
 } // namespace Data
 } // namespace ComPWA
 
@@ -9,6 +9,9 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include "TFile.h"
+#include "TTree.h"
+
 #include "Data/DataSet.hpp"
 #include "Data/RootIO/RootDataIO.hpp"
 #include "Tools/Generate.hpp"
@@ -40,6 +43,111 @@ BOOST_AUTO_TEST_CASE(SimpleWriteReadCheck) {
   std::remove("RootReaderTest-output.root"); // delete file
 }
 
+BOOST_AUTO_TEST_CASE(FlatBranchWriteReadCheck) {
+  ComPWA::Logging log("", "trace");
+
+  std::vector<double> FSMasses = {0.5, 0.5, 0.5};
+  std::shared_ptr<ComPWA::Generator> gen(
+      new ComPWA::Tools::RootGenerator(1.864, FSMasses, 305896));
+
+  std::shared_ptr<DataSet> sample(ComPWA::Tools::generatePhsp(200, gen));
+
+  RootFlatDataIO RootIO("trtr");
+  RootIO.writeData(sample, "RootFlatReaderTest-output.root");
+
+  std::shared_ptr<DataSet> sampleIn(
+      RootIO.readData("RootFlatReaderTest-output.root"));
+  BOOST_REQUIRE_EQUAL(sample->getEventList().size(),
+                      sampleIn->getEventList().size());
+  for (size_t i = 0; i < sample->getEventList().size(); ++i) {
+    auto const &evt = sample->getEventList()[i];
+    auto const &evtIn = sampleIn->getEventList()[i];
+    BOOST_CHECK_EQUAL(evt.Weight, evtIn.Weight);
+    BOOST_REQUIRE_EQUAL(evt.ParticleList.size(), evtIn.ParticleList.size());
+    for (size_t j = 0; j < evt.ParticleList.size(); ++j)
+      BOOST_CHECK(evt.ParticleList[j].fourMomentum() ==
+                  evtIn.ParticleList[j].fourMomentum());
+  }
+
+  std::remove("RootFlatReaderTest-output.root"); // delete file
+}
+
+BOOST_AUTO_TEST_CASE(FlatBranchParallelReadCheck) {
+  ComPWA::Logging log("", "trace");
+
+  std::vector<double> FSMasses = {0.5, 0.5, 0.5};
+  std::shared_ptr<ComPWA::Generator> gen(
+      new ComPWA::Tools::RootGenerator(1.864, FSMasses, 305896));
+  auto Events = ComPWA::Tools::generatePhsp(20000, gen)->getEventList();
+
+  // a tree with many clusters, which are read by different threads
+  {
+    TFile File("RootFlatReaderTest-clusters.root", "RECREATE");
+    TTree Tree("data", "data");
+    Tree.SetAutoFlush(1000);
+    std::vector<FlatParticleBranches> Buffers(3);
+    FlatEventBranches EventBuffer;
+    for (unsigned int i = 0; i < 3; ++i) {
+      std::string Prefix("p" + std::to_string(i) + "_");
+      Tree.Branch((Prefix + "px").c_str(), &Buffers[i].Px,
+                  (Prefix + "px/D").c_str());
+      Tree.Branch((Prefix + "py").c_str(), &Buffers[i].Py,
+                  (Prefix + "py/D").c_str());
+      Tree.Branch((Prefix + "pz").c_str(), &Buffers[i].Pz,
+                  (Prefix + "pz/D").c_str());
+      Tree.Branch((Prefix + "E").c_str(), &Buffers[i].E,
+                  (Prefix + "E/D").c_str());
+      Tree.Branch((Prefix + "pid").c_str(), &Buffers[i].Pid,
+                  (Prefix + "pid/I").c_str());
+    }
+    Tree.Branch("weight", &EventBuffer.Weight, "weight/D");
+    for (size_t k = 0; k < Events.size(); ++k) {
+      for (unsigned int i = 0; i < 3; ++i) {
+        auto const &x = Events[k].ParticleList[i];
+        Buffers[i].Px = x.px();
+        Buffers[i].Py = x.py();
+        Buffers[i].Pz = x.pz();
+        Buffers[i].E = x.e();
+        Buffers[i].Pid = (int)(211 * i + k % 7);
+      }
+      EventBuffer.Weight = 1.0 + k;
+      Tree.Fill();
+    }
+    Tree.Write("", TObject::kOverwrite, 0);
+    File.Close();
+  }
+
+  auto checkEvents = [&](const std::vector<Event> &EventsIn, size_t First) {
+    for (size_t k = 0; k < EventsIn.size(); ++k) {
+      auto const &evt = Events[First + k];
+      BOOST_REQUIRE_EQUAL(EventsIn[k].ParticleList.size(), 3);
+      BOOST_CHECK_EQUAL(EventsIn[k].Weight, 1.0 + First + k);
+      for (unsigned int i = 0; i < 3; ++i) {
+        BOOST_CHECK(EventsIn[k].ParticleList[i].fourMomentum() ==
+                    evt.ParticleList[i].fourMomentum());
+        BOOST_CHECK_EQUAL(EventsIn[k].ParticleList[i].pid(),
+                          (int)(211 * i + (First + k) % 7));
+        // missing branches are read as 0
+        BOOST_CHECK_EQUAL(EventsIn[k].ParticleList[i].charge(), 0);
+      }
+    }
+  };
+
+  auto sampleIn = RootFlatDataIO().readData("RootFlatReaderTest-clusters.root");
+  BOOST_REQUIRE_EQUAL(sampleIn->getEventList().size(), Events.size());
+  checkEvents(sampleIn->getEventList(), 0);
+
+  // a chunk which starts and ends within a cluster
+  RootFlatEventChunkReader Reader("RootFlatReaderTest-clusters.root");
+  BOOST_CHECK_EQUAL(Reader.numberOfEvents(), Events.size());
+  BOOST_CHECK_EQUAL(Reader.numberOfParticles(), 3);
+  auto Chunk = Reader.readEvents(1500, 5321);
+  BOOST_REQUIRE_EQUAL(Chunk.size(), 5321);
+  checkEvents(Chunk, 1500);
+
+  std::remove("RootFlatReaderTest-clusters.root");
+}
+
 BOOST_AUTO_TEST_SUITE_END();
 
 } // namespace Data
@@ -0,0 +1,217 @@
+// Copyright (c) 2013, 2017 The ComPWA Team.
+// This file is part of the ComPWA framework, check
+// https://github.com/ComPWA/ComPWA/license.txt for details.
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+
+#include "Core/Intensity.hpp"
+#include "Core/Logging.hpp"
+#include "Data/DataSet.hpp"
+#include "Data/SampleReduction.hpp"
+
+namespace ComPWA {
+namespace Data {
+
+/// Recursively divides the events \p Indices into \p NumberOfCells cells of
+/// equal population and appends them to \p Cells.
+static void createCells(std::vector<size_t> Indices, size_t NumberOfCells,
+                 const std::vector<DataPoint> &Sample,
+                 const std::vector<size_t> &Variables,
+                 const std::vector<double> &VariableRanges,
+                 std::vector<std::vector<size_t>> &Cells) {
+  if (NumberOfCells <= 1 || Indices.size() <= 1) {
+    Cells.push_back(std::move(Indices));
+    return;
+  }
+
+  size_t SplitVariable(Variables.front());
+  double LargestSpread(-1.0);
+  for (size_t i = 0; i < Variables.size(); ++i) {
+    auto var = Variables[i];
+    auto MinMax = std::minmax_element(
+        Indices.begin(), Indices.end(), [&Sample, var](size_t a, size_t b) {
+          return Sample[a].KinematicVariableList[var] <
+                 Sample[b].KinematicVariableList[var];
+        });
+    double Spread((Sample[*MinMax.second].KinematicVariableList[var] -
+                   Sample[*MinMax.first].KinematicVariableList[var]) /
+                  VariableRanges[i]);
+    if (Spread > LargestSpread) {
+      LargestSpread = Spread;
+      SplitVariable = var;
+    }
+  }
+
+  // split such that the cells of both parts have the same population
+  size_t LeftCells(NumberOfCells / 2);
+  auto Split = Indices.begin() + Indices.size() * LeftCells / NumberOfCells;
+  std::nth_element(Indices.begin(), Split, Indices.end(),
+                   [&Sample, SplitVariable](size_t a, size_t b) {
+                     return Sample[a].KinematicVariableList[SplitVariable] <
+                            Sample[b].KinematicVariableList[SplitVariable];
+                   });
+  createCells(std::vector<size_t>(Indices.begin(), Split), LeftCells, Sample,
+              Variables, VariableRanges, Cells);
+  createCells(std::vector<size_t>(Split, Indices.end()),
+              NumberOfCells - LeftCells, Sample, Variables, VariableRanges,
+              Cells);
+}
+
+/// Divides \p Sample into \p NumberOfCells cells of equal population.
+static std::vector<std::vector<size_t>>
+createCells(const std::vector<DataPoint> &Sample, size_t NumberOfCells,
+            std::vector<size_t> Variables) {
+  if (0 == Sample.size())
+    throw std::runtime_error("Data::createCells(): sample is empty!");
+  if (0 == NumberOfCells)
+    throw std::runtime_error("Data::createCells(): number of cells is zero!");
+
+  size_t NumberOfVariables(Sample.front().KinematicVariableList.size());
+  if (Variables.empty()) {
+    Variables.resize(NumberOfVariables);
+    std::iota(Variables.begin(), Variables.end(), 0);
+  }
+  std::vector<double> VariableRanges;
+  for (auto var : Variables) {
+    if (var >= NumberOfVariables)
+      throw std::runtime_error("Data::createCells(): variable index " +
+                               std::to_string(var) + " is out of range!");
+    auto MinMax = std::minmax_element(
+        Sample.begin(), Sample.end(),
+        [var](const DataPoint &a, const DataPoint &b) {
+          return a.KinematicVariableList[var] < b.KinematicVariableList[var];
+        });
+    double Range(MinMax.second->KinematicVariableList[var] -
+                 MinMax.first->KinematicVariableList[var]);
+    VariableRanges.push_back(Range > 0.0 ? Range : 1.0);
+  }
+
+  std::vector<size_t> Indices(Sample.size());
+  std::iota(Indices.begin(), Indices.end(), 0);
+  std::vector<std::vector<size_t>> Cells;
+  Cells.reserve(std::min(NumberOfCells, Sample.size()));
+  createCells(std::move(Indices), NumberOfCells, Sample, Variables,
+              VariableRanges, Cells);
+  return Cells;
+}
+
+std::shared_ptr<DataSet> reduceSample(const std::vector<DataPoint> &Sample,
+                                      size_t NumberOfCells,
+                                      std::vector<size_t> Variables,
+                                      unsigned int Seed) {
+  if (NumberOfCells >= Sample.size()) {
+    LOG(INFO) << "Data::reduceSample(): sample has less than " << NumberOfCells
+              << " events. Nothing to reduce!";
+    return std::make_shared<DataSet>(Sample);
+  }
+  auto Cells = createCells(Sample, NumberOfCells, Variables);
+
+  std::mt19937 Generator(Seed);
+  std::uniform_real_distribution<double> Uniform(0.0, 1.0);
+
+  std::vector<DataPoint> ReducedSample;
+  ReducedSample.reserve(Cells.size());
+  for (auto const &Cell : Cells) {
+    double WeightSum(0.0);
+    for (auto i : Cell)
+      WeightSum += Sample[i].Weight;
+
+    // choose the representative proportional to its weight
+    double Threshold(Uniform(Generator) * WeightSum);
+    size_t Representative(Cell.back());
+    double CumulativeWeight(0.0);
+    for (auto i : Cell) {
+      CumulativeWeight += Sample[i].Weight;
+      if (CumulativeWeight > Threshold) {
+        Representative = i;
+        break;
+      }
+    }
+    DataPoint Point(Sample[Representative]);
+    Point.Weight = WeightSum;
+    ReducedSample.push_back(Point);
+  }
+
+  LOG(INFO) << "Data::reduceSample(): reduced sample from " << Sample.size()
+            << " to " << ReducedSample.size() << " events.";
+  return std::make_shared<DataSet>(ReducedSample);
+}
+
+/// Intensities of all events in \p Sample
+static std::vector<double>
+evaluateIntensity(std::shared_ptr<const ComPWA::Intensity> Intensity,
+                  const std::vector<DataPoint> &Sample) {
+  std::vector<double> Values;
+  Values.reserve(Sample.size());
+  for (auto const &Point : Sample)
+    Values.push_back(Intensity->evaluate(Point));
+  return Values;
+}
+
+/// Relative reduction error of the integral over \p Sample with the
+/// intensities \p Values.
+static double reductionError(const std::vector<DataPoint> &Sample,
+                             const std::vector<double> &Values,
+                             size_t NumberOfCells,
+                             const std::vector<size_t> &Variables) {
+  if (NumberOfCells >= Sample.size())
+    return 0.0;
+  auto Cells = createCells(Sample, NumberOfCells, Variables);
+
+  // The reduced integral is sum_c W_c f(x_c) with x_c drawn with probability
+  // w_i / W_c. Its variance per cell is W_c sum_i w_i f_i^2 - (sum_i w_i f_i)^2
+  double Integral(0.0);
+  double Variance(0.0);
+  for (auto const &Cell : Cells) {
+    double WeightSum(0.0);
+    double Sum(0.0);
+    double SquaredSum(0.0);
+    for (auto i : Cell) {
+      WeightSum += Sample[i].Weight;
+      Sum += Sample[i].Weight * Values[i];
+      SquaredSum += Sample[i].Weight * Values[i] * Values[i];
+    }
+    Integral += Sum;
+    Variance += std::max(0.0, WeightSum * SquaredSum - Sum * Sum);
+  }
+  if (0.0 == Integral)
+    return 0.0;
+  return std::sqrt(Variance) / std::abs(Integral);
+}
+
+double estimateReductionError(std::shared_ptr<const ComPWA::Intensity> Intensity,
+                              const std::vector<DataPoint> &Sample,
+                              size_t NumberOfCells,
+                              std::vector<size_t> Variables) {
+  if (NumberOfCells >= Sample.size())
+    return 0.0;
+  return reductionError(Sample, evaluateIntensity(Intensity, Sample),
+                        NumberOfCells, Variables);
+}
+
+std::shared_ptr<DataSet>
+reduceSample(std::shared_ptr<const ComPWA::Intensity> Intensity,
+             const std::vector<DataPoint> &Sample, double RelativePrecision,
+             std::vector<size_t> Variables, size_t InitialNumberOfCells,
+             unsigned int Seed) {
+  size_t NumberOfCells(std::max<size_t>(1, InitialNumberOfCells));
+  // the intensities are evaluated only once for all numbers of cells
+  std::vector<double> Values;
+  if (NumberOfCells < Sample.size())
+    Values = evaluateIntensity(Intensity, Sample);
+  while (NumberOfCells < Sample.size()) {
+    double Error(reductionError(Sample, Values, NumberOfCells, Variables));
+    LOG(INFO) << "Data::reduceSample(): relative integration error with "
+              << NumberOfCells << " cells: " << Error;
+    if (Error < RelativePrecision)
+      break;
+    NumberOfCells *= 2;
+  }
+  return reduceSample(Sample, NumberOfCells, Variables, Seed);
+}
+
+} // namespace Data
+} // namespace ComPWA
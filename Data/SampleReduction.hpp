@@ -0,0 +1,66 @@
+// Copyright (c) 2013, 2017 The ComPWA Team.
+// This file is part of the ComPWA framework, check
+// https://github.com/ComPWA/ComPWA/license.txt for details.
+
+#ifndef DATA_SAMPLEREDUCTION_HPP_
+#define DATA_SAMPLEREDUCTION_HPP_
+
+#include <memory>
+#include <vector>
+
+#include "Core/Event.hpp"
+
+namespace ComPWA {
+class Intensity;
+namespace Data {
+
+class DataSet;
+
+///
+/// Reduction of large (phase space) samples to smaller weighted samples,
+/// which are used for the integration of intensities.
+///
+/// The sample is divided into \p NumberOfCells cells of equal population in
+/// the kinematic variables \p Variables (indices of
+/// DataPoint::KinematicVariableList, all variables by default). The cells are
+/// created by recursive median splits along the variable with the largest
+/// relative spread. All events of a cell are merged into a single event,
+/// which carries the summed weight of the cell. The kinematics of that event
+/// is taken from a cell member chosen randomly with a probability proportional
+/// to its weight, so that the integral over the reduced sample is an unbiased
+/// estimate of the integral over the full sample and all events stay within
+/// the phase space.
+///
+/// The returned DataSet can be used directly in Tools::MCIntegrationStrategy
+/// or Estimator::createMinLogLHEstimatorFunctionTree. Note that it only
+/// contains DataPoints and no Events.
+///
+std::shared_ptr<DataSet> reduceSample(const std::vector<DataPoint> &Sample,
+                                      size_t NumberOfCells,
+                                      std::vector<size_t> Variables = {},
+                                      unsigned int Seed = 1234);
+
+/// Estimates the relative standard deviation of the integral of \p Intensity
+/// due to the reduction of \p Sample to \p NumberOfCells events (in addition
+/// to the statistical uncertainty of \p Sample itself).
+/// \see reduceSample()
+double estimateReductionError(std::shared_ptr<const ComPWA::Intensity> Intensity,
+                              const std::vector<DataPoint> &Sample,
+                              size_t NumberOfCells,
+                              std::vector<size_t> Variables = {});
+
+/// Reduces \p Sample to the smallest number of cells (doubling from
+/// \p InitialNumberOfCells) for which the relative reduction error of the
+/// integral of \p Intensity is below \p RelativePrecision. The intensity is
+/// evaluated once for each event of \p Sample.
+/// \see reduceSample(), estimateReductionError()
+std::shared_ptr<DataSet>
+reduceSample(std::shared_ptr<const ComPWA::Intensity> Intensity,
+             const std::vector<DataPoint> &Sample, double RelativePrecision,
+             std::vector<size_t> Variables = {},
+             size_t InitialNumberOfCells = 1000, unsigned int Seed = 1234);
+
+} // namespace Data
+} // namespace ComPWA
+
+#endif
@@ -0,0 +1,171 @@
+// Copyright (c) 2013, 2017 The ComPWA Team.
+// This file is part of the ComPWA framework, check
+// https://github.com/ComPWA/ComPWA/license.txt for details.
+
+#define BOOST_TEST_MODULE Data_KinematicsCacheTest
+
+#include <cstdio>
+#include <fstream>
+
+#include <boost/test/unit_test.hpp>
+
+#include "Core/Kinematics.hpp"
+#include "Core/Logging.hpp"
+#include "Data/DataSet.hpp"
+#include "Data/KinematicsCache.hpp"
+
+BOOST_AUTO_TEST_SUITE(Data_KinematicsCacheTest)
+
+/// Kinematics which uses the energies of the particles, scaled by a factor,
+/// as variables. The factor is part of the configuration. It counts the
+/// converted events.
+class ScaledEnergyKinematics : public ComPWA::Kinematics {
+public:
+  ScaledEnergyKinematics(double Scale_, std::vector<std::string> Names_)
+      : Scale(Scale_), Names(Names_), Conversions(0) {}
+
+  using ComPWA::Kinematics::convert;
+
+  ComPWA::DataPoint convert(const ComPWA::Event &event) const {
+    ++Conversions;
+    ComPWA::DataPoint point;
+    for (auto const &x : event.ParticleList)
+      point.KinematicVariableList.push_back(Scale * x.e());
+    point.Weight = event.Weight;
+    return point;
+  }
+  std::vector<std::string> getKinematicVariableNames() const { return Names; }
+  std::string configuration() const { return std::to_string(Scale); }
+  bool isWithinPhaseSpace(const ComPWA::DataPoint &) const { return true; }
+  double phspVolume() const { return 1.0; }
+
+  double Scale;
+  std::vector<std::string> Names;
+  mutable size_t Conversions;
+};
+
+std::vector<ComPWA::Event> createEvents(size_t NumberOfEvents) {
+  std::vector<ComPWA::Event> Events;
+  for (size_t i = 0; i < NumberOfEvents; ++i) {
+    ComPWA::Event evt;
+    for (int j = 0; j < 2; ++j)
+      evt.ParticleList.push_back(ComPWA::Particle(0.1, 0.2, 0.3, 1.0 + i + j));
+    evt.Weight = 0.5 + 0.01 * i;
+    Events.push_back(evt);
+  }
+  return Events;
+}
+
+/// Writes the energies of \p Events to \p FilePath. The cache is keyed on the
+/// file from which the events are read.
+void writeEvents(const std::vector<ComPWA::Event> &Events,
+                 const std::string &FilePath) {
+  std::ofstream File(FilePath, std::ios::trunc);
+  for (auto const &evt : Events) {
+    for (auto const &x : evt.ParticleList)
+      File << std::to_string(x.e()) << " ";
+    File << "\n";
+  }
+}
+
+/// Converts \p Events, which were read from "KinematicsCacheTest.txt", with
+/// the cache and checks the values against Kinematics::convert(). Returns the
+/// number of converted events.
+size_t convertWithCache(const std::vector<ComPWA::Event> &Events,
+                        std::shared_ptr<ScaledEnergyKinematics> Kin) {
+  size_t Conversions(Kin->Conversions);
+  ComPWA::Data::DataSet Sample(Events);
+  Sample.convertEventsToParameterList(Kin, "KinematicsCacheTest.txt");
+  Conversions = Kin->Conversions - Conversions;
+
+  auto const &Columns = Sample.getParameterList().mDoubleValues();
+  BOOST_REQUIRE_EQUAL(Columns.size(), 3);
+  for (size_t i = 0; i < Events.size(); ++i) {
+    auto Point = Kin->convert(Events[i]);
+    for (size_t j = 0; j < 2; ++j)
+      BOOST_CHECK_EQUAL(Columns[j]->values()[i],
+                        Point.KinematicVariableList[j]);
+    BOOST_CHECK_EQUAL(Columns[2]->values()[i], Events[i].Weight);
+  }
+  Kin->Conversions -= Events.size();
+  return Conversions;
+}
+
+BOOST_AUTO_TEST_CASE(HitAndMissCheck) {
+  ComPWA::Logging log("output.log", "INFO");
+  std::string CacheFilePath(
+      ComPWA::Data::KinematicsCache::defaultFilePath("KinematicsCacheTest.txt"));
+  std::remove(CacheFilePath.c_str());
+
+  auto Events = createEvents(100);
+  writeEvents(Events, "KinematicsCacheTest.txt");
+  auto Kin = std::make_shared<ScaledEnergyKinematics>(
+      2.0, std::vector<std::string>{"E0", "E1"});
+
+  // the first conversion writes the cache, the second one reads it
+  BOOST_CHECK_EQUAL(convertWithCache(Events, Kin), 100);
+  BOOST_CHECK_EQUAL(convertWithCache(Events, Kin), 0);
+
+  // changed configuration
+  Kin->Scale = 3.0;
+  BOOST_CHECK_EQUAL(convertWithCache(Events, Kin), 100);
+  BOOST_CHECK_EQUAL(convertWithCache(Events, Kin), 0);
+
+  // changed variable names
+  Kin->Names = {"E0", "E2"};
+  BOOST_CHECK_EQUAL(convertWithCache(Events, Kin), 100);
+  BOOST_CHECK_EQUAL(convertWithCache(Events, Kin), 0);
+
+  // changed events
+  Events[50].ParticleList[1].e(7.0);
+  writeEvents(Events, "KinematicsCacheTest.txt");
+  BOOST_CHECK_EQUAL(convertWithCache(Events, Kin), 100);
+  BOOST_CHECK_EQUAL(convertWithCache(Events, Kin), 0);
+
+  // without an input file nothing is cached
+  size_t Conversions(Kin->Conversions);
+  ComPWA::Data::DataSet Sample(Events);
+  Sample.convertEventsToParameterList(Kin, "KinematicsCacheTest-missing.txt");
+  BOOST_CHECK_EQUAL(Kin->Conversions - Conversions, 100);
+  BOOST_CHECK(!std::ifstream(ComPWA::Data::KinematicsCache::defaultFilePath(
+      "KinematicsCacheTest-missing.txt")));
+
+  std::remove(CacheFilePath.c_str());
+  std::remove("KinematicsCacheTest.txt");
+}
+
+BOOST_AUTO_TEST_CASE(MissingVariablesCheck) {
+  ComPWA::Logging log("output.log", "INFO");
+  auto Events = createEvents(10);
+  writeEvents(Events, "KinematicsCacheTest-partial.txt");
+  auto Kin = std::make_shared<ScaledEnergyKinematics>(
+      2.0, std::vector<std::string>{"E0", "E1"});
+  ComPWA::Data::KinematicsCache Cache("KinematicsCacheTest-partial.kinematics");
+  uint64_t Key(
+      ComPWA::Data::KinematicsCache::key("KinematicsCacheTest-partial.txt", *Kin));
+  BOOST_REQUIRE(Key);
+
+  // only the first variable is stored
+  std::vector<std::vector<double>> Columns;
+  std::vector<double> Weights;
+  Kin->convert(Events, {true, false}, Columns, Weights);
+  Cache.write(Key, Columns, Weights);
+
+  BOOST_CHECK(Cache.read(Key, {true, false}, Columns, Weights));
+  BOOST_CHECK_EQUAL(Columns[0].size(), 10);
+  BOOST_CHECK_EQUAL(Columns[1].size(), 0);
+  BOOST_CHECK(!Cache.read(Key, {true, true}, Columns, Weights));
+  BOOST_CHECK(!Cache.read(Key + 1, {true, false}, Columns, Weights));
+
+  // only the requested variables are read
+  Kin->convert(Events, Columns, Weights);
+  Cache.write(Key, Columns, Weights);
+  BOOST_CHECK(Cache.read(Key, {false, true}, Columns, Weights));
+  BOOST_CHECK_EQUAL(Columns[0].size(), 0);
+  BOOST_CHECK_EQUAL(Columns[1].size(), 10);
+
+  std::remove("KinematicsCacheTest-partial.kinematics");
+  std::remove("KinematicsCacheTest-partial.txt");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
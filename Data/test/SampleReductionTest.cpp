@@ -0,0 +1,115 @@
+// Copyright (c) 2013, 2017 The ComPWA Team.
+// This file is part of the ComPWA framework, check
+// https://github.com/ComPWA/ComPWA/license.txt for details.
+
+#define BOOST_TEST_MODULE Data_SampleReductionTest
+
+#include <cmath>
+#include <random>
+
+#include <boost/test/unit_test.hpp>
+
+#include "Core/Intensity.hpp"
+#include "Core/Logging.hpp"
+#include "Data/DataSet.hpp"
+#include "Data/SampleReduction.hpp"
+
+BOOST_AUTO_TEST_SUITE(Data_SampleReductionTest)
+
+/// Intensity 1 + x^2 + y^2, which counts its evaluations
+class QuadraticIntensity : public ComPWA::Intensity {
+public:
+  QuadraticIntensity() : NumberOfEvaluations(0) {}
+
+  double evaluate(const ComPWA::DataPoint &point) const {
+    ++NumberOfEvaluations;
+    return 1.0 + std::pow(point.KinematicVariableList[0], 2) +
+           std::pow(point.KinematicVariableList[1], 2);
+  }
+
+  std::shared_ptr<ComPWA::FunctionTree>
+  createFunctionTree(const ComPWA::ParameterList &DataSample,
+                     const std::string &suffix) const {
+    return nullptr;
+  }
+  void addUniqueParametersTo(ComPWA::ParameterList &list) {}
+  void addFitParametersTo(std::vector<double> &list) {}
+  void updateParametersFrom(const ComPWA::ParameterList &list) {}
+
+  mutable size_t NumberOfEvaluations;
+};
+
+std::vector<ComPWA::DataPoint> createSample(size_t Size) {
+  std::mt19937 Generator(123);
+  std::uniform_real_distribution<double> Uniform(-1.0, 1.0);
+  std::vector<ComPWA::DataPoint> Sample(Size);
+  for (auto &Point : Sample) {
+    Point.KinematicVariableList = {Uniform(Generator), Uniform(Generator)};
+    Point.Weight = 0.5 + 0.5 * Uniform(Generator);
+  }
+  return Sample;
+}
+
+double integrate(const ComPWA::Intensity &Intensity,
+                 const std::vector<ComPWA::DataPoint> &Sample) {
+  double Integral(0.0);
+  for (auto const &Point : Sample)
+    Integral += Point.Weight * Intensity.evaluate(Point);
+  return Integral;
+}
+
+BOOST_AUTO_TEST_CASE(ReductionCheck) {
+  ComPWA::Logging log("output.log", "INFO");
+  auto Sample = createSample(100000);
+  QuadraticIntensity Intensity;
+  double Integral(integrate(Intensity, Sample));
+  double WeightSum(0.0);
+  for (auto const &Point : Sample)
+    WeightSum += Point.Weight;
+
+  auto Reduced = ComPWA::Data::reduceSample(Sample, 1000);
+  BOOST_CHECK_EQUAL(Reduced->getDataPointList().size(), 1000);
+  double ReducedWeightSum(0.0);
+  for (auto const &Point : Reduced->getDataPointList())
+    ReducedWeightSum += Point.Weight;
+  BOOST_CHECK_CLOSE(ReducedWeightSum, WeightSum, 1e-8);
+
+  // the reduced integrals of different seeds scatter around the full
+  // integral as predicted
+  auto Intensity_ = std::make_shared<QuadraticIntensity>();
+  double Error(
+      ComPWA::Data::estimateReductionError(Intensity_, Sample, 1000));
+  BOOST_CHECK(Error > 0.0);
+  double Mean(0.0);
+  double Variance(0.0);
+  unsigned int NumberOfSeeds(50);
+  for (unsigned int Seed = 0; Seed < NumberOfSeeds; ++Seed) {
+    auto x = ComPWA::Data::reduceSample(Sample, 1000, {}, Seed);
+    double Deviation(integrate(Intensity, x->getDataPointList()) / Integral -
+                     1.0);
+    Mean += Deviation / NumberOfSeeds;
+    Variance += Deviation * Deviation / NumberOfSeeds;
+  }
+  BOOST_CHECK_SMALL(Mean, 4.0 * Error / std::sqrt(NumberOfSeeds));
+  BOOST_CHECK_CLOSE(std::sqrt(Variance), Error, 30.0);
+}
+
+BOOST_AUTO_TEST_CASE(PrecisionCheck) {
+  ComPWA::Logging log("output.log", "INFO");
+  auto Sample = createSample(100000);
+  auto Intensity = std::make_shared<QuadraticIntensity>();
+
+  auto Reduced = ComPWA::Data::reduceSample(Intensity, Sample, 1e-3, {}, 100);
+  // the number of cells is doubled from 100 until the precision is reached
+  size_t NumberOfCells(Reduced->getDataPointList().size());
+  BOOST_CHECK(ComPWA::Data::estimateReductionError(Intensity, Sample,
+                                                   NumberOfCells) < 1e-3);
+  BOOST_CHECK(ComPWA::Data::estimateReductionError(
+                  Intensity, Sample, NumberOfCells / 2) >= 1e-3);
+
+  // each event was evaluated only once in reduceSample() and twice in the
+  // two error estimates above
+  BOOST_CHECK_EQUAL(Intensity->NumberOfEvaluations, 3 * Sample.size());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
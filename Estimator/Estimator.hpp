@@ -26,6 +26,24 @@ public:
   virtual double evaluate() const = 0;
 };
 
+///
+/// Interface of Estimators which can be evaluated with different levels of
+/// precision, e.g. on sub samples of the data. Level 0 is the fastest and
+/// least precise one, the last level corresponds to the full precision. An
+/// Optimizer can use the coarse levels far away from the minimum and switch
+/// to the full precision for the final iterations and the error estimate.
+///
+class ProgressiveEstimator : public Estimator {
+public:
+  virtual ~ProgressiveEstimator(){};
+
+  virtual unsigned int numberOfPrecisionLevels() const = 0;
+
+  virtual void setPrecisionLevel(unsigned int Level) = 0;
+
+  virtual unsigned int precisionLevel() const = 0;
+};
+
 } // namespace Estimator
 } // namespace ComPWA
 
@@ -0,0 +1,253 @@
+// Copyright (c) 2013, 2015, 2017 The ComPWA Team.
+// This file is part of the ComPWA framework, check
+// https://github.com/ComPWA/ComPWA/license.txt for details.
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+#include "BinnedMinLogLH.hpp"
+#include "Core/Event.hpp"
+#include "Core/Intensity.hpp"
+#include "Core/Logging.hpp"
+
+namespace ComPWA {
+namespace Estimator {
+
+BinnedMinLogLH::BinnedMinLogLH(
+    std::shared_ptr<ComPWA::Intensity> intensity,
+    const std::vector<ComPWA::DataPoint> &datapoints,
+    const std::vector<ComPWA::DataPoint> &phsppoints,
+    std::vector<size_t> BinningVariables_, size_t MinEventsPerBin_,
+    size_t PhspEventsPerBin_)
+    : Intensity(intensity), BinningVariables(BinningVariables_),
+      MinEventsPerBin(MinEventsPerBin_), PhspEventsPerBin(PhspEventsPerBin_),
+      DataWeightSum(0.0) {
+  if (0 == datapoints.size() || 0 == phsppoints.size())
+    throw std::runtime_error("BinnedMinLogLH::BinnedMinLogLH(): data or phase "
+                             "space sample is empty!");
+
+  // a bin is split only if it contains twice the minimal number of events,
+  // hence there are at most 1024 bins
+  if (0 == MinEventsPerBin)
+    MinEventsPerBin = std::max<size_t>(25, (datapoints.size() + 1023) / 1024);
+
+  size_t NumberOfVariables(datapoints.front().KinematicVariableList.size());
+  if (BinningVariables.empty()) {
+    BinningVariables.resize(NumberOfVariables);
+    std::iota(BinningVariables.begin(), BinningVariables.end(), 0);
+  }
+  for (auto x : BinningVariables) {
+    if (x >= NumberOfVariables)
+      throw std::runtime_error("BinnedMinLogLH::BinnedMinLogLH(): binning "
+                               "variable index " +
+                               std::to_string(x) + " is out of range!");
+  }
+
+  // the spread of each variable is compared relative to its full range
+  std::vector<double> VariableRanges;
+  for (auto var : BinningVariables) {
+    auto MinMax = std::minmax_element(
+        datapoints.begin(), datapoints.end(),
+        [var](const DataPoint &a, const DataPoint &b) {
+          return a.KinematicVariableList[var] < b.KinematicVariableList[var];
+        });
+    double Range(MinMax.second->KinematicVariableList[var] -
+                 MinMax.first->KinematicVariableList[var]);
+    VariableRanges.push_back(Range > 0.0 ? Range : 1.0);
+  }
+
+  std::vector<size_t> DataIndices(datapoints.size());
+  std::iota(DataIndices.begin(), DataIndices.end(), 0);
+  std::vector<size_t> PhspIndices(phsppoints.size());
+  std::iota(PhspIndices.begin(), PhspIndices.end(), 0);
+  createBins(std::move(DataIndices), std::move(PhspIndices), datapoints,
+             phsppoints, VariableRanges);
+
+  size_t NumberOfPhspEvents(0);
+  for (auto const &b : Bins) {
+    DataWeightSum += b.DataWeight;
+    NumberOfPhspEvents += b.PhspDataPoints.size();
+  }
+
+  LOG(INFO) << "BinnedMinLogLH::BinnedMinLogLH() | Binned "
+            << datapoints.size() << " data events in " << Bins.size()
+            << " bins of " << BinningVariables.size()
+            << " variables. Using " << NumberOfPhspEvents << " of "
+            << phsppoints.size() << " phase space events.";
+}
+
+void BinnedMinLogLH::createBins(
+    std::vector<size_t> DataIndices, std::vector<size_t> PhspIndices,
+    const std::vector<ComPWA::DataPoint> &datapoints,
+    const std::vector<ComPWA::DataPoint> &phsppoints,
+    const std::vector<double> &VariableRanges) {
+
+  if (DataIndices.size() >= 2 * MinEventsPerBin) {
+    // split along the variable with the largest relative spread
+    size_t SplitVariable(0);
+    double LargestSpread(-1.0);
+    for (size_t i = 0; i < BinningVariables.size(); ++i) {
+      auto var = BinningVariables[i];
+      auto MinMax = std::minmax_element(
+          DataIndices.begin(), DataIndices.end(),
+          [&datapoints, var](size_t a, size_t b) {
+            return datapoints[a].KinematicVariableList[var] <
+                   datapoints[b].KinematicVariableList[var];
+          });
+      double Spread((datapoints[*MinMax.second].KinematicVariableList[var] -
+                     datapoints[*MinMax.first].KinematicVariableList[var]) /
+                    VariableRanges[i]);
+      if (Spread > LargestSpread) {
+        LargestSpread = Spread;
+        SplitVariable = var;
+      }
+    }
+
+    auto Median = DataIndices.begin() + DataIndices.size() / 2;
+    std::nth_element(DataIndices.begin(), Median, DataIndices.end(),
+                     [&datapoints, SplitVariable](size_t a, size_t b) {
+                       return datapoints[a].KinematicVariableList[SplitVariable] <
+                              datapoints[b].KinematicVariableList[SplitVariable];
+                     });
+    double Cut(datapoints[*Median].KinematicVariableList[SplitVariable]);
+
+    auto PhspSplit = std::partition(
+        PhspIndices.begin(), PhspIndices.end(),
+        [&phsppoints, SplitVariable, Cut](size_t a) {
+          return phsppoints[a].KinematicVariableList[SplitVariable] < Cut;
+        });
+
+    // both parts require phase space events, otherwise the bin content can
+    // not be predicted
+    if (PhspSplit != PhspIndices.begin() && PhspSplit != PhspIndices.end()) {
+      createBins(std::vector<size_t>(DataIndices.begin(), Median),
+                 std::vector<size_t>(PhspIndices.begin(), PhspSplit),
+                 datapoints, phsppoints, VariableRanges);
+      createBins(std::vector<size_t>(Median, DataIndices.end()),
+                 std::vector<size_t>(PhspSplit, PhspIndices.end()),
+                 datapoints, phsppoints, VariableRanges);
+      return;
+    }
+  }
+
+  Bin NewBin;
+  NewBin.DataWeight = 0.0;
+  for (auto i : DataIndices)
+    NewBin.DataWeight += datapoints[i].Weight;
+
+  if (0 == PhspEventsPerBin) {
+    for (auto i : PhspIndices)
+      NewBin.PhspDataPoints.push_back(phsppoints[i]);
+  } else {
+    addRepresentatives(PhspIndices.begin(), PhspIndices.end(),
+                       PhspEventsPerBin, phsppoints, VariableRanges,
+                       NewBin.PhspDataPoints);
+  }
+
+  Bins.push_back(NewBin);
+}
+
+void BinnedMinLogLH::addRepresentatives(
+    std::vector<size_t>::iterator First, std::vector<size_t>::iterator Last,
+    size_t Number, const std::vector<ComPWA::DataPoint> &phsppoints,
+    const std::vector<double> &VariableRanges,
+    std::vector<ComPWA::DataPoint> &Representatives) const {
+  size_t Size(Last - First);
+  if (Number > 1 && Size > 1) {
+    // split at the median of the variable with the largest relative spread
+    size_t SplitVariable(BinningVariables.front());
+    double LargestSpread(-1.0);
+    for (size_t i = 0; i < BinningVariables.size(); ++i) {
+      auto var = BinningVariables[i];
+      auto MinMax = std::minmax_element(
+          First, Last, [&phsppoints, var](size_t a, size_t b) {
+            return phsppoints[a].KinematicVariableList[var] <
+                   phsppoints[b].KinematicVariableList[var];
+          });
+      double Spread((phsppoints[*MinMax.second].KinematicVariableList[var] -
+                     phsppoints[*MinMax.first].KinematicVariableList[var]) /
+                    VariableRanges[i]);
+      if (Spread > LargestSpread) {
+        LargestSpread = Spread;
+        SplitVariable = var;
+      }
+    }
+    auto Median = First + Size / 2;
+    std::nth_element(First, Median, Last,
+                     [&phsppoints, SplitVariable](size_t a, size_t b) {
+                       return phsppoints[a].KinematicVariableList[SplitVariable] <
+                              phsppoints[b].KinematicVariableList[SplitVariable];
+                     });
+    addRepresentatives(First, Median, Number / 2, phsppoints, VariableRanges,
+                       Representatives);
+    addRepresentatives(Median, Last, Number - Number / 2, phsppoints,
+                       VariableRanges, Representatives);
+    return;
+  }
+
+  // the event closest to the weighted mean represents the weight sum of all
+  std::vector<double> Mean(BinningVariables.size(), 0.0);
+  double WeightSum(0.0);
+  for (auto it = First; it != Last; ++it) {
+    auto const &dp = phsppoints[*it];
+    WeightSum += dp.Weight;
+    for (size_t i = 0; i < BinningVariables.size(); ++i)
+      Mean[i] += dp.Weight * dp.KinematicVariableList[BinningVariables[i]];
+  }
+  if (0.0 == WeightSum)
+    return;
+  for (auto &x : Mean)
+    x /= WeightSum;
+  auto Closest = std::min_element(
+      First, Last, [&](size_t a, size_t b) {
+        double DistanceA(0.0), DistanceB(0.0);
+        for (size_t i = 0; i < BinningVariables.size(); ++i) {
+          auto var = BinningVariables[i];
+          DistanceA += std::pow((phsppoints[a].KinematicVariableList[var] -
+                                 Mean[i]) /
+                                    VariableRanges[i],
+                                2);
+          DistanceB += std::pow((phsppoints[b].KinematicVariableList[var] -
+                                 Mean[i]) /
+                                    VariableRanges[i],
+                                2);
+        }
+        return DistanceA < DistanceB;
+      });
+  Representatives.push_back(phsppoints[*Closest]);
+  Representatives.back().Weight = WeightSum;
+}
+
+double BinnedMinLogLH::evaluate() const {
+  std::vector<double> BinIntegrals;
+  BinIntegrals.reserve(Bins.size());
+  for (auto const &b : Bins) {
+    double Integral(0.0);
+    for (auto const &dp : b.PhspDataPoints)
+      Integral += Intensity->evaluate(dp) * dp.Weight;
+    BinIntegrals.push_back(Integral);
+  }
+  double Norm(
+      std::accumulate(BinIntegrals.begin(), BinIntegrals.end(), 0.0));
+
+  double lh(0.0);
+  for (size_t i = 0; i < Bins.size(); ++i) {
+    double Expected(DataWeightSum * BinIntegrals[i] / Norm);
+    double Observed(Bins[i].DataWeight);
+    if (0.0 >= Expected) {
+      if (0.0 < Observed)
+        return std::numeric_limits<double>::max();
+      continue;
+    }
+    lh += Expected - Observed;
+    if (0.0 < Observed)
+      lh += Observed * std::log(Observed / Expected);
+  }
+
+  return lh;
+}
+
+} // namespace Estimator
+} // namespace ComPWA
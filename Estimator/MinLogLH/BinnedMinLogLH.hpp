@@ -0,0 +1,123 @@
+// Copyright (c) 2013, 2015, 2017 The ComPWA Team.
+// This file is part of the ComPWA framework, check
+// https://github.com/ComPWA/ComPWA/license.txt for details.
+
+#ifndef COMPWA_ESTIMATOR_MINLOGLH_BINNEDMINLOGLH_HPP_
+#define COMPWA_ESTIMATOR_MINLOGLH_BINNEDMINLOGLH_HPP_
+
+#include <memory>
+#include <vector>
+
+#include "Estimator/Estimator.hpp"
+
+namespace ComPWA {
+
+class Intensity;
+struct DataPoint;
+
+namespace Estimator {
+
+///
+/// \class BinnedMinLogLH
+/// Binned Poisson Log Likelihood-Estimator for large data samples.
+///
+/// The data sample is binned adaptively in the kinematic variables
+/// \p BinningVariables (indices in DataPoint::KinematicVariableList, e.g. the
+/// HelicityKinematics variables). Similar to TKDTreeBinning, the binning is
+/// created by recursively splitting the sample at the median of the variable
+/// with the largest relative spread, so that all bins contain about the same
+/// number of events. A bin is only split if both parts contain at least
+/// \p MinEventsPerBin data events and at least one phase space event.
+///
+/// \par log likelihood
+/// The expected number of events in bin \f$b\f$ is
+/// \f[
+///    \mu_b = N_{\mathrm{obs}} \frac{\lambda_b}{\sum_b \lambda_b}
+/// \f]
+/// with the intensity integral \f$\lambda_b\f$ over the bin, estimated from the
+/// phase space sample. The negative log likelihood is given by the Poisson
+/// likelihood ratio (Baker-Cousins)
+/// \f[
+///    -log \mathcal{L} = \sum_b \mu_b - n_b + n_b \log(n_b / \mu_b)
+/// \f]
+/// with the sum of event weights \f$n_b\f$ in bin \f$b\f$. Since the
+/// Intensity is not normalized, the total yield is fixed to the (weighted)
+/// number of observed events.
+///
+/// \par Phase space integration
+/// The phase space events and their weight sums are assigned to the bins once
+/// in the constructor. The events of a bin are split into \p PhspEventsPerBin
+/// parts of equal size, again at the medians of the binning variables. Each
+/// part is represented by its event closest to the weighted mean of the part,
+/// which carries the weight sum of the part. This is a midpoint rule for the
+/// bin integral, its error is of second order in the size of the parts. Hence
+/// a call to evaluate() needs \p PhspEventsPerBin intensity evaluations per
+/// bin, independent of the sample sizes. Use \p PhspEventsPerBin = 0 to keep
+/// all phase space events. If the intensity depends on variables which are
+/// not binned, their variation within a part is not integrated and more
+/// events per bin are needed.
+///
+/// \par Default binning
+/// With \p MinEventsPerBin = 0 the minimal bin content is chosen such that
+/// there are at most 1024 bins (but at least 25 events per bin). With the
+/// default \p PhspEventsPerBin = 8, a call to evaluate() needs at most 8192
+/// intensity evaluations. A single event per bin is not sufficient in the
+/// wide bins where the intensity changes rapidly. For a Gaussian with 10^5
+/// data and 4 * 10^5 phase space events, 8 events per bin give the same
+/// likelihood at the true parameters as the full phase space sample within
+/// 0.2%.
+///
+class BinnedMinLogLH : public ComPWA::Estimator::Estimator {
+
+public:
+  BinnedMinLogLH(std::shared_ptr<ComPWA::Intensity> intensity,
+                 const std::vector<ComPWA::DataPoint> &datapoints,
+                 const std::vector<ComPWA::DataPoint> &phsppoints,
+                 std::vector<size_t> BinningVariables = {},
+                 size_t MinEventsPerBin = 0, size_t PhspEventsPerBin = 8);
+
+  /// Value of the binned log likelihood function.
+  double evaluate() const final;
+
+  size_t numberOfBins() const { return Bins.size(); }
+
+private:
+  struct Bin {
+    /// Sum of data event weights in this bin
+    double DataWeight;
+    /// (Reduced) phase space sample of this bin
+    std::vector<DataPoint> PhspDataPoints;
+  };
+
+  /// Recursively splits the data and phase space events \p DataIndices and
+  /// \p PhspIndices and creates the bins.
+  void createBins(std::vector<size_t> DataIndices,
+                  std::vector<size_t> PhspIndices,
+                  const std::vector<ComPWA::DataPoint> &datapoints,
+                  const std::vector<ComPWA::DataPoint> &phsppoints,
+                  const std::vector<double> &VariableRanges);
+
+  /// Adds \p Number events which represent the phase space events [\p First,
+  /// \p Last) to \p Representatives.
+  void addRepresentatives(std::vector<size_t>::iterator First,
+                          std::vector<size_t>::iterator Last, size_t Number,
+                          const std::vector<ComPWA::DataPoint> &phsppoints,
+                          const std::vector<double> &VariableRanges,
+                          std::vector<ComPWA::DataPoint> &Representatives) const;
+
+  std::shared_ptr<ComPWA::Intensity> Intensity;
+
+  std::vector<size_t> BinningVariables;
+  size_t MinEventsPerBin;
+  size_t PhspEventsPerBin;
+
+  std::vector<Bin> Bins;
+
+  /// Total sum of data event weights
+  double DataWeightSum;
+};
+
+} // namespace Estimator
+} // namespace ComPWA
+
+#endif
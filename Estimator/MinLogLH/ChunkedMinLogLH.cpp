@@ -0,0 +1,83 @@
+// Copyright (c) 2013, 2015, 2017 The ComPWA Team.
+// This file is part of the ComPWA framework, check
+// https://github.com/ComPWA/ComPWA/license.txt for details.
+
+#include <cmath>
+
+#include "ChunkedMinLogLH.hpp"
+#include "Core/Concurrency.hpp"
+#include "Core/Intensity.hpp"
+#include "Core/Logging.hpp"
+#include "Data/ChunkedDataSet.hpp"
+#include "Data/DataSet.hpp"
+
+namespace ComPWA {
+namespace Estimator {
+
+ChunkedMinLogLH::ChunkedMinLogLH(
+    std::shared_ptr<ComPWA::Intensity> intensity,
+    std::shared_ptr<const ComPWA::Data::ChunkedDataSet> data,
+    std::shared_ptr<const ComPWA::Data::ChunkedDataSet> phsp)
+    : Intensity(intensity), DataSample(data), PhspSample(phsp) {
+  if (!DataSample)
+    throw std::runtime_error("ChunkedMinLogLH::ChunkedMinLogLH(): data "
+                             "sample is not set!");
+  LOG(INFO) << "ChunkedMinLogLH::Init() |  Size of data sample = "
+            << DataSample->numberOfEvents() << " in "
+            << DataSample->numberOfChunks() << " chunks";
+}
+
+/// Evaluates \p Intensity for all events of \p Chunk. The events are split
+/// into ranges, which are evaluated concurrently.
+static std::vector<double> evaluateChunk(const ComPWA::Intensity &Intensity,
+                                         const ComPWA::Data::DataSet &Chunk) {
+  auto const &Columns = Chunk.getParameterList().mDoubleValues();
+  if (Columns.empty())
+    return {};
+  size_t NumberOfVariables(Columns.size() - 1);
+  std::vector<double> Intensities(Columns.back()->values().size());
+  runOnRanges(Intensities.size(), 1000, [&](size_t Begin, size_t End) {
+    DataPoint Point;
+    Point.KinematicVariableList.resize(NumberOfVariables);
+    for (size_t i = Begin; i < End; ++i) {
+      for (size_t j = 0; j < NumberOfVariables; ++j)
+        Point.KinematicVariableList[j] = Columns[j]->values()[i];
+      Intensities[i] = Intensity.evaluate(Point);
+    }
+  });
+  return Intensities;
+}
+
+double ChunkedMinLogLH::evaluate() const {
+  // the intensities are summed in the order of the events, so that the result
+  // does not depend on the number of threads
+  double Norm(0.0);
+  if (PhspSample && 0 < PhspSample->numberOfEvents()) {
+    double PhspIntegral(0.0);
+    double WeightSum(0.0);
+    PhspSample->forEachChunk([&](const ComPWA::Data::DataSet &Chunk) {
+      auto Intensities = evaluateChunk(*Intensity, Chunk);
+      auto const &Weights =
+          Chunk.getParameterList().mDoubleValues().back()->values();
+      for (size_t i = 0; i < Intensities.size(); ++i) {
+        PhspIntegral += Intensities[i] * Weights[i];
+        WeightSum += Weights[i];
+      }
+    });
+    Norm = (std::log(PhspIntegral / WeightSum) * DataSample->numberOfEvents());
+  }
+
+  double LogSum(0.0);
+  DataSample->forEachChunk([&](const ComPWA::Data::DataSet &Chunk) {
+    auto Intensities = evaluateChunk(*Intensity, Chunk);
+    auto const &Weights =
+        Chunk.getParameterList().mDoubleValues().back()->values();
+    for (size_t i = 0; i < Intensities.size(); ++i)
+      LogSum += Weights[i] * std::log(Intensities[i]);
+  });
+
+  return Norm - LogSum;
+}
+
+} // namespace Estimator
+} // namespace ComPWA
@@ -0,0 +1,55 @@
+// Copyright (c) 2013, 2015, 2017 The ComPWA Team.
+// This file is part of the ComPWA framework, check
+// https://github.com/ComPWA/ComPWA/license.txt for details.
+
+#ifndef COMPWA_ESTIMATOR_MINLOGLH_CHUNKEDMINLOGLH_HPP_
+#define COMPWA_ESTIMATOR_MINLOGLH_CHUNKEDMINLOGLH_HPP_
+
+#include <memory>
+
+#include "Estimator/Estimator.hpp"
+
+namespace ComPWA {
+
+class Intensity;
+
+namespace Data {
+class ChunkedDataSet;
+class DataSet;
+} // namespace Data
+
+namespace Estimator {
+
+///
+/// \class ChunkedMinLogLH
+/// Negative Log Likelihood-Estimator for samples which do not fit into memory.
+/// The likelihood is identical to MinLogLH, but the data and phase space
+/// samples are ChunkedDataSets, which are read from disk chunk by chunk in
+/// each evaluation. The sums over the events are accumulated chunk-wise, hence
+/// the memory consumption is limited by the memory budgets of the samples.
+/// The events of each chunk are evaluated concurrently.
+///
+/// Give the ChunkedDataSets a cache file, so that the events are only
+/// converted in the first evaluation.
+///
+class ChunkedMinLogLH : public ComPWA::Estimator::Estimator {
+
+public:
+  ChunkedMinLogLH(std::shared_ptr<ComPWA::Intensity> intensity,
+                  std::shared_ptr<const ComPWA::Data::ChunkedDataSet> data,
+                  std::shared_ptr<const ComPWA::Data::ChunkedDataSet> phsp);
+
+  /// Value of log likelihood function.
+  double evaluate() const final;
+
+private:
+  std::shared_ptr<ComPWA::Intensity> Intensity;
+
+  std::shared_ptr<const ComPWA::Data::ChunkedDataSet> DataSample;
+  std::shared_ptr<const ComPWA::Data::ChunkedDataSet> PhspSample;
+};
+
+} // namespace Estimator
+} // namespace ComPWA
+
+#endif
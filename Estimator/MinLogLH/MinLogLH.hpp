@@ -59,6 +59,13 @@ public:
   /// Value of log likelihood function.
   double evaluate() const final;
 
+  /// Number of events (data and phase space) which are evaluated per call.
+  size_t sampleSize() const {
+    return DataPoints.size() + PhspDataPoints.size();
+  }
+
+  std::shared_ptr<ComPWA::Intensity> intensity() const { return Intensity; }
+
 private:
   std::shared_ptr<ComPWA::Intensity> Intensity;
 
@@ -0,0 +1,103 @@
+// Copyright (c) 2013, 2015, 2017 The ComPWA Team.
+// This file is part of the ComPWA framework, check
+// https://github.com/ComPWA/ComPWA/license.txt for details.
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <sstream>
+
+#include "ProgressiveMinLogLH.hpp"
+#include "Core/Intensity.hpp"
+#include "Core/Logging.hpp"
+
+namespace ComPWA {
+namespace Estimator {
+
+/// Minimal number of events of a sub sample (if the sample is large enough)
+static const size_t MinimalSubSampleSize = 1000;
+
+ProgressiveMinLogLH::ProgressiveMinLogLH(
+    std::shared_ptr<ComPWA::Intensity> intensity,
+    const std::vector<ComPWA::DataPoint> &datapoints,
+    const std::vector<ComPWA::DataPoint> &phsppoints,
+    unsigned int NumberOfLevels, double GrowthFactor, bool SubsampleData,
+    unsigned int Seed)
+    : Intensity(intensity), DataPoints(datapoints), PhspDataPoints(phsppoints),
+      Level(0) {
+  if (0 == NumberOfLevels || 1.0 >= GrowthFactor)
+    throw std::runtime_error("ProgressiveMinLogLH::ProgressiveMinLogLH(): "
+                             "at least one level and a growth factor larger "
+                             "than one are required!");
+
+  // shuffle once, so that the first N events of a sample are a random sub
+  // sample and the sub samples of different levels are nested
+  std::mt19937 Generator(Seed);
+  std::shuffle(PhspDataPoints.begin(), PhspDataPoints.end(), Generator);
+  if (SubsampleData)
+    std::shuffle(DataPoints.begin(), DataPoints.end(), Generator);
+
+  auto SubSampleSize = [&](size_t FullSize, unsigned int l) -> size_t {
+    double Size(FullSize / std::pow(GrowthFactor, NumberOfLevels - 1 - l));
+    return std::min(FullSize,
+                    std::max<size_t>(Size, MinimalSubSampleSize));
+  };
+  for (unsigned int l = 0; l < NumberOfLevels; ++l) {
+    size_t PhspSize(SubSampleSize(PhspDataPoints.size(), l));
+    size_t DataSize(DataPoints.size());
+    if (SubsampleData)
+      DataSize = SubSampleSize(DataPoints.size(), l);
+    // skip levels which do not differ from the previous one
+    if (PhspSampleSizes.size() && PhspSampleSizes.back() == PhspSize &&
+        DataSampleSizes.back() == DataSize)
+      continue;
+    PhspSampleSizes.push_back(PhspSize);
+    DataSampleSizes.push_back(DataSize);
+  }
+
+  std::stringstream ss;
+  for (size_t l = 0; l < PhspSampleSizes.size(); ++l)
+    ss << " (" << DataSampleSizes[l] << ", " << PhspSampleSizes[l] << ")";
+  LOG(INFO) << "ProgressiveMinLogLH::ProgressiveMinLogLH() | Sample sizes "
+               "(data, phsp) of the precision levels:"
+            << ss.str();
+}
+
+void ProgressiveMinLogLH::setPrecisionLevel(unsigned int Level_) {
+  if (Level_ >= numberOfPrecisionLevels())
+    throw std::runtime_error("ProgressiveMinLogLH::setPrecisionLevel(): "
+                             "level " +
+                             std::to_string(Level_) + " does not exist!");
+  Level = Level_;
+  LOG(DEBUG) << "ProgressiveMinLogLH::setPrecisionLevel() | Using "
+             << DataSampleSizes[Level] << " data and "
+             << PhspSampleSizes[Level] << " phase space events.";
+}
+
+double ProgressiveMinLogLH::evaluate() const {
+  double Norm(0.0);
+  if (0 < PhspDataPoints.size()) {
+    double PhspIntegral(0.0);
+    double WeightSum(0.0);
+    for (size_t i = 0; i < PhspSampleSizes[Level]; ++i) {
+      PhspIntegral +=
+          Intensity->evaluate(PhspDataPoints[i]) * PhspDataPoints[i].Weight;
+      WeightSum += PhspDataPoints[i].Weight;
+    }
+    Norm = (std::log(PhspIntegral / WeightSum) * DataPoints.size());
+  }
+
+  double LogSum(0.0);
+  for (size_t i = 0; i < DataSampleSizes[Level]; ++i) {
+    LogSum +=
+        DataPoints[i].Weight * std::log(Intensity->evaluate(DataPoints[i]));
+  }
+  // scale to the full data sample
+  if (DataSampleSizes[Level])
+    LogSum *= double(DataPoints.size()) / DataSampleSizes[Level];
+
+  return Norm - LogSum;
+}
+
+} // namespace Estimator
+} // namespace ComPWA
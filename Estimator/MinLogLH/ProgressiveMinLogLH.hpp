@@ -0,0 +1,75 @@
+// Copyright (c) 2013, 2015, 2017 The ComPWA Team.
+// This file is part of the ComPWA framework, check
+// https://github.com/ComPWA/ComPWA/license.txt for details.
+
+#ifndef COMPWA_ESTIMATOR_MINLOGLH_PROGRESSIVEMINLOGLH_HPP_
+#define COMPWA_ESTIMATOR_MINLOGLH_PROGRESSIVEMINLOGLH_HPP_
+
+#include <memory>
+#include <vector>
+
+#include "Core/Event.hpp"
+#include "Estimator/Estimator.hpp"
+
+namespace ComPWA {
+
+class Intensity;
+
+namespace Estimator {
+
+///
+/// \class ProgressiveMinLogLH
+/// Negative Log Likelihood-Estimator with a progressively increasing
+/// precision of the phase space integral. The likelihood is identical to
+/// MinLogLH, but on the lower precision levels only a random sub sample of the
+/// phase space sample (and optionally of the data sample) is used.
+///
+/// The sub sample sizes grow geometrically by \p GrowthFactor from level to
+/// level, the last level uses the full samples. The sub samples are nested,
+/// hence the likelihood changes smoothly when the level is increased. If the
+/// data sample is reduced as well, the data term is scaled to the full sample
+/// size, so that the curvature (and therefore the EDM) of the likelihood is
+/// comparable on all levels.
+///
+/// The samples are shuffled once and copied in the constructor.
+/// \see Optimizer::Minuit2::MinuitIF for the usage of the precision levels.
+///
+class ProgressiveMinLogLH : public ComPWA::Estimator::ProgressiveEstimator {
+
+public:
+  ProgressiveMinLogLH(std::shared_ptr<ComPWA::Intensity> intensity,
+                      const std::vector<ComPWA::DataPoint> &datapoints,
+                      const std::vector<ComPWA::DataPoint> &phsppoints,
+                      unsigned int NumberOfLevels = 4,
+                      double GrowthFactor = 4.0, bool SubsampleData = false,
+                      unsigned int Seed = 12345);
+
+  /// Value of log likelihood function at the current precision level.
+  double evaluate() const final;
+
+  unsigned int numberOfPrecisionLevels() const final {
+    return PhspSampleSizes.size();
+  }
+
+  void setPrecisionLevel(unsigned int Level) final;
+
+  unsigned int precisionLevel() const final { return Level; }
+
+private:
+  std::shared_ptr<ComPWA::Intensity> Intensity;
+
+  /// Shuffled copies of the samples
+  std::vector<DataPoint> DataPoints;
+  std::vector<DataPoint> PhspDataPoints;
+
+  /// Number of used events per precision level
+  std::vector<size_t> DataSampleSizes;
+  std::vector<size_t> PhspSampleSizes;
+
+  unsigned int Level;
+};
+
+} // namespace Estimator
+} // namespace ComPWA
+
+#endif
@@ -2,6 +2,13 @@
 // This file is part of the ComPWA framework, check
 // https://github.com/ComPWA/ComPWA/license.txt for details.
 
+#include <algorithm>
+#include <functional>
+#include <future>
+#include <numeric>
+#include <set>
+#include <thread>
+
 #include "Estimator/MinLogLH/SumMinLogLH.hpp"
 #include "Core/Event.hpp"
 #include "Core/FitResult.hpp"
@@ -14,21 +21,192 @@
 namespace ComPWA {
 namespace Estimator {
 
-SumMinLogLH::SumMinLogLH(std::vector<std::shared_ptr<MinLogLH>> LogLikelihoods_)
-    : LogLikelihoods(LogLikelihoods_) {}
+std::vector<std::vector<size_t>> balanceLoad(const std::vector<double> &Costs,
+                                             unsigned int NumberOfThreads) {
+  if (0 == NumberOfThreads)
+    NumberOfThreads = std::max(1u, std::thread::hardware_concurrency());
+  size_t NumberOfGroups(std::min<size_t>(NumberOfThreads, Costs.size()));
+
+  std::vector<size_t> SortedTasks(Costs.size());
+  std::iota(SortedTasks.begin(), SortedTasks.end(), 0);
+  std::stable_sort(SortedTasks.begin(), SortedTasks.end(),
+                   [&Costs](size_t a, size_t b) { return Costs[a] > Costs[b]; });
+
+  std::vector<std::vector<size_t>> Groups(NumberOfGroups);
+  std::vector<double> GroupCosts(NumberOfGroups, 0.0);
+  for (auto Task : SortedTasks) {
+    size_t Group =
+        std::min_element(GroupCosts.begin(), GroupCosts.end()) -
+        GroupCosts.begin();
+    Groups[Group].push_back(Task);
+    GroupCosts[Group] += Costs[Task];
+  }
+  return Groups;
+}
+
+/// Executes \p Task for all indices in \p ThreadAssignments. Each group of
+/// indices is processed on its own thread. Exceptions are rethrown in the
+/// calling thread.
+void runConcurrently(const std::vector<std::vector<size_t>> &ThreadAssignments,
+                     const std::function<void(size_t)> &Task) {
+  if (ThreadAssignments.size() < 2) {
+    for (auto const &Group : ThreadAssignments)
+      for (auto i : Group)
+        Task(i);
+    return;
+  }
+  std::vector<std::future<void>> Results;
+  Results.reserve(ThreadAssignments.size());
+  for (auto const &Group : ThreadAssignments) {
+    Results.push_back(std::async(std::launch::async, [&Group, &Task]() {
+      for (auto i : Group)
+        Task(i);
+    }));
+  }
+  // wait for all threads before a possible exception leaves this scope
+  for (auto &x : Results)
+    x.wait();
+  for (auto &x : Results)
+    x.get();
+}
+
+SumMinLogLH::SumMinLogLH(std::vector<std::shared_ptr<MinLogLH>> LogLikelihoods_,
+                         unsigned int NumberOfThreads)
+    : LogLikelihoods(LogLikelihoods_) {
+  std::vector<double> Costs;
+  for (auto const &x : LogLikelihoods)
+    Costs.push_back(x->sampleSize());
+  ThreadAssignments = balanceLoad(Costs, NumberOfThreads);
+
+  if (ThreadAssignments.size() > 1) {
+    std::set<ComPWA::Intensity *> Intensities;
+    for (auto const &x : LogLikelihoods) {
+      if (!Intensities.insert(x->intensity().get()).second)
+        throw std::runtime_error(
+            "SumMinLogLH::SumMinLogLH(): log likelihoods share an Intensity "
+            "and can not be evaluated concurrently. Use NumberOfThreads = 1!");
+    }
+  }
+}
 
 double SumMinLogLH::evaluate() const {
-  double lh(0.0);
-  for (auto const x : LogLikelihoods)
-    lh += x->evaluate();
-  return lh;
+  std::vector<double> Values(LogLikelihoods.size(), 0.0);
+  runConcurrently(ThreadAssignments, [this, &Values](size_t i) {
+    Values[i] = LogLikelihoods[i]->evaluate();
+  });
+  // sum up in a fixed order, so that the result does not depend on the
+  // number of threads
+  return std::accumulate(Values.begin(), Values.end(), 0.0);
+}
+
+///
+/// \class ConcurrentTreeNode
+/// TreeNode which recalculates its child nodes concurrently. The child nodes
+/// are grouped via setThreadAssignments() and each group is recalculated on
+/// its own thread. This requires that the sub trees of different groups do not
+/// share any nodes.
+///
+class ConcurrentTreeNode : public ComPWA::TreeNode {
+public:
+  ConcurrentTreeNode(std::string name,
+                     std::shared_ptr<ComPWA::Parameter> parameter,
+                     std::shared_ptr<ComPWA::Strategy> strategy)
+      : TreeNode(name, parameter, strategy, nullptr) {}
+
+  void setThreadAssignments(const std::vector<std::vector<size_t>> &groups) {
+    ThreadAssignments = groups;
+  }
+
+protected:
+  std::shared_ptr<ComPWA::Parameter> recalculate() const final {
+    if (Parameter && (!HasChanged || !ChildNodes.size()))
+      return Parameter;
+
+    std::vector<std::shared_ptr<ComPWA::Parameter>> ChildValues(
+        ChildNodes.size());
+    runConcurrently(ThreadAssignments, [this, &ChildValues](size_t i) {
+      ChildValues[i] = ChildNodes[i]->parameter();
+    });
+
+    std::shared_ptr<ComPWA::Parameter> result;
+    if (Parameter)
+      result = Parameter;
+
+    ParameterList newVals;
+    for (auto p : ChildValues) {
+      if (p->isParameter())
+        newVals.addParameter(p);
+      else
+        newVals.addValue(p);
+    }
+    try {
+      Strat->execute(newVals, result);
+    } catch (std::exception &ex) {
+      LOG(INFO) << "ConcurrentTreeNode::recalculate() | Strategy " << Strat
+                << " failed on node " << name() << ": " << ex.what();
+      throw;
+    }
+    return result;
+  }
+
+private:
+  std::vector<std::vector<size_t>> ThreadAssignments;
+};
+
+/// Inserts all nodes with child nodes of the (sub) tree starting at \p Node
+/// into \p Nodes.
+void collectInnerNodes(std::shared_ptr<ComPWA::TreeNode> Node,
+                       std::set<ComPWA::TreeNode *> &Nodes) {
+  if (Node->childNodes().empty() || !Nodes.insert(Node.get()).second)
+    return;
+  for (auto const &x : Node->childNodes())
+    collectInnerNodes(x, Nodes);
+}
+
+/// Estimates the computational costs of the (sub) tree starting at \p Node by
+/// the total size of its multi value leaves, e.g. the data samples.
+double estimateEvaluationCost(std::shared_ptr<ComPWA::TreeNode> Node,
+                              std::set<ComPWA::TreeNode *> &VisitedNodes) {
+  if (!VisitedNodes.insert(Node.get()).second)
+    return 0.0;
+  double Cost(0.0);
+  if (Node->childNodes().empty()) {
+    auto Par = Node->parameter();
+    switch (Par->type()) {
+    case ParType::MDOUBLE:
+      Cost += std::dynamic_pointer_cast<Value<std::vector<double>>>(Par)
+                  ->values()
+                  .size();
+      break;
+    case ParType::MCOMPLEX:
+      Cost += std::dynamic_pointer_cast<
+                  Value<std::vector<std::complex<double>>>>(Par)
+                  ->values()
+                  .size();
+      break;
+    case ParType::MINTEGER:
+      Cost += std::dynamic_pointer_cast<Value<std::vector<int>>>(Par)
+                  ->values()
+                  .size();
+      break;
+    default:
+      break;
+    }
+  }
+  for (auto const &x : Node->childNodes())
+    Cost += estimateEvaluationCost(x, VisitedNodes);
+  return Cost;
 }
 
 std::shared_ptr<FunctionTree> createSumMinLogLHEstimatorFunctionTree(
-    std::vector<std::shared_ptr<FunctionTree>> LogLikelihoods) {
-  auto EvaluationTree = std::make_shared<FunctionTree>(
+    std::vector<std::shared_ptr<FunctionTree>> LogLikelihoods,
+    unsigned int NumberOfThreads) {
+  auto Head = std::make_shared<ConcurrentTreeNode>(
       "SumLogLh", std::make_shared<Value<double>>(),
       std::make_shared<AddAll>(ParType::DOUBLE));
+  auto EvaluationTree = std::make_shared<FunctionTree>(Head);
+
+  std::vector<double> Costs;
   unsigned int counter(1);
   for (auto ll : LogLikelihoods) {
     try {
@@ -36,6 +214,8 @@ std::shared_ptr<FunctionTree> createSumMinLogLHEstimatorFunctionTree(
       // function tree will be constructed correctly
       ll->head()->setName("LH_" + std::to_string(counter));
       EvaluationTree->insertTree(ll, "SumLogLh");
+      std::set<ComPWA::TreeNode *> VisitedNodes;
+      Costs.push_back(estimateEvaluationCost(ll->head(), VisitedNodes));
     } catch (std::exception &ex) {
       LOG(ERROR) << "createSumMinLogLHEstimatorFunctionTree(): Construction of "
                     "one or more sub trees has failed! Error: "
@@ -43,6 +223,28 @@ std::shared_ptr<FunctionTree> createSumMinLogLHEstimatorFunctionTree(
     }
     ++counter;
   }
+  auto ThreadAssignments = balanceLoad(Costs, NumberOfThreads);
+
+  // only leaves may be shared between sub trees of different threads
+  if (ThreadAssignments.size() > 1) {
+    std::set<ComPWA::TreeNode *> VisitedNodes;
+    for (auto const &Group : ThreadAssignments) {
+      std::set<ComPWA::TreeNode *> GroupNodes;
+      for (auto i : Group)
+        collectInnerNodes(Head->childNodes()[i], GroupNodes);
+      for (auto x : GroupNodes) {
+        if (!VisitedNodes.insert(x).second)
+          throw std::runtime_error(
+              "createSumMinLogLHEstimatorFunctionTree(): node " + x->name() +
+              " is shared between concurrently evaluated log likelihoods. "
+              "Use NumberOfThreads = 1!");
+      }
+    }
+  }
+  Head->setThreadAssignments(ThreadAssignments);
+  LOG(INFO) << "createSumMinLogLHEstimatorFunctionTree(): evaluating "
+            << Costs.size() << " log likelihoods on "
+            << ThreadAssignments.size() << " threads.";
 
   EvaluationTree->parameter();
   if (!EvaluationTree->sanityCheck()) {
@@ -20,19 +20,49 @@ class MinLogLH;
 /// \class SumMinLogLH
 /// Calculates the combined likelihood of multiple MinLogLH.
 ///
+/// The log likelihoods can be evaluated concurrently if they are independent
+/// of each other (apart from shared FitParameters). Each thread then
+/// evaluates a group of log likelihoods. The groups are balanced by the number
+/// of events that each log likelihood has to evaluate. The evaluation of an
+/// Intensity is not thread safe, therefore the log likelihoods must not share
+/// an Intensity instance in that case. By default the log likelihoods are
+/// evaluated sequentially.
+///
 class SumMinLogLH : public Estimator {
 public:
-  SumMinLogLH(std::vector<std::shared_ptr<MinLogLH>> LogLikelihoods_);
+  /// \param NumberOfThreads Maximal number of concurrently evaluated log
+  /// likelihoods. If zero, the number of hardware threads is used. Throws if
+  /// more than one thread is used and log likelihoods share an Intensity.
+  SumMinLogLH(std::vector<std::shared_ptr<MinLogLH>> LogLikelihoods_,
+              unsigned int NumberOfThreads = 1);
 
   /// Value of minimum log likelhood function.
   double evaluate() const;
 
 private:
   std::vector<std::shared_ptr<MinLogLH>> LogLikelihoods;
+
+  /// Indices of the log likelihoods grouped by the thread which evaluates them
+  std::vector<std::vector<size_t>> ThreadAssignments;
 };
 
+/// Distributes tasks with the computational \p Costs on at most
+/// \p NumberOfThreads groups. The tasks are assigned in the order of
+/// decreasing cost to the group with the lowest total cost (longest processing
+/// time first). Empty groups are omitted.
+std::vector<std::vector<size_t>>
+balanceLoad(const std::vector<double> &Costs, unsigned int NumberOfThreads);
+
+/// Creates a FunctionTree which sums up the log likelihood trees
+/// \p LogLikelihoods. For \p NumberOfThreads other than one, the head node
+/// SumLogLh evaluates its sub trees concurrently, balanced by the sample sizes
+/// used in each sub tree. Sub trees which are evaluated on different threads
+/// may only share leaves (e.g. FitParameters), otherwise an exception is
+/// thrown.
+/// \see SumMinLogLH
 std::shared_ptr<FunctionTree> createSumMinLogLHEstimatorFunctionTree(
-    std::vector<std::shared_ptr<FunctionTree>> LogLikelihoods);
+    std::vector<std::shared_ptr<FunctionTree>> LogLikelihoods,
+    unsigned int NumberOfThreads = 1);
 
 } // namespace Estimator
 } // namespace ComPWA
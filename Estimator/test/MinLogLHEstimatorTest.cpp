@@ -4,17 +4,25 @@
 
 #define BOOST_TEST_MODULE Estimator_MinLogLHEstimatorTest
 
+#include <atomic>
 #include <chrono>
 #include <cmath>
+#include <cstdio>
+#include <fstream>
 #include <random>
 
 #include <boost/test/unit_test.hpp>
 
 #include "Core/Event.hpp"
 #include "Core/Intensity.hpp"
+#include "Core/Kinematics.hpp"
 #include "Core/ParameterList.hpp"
+#include "Data/ChunkedDataSet.hpp"
 #include "Data/DataSet.hpp"
+#include "Estimator/MinLogLH/BinnedMinLogLH.hpp"
+#include "Estimator/MinLogLH/ChunkedMinLogLH.hpp"
 #include "Estimator/MinLogLH/MinLogLH.hpp"
+#include "Estimator/MinLogLH/ProgressiveMinLogLH.hpp"
 #include "Optimizer/Minuit2/MinuitIF.hpp"
 #include "Optimizer/Minuit2/MinuitResult.hpp"
 #include "Tools/Integration.hpp"
@@ -492,4 +500,262 @@ BOOST_AUTO_TEST_CASE(MinLogLHEstimator_GaussianModelEventWeightTest) {
   BOOST_CHECK(std::abs(pwft.Mean) < 3.0 * pwft.MeanError);
   BOOST_CHECK(std::abs(pwft.Width - 1.0) < 3.0 * pwft.WidthError);
 };
+
+/// Gaussian model with a uniform phase space sample and a normal distributed
+/// data sample. The fit starts at a shifted mean and width.
+struct GaussianFit {
+  double mean;
+  double sigma;
+  std::vector<ComPWA::DataPoint> PhspDataPoints;
+  std::vector<ComPWA::DataPoint> DataPoints;
+  std::shared_ptr<ComPWA::Intensity> Gauss;
+  ComPWA::ParameterList FitParameters;
+  std::shared_ptr<ComPWA::FitParameter> MeanParameter;
+  std::shared_ptr<ComPWA::FitParameter> WidthParameter;
+
+  GaussianFit(unsigned int NumberOfPhspEvents, unsigned int NumberOfEvents)
+      : mean(3.0), sigma(0.1), Gauss(new Gaussian(mean, sigma)) {
+    std::pair<double, double> domain_range(mean - 10.0 * sigma,
+                                           mean + 10.0 * sigma);
+
+    std::mt19937 mt_gen(123456);
+    std::uniform_real_distribution<double> distribution(domain_range.first,
+                                                        domain_range.second);
+    for (unsigned int i = 0; i < NumberOfPhspEvents; ++i) {
+      ComPWA::DataPoint dp;
+      dp.KinematicVariableList.push_back(distribution(mt_gen));
+      PhspDataPoints.push_back(dp);
+    }
+
+    std::normal_distribution<double> normal_distribution(mean, sigma);
+    for (unsigned int i = 0; i < NumberOfEvents; ++i) {
+      ComPWA::DataPoint dp;
+      dp.KinematicVariableList.push_back(normal_distribution(mt_gen));
+      DataPoints.push_back(dp);
+    }
+
+    Gauss->addUniqueParametersTo(FitParameters);
+    MeanParameter = ComPWA::FindParameter("Mean", FitParameters);
+    MeanParameter->fixParameter(false);
+    MeanParameter->setValue(0.95 * mean);
+    WidthParameter = ComPWA::FindParameter("Width", FitParameters);
+    WidthParameter->fixParameter(false);
+    WidthParameter->setValue(1.1 * sigma);
+  }
+
+  /// Minimizes \p Estimator and checks that the true values are found.
+  void fit(std::shared_ptr<ComPWA::Estimator::Estimator> Estimator) {
+    auto minuitif =
+        new ComPWA::Optimizer::Minuit2::MinuitIF(Estimator, FitParameters);
+    minuitif->setUseHesse(true);
+    auto result =
+        std::dynamic_pointer_cast<ComPWA::Optimizer::Minuit2::MinuitResult>(
+            minuitif->exec(FitParameters));
+
+    BOOST_CHECK(std::abs(MeanParameter->value() - mean) <
+                5.0 * MeanParameter->error().first);
+    BOOST_CHECK(std::abs(WidthParameter->value() - sigma) <
+                5.0 * WidthParameter->error().first);
+  }
+};
+
+BOOST_AUTO_TEST_CASE(BinnedMinLogLHEstimator_GaussianModelFitTest) {
+  ComPWA::Logging log("output.log", "INFO");
+  GaussianFit Fit(200000, 100000);
+
+  auto BinnedLH = std::make_shared<ComPWA::Estimator::BinnedMinLogLH>(
+      Fit.Gauss, Fit.DataPoints, Fit.PhspDataPoints, std::vector<size_t>{0},
+      100, 0);
+  BOOST_CHECK_EQUAL(BinnedLH->numberOfBins(), 512);
+  Fit.fit(BinnedLH);
+}
+
+BOOST_AUTO_TEST_CASE(BinnedMinLogLHEstimator_DefaultBinningTest) {
+  ComPWA::Logging log("output.log", "INFO");
+  GaussianFit Fit(400000, 100000);
+
+  // the number of bins is limited, independent of the sample size
+  auto BinnedLH = std::make_shared<ComPWA::Estimator::BinnedMinLogLH>(
+      Fit.Gauss, Fit.DataPoints, Fit.PhspDataPoints);
+  BOOST_CHECK_LE(BinnedLH->numberOfBins(), 1024);
+
+  // at the true parameters the reduced phase space sample reproduces the
+  // full one
+  auto FullBinnedLH = std::make_shared<ComPWA::Estimator::BinnedMinLogLH>(
+      Fit.Gauss, Fit.DataPoints, Fit.PhspDataPoints, std::vector<size_t>{}, 0,
+      0);
+  BOOST_CHECK_EQUAL(BinnedLH->numberOfBins(), FullBinnedLH->numberOfBins());
+  Fit.MeanParameter->setValue(Fit.mean);
+  Fit.WidthParameter->setValue(Fit.sigma);
+  BOOST_CHECK_CLOSE(BinnedLH->evaluate(), FullBinnedLH->evaluate(), 5.0);
+  Fit.MeanParameter->setValue(0.95 * Fit.mean);
+  Fit.WidthParameter->setValue(1.1 * Fit.sigma);
+
+  Fit.fit(BinnedLH);
+}
+
+BOOST_AUTO_TEST_CASE(ProgressiveMinLogLHEstimator_GaussianModelFitTest) {
+  ComPWA::Logging log("output.log", "INFO");
+  double mean(3.0);
+  double sigma(0.1);
+
+  std::pair<double, double> domain_range(mean - 10.0 * sigma,
+                                         mean + 10.0 * sigma);
+
+  std::mt19937 mt_gen(123456);
+  std::uniform_real_distribution<double> distribution(domain_range.first,
+                                                      domain_range.second);
+  std::vector<ComPWA::DataPoint> PhspDataPoints;
+  for (unsigned int i = 0; i < 100000; ++i) {
+    ComPWA::DataPoint dp;
+    dp.KinematicVariableList.push_back(distribution(mt_gen));
+    PhspDataPoints.push_back(dp);
+  }
+
+  std::normal_distribution<double> normal_distribution(mean, sigma);
+  std::vector<ComPWA::DataPoint> DataPoints;
+  for (unsigned int i = 0; i < 2000; ++i) {
+    ComPWA::DataPoint dp;
+    dp.KinematicVariableList.push_back(normal_distribution(mt_gen));
+    DataPoints.push_back(dp);
+  }
+
+  std::shared_ptr<ComPWA::Intensity> Gauss(new Gaussian(mean, sigma));
+
+  ComPWA::ParameterList FitParameters;
+  Gauss->addUniqueParametersTo(FitParameters);
+
+  auto MeanParameter = ComPWA::FindParameter("Mean", FitParameters);
+  MeanParameter->fixParameter(false);
+  MeanParameter->setValue(0.95 * mean);
+  auto WidthParameter = ComPWA::FindParameter("Width", FitParameters);
+  WidthParameter->fixParameter(false);
+  WidthParameter->setValue(1.1 * sigma);
+
+  auto ProgressiveLH = std::make_shared<ComPWA::Estimator::ProgressiveMinLogLH>(
+      Gauss, DataPoints, PhspDataPoints, 3, 5.0);
+  BOOST_CHECK_EQUAL(ProgressiveLH->numberOfPrecisionLevels(), 3);
+
+  auto minuitif =
+      new ComPWA::Optimizer::Minuit2::MinuitIF(ProgressiveLH, FitParameters);
+  minuitif->setUseHesse(true);
+  auto result =
+      std::dynamic_pointer_cast<ComPWA::Optimizer::Minuit2::MinuitResult>(
+          minuitif->exec(FitParameters));
+
+  // the final iterations and hesse have to use the full samples
+  BOOST_CHECK_EQUAL(ProgressiveLH->precisionLevel(), 2);
+  auto FullLH = std::make_shared<ComPWA::Estimator::MinLogLH>(
+      Gauss, DataPoints, PhspDataPoints);
+  BOOST_CHECK_CLOSE(ProgressiveLH->evaluate(), FullLH->evaluate(), 1e-8);
+
+  BOOST_CHECK(std::abs(MeanParameter->value() - mean) <
+              5.0 * MeanParameter->error().first);
+  BOOST_CHECK(std::abs(WidthParameter->value() - sigma) <
+              5.0 * WidthParameter->error().first);
+}
+
+/// Kinematics with the x momentum of the first particle as only variable. It
+/// counts the conversions.
+class MomentumKinematics : public ComPWA::Kinematics {
+public:
+  MomentumKinematics() : Conversions(0) {}
+
+  ComPWA::DataPoint convert(const ComPWA::Event &event) const {
+    ++Conversions;
+    ComPWA::DataPoint point;
+    point.KinematicVariableList.push_back(event.ParticleList[0].px());
+    point.Weight = event.Weight;
+    return point;
+  }
+  std::vector<std::string> getKinematicVariableNames() const { return {"x"}; }
+  bool isWithinPhaseSpace(const ComPWA::DataPoint &) const { return true; }
+  double phspVolume() const { return 1.0; }
+
+  mutable std::atomic<size_t> Conversions;
+};
+
+/// Reads chunks of events from memory. The events are also written to
+/// \p FilePath, which identifies them for the cache of the ChunkedDataSet.
+class VectorChunkReader : public ComPWA::Data::EventChunkReader {
+public:
+  VectorChunkReader(const std::vector<ComPWA::DataPoint> &Points,
+                    const std::string &FilePath_)
+      : FilePath(FilePath_) {
+    std::ofstream File(FilePath, std::ios::trunc);
+    for (auto const &x : Points) {
+      File << x.KinematicVariableList[0] << "\n";
+      ComPWA::Event evt;
+      evt.ParticleList.push_back(
+          ComPWA::Particle(x.KinematicVariableList[0], 0.0, 0.0, 1.0));
+      Events.push_back(evt);
+    }
+  }
+  size_t numberOfEvents() const { return Events.size(); }
+  unsigned int numberOfParticles() const { return 1; }
+  std::vector<ComPWA::Event> readEvents(size_t First, size_t Number) const {
+    return std::vector<ComPWA::Event>(Events.begin() + First,
+                                      Events.begin() + First + Number);
+  }
+  std::string filePath() const { return FilePath; }
+
+private:
+  std::string FilePath;
+  std::vector<ComPWA::Event> Events;
+};
+
+BOOST_AUTO_TEST_CASE(ChunkedMinLogLHEstimator_InMemoryComparisonTest) {
+  ComPWA::Logging log("output.log", "INFO");
+  GaussianFit Fit(20000, 10000);
+  auto Kin = std::make_shared<MomentumKinematics>();
+  // chunks of 1000 events
+  size_t MemoryBudget(2000 * (sizeof(ComPWA::Event) + sizeof(ComPWA::Particle) +
+                              2 * sizeof(double)));
+  auto Data = std::make_shared<ComPWA::Data::ChunkedDataSet>(
+      std::make_shared<VectorChunkReader>(Fit.DataPoints,
+                                          "MinLogLHEstimatorTest-data.txt"),
+      Kin, MemoryBudget, std::vector<bool>{},
+      "MinLogLHEstimatorTest-data.kinematics");
+  auto PhspReader = std::make_shared<VectorChunkReader>(
+      Fit.PhspDataPoints, "MinLogLHEstimatorTest-phsp.txt");
+  auto Phsp = std::make_shared<ComPWA::Data::ChunkedDataSet>(
+      PhspReader, Kin, MemoryBudget, std::vector<bool>{},
+      "MinLogLHEstimatorTest-phsp.kinematics");
+  BOOST_CHECK_EQUAL(Phsp->numberOfChunks(), 20);
+
+  auto ChunkedLH =
+      std::make_shared<ComPWA::Estimator::ChunkedMinLogLH>(Fit.Gauss, Data,
+                                                           Phsp);
+  auto LH = std::make_shared<ComPWA::Estimator::MinLogLH>(
+      Fit.Gauss, Fit.DataPoints, Fit.PhspDataPoints);
+  BOOST_CHECK_CLOSE(ChunkedLH->evaluate(), LH->evaluate(), 1e-10);
+  BOOST_CHECK_EQUAL(Kin->Conversions, 30000);
+
+  // the further evaluations read the kinematic variables from the cache
+  Fit.MeanParameter->setValue(Fit.mean);
+  BOOST_CHECK_CLOSE(ChunkedLH->evaluate(), LH->evaluate(), 1e-10);
+  BOOST_CHECK_EQUAL(Kin->Conversions, 30000);
+
+  // the chunked integral agrees with the integral of the sample in memory
+  BOOST_CHECK_CLOSE(
+      ComPWA::Tools::integrate(Fit.Gauss, *Phsp, 2.0),
+      ComPWA::Tools::integrate(
+          Fit.Gauss,
+          std::make_shared<ComPWA::Data::DataSet>(Fit.PhspDataPoints), 2.0),
+      1e-10);
+
+  // another sample of the same file uses the existing cache file
+  ComPWA::Data::ChunkedDataSet SamePhsp(
+      PhspReader, Kin, MemoryBudget, std::vector<bool>{},
+      "MinLogLHEstimatorTest-phsp.kinematics");
+  BOOST_CHECK_CLOSE(ComPWA::Tools::integrate(Fit.Gauss, SamePhsp, 2.0),
+                    ComPWA::Tools::integrate(Fit.Gauss, *Phsp, 2.0), 1e-10);
+  BOOST_CHECK_EQUAL(Kin->Conversions, 30000);
+
+  std::remove("MinLogLHEstimatorTest-data.kinematics");
+  std::remove("MinLogLHEstimatorTest-phsp.kinematics");
+  std::remove("MinLogLHEstimatorTest-data.txt");
+  std::remove("MinLogLHEstimatorTest-phsp.txt");
+}
+
 BOOST_AUTO_TEST_SUITE_END()
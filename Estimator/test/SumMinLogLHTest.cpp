@@ -0,0 +1,95 @@
+// Copyright (c) 2013, 2017 The ComPWA Team.
+// This file is part of the ComPWA framework, check
+// https://github.com/ComPWA/ComPWA/license.txt for details.
+
+#define BOOST_TEST_MODULE Estimator_SumMinLogLHTest
+
+#include <boost/test/unit_test.hpp>
+
+#include "Core/FunctionTree.hpp"
+#include "Core/Logging.hpp"
+#include "Estimator/MinLogLH/SumMinLogLH.hpp"
+
+BOOST_AUTO_TEST_SUITE(Estimator_SumMinLogLHTest)
+
+BOOST_AUTO_TEST_CASE(LoadBalancing) {
+  auto Groups = ComPWA::Estimator::balanceLoad({5, 1, 4, 3, 2, 8}, 2);
+  BOOST_CHECK_EQUAL(Groups.size(), 2);
+  // longest processing time first: {8, 3, 1} and {5, 4, 2}
+  std::vector<size_t> First = {5, 3, 1};
+  std::vector<size_t> Second = {0, 2, 4};
+  BOOST_CHECK(Groups[0] == First);
+  BOOST_CHECK(Groups[1] == Second);
+
+  // never more groups than tasks
+  BOOST_CHECK_EQUAL(ComPWA::Estimator::balanceLoad({1.0, 2.0}, 8).size(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(ConcurrentSumTree) {
+  ComPWA::Logging log("output.log", "INFO");
+
+  auto Par = std::make_shared<ComPWA::FitParameter>("a", 2.0);
+  Par->fixParameter(false);
+
+  std::vector<std::shared_ptr<ComPWA::FunctionTree>> Trees;
+  double Expected(0.0);
+  for (unsigned int i = 0; i < 5; ++i) {
+    size_t Size = 1000 * (i + 1);
+    auto Tree = std::make_shared<ComPWA::FunctionTree>(
+        "LH", std::make_shared<ComPWA::Value<double>>(),
+        std::make_shared<ComPWA::AddAll>(ComPWA::ParType::DOUBLE));
+    Tree->createNode(
+        "Mult", ComPWA::MDouble("", Size),
+        std::make_shared<ComPWA::MultAll>(ComPWA::ParType::MDOUBLE), "LH");
+    Tree->createLeaf("Data", ComPWA::MDouble("", Size, 1.0 + i), "Mult");
+    Tree->createLeaf("a", Par, "Mult");
+    Trees.push_back(Tree);
+    Expected += Size * (1.0 + i);
+  }
+
+  auto Sum =
+      ComPWA::Estimator::createSumMinLogLHEstimatorFunctionTree(Trees, 3);
+  auto Result = std::dynamic_pointer_cast<ComPWA::Value<double>>(
+      Sum->parameter());
+  BOOST_CHECK_CLOSE(Result->value(), 2.0 * Expected, 1e-10);
+
+  // a parameter change has to be propagated through all threads
+  Par->setValue(3.0);
+  Result = std::dynamic_pointer_cast<ComPWA::Value<double>>(Sum->parameter());
+  BOOST_CHECK_CLOSE(Result->value(), 3.0 * Expected, 1e-10);
+}
+
+BOOST_AUTO_TEST_CASE(SharedSubTree) {
+  ComPWA::Logging log("output.log", "INFO");
+
+  // both log likelihoods contain the same Norm node
+  auto createTrees = []() {
+    auto Shared = std::make_shared<ComPWA::FunctionTree>(
+        "Norm", std::make_shared<ComPWA::Value<double>>(),
+        std::make_shared<ComPWA::AddAll>(ComPWA::ParType::DOUBLE));
+    Shared->createLeaf("Data", ComPWA::MDouble("", 100, 1.0), "Norm");
+
+    std::vector<std::shared_ptr<ComPWA::FunctionTree>> Trees;
+    for (unsigned int i = 0; i < 2; ++i) {
+      auto Tree = std::make_shared<ComPWA::FunctionTree>(
+          "LH", std::make_shared<ComPWA::Value<double>>(),
+          std::make_shared<ComPWA::AddAll>(ComPWA::ParType::DOUBLE));
+      Tree->insertTree(Shared, "LH");
+      Trees.push_back(Tree);
+    }
+    return Trees;
+  };
+  BOOST_CHECK_THROW(
+      ComPWA::Estimator::createSumMinLogLHEstimatorFunctionTree(createTrees(),
+                                                                2),
+      std::runtime_error);
+
+  // sequential evaluation is fine
+  auto Sum =
+      ComPWA::Estimator::createSumMinLogLHEstimatorFunctionTree(createTrees());
+  auto Result = std::dynamic_pointer_cast<ComPWA::Value<double>>(
+      Sum->parameter());
+  BOOST_CHECK_CLOSE(Result->value(), 200.0, 1e-10);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
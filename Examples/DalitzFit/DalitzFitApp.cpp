@@ -214,6 +214,9 @@ int main(int argc, char **argv) {
   ComPWA::Physics::IntensityBuilderXML Builder(phspSample);
   auto intens =
       Builder.createIntensity(partL, kin, modelTree.get_child("Intensity"));
+  // only the kinematic variables of the model are calculated for the fit
+  kin->setUsedKinematicVariables(ComPWA::Data::findUsedKinematicVariables(
+      *intens, *kin, phspSample->getEventList().front()));
 
   // Pass phsp sample to intensity for normalization.
   // Convert to dataPoints first.
@@ -226,8 +229,9 @@ int main(int argc, char **argv) {
   std::shared_ptr<ComPWA::Data::DataSet> sample =
       ComPWA::Tools::generate(1000, kin, gen, intens, phspSample);
 
-  sample->convertEventsToParameterList(kin);
-  phspSample->convertEventsToParameterList(kin);
+  sample->convertEventsToParameterList(kin, kin->getUsedKinematicVariables());
+  phspSample->convertEventsToParameterList(kin,
+                                           kin->getUsedKinematicVariables());
 
   //---------------------------------------------------
   // 5) Fit the model to the data and print the result
@@ -257,12 +257,17 @@ int main(int argc, char **argv) {
   sqrtS4230._amp = Builder.createIntensity(partL, sqrtS4230._kin,
                                            tmpTr.get_child("Intensity"));
   sqrtS4230._amp->addUniqueParametersTo(fitPar);
+  sqrtS4230._kin->setUsedKinematicVariables(
+      ComPWA::Data::findUsedKinematicVariables(
+          *sqrtS4230._amp, *sqrtS4230._kin,
+          sqrtS4230._mcSample->getEventList().front()));
 
   sqrtS4230._data = ComPWA::Tools::generate(sqrtS4230._nEvents, sqrtS4230._kin,
                                             sqrtS4230._gen, sqrtS4230._amp,
                                             sqrtS4230._mcSample);
 
-  sqrtS4230._mcSample->convertEventsToParameterList(sqrtS4230._kin);
+  sqrtS4230._mcSample->convertEventsToParameterList(
+      sqrtS4230._kin, sqrtS4230._kin->getUsedKinematicVariables());
   auto estimator1 = ComPWA::Estimator::createMinLogLHEstimatorFunctionTree(
       sqrtS4230._amp, sqrtS4230._data, sqrtS4230._mcSample);
   estimator1->head()->print();
@@ -291,12 +296,17 @@ int main(int argc, char **argv) {
   sqrtS4260._amp = Builder.createIntensity(partL, sqrtS4260._kin,
                                            tmpTr.get_child("Intensity"));
   sqrtS4260._amp->addUniqueParametersTo(fitPar);
+  sqrtS4260._kin->setUsedKinematicVariables(
+      ComPWA::Data::findUsedKinematicVariables(
+          *sqrtS4260._amp, *sqrtS4260._kin,
+          sqrtS4260._mcSample->getEventList().front()));
 
   sqrtS4260._data = ComPWA::Tools::generate(sqrtS4260._nEvents, sqrtS4260._kin,
                                             sqrtS4260._gen, sqrtS4260._amp,
                                             sqrtS4260._mcSample);
 
-  sqrtS4260._mcSample->convertEventsToParameterList(sqrtS4260._kin);
+  sqrtS4260._mcSample->convertEventsToParameterList(
+      sqrtS4260._kin, sqrtS4260._kin->getUsedKinematicVariables());
   auto estimator2 = ComPWA::Estimator::createMinLogLHEstimatorFunctionTree(
       sqrtS4260._amp, sqrtS4260._data, sqrtS4260._mcSample);
   estimator2->head()->print();
@@ -2,6 +2,7 @@
 // This file is part of the ComPWA framework, check
 // https://github.com/ComPWA/ComPWA/license.txt for details.
 
+#include <cmath>
 #include <ctime>
 #include <iostream>
 #include <memory>
@@ -23,6 +24,7 @@
 #include "Core/FitParameter.hpp"
 #include "Core/FitResult.hpp"
 #include "Core/ParameterList.hpp"
+#include "Estimator/Estimator.hpp"
 #include "Optimizer/Minuit2/MinuitIF.hpp"
 
 using namespace ComPWA::Optimizer::Minuit2;
@@ -123,7 +125,6 @@ std::shared_ptr<ComPWA::FitResult> MinuitIF::exec(ParameterList &list) {
   LOG(DEBUG) << "Hesse G2 tolerance: " << strat.HessianG2Tolerance();
 
   // MIGRAD
-  MnMigrad migrad(Function, upar, strat);
   double maxfcn = 0.0;
   double tolerance = 0.1;
 
@@ -139,6 +140,34 @@ std::shared_ptr<ComPWA::FitResult> MinuitIF::exec(ParameterList &list) {
                "maxCalls="
             << maxfcn << " tolerance=" << tolerance;
 
+  // For a ProgressiveEstimator the minimum is approached on the coarse
+  // precision levels with a looser tolerance. Each level starts from the
+  // minimum of the previous one. Only the last level (full precision) is
+  // used for the final iterations and for hesse.
+  auto Progressive =
+      std::dynamic_pointer_cast<ComPWA::Estimator::ProgressiveEstimator>(
+          Estimator);
+  if (Progressive && Progressive->numberOfPrecisionLevels() > 1) {
+    MnUserParameterState LevelState(upar);
+    unsigned int NumberOfLevels(Progressive->numberOfPrecisionLevels());
+    for (unsigned int l = 0; l < NumberOfLevels - 1; ++l) {
+      Progressive->setPrecisionLevel(l);
+      double LevelTolerance(tolerance *
+                            std::pow(10.0, double(NumberOfLevels - 1 - l)));
+      MnMigrad LevelMigrad(Function, LevelState, strat);
+      FunctionMinimum LevelMin = LevelMigrad(maxfcn, LevelTolerance);
+      LOG(INFO) << "MinuitIF::exec() | Precision level " << l
+                << " finished: tolerance=" << LevelTolerance
+                << " EDM=" << LevelMin.Edm() << " calls=" << LevelMin.NFcn();
+      LevelState = LevelMin.UserState();
+    }
+    Progressive->setPrecisionLevel(NumberOfLevels - 1);
+    for (unsigned int i = 0; i < upar.Params().size(); ++i) {
+      upar.SetValue(i, LevelState.Value(i));
+      upar.SetError(i, LevelState.Error(i));
+    }
+  }
+  MnMigrad migrad(Function, upar, strat);
   FunctionMinimum minMin = migrad(maxfcn, tolerance); //(maxfcn,tolerance)
 
   LOG(INFO) << "MinuitIF::exec() | Migrad finished! "
@@ -4,8 +4,10 @@
 
 #include <algorithm>
 #include <cmath>
+#include <future>
 #include <numeric>
 #include <stdexcept>
+#include <thread>
 #include <tuple>
 
 #include "Core/Event.hpp"
@@ -13,8 +15,6 @@
 #include "Core/Properties.hpp"
 #include "Physics/HelicityFormalism/HelicityKinematics.hpp"
 
-#include "qft++/Vector4.h"
-
 namespace ComPWA {
 namespace Physics {
 namespace HelicityFormalism {
@@ -50,6 +50,22 @@ HelicityKinematics::HelicityKinematics(
 
 double HelicityKinematics::phspVolume() const { return PhspVolume; }
 
+std::string HelicityKinematics::configuration() const {
+  std::stringstream ss;
+  ss.precision(17);
+  ss << KinematicsInfo << " " << KinematicsInfo.getInitialStateFourMomentum()
+     << " masses:";
+  for (auto x : KinematicsInfo.getFinalStateMasses())
+    ss << " " << x;
+  ss << " positions:";
+  for (unsigned int i = 0; i < KinematicsInfo.getFinalStateParticleCount(); ++i)
+    ss << " " << KinematicsInfo.convertPositionIndexToFinalStateID(i);
+  ss << " subsystems:";
+  for (auto const &x : Subsystems)
+    ss << " " << x;
+  return ss.str();
+}
+
 bool HelicityKinematics::isWithinPhaseSpace(const DataPoint &point) const {
   unsigned int subSystemID = 0;
   unsigned int pos = 0;
@@ -80,11 +96,278 @@ DataPoint HelicityKinematics::convert(const Event &event) const {
                   "requested before. Therefore this function is doing nothing!";
   }
   DataPoint point;
-  for (unsigned int i = 0; i < Subsystems.size(); i++)
-    convert(event, point, Subsystems.at(i), InvMassBounds.at(i));
+  point.KinematicVariableList.resize(numVariables());
+  std::vector<double *> Output;
+  for (auto &x : point.KinematicVariableList)
+    Output.push_back(&x);
+  std::vector<FourVector> Momenta;
+  for (auto const &x : event.ParticleList)
+    Momenta.push_back(x.fourVector());
+  std::vector<FourVector> SumBuffer, BoostBuffer;
+  std::vector<std::array<double, 3>> FrameBuffer;
+  calculateVariables(Momenta.data(), nullptr, SumBuffer, BoostBuffer,
+                     FrameBuffer, Output.data(), 0);
+  point.Weight = event.Weight;
   return point;
 }
 
+void HelicityKinematics::convert(const std::vector<Event> &Events,
+                                 std::vector<std::vector<double>> &Columns,
+                                 std::vector<double> &Weights) const {
+  convert(PackedEvents(Events), std::vector<bool>(numVariables(), true),
+          Columns, Weights);
+}
+
+void HelicityKinematics::convert(const std::vector<Event> &Events,
+                                 const std::vector<bool> &Variables,
+                                 std::vector<std::vector<double>> &Columns,
+                                 std::vector<double> &Weights) const {
+  convert(PackedEvents(Events), Variables, Columns, Weights);
+}
+
+void HelicityKinematics::convert(const PackedEvents &Events,
+                                 std::vector<std::vector<double>> &Columns,
+                                 std::vector<double> &Weights) const {
+  convert(Events, std::vector<bool>(numVariables(), true), Columns, Weights);
+}
+
+void HelicityKinematics::convert(const PackedEvents &Events,
+                                 const std::vector<bool> &Variables,
+                                 std::vector<std::vector<double>> &Columns,
+                                 std::vector<double> &Weights) const {
+  if (!Subsystems.size()) {
+    LOG(ERROR) << "HelicityKinematics::convert() | No variables were "
+                  "requested before. Therefore this function is doing nothing!";
+  }
+  if (Variables.size() != numVariables())
+    throw std::runtime_error("HelicityKinematics::convert(): number of "
+                             "variable flags does not match!");
+  size_t NumberOfEvents(Events.size());
+  PlanSelection Selection(selectConversionPlan(Variables));
+  // the columns of unused variables stay empty
+  Columns.assign(numVariables(), std::vector<double>());
+  std::vector<double *> Output;
+  for (size_t i = 0; i < Columns.size(); ++i) {
+    if (Selection.Variables[i])
+      Columns[i].resize(NumberOfEvents);
+    Output.push_back(Columns[i].data());
+  }
+  Weights = Events.Weights;
+
+  // each task fills a contiguous range of all columns
+  auto convertRange = [&](size_t Begin, size_t End) {
+    std::vector<FourVector> SumBuffer, BoostBuffer;
+    std::vector<std::array<double, 3>> FrameBuffer;
+    for (size_t i = Begin; i < End; ++i) {
+      calculateVariables(Events.event(i), &Selection, SumBuffer, BoostBuffer,
+                         FrameBuffer, Output.data(), i);
+    }
+  };
+
+  size_t NumberOfTasks(std::max<size_t>(
+      1, std::min<size_t>(std::thread::hardware_concurrency(),
+                          NumberOfEvents / 10000)));
+  std::vector<std::future<void>> Results;
+  for (size_t i = 0; i < NumberOfTasks; ++i)
+    Results.push_back(std::async(std::launch::async, convertRange,
+                                 i * NumberOfEvents / NumberOfTasks,
+                                 (i + 1) * NumberOfEvents / NumberOfTasks));
+  for (auto &x : Results)
+    x.wait();
+  for (auto &x : Results)
+    x.get();
+}
+
+HelicityKinematics::PlanSelection HelicityKinematics::selectConversionPlan(
+    const std::vector<bool> &Variables) const {
+  PlanSelection Selection;
+  Selection.Variables = std::vector<char>(Variables.begin(), Variables.end());
+  Selection.Sums = std::vector<char>(Plan.MomentumSums.size(), 0);
+  Selection.Boosts = std::vector<char>(Plan.Boosts.size(), 0);
+  Selection.Frames = std::vector<char>(Plan.Frames.size(), 0);
+
+  // go backwards through the dependencies: variables -> frames -> boosts ->
+  // sums
+  for (size_t k = 0; k < Plan.SubSystems.size(); ++k) {
+    auto const &Entry = Plan.SubSystems[k];
+    if (Selection.Variables[3 * k])
+      Selection.Sums[Entry.DecayingState] = 1;
+    if (Selection.Variables[3 * k + 1] || Selection.Variables[3 * k + 2]) {
+      Selection.Boosts[Entry.Daughter] = 1;
+      if (Entry.Frame >= 0)
+        Selection.Frames[Entry.Frame] = 1;
+    }
+  }
+  for (size_t i = 0; i < Plan.Frames.size(); ++i) {
+    if (Selection.Frames[i]) {
+      Selection.Boosts[Plan.Frames[i].first] = 1;
+      Selection.Boosts[Plan.Frames[i].second] = 1;
+    }
+  }
+  for (size_t i = 0; i < Plan.Boosts.size(); ++i) {
+    if (Selection.Boosts[i]) {
+      if (Plan.Boosts[i].first >= 0)
+        Selection.Sums[Plan.Boosts[i].first] = 1;
+      Selection.Sums[Plan.Boosts[i].second] = 1;
+    }
+  }
+  // sums only depend on sums with a lower index
+  for (size_t i = Plan.MomentumSums.size(); i-- > 0;) {
+    auto const &Sum = Plan.MomentumSums[i];
+    if (Selection.Sums[i] && Sum.second >= 0) {
+      Selection.Sums[Sum.first] = 1;
+      Selection.Sums[Sum.second] = 1;
+    }
+  }
+  return Selection;
+}
+
+void HelicityKinematics::calculateVariables(
+    const FourVector *Momenta, const PlanSelection *Selection,
+    std::vector<FourVector> &SumBuffer, std::vector<FourVector> &BoostBuffer,
+    std::vector<std::array<double, 3>> &FrameBuffer, double *const *Output,
+    size_t Position) const {
+  // all sums start from zero, like the sums in the per SubSystem calculation
+  SumBuffer.resize(Plan.MomentumSums.size());
+  for (size_t i = 0; i < Plan.MomentumSums.size(); ++i) {
+    if (Selection && !Selection->Sums[i])
+      continue;
+    auto const &Sum = Plan.MomentumSums[i];
+    if (Sum.second < 0) {
+      SumBuffer[i] = FourVector(0, 0, 0, 0);
+      SumBuffer[i] += Momenta[Sum.first];
+    } else {
+      SumBuffer[i] = SumBuffer[Sum.first] + SumBuffer[Sum.second];
+    }
+  }
+
+  BoostBuffer.resize(Plan.Boosts.size());
+  for (size_t i = 0; i < Plan.Boosts.size(); ++i) {
+    if (Selection && !Selection->Boosts[i])
+      continue;
+    auto const &Boost = Plan.Boosts[i];
+    // in case there is no parent recoil, it is artificially along z
+    BoostBuffer[i] =
+        Boost.first < 0 ? FourVector(0, 0, 1.0, 0) : SumBuffer[Boost.first];
+    BoostBuffer[i].boostToRestFrame(SumBuffer[Boost.second]);
+  }
+
+  // rotation angles of the helicity frames: (phi, pi - theta) of the recoil
+  // and pi - phi of the rotated parent recoil
+  FrameBuffer.resize(Plan.Frames.size());
+  for (size_t i = 0; i < Plan.Frames.size(); ++i) {
+    if (Selection && !Selection->Frames[i])
+      continue;
+    auto const &Recoil = BoostBuffer[Plan.Frames[i].first];
+    FrameBuffer[i][0] = Recoil.phi();
+    FrameBuffer[i][1] = M_PI - Recoil.theta();
+
+    FourVector ParentRecoil(BoostBuffer[Plan.Frames[i].second]);
+    ParentRecoil.rotateZ(-FrameBuffer[i][0]);
+    ParentRecoil.rotateY(FrameBuffer[i][1]);
+    FrameBuffer[i][2] = M_PI - ParentRecoil.phi();
+  }
+
+  for (size_t k = 0; k < Plan.SubSystems.size(); ++k) {
+    auto const &Entry = Plan.SubSystems[k];
+    if (!Selection || Selection->Variables[3 * k])
+      Output[3 * k][Position] = SumBuffer[Entry.DecayingState].invMassSq();
+    if (Selection && !Selection->Variables[3 * k + 1] &&
+        !Selection->Variables[3 * k + 2])
+      continue;
+    FourVector Daughter(BoostBuffer[Entry.Daughter]);
+    if (Entry.Frame >= 0) {
+      auto const &Angles = FrameBuffer[Entry.Frame];
+      // rotate vectors so that recoil moves in the negative z-axis direction
+      Daughter.rotateZ(-Angles[0]);
+      Daughter.rotateY(Angles[1]);
+      // rotate around the z-axis so that the parent recoil lies in the x-z
+      // plane
+      Daughter.rotateZ(Angles[2]);
+    }
+    if (!Selection || Selection->Variables[3 * k + 1])
+      Output[3 * k + 1][Position] = std::acos(Daughter.cosTheta());
+    if (!Selection || Selection->Variables[3 * k + 2])
+      Output[3 * k + 2][Position] = Daughter.phi();
+  }
+}
+
+int HelicityKinematics::momentumSumID(int Left, int Right) {
+  auto Key = std::make_pair(Left, Right);
+  auto Found = Plan.SumPairIDs.find(Key);
+  if (Found != Plan.SumPairIDs.end())
+    return Found->second;
+  int ID(Plan.MomentumSums.size());
+  Plan.MomentumSums.push_back(Key);
+  Plan.SumPairIDs[Key] = ID;
+  return ID;
+}
+
+int HelicityKinematics::momentumSumID(const IndexList &Indices) {
+  // a sum is identified by the set of particles, independent of the order
+  IndexList SortedIndices(Indices);
+  std::sort(SortedIndices.begin(), SortedIndices.end());
+  auto Found = Plan.MomentumSumIDs.find(SortedIndices);
+  if (Found != Plan.MomentumSumIDs.end())
+    return Found->second;
+  int ID;
+  if (1 == SortedIndices.size()) {
+    ID = momentumSumID(SortedIndices.front(), -1);
+  } else {
+    // the particles are added one after the other, so that sums with the
+    // same leading particles are shared
+    int Prefix(momentumSumID(
+        IndexList(SortedIndices.begin(), SortedIndices.end() - 1)));
+    ID = momentumSumID(Prefix, momentumSumID(IndexList{SortedIndices.back()}));
+  }
+  Plan.MomentumSumIDs[SortedIndices] = ID;
+  return ID;
+}
+
+int HelicityKinematics::boostID(int Sum, int Frame) {
+  auto Key = std::make_pair(Sum, Frame);
+  auto Found = Plan.BoostIDs.find(Key);
+  if (Found != Plan.BoostIDs.end())
+    return Found->second;
+  int ID(Plan.Boosts.size());
+  Plan.Boosts.push_back(Key);
+  Plan.BoostIDs[Key] = ID;
+  return ID;
+}
+
+int HelicityKinematics::frameID(int Recoil, int ParentRecoil) {
+  auto Key = std::make_pair(Recoil, ParentRecoil);
+  auto Found = Plan.FrameIDs.find(Key);
+  if (Found != Plan.FrameIDs.end())
+    return Found->second;
+  int ID(Plan.Frames.size());
+  Plan.Frames.push_back(Key);
+  Plan.FrameIDs[Key] = ID;
+  return ID;
+}
+
+void HelicityKinematics::addToConversionPlan(const IndexListTuple &Indices) {
+  ConversionPlan::SubSystemEntry Entry;
+  int FinalA(momentumSumID(std::get<0>(Indices)));
+  // the decaying state is the same for all splittings into A and B
+  IndexList DecayingState(std::get<0>(Indices));
+  DecayingState.insert(DecayingState.end(), std::get<1>(Indices).begin(),
+                       std::get<1>(Indices).end());
+  Entry.DecayingState = momentumSumID(DecayingState);
+  Entry.Daughter = boostID(FinalA, Entry.DecayingState);
+  Entry.Frame = -1;
+  if (std::get<2>(Indices).size() > 0) {
+    int Recoil(
+        boostID(momentumSumID(std::get<2>(Indices)), Entry.DecayingState));
+    int ParentRecoil(-1);
+    if (std::get<3>(Indices).size() > 0)
+      ParentRecoil = momentumSumID(std::get<3>(Indices));
+    Entry.Frame =
+        frameID(Recoil, boostID(ParentRecoil, Entry.DecayingState));
+  }
+  Plan.SubSystems.push_back(Entry);
+}
+
 void HelicityKinematics::convert(const Event &event, DataPoint &point,
                                  const SubSystem &sys) const {
   auto massLimits = invMassBounds(sys);
@@ -166,9 +449,11 @@ void HelicityKinematics::createAllSubsystems() {
       }
     }
   }
+  // the variables are only calculated in a batch conversion if no other
+  // variables are used, see useVariable()
   for (auto const &x : AllSubsystems) {
-    addSubSystem(std::get<0>(x), std::get<1>(x), std::get<2>(x),
-                 std::get<3>(x));
+    registerSubSystem(subSystemFromPositionIndices(
+        std::get<0>(x), std::get<1>(x), std::get<2>(x), std::get<3>(x)));
   }
 }
 
@@ -216,7 +501,18 @@ HelicityKinematics::redistributeIndexLists(const IndexList &A,
   return NewIndexLists;
 }
 
-unsigned int HelicityKinematics::addSubSystem(const SubSystem &subSys) {
+unsigned int HelicityKinematics::addSubSystem(const SubSystem &subSys,
+                                              bool UseAngles) {
+  unsigned int pos(registerSubSystem(subSys));
+  useVariable(3 * pos);
+  if (UseAngles) {
+    useVariable(3 * pos + 1);
+    useVariable(3 * pos + 2);
+  }
+  return pos;
+}
+
+unsigned int HelicityKinematics::registerSubSystem(const SubSystem &subSys) {
   // We calculate the variables currently for two-body decays
   if (subSys.getFinalStates().size() != 2) {
     std::stringstream ss;
@@ -230,11 +526,13 @@ unsigned int HelicityKinematics::addSubSystem(const SubSystem &subSys) {
   if (result == Subsystems.end()) {
     Subsystems.push_back(subSys);
     InvMassBounds.push_back(calculateInvMassBounds(subSys));
+    addToConversionPlan(positionIndices(subSys));
     std::stringstream ss;
     ss << subSys;
     VariableNames.push_back("mSq" + ss.str());
     VariableNames.push_back("theta" + ss.str());
     VariableNames.push_back("phi" + ss.str());
+    UsedVariables.resize(VariableNames.size(), false);
   } else {
     pos = result - Subsystems.begin();
   }
@@ -246,6 +544,38 @@ unsigned int HelicityKinematics::addSubSystem(
     const std::vector<unsigned int> &FinalB,
     const std::vector<unsigned int> &Recoil,
     const std::vector<unsigned int> &ParentRecoil) {
+  return addSubSystem(
+      subSystemFromPositionIndices(FinalA, FinalB, Recoil, ParentRecoil));
+}
+
+void HelicityKinematics::useVariable(unsigned int Position) {
+  if (Position >= UsedVariables.size())
+    throw std::out_of_range("HelicityKinematics::useVariable(): variable " +
+                            std::to_string(Position) + " does not exist!");
+  UsedVariables[Position] = true;
+}
+
+std::vector<bool> HelicityKinematics::getUsedKinematicVariables() const {
+  // without any information about the model all variables are calculated
+  if (std::find(UsedVariables.begin(), UsedVariables.end(), true) ==
+      UsedVariables.end())
+    return std::vector<bool>(numVariables(), true);
+  return UsedVariables;
+}
+
+void HelicityKinematics::setUsedKinematicVariables(
+    const std::vector<bool> &Variables) {
+  if (Variables.size() != UsedVariables.size())
+    throw std::runtime_error("HelicityKinematics::setUsedKinematicVariables(): "
+                             "number of variable flags does not match!");
+  UsedVariables = Variables;
+}
+
+SubSystem HelicityKinematics::subSystemFromPositionIndices(
+    const std::vector<unsigned int> &FinalA,
+    const std::vector<unsigned int> &FinalB,
+    const std::vector<unsigned int> &Recoil,
+    const std::vector<unsigned int> &ParentRecoil) const {
   std::vector<std::vector<unsigned int>> ConvertedFinalStates;
   ConvertedFinalStates.push_back(
       KinematicsInfo.convertPositionIndexToFinalStateID(FinalA));
@@ -258,8 +588,8 @@ unsigned int HelicityKinematics::addSubSystem(
   std::vector<unsigned int> ConvertedParentRecoil =
       KinematicsInfo.convertPositionIndexToFinalStateID(ParentRecoil);
 
-  return addSubSystem(
-      SubSystem(ConvertedFinalStates, ConvertedRecoil, ConvertedParentRecoil));
+  return SubSystem(ConvertedFinalStates, ConvertedRecoil,
+                   ConvertedParentRecoil);
 }
 
 double HelicityKinematics::helicityAngle(double M, double m, double m2,
@@ -303,75 +633,80 @@ double HelicityKinematics::helicityAngle(double M, double m, double m2,
 void HelicityKinematics::convert(const Event &event, DataPoint &point,
                                  const SubSystem &sys,
                                  const std::pair<double, double> limits) const {
-  FourMomentum FinalA, FinalB;
-  for (auto s : sys.getFinalStates().at(0)) {
-    unsigned int index = KinematicsInfo.convertFinalStateIDToPositionIndex(s);
-    FinalA += event.ParticleList[index].fourMomentum();
-  }
+  double mSq, Theta, Phi;
+  calculateVariables(event, positionIndices(sys), mSq, Theta, Phi);
 
-  for (auto s : sys.getFinalStates().at(1)) {
-    unsigned int index = KinematicsInfo.convertFinalStateIDToPositionIndex(s);
-    FinalB += event.ParticleList[index].fourMomentum();
-  }
+  point.Weight = event.Weight;
+  point.KinematicVariableList.push_back(mSq);
+  point.KinematicVariableList.push_back(Theta);
+  point.KinematicVariableList.push_back(Phi);
+}
 
-  // Four momentum of the decaying resonance
-  FourMomentum State = FinalA + FinalB;
-  double mSq = State.invMassSq();
+HelicityKinematics::IndexListTuple
+HelicityKinematics::positionIndices(const SubSystem &sys) const {
+  return std::make_tuple(KinematicsInfo.convertFinalStateIDToPositionIndex(
+                             sys.getFinalStates().at(0)),
+                         KinematicsInfo.convertFinalStateIDToPositionIndex(
+                             sys.getFinalStates().at(1)),
+                         KinematicsInfo.convertFinalStateIDToPositionIndex(
+                             sys.getRecoilState()),
+                         KinematicsInfo.convertFinalStateIDToPositionIndex(
+                             sys.getParentRecoilState()));
+}
+
+void HelicityKinematics::calculateVariables(const Event &event,
+                                            const IndexListTuple &Indices,
+                                            double &mSq, double &Theta,
+                                            double &Phi) const {
+  FourVector FinalA(0, 0, 0, 0), FinalB(0, 0, 0, 0);
+  for (auto index : std::get<0>(Indices))
+    FinalA += event.ParticleList[index].fourVector();
 
-  QFT::Vector4<double> DecayingState(State);
-  QFT::Vector4<double> Daughter(FinalA);
+  for (auto index : std::get<1>(Indices))
+    FinalB += event.ParticleList[index].fourVector();
+
+  // Four momentum of the decaying resonance
+  FourVector DecayingState = FinalA + FinalB;
+  mSq = DecayingState.invMassSq();
 
   // the first step is boosting everything into the rest system of the
   // decaying state
-  Daughter.Boost(DecayingState);
+  FourVector Daughter(FinalA);
+  Daughter.boostToRestFrame(DecayingState);
 
   // calculate the recoil and parent recoil
-  auto const &RecoilState = sys.getRecoilState();
+  auto const &RecoilState = std::get<2>(Indices);
   if (RecoilState.size() > 0) {
-    FourMomentum TempRecoil;
-    for (auto s : RecoilState) {
-      unsigned int index = KinematicsInfo.convertFinalStateIDToPositionIndex(s);
-      TempRecoil += event.ParticleList[index].fourMomentum();
-    }
-    QFT::Vector4<double> Recoil(TempRecoil);
-    Recoil.Boost(DecayingState);
+    FourVector Recoil(0, 0, 0, 0);
+    for (auto index : RecoilState)
+      Recoil += event.ParticleList[index].fourVector();
+    Recoil.boostToRestFrame(DecayingState);
 
     // rotate vectors so that recoil moves in the negative z-axis direction
-    Daughter.RotateZ(-Recoil.Phi());
-    Daughter.RotateY(M_PI - Recoil.Theta());
+    Daughter.rotateZ(-Recoil.phi());
+    Daughter.rotateY(M_PI - Recoil.theta());
 
-    auto const &ParentRecoilState = sys.getParentRecoilState();
-    QFT::Vector4<double> ParentRecoil;
+    auto const &ParentRecoilState = std::get<3>(Indices);
+    // in case there is no parent recoil, it is artificially along z
+    FourVector ParentRecoil(0, 0, 1.0, 0);
     if (ParentRecoilState.size() > 0) {
-      FourMomentum TempParentRecoil;
-      for (auto s : ParentRecoilState) {
-        unsigned int index =
-            KinematicsInfo.convertFinalStateIDToPositionIndex(s);
-        TempParentRecoil += event.ParticleList[index].fourMomentum();
-      }
-      ParentRecoil = TempParentRecoil;
-    } else {
-      // in case there is no parent recoil, it is artificially along z
-      ParentRecoil.SetP4(0, 0, 0, 1.0);
+      ParentRecoil = FourVector(0, 0, 0, 0);
+      for (auto index : ParentRecoilState)
+        ParentRecoil += event.ParticleList[index].fourVector();
     }
 
-    ParentRecoil.Boost(DecayingState);
+    ParentRecoil.boostToRestFrame(DecayingState);
 
-    ParentRecoil.RotateZ(-Recoil.Phi());
-    ParentRecoil.RotateY(M_PI - Recoil.Theta());
+    ParentRecoil.rotateZ(-Recoil.phi());
+    ParentRecoil.rotateY(M_PI - Recoil.theta());
 
     // rotate around the z-axis so that the parent recoil lies in the x-z
     // plane
-    Daughter.RotateZ(M_PI - ParentRecoil.Phi());
+    Daughter.rotateZ(M_PI - ParentRecoil.phi());
   }
 
-  double cosTheta = Daughter.CosTheta();
-  double phi = Daughter.Phi();
-
-  point.Weight = event.Weight;
-  point.KinematicVariableList.push_back(mSq);
-  point.KinematicVariableList.push_back(std::acos(cosTheta));
-  point.KinematicVariableList.push_back(phi);
+  Theta = std::acos(Daughter.cosTheta());
+  Phi = Daughter.phi();
 }
 
 const std::pair<double, double> &
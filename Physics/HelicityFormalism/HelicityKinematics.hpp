@@ -5,6 +5,8 @@
 #ifndef PHYSICS_HELICITYFORMALISM_HELICITYKINEMATICS_HPP_
 #define PHYSICS_HELICITYFORMALISM_HELICITYKINEMATICS_HPP_
 
+#include <array>
+#include <map>
 #include <vector>
 
 #include "Core/Kinematics.hpp"
@@ -90,6 +92,30 @@ public:
   /// the variables are calculated that are used by the model.
   DataPoint convert(const Event &event) const;
 
+  /// Batch conversion of \p Events into the columns of the kinematic
+  /// variables. The event ranges are processed in parallel and the position
+  /// indices of the SubSystems are precomputed, but the variables are
+  /// identical to convert(const Event &).
+  void convert(const std::vector<Event> &Events,
+               std::vector<std::vector<double>> &Columns,
+               std::vector<double> &Weights) const;
+
+  /// Batch conversion of the variables with set flag in \p Variables, the
+  /// other columns are left empty.
+  void convert(const std::vector<Event> &Events,
+               const std::vector<bool> &Variables,
+               std::vector<std::vector<double>> &Columns,
+               std::vector<double> &Weights) const;
+
+  /// Batch conversion of events in the packed layout.
+  void convert(const PackedEvents &Events,
+               std::vector<std::vector<double>> &Columns,
+               std::vector<double> &Weights) const;
+
+  void convert(const PackedEvents &Events, const std::vector<bool> &Variables,
+               std::vector<std::vector<double>> &Columns,
+               std::vector<double> &Weights) const override;
+
   /// Fill \p point with variables for \p sys.
   /// The triple (\f$m^2, cos\Theta, \phi\f$) is added to dataPoint for
   /// SubSystem \p sys. Invariant mass limits of the SubSystem can be given via
@@ -122,12 +148,16 @@ public:
   /// Get ID of data for \p subSys.
   unsigned int getDataID(const SubSystem &subSys) const;
 
+  /// Adds all possible SubSystems of the decay. Their variables are not
+  /// marked as used, so that they are only calculated by the batch conversion
+  /// if no model variables are known (see useVariable()).
   void createAllSubsystems();
 
   /// Add \p newSys to list of SubSystems and return its ID.
   /// In case that this SubSystem is already in the list only the ID is
-  /// returned.
-  unsigned int addSubSystem(const SubSystem &newSys);
+  /// returned. The invariant mass and, if \p UseAngles is set, the helicity
+  /// angles of the SubSystem are marked as used.
+  unsigned int addSubSystem(const SubSystem &newSys, bool UseAngles = true);
 
   /// Add SubSystem from \p pos indices of final state particles
   unsigned int addSubSystem(const std::vector<unsigned int> &FinalA,
@@ -135,6 +165,18 @@ public:
                             const std::vector<unsigned int> &Recoil,
                             const std::vector<unsigned int> &ParentRecoil);
 
+  /// Mark the variable at \p Position as used by the model.
+  /// Once a variable is marked, the batch conversion only calculates the
+  /// marked variables. E.g. for a spin zero resonance the helicity angles are
+  /// not needed.
+  void useVariable(unsigned int Position);
+
+  /// Variables which are marked as used or all variables if none is marked.
+  std::vector<bool> getUsedKinematicVariables() const override;
+
+  /// Replaces the marks of useVariable() by \p Variables.
+  void setUsedKinematicVariables(const std::vector<bool> &Variables) override;
+
   /// Get SubSystem from \p pos in list
   SubSystem subSystem(unsigned int pos) const { return Subsystems.at(pos); }
 
@@ -161,6 +203,9 @@ public:
 
   double phspVolume() const;
 
+  /// Reaction, masses, event positions and SubSystems
+  std::string configuration() const;
+
   const ParticleStateTransitionKinematicsInfo &
   getParticleStateTransitionKinematicsInfo() const {
     return KinematicsInfo;
@@ -177,10 +222,96 @@ private:
   /// Invariant mass bounds for each SubSystem
   std::vector<std::pair<double, double>> InvMassBounds;
 
+  ///
+  /// Evaluation plan of the variables of all SubSystems. The four-momentum
+  /// sums and the boosts into the rest frames of the decaying states are
+  /// shared by many SubSystems (e.g. after createAllSubsystems()). The plan
+  /// contains each of them only once, so that they are calculated once per
+  /// event.
+  ///
+  struct ConversionPlan {
+    /// Four-momentum sums. A sum with Right < 0 is the final state particle
+    /// at event position Left, otherwise it is the sum of the sums Left and
+    /// Right. Sums only depend on sums with a lower index.
+    std::vector<std::pair<int, int>> MomentumSums;
+    /// Boosts of the sum \p first into the rest frame of the sum \p second.
+    /// \p first < 0 is the artificial parent recoil along the z-axis.
+    std::vector<std::pair<int, int>> Boosts;
+
+    /// Helicity frames, defined by the boosted recoil (\p first) and parent
+    /// recoil (\p second). The rotation angles of a frame are shared by all
+    /// SubSystems with the same decaying state, recoil and parent recoil.
+    std::vector<std::pair<int, int>> Frames;
+
+    /// Indices of the sums, boosts and frames which are used for a SubSystem
+    struct SubSystemEntry {
+      int DecayingState;
+      int Daughter;
+      /// < 0 if the SubSystem has no recoil
+      int Frame;
+    };
+    std::vector<SubSystemEntry> SubSystems;
+
+    std::map<IndexList, int> MomentumSumIDs;
+    std::map<std::pair<int, int>, int> SumPairIDs;
+    std::map<std::pair<int, int>, int> BoostIDs;
+    std::map<std::pair<int, int>, int> FrameIDs;
+  };
+  ConversionPlan Plan;
+
+  /// Flags of the sums, boosts, frames and variables of the ConversionPlan
+  /// which are needed for the used variables
+  struct PlanSelection {
+    std::vector<char> Sums;
+    std::vector<char> Boosts;
+    std::vector<char> Frames;
+    std::vector<char> Variables;
+  };
+  PlanSelection selectConversionPlan(const std::vector<bool> &Variables) const;
+
+  /// Variables which are marked by useVariable()
+  std::vector<bool> UsedVariables;
+
+  /// Adds \p newSys without marking its variables as used.
+  unsigned int registerSubSystem(const SubSystem &newSys);
+
+  SubSystem subSystemFromPositionIndices(
+      const std::vector<unsigned int> &FinalA,
+      const std::vector<unsigned int> &FinalB,
+      const std::vector<unsigned int> &Recoil,
+      const std::vector<unsigned int> &ParentRecoil) const;
+
+  /// Adds the SubSystem with the event position indices \p Indices of the
+  /// final state A, final state B, recoil and parent recoil particles.
+  void addToConversionPlan(const IndexListTuple &Indices);
+  int momentumSumID(const IndexList &Indices);
+  int momentumSumID(int Left, int Right);
+  int boostID(int Sum, int Frame);
+  int frameID(int Recoil, int ParentRecoil);
+
+  /// Calculates the variables of all SubSystems of the event with the four
+  /// momenta \p Momenta (in event position order) using the
+  /// ConversionPlan. Variable j is stored at \p Output[j][\p Position].
+  /// Only the parts in \p Selection are calculated, all if it is nullptr.
+  /// The buffers are work space.
+  void calculateVariables(const FourVector *Momenta,
+                          const PlanSelection *Selection,
+                          std::vector<FourVector> &SumBuffer,
+                          std::vector<FourVector> &BoostBuffer,
+                          std::vector<std::array<double, 3>> &FrameBuffer,
+                          double *const *Output, size_t Position) const;
+
   std::vector<std::string> VariableNames;
 
   std::pair<double, double> calculateInvMassBounds(const SubSystem &sys) const;
 
+  IndexListTuple positionIndices(const SubSystem &sys) const;
+
+  /// Calculates (\f$m^2, \Theta, \phi\f$) of \p event for the SubSystem
+  /// with the position indices \p Indices.
+  void calculateVariables(const Event &event, const IndexListTuple &Indices,
+                          double &mSq, double &Theta, double &Phi) const;
+
   IndexListTuple sortSubsystem(const IndexListTuple &SubSys) const;
   std::vector<std::pair<IndexList, IndexList>>
   redistributeIndexLists(const IndexList &A, const IndexList &B) const;
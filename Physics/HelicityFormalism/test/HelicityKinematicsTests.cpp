@@ -5,10 +5,15 @@
 // Define Boost test module
 #define BOOST_TEST_MODULE HelicityFormalism
 
+#include <cmath>
+#include <map>
+
 #include <boost/property_tree/ptree.hpp>
 #include <boost/property_tree/xml_parser.hpp>
 #include <boost/test/unit_test.hpp>
 
+#include "Core/PhspGenerator.hpp"
+#include "Data/DataSet.hpp"
 #include "Physics/HelicityFormalism/HelicityKinematics.hpp"
 
 const std::string HelicityTestParticles = R"####(
@@ -82,4 +87,191 @@ BOOST_AUTO_TEST_CASE(CreateAllSubsystems) {
   BOOST_CHECK_EQUAL(kin3->subSystems().size(), 270);
 }
 
+BOOST_AUTO_TEST_CASE(UsedVariables) {
+  ComPWA::Logging log("", "debug");
+
+  boost::property_tree::ptree tr;
+  std::stringstream modelStream;
+  modelStream << HelicityTestParticles;
+  boost::property_tree::xml_parser::read_xml(modelStream, tr);
+  auto partL = std::make_shared<ComPWA::PartList>();
+  ComPWA::ReadParticles(partL, tr);
+
+  std::vector<int> initialState{443}, finalState{22, 111, 111};
+  auto kin =
+      std::make_shared<ComPWA::Physics::HelicityFormalism::HelicityKinematics>(
+          partL, initialState, finalState);
+  kin->createAllSubsystems();
+  // without a model all variables are calculated
+  auto UsedVariables = kin->getUsedKinematicVariables();
+  BOOST_CHECK_EQUAL(std::count(UsedVariables.begin(), UsedVariables.end(), true),
+                    18);
+
+  // spin zero resonance: only the invariant mass is needed
+  unsigned int SubSystemID(
+      kin->addSubSystem(ComPWA::Physics::SubSystem({{1}, {2}}, {0}, {}),
+                        false));
+  UsedVariables = kin->getUsedKinematicVariables();
+  BOOST_CHECK_EQUAL(std::count(UsedVariables.begin(), UsedVariables.end(), true),
+                    1);
+  BOOST_CHECK(UsedVariables[3 * SubSystemID]);
+
+  ComPWA::Event Event;
+  Event.ParticleList.push_back(ComPWA::Particle(0.1, 0.2, 0.3, 1.0));
+  Event.ParticleList.push_back(ComPWA::Particle(-0.3, 0.1, -0.2, 1.0));
+  Event.ParticleList.push_back(ComPWA::Particle(0.2, -0.3, -0.1, 1.1));
+  std::vector<std::vector<double>> Columns;
+  std::vector<double> Weights;
+  auto Point = kin->convert(Event);
+  // by default all variables are calculated
+  kin->convert(std::vector<ComPWA::Event>{Event}, Columns, Weights);
+  BOOST_REQUIRE_EQUAL(Columns.size(), UsedVariables.size());
+  for (size_t i = 0; i < Columns.size(); ++i) {
+    BOOST_REQUIRE_EQUAL(Columns[i].size(), 1);
+    BOOST_CHECK_EQUAL(Columns[i][0], Point.KinematicVariableList[i]);
+  }
+  // only the used variables on request
+  kin->convert(std::vector<ComPWA::Event>{Event}, UsedVariables, Columns,
+               Weights);
+  for (size_t i = 0; i < Columns.size(); ++i) {
+    BOOST_CHECK_EQUAL(Columns[i].size(), UsedVariables[i] ? 1 : 0);
+    if (UsedVariables[i])
+      BOOST_CHECK_EQUAL(Columns[i][0], Point.KinematicVariableList[i]);
+  }
+}
+
+/// The conversion plan shares the four-momentum sums, boosts and frames of
+/// the SubSystems. Its variables have to agree with the ones of the
+/// independent calculation per SubSystem up to rounding.
+BOOST_AUTO_TEST_CASE(ConversionPlanMatchesSubSystems) {
+  ComPWA::Logging log("", "error");
+
+  boost::property_tree::ptree tr;
+  std::stringstream modelStream;
+  modelStream << HelicityTestParticles;
+  boost::property_tree::xml_parser::read_xml(modelStream, tr);
+  auto partL = std::make_shared<ComPWA::PartList>();
+  ComPWA::ReadParticles(partL, tr);
+
+  std::vector<int> initialState{443};
+  for (std::vector<int> finalState :
+       {std::vector<int>{22, 111, 111, 111},
+        std::vector<int>{22, 111, 111, 111, 111}}) {
+    auto kin = std::make_shared<
+        ComPWA::Physics::HelicityFormalism::HelicityKinematics>(
+        partL, initialState, finalState);
+    kin->createAllSubsystems();
+    auto SubSystems = kin->subSystems();
+
+    std::vector<double> Masses(finalState.size(), 0.135);
+    Masses[0] = 0.0;
+    ComPWA::PhspGenerator Generator(ComPWA::FourMomentum(0.0, 0.0, 0.0, 3.097),
+                                    Masses, 4711);
+    std::vector<ComPWA::Event> Events(50);
+    Generator.generateEvents(0, Events.begin(), Events.end());
+
+    std::vector<std::vector<double>> Columns;
+    std::vector<double> Weights;
+    kin->convert(Events, Columns, Weights);
+    BOOST_REQUIRE_EQUAL(Columns.size(), 3 * SubSystems.size());
+
+    for (size_t i = 0; i < Events.size(); ++i) {
+      auto Point = kin->convert(Events[i]);
+      // invariant masses of SubSystems with the same final states are
+      // calculated from the same sum
+      std::map<std::vector<std::vector<unsigned int>>, double> SharedMasses;
+      for (size_t j = 0; j < SubSystems.size(); ++j) {
+        ComPWA::DataPoint Reference;
+        kin->convert(Events[i], Reference, SubSystems[j]);
+        BOOST_REQUIRE_EQUAL(Reference.KinematicVariableList.size(), 3);
+        double mSq(Columns[3 * j][i]);
+        BOOST_CHECK_EQUAL(mSq, Point.KinematicVariableList[3 * j]);
+        BOOST_CHECK_SMALL(mSq - Reference.KinematicVariableList[0], 1e-10);
+        BOOST_CHECK_SMALL(Columns[3 * j + 1][i] -
+                              Reference.KinematicVariableList[1],
+                          1e-6);
+        // phi = -pi and pi are the same angle
+        BOOST_CHECK_SMALL(std::remainder(Columns[3 * j + 2][i] -
+                                             Reference.KinematicVariableList[2],
+                                         2 * M_PI),
+                          1e-6);
+
+        auto FinalStates = SubSystems[j].getFinalStates();
+        std::sort(FinalStates.begin(), FinalStates.end());
+        auto Shared = SharedMasses.insert(std::make_pair(FinalStates, mSq));
+        if (!Shared.second)
+          BOOST_CHECK_EQUAL(Shared.first->second, mSq);
+      }
+      BOOST_CHECK_LT(SharedMasses.size(), SubSystems.size());
+    }
+  }
+}
+
+/// Variables of new SubSystems are appended to the columns of a DataSet. The
+/// existing columns are kept, since FunctionTrees can refer to them.
+BOOST_AUTO_TEST_CASE(AppendKinematicVariables) {
+  ComPWA::Logging log("", "error");
+
+  boost::property_tree::ptree tr;
+  std::stringstream modelStream;
+  modelStream << HelicityTestParticles;
+  boost::property_tree::xml_parser::read_xml(modelStream, tr);
+  auto partL = std::make_shared<ComPWA::PartList>();
+  ComPWA::ReadParticles(partL, tr);
+
+  std::vector<int> initialState{443}, finalState{22, 111, 111};
+  auto kin =
+      std::make_shared<ComPWA::Physics::HelicityFormalism::HelicityKinematics>(
+          partL, initialState, finalState);
+  kin->addSubSystem(ComPWA::Physics::SubSystem({{1}, {2}}, {0}, {}), false);
+
+  ComPWA::PhspGenerator Generator(ComPWA::FourMomentum(0.0, 0.0, 0.0, 3.097),
+                                  {0.0, 0.135, 0.135}, 4711);
+  std::vector<ComPWA::Event> Events(200);
+  Generator.generateEvents(0, Events.begin(), Events.end());
+
+  ComPWA::Data::DataSet Sample(Events);
+  Sample.convertEventsToParameterList(kin, kin->getUsedKinematicVariables());
+  auto OldColumns = Sample.getParameterList().mDoubleValues();
+  std::vector<std::vector<double>> OldValues;
+  for (auto const &x : OldColumns)
+    OldValues.push_back(x->values());
+
+  // the variables of a new SubSystem are appended, and the angles of the
+  // first SubSystem are requested afterwards
+  kin->addSubSystem(ComPWA::Physics::SubSystem({{0}, {1}}, {2}, {}), true);
+  auto UsedVariables = kin->getUsedKinematicVariables();
+  for (auto Variables :
+       {UsedVariables, std::vector<bool>(UsedVariables.size(), true)}) {
+    Sample.convertEventsToParameterList(kin, Variables);
+    auto const &Columns = Sample.getParameterList().mDoubleValues();
+    BOOST_REQUIRE_EQUAL(Columns.size(), UsedVariables.size() + 1);
+
+    // the calculated columns and the weights keep their identity and values
+    BOOST_CHECK(Columns.back() == OldColumns.back());
+    BOOST_CHECK(Columns.back()->values() == OldValues.back());
+    BOOST_CHECK(Columns[0] == OldColumns[0]);
+    BOOST_CHECK(Columns[0]->values() == OldValues[0]);
+
+    ComPWA::Data::DataSet FreshSample(Events);
+    FreshSample.convertEventsToParameterList(kin, Variables);
+    auto const &FreshColumns = FreshSample.getParameterList().mDoubleValues();
+    BOOST_REQUIRE_EQUAL(FreshColumns.size(), Columns.size());
+    BOOST_CHECK(Sample.getKinematicVariableNames() ==
+                FreshSample.getKinematicVariableNames());
+    BOOST_CHECK(Sample.getUsedKinematicVariables() ==
+                FreshSample.getUsedKinematicVariables());
+    for (size_t i = 0; i < Columns.size(); ++i) {
+      BOOST_REQUIRE_EQUAL(Columns[i]->values().size(), Events.size());
+      for (size_t j = 0; j < Events.size(); ++j) {
+        if (i == Columns.size() - 1 || Variables[i])
+          BOOST_CHECK_EQUAL(Columns[i]->values()[j],
+                            FreshColumns[i]->values()[j]);
+        else
+          BOOST_CHECK(std::isnan(Columns[i]->values()[j]));
+      }
+    }
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
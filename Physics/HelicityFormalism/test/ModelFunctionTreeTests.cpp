@@ -5,6 +5,8 @@
 // This can only be define once within the same library ?!
 #define BOOST_TEST_MODULE HelicityFormalism
 
+#include <algorithm>
+#include <cmath>
 #include <vector>
 
 #include "Core/Intensity.hpp"
@@ -678,4 +680,91 @@ BOOST_AUTO_TEST_CASE(SeqPartialAmplitudeTreeConcordance) {
   }
 };
 
+BOOST_AUTO_TEST_CASE(UsedKinematicVariablesOfModel) {
+  boost::property_tree::ptree tr;
+  std::stringstream modelStream;
+  // Construct particle list from XML tree
+  modelStream << HelicityTestParticles;
+  boost::property_tree::xml_parser::read_xml(modelStream, tr);
+  auto partL = std::make_shared<ComPWA::PartList>();
+  ReadParticles(partL, tr);
+
+  modelStream.clear();
+  tr = boost::property_tree::ptree();
+  // Construct Kinematics from XML tree
+  modelStream << HelicityTestKinematics;
+  boost::property_tree::xml_parser::read_xml(modelStream, tr);
+  ComPWA::Physics::IntensityBuilderXML Builder;
+  auto kin = Builder.createHelicityKinematics(
+      partL, tr.get_child("HelicityKinematics"));
+  // the model does not use the variables of the other SubSystems
+  kin->createAllSubsystems();
+
+  std::shared_ptr<ComPWA::Generator> gen(new ComPWA::Tools::RootGenerator(
+      kin->getParticleStateTransitionKinematicsInfo(), 123));
+  std::shared_ptr<ComPWA::Data::DataSet> phspsample(
+      ComPWA::Tools::generatePhsp(1000, gen));
+
+  modelStream.clear();
+  tr = boost::property_tree::ptree();
+  modelStream << HelicityTestModel;
+  boost::property_tree::xml_parser::read_xml(modelStream, tr);
+
+  Builder = ComPWA::Physics::IntensityBuilderXML(phspsample);
+  auto intens = Builder.createIntensity(partL, kin, tr.get_child("Intensity"));
+
+  // the variables of the FunctionTree are a subset of the ones of the
+  // SubSystems of the model
+  auto MarkedVariables = kin->getUsedKinematicVariables();
+  auto UsedVariables = ComPWA::Data::findUsedKinematicVariables(
+      *intens, *kin, phspsample->getEventList().front());
+  BOOST_REQUIRE_EQUAL(UsedVariables.size(), MarkedVariables.size());
+  size_t NumberOfUsedVariables(
+      std::count(UsedVariables.begin(), UsedVariables.end(), true));
+  BOOST_CHECK(NumberOfUsedVariables > 0);
+  BOOST_CHECK(NumberOfUsedVariables < UsedVariables.size());
+  for (size_t i = 0; i < UsedVariables.size(); ++i)
+    BOOST_CHECK(!UsedVariables[i] || MarkedVariables[i]);
+  kin->setUsedKinematicVariables(UsedVariables);
+
+  // the same events with the restricted and with all variables
+  std::shared_ptr<ComPWA::Data::DataSet> sample(
+      ComPWA::Tools::generatePhsp(100, gen));
+  auto fullsample =
+      std::make_shared<ComPWA::Data::DataSet>(sample->getEventList());
+  sample->convertEventsToParameterList(kin, kin->getUsedKinematicVariables());
+  fullsample->convertEventsToParameterList(kin);
+
+  auto const &Columns = sample->getParameterList().mDoubleValues();
+  auto const &FullColumns = fullsample->getParameterList().mDoubleValues();
+  BOOST_REQUIRE_EQUAL(Columns.size(), FullColumns.size());
+  for (size_t i = 0; i < UsedVariables.size(); ++i) {
+    for (size_t j = 0; j < Columns[i]->values().size(); ++j) {
+      if (UsedVariables[i])
+        BOOST_CHECK_EQUAL(Columns[i]->values()[j], FullColumns[i]->values()[j]);
+      else
+        BOOST_CHECK(std::isnan(Columns[i]->values()[j]));
+    }
+  }
+
+  // the model gives the same intensities for both samples
+  auto tree = intens->createFunctionTree(sample->getParameterList(), "");
+  auto fulltree =
+      intens->createFunctionTree(fullsample->getParameterList(), "");
+  auto intensities =
+      std::dynamic_pointer_cast<Value<std::vector<double>>>(tree->parameter());
+  auto fullintensities = std::dynamic_pointer_cast<Value<std::vector<double>>>(
+      fulltree->parameter());
+  BOOST_REQUIRE_EQUAL(intensities->values().size(),
+                      fullintensities->values().size());
+  for (size_t i = 0; i < intensities->values().size(); ++i) {
+    BOOST_CHECK(std::isfinite(intensities->values()[i]));
+    BOOST_CHECK_CLOSE(intensities->values()[i], fullintensities->values()[i],
+                      1e-10);
+    BOOST_CHECK_CLOSE(intens->evaluate(sample->getDataPointList()[i]),
+                      intens->evaluate(fullsample->getDataPointList()[i]),
+                      1e-10);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,112 @@
+// Copyright (c) 2013, 2017 The ComPWA Team.
+// This file is part of the ComPWA framework, check
+// https://github.com/ComPWA/ComPWA/license.txt for details.
+
+// Define Boost test module
+#define BOOST_TEST_MODULE HelicityFormalism
+
+#include <atomic>
+#include <numeric>
+
+#include <boost/test/unit_test.hpp>
+#include <tbb/global_control.h>
+#include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
+
+#include "Core/Event.hpp"
+#include "Core/Intensity.hpp"
+#include "Physics/NormalizationIntensityDecorator.hpp"
+#include "Tools/Integration.hpp"
+
+namespace {
+
+/// Intensity 1 + Slope * x, which counts its evaluations
+class LinearIntensity : public ComPWA::Intensity {
+public:
+  LinearIntensity() : Slope(1.0), Evaluations(0) {}
+  double evaluate(const ComPWA::DataPoint &point) const {
+    ++Evaluations;
+    return 1.0 + Slope * point.KinematicVariableList[0];
+  }
+  void updateParametersFrom(const ComPWA::ParameterList &list) {}
+  void addUniqueParametersTo(ComPWA::ParameterList &list) {}
+  void addFitParametersTo(std::vector<double> &FitParameters) {
+    FitParameters.push_back(Slope);
+  }
+  std::shared_ptr<ComPWA::FunctionTree>
+  createFunctionTree(const ComPWA::ParameterList &DataSample,
+                     const std::string &suffix) const {
+    return nullptr;
+  }
+
+  double Slope;
+  mutable std::atomic<size_t> Evaluations;
+};
+
+/// Midpoint rule with \p NumberOfPoints points in [0, 1]. The points are
+/// evaluated with a plain parallel loop, so a thread which waits for it may
+/// run other tasks.
+class MidpointIntegrationStrategy : public ComPWA::Tools::IntegrationStrategy {
+public:
+  MidpointIntegrationStrategy(size_t numberOfPoints)
+      : NumberOfPoints(numberOfPoints) {}
+  std::pair<double, double>
+  integrateWithError(std::shared_ptr<const ComPWA::Intensity> intensity,
+                     double TargetPrecision = 0.0) const {
+    std::vector<double> Values(NumberOfPoints);
+    tbb::parallel_for(size_t(0), NumberOfPoints, [&](size_t i) {
+      Values[i] = intensity->evaluate(point(i));
+    });
+    return std::make_pair(
+        std::accumulate(Values.begin(), Values.end(), 0.0) / NumberOfPoints,
+        0.0);
+  }
+  std::shared_ptr<ComPWA::FunctionTree>
+  createFunctionTree(std::shared_ptr<const ComPWA::Intensity> intensity,
+                     const std::string &suffix) const {
+    return nullptr;
+  }
+
+  ComPWA::DataPoint point(size_t i) const {
+    ComPWA::DataPoint Point;
+    Point.KinematicVariableList = {(i + 0.5) / NumberOfPoints};
+    return Point;
+  }
+
+  size_t NumberOfPoints;
+};
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(HelicityFormalism)
+
+BOOST_AUTO_TEST_CASE(NormalizationUpdateInParallelLoop) {
+  auto Intensity = std::make_shared<LinearIntensity>();
+  auto Integrator = std::make_shared<MidpointIntegrationStrategy>(20000);
+  ComPWA::Physics::NormalizationIntensityDecorator Normalized(
+      "Linear", Intensity, Integrator);
+
+  // the parameter change is noticed by the parallel evaluations, one of them
+  // integrates the intensity while the others wait
+  Intensity->Slope = 3.0;
+  Intensity->Evaluations = 0;
+  const int NumberOfThreads(4);
+  tbb::global_control Control(tbb::global_control::max_allowed_parallelism,
+                              NumberOfThreads);
+  tbb::task_arena Arena(NumberOfThreads);
+  std::vector<double> Values(Integrator->NumberOfPoints);
+  Arena.execute([&]() {
+    tbb::parallel_for(size_t(0), Values.size(), [&](size_t i) {
+      Values[i] = Normalized.evaluate(Integrator->point(i));
+    });
+  });
+
+  // one integration and one evaluation per point
+  BOOST_CHECK_EQUAL(Intensity->Evaluations, 2 * Values.size());
+  for (size_t i = 0; i < Values.size(); ++i) {
+    double x(Integrator->point(i).KinematicVariableList[0]);
+    BOOST_CHECK_CLOSE(Values[i], (1.0 + 3.0 * x) / 2.5, 1e-9);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -6,6 +6,7 @@
 
 #include "Core/Exceptions.hpp"
 #include "Core/Logging.hpp"
+#include "Core/PhspGenerator.hpp"
 #include "Core/Properties.hpp"
 #include "Data/DataSet.hpp"
 #include "Physics/CoefficientAmplitudeDecorator.hpp"
@@ -35,8 +36,9 @@ namespace ComPWA {
 namespace Physics {
 
 IntensityBuilderXML::IntensityBuilderXML(
-    std::shared_ptr<ComPWA::Data::DataSet> phspsample)
-    : PhspSample(phspsample) {}
+    std::shared_ptr<ComPWA::Data::DataSet> phspsample,
+    std::shared_ptr<ComPWA::Generator> generator)
+    : PhspSample(phspsample), Generator(generator) {}
 
 std::tuple<std::shared_ptr<Intensity>, std::shared_ptr<HelicityKinematics>>
 IntensityBuilderXML::createIntensityAndKinematics(
@@ -53,9 +55,16 @@ IntensityBuilderXML::createIntensityAndKinematics(
                     " No Kinematics found!");
   }
   it = pt.find("Intensity");
-  if (it != pt.not_found())
-    return std::make_tuple(createIntensity(partL, kin, it->second), kin);
-  else {
+  if (it != pt.not_found()) {
+    auto Intens = createIntensity(partL, kin, it->second);
+    // samples are only converted for the variables which the model uses
+    auto KinInfo = kin->getParticleStateTransitionKinematicsInfo();
+    ComPWA::PhspGenerator Gen(KinInfo.getInitialStateFourMomentum(),
+                              KinInfo.getFinalStateMasses(), 1234);
+    kin->setUsedKinematicVariables(ComPWA::Data::findUsedKinematicVariables(
+        *Intens, *kin, Gen.generate()));
+    return std::make_tuple(Intens, kin);
+  } else {
     throw BadConfig("IntensityBuilderXML::createIntensityAndKinematics(): "
                     " No Intensity found!");
   }
@@ -269,7 +278,8 @@ std::shared_ptr<Intensity> IntensityBuilderXML::createNormalizedIntensity(
   Integrator = createIntegrationStrategy(partL, kin, IntegratorPT);
 
   return std::make_shared<NormalizationIntensityDecorator>(
-      name, UndecoratedIntensity, Integrator);
+      name, UndecoratedIntensity, Integrator,
+      IntegratorPT.get<double>("<xmlattr>.TargetPrecision", 0.0));
 }
 
 std::shared_ptr<Tools::IntegrationStrategy>
@@ -285,8 +295,21 @@ IntensityBuilderXML::createIntegrationStrategy(
       if (!PhspSample)
         LOG(FATAL) << "IntensityBuilderXML::createIntegrationStrategy(): phsp "
                       "sample is not set!";
-      PhspSample->convertEventsToDataPoints(kin);
+      PhspSample->convertEventsToParameterList(
+          kin, kin->getUsedKinematicVariables());
       return std::make_shared<ComPWA::Tools::MCIntegrationStrategy>(PhspSample);
+    } else if (ClassName == "VegasIntegrationStrategy") {
+      return std::make_shared<ComPWA::Tools::VegasIntegrationStrategy>(
+          kin, getGenerator(kin, pt), kin->phspVolume(),
+          pt.get<unsigned int>("<xmlattr>.NumberOfEvaluations", 10000),
+          pt.get<unsigned int>("<xmlattr>.NumberOfIterations", 5),
+          pt.get<unsigned int>("<xmlattr>.NumberOfBins", 50),
+          pt.get<double>("<xmlattr>.Alpha", 1.5));
+    } else if (ClassName == "QMCIntegrationStrategy") {
+      return std::make_shared<ComPWA::Tools::QMCIntegrationStrategy>(
+          kin, getGenerator(kin, pt), kin->phspVolume(),
+          pt.get<unsigned int>("<xmlattr>.NumberOfPoints", 4096),
+          pt.get<unsigned int>("<xmlattr>.NumberOfReplicas", 8));
     } else {
       LOG(WARNING) << "IntensityBuilderXML::createIntegrationStrategy(): "
                       "IntegrationStrategy type "
@@ -302,10 +325,26 @@ IntensityBuilderXML::createIntegrationStrategy(
   if (!PhspSample)
     LOG(FATAL) << "IntensityBuilderXML::createIntegrationStrategy(): phsp "
                   "sample is not set!";
-  PhspSample->convertEventsToDataPoints(kin);
+  PhspSample->convertEventsToParameterList(kin,
+                                           kin->getUsedKinematicVariables());
   return std::make_shared<ComPWA::Tools::MCIntegrationStrategy>(PhspSample);
 }
 
+std::shared_ptr<ComPWA::Generator>
+IntensityBuilderXML::getGenerator(std::shared_ptr<Kinematics> kin,
+                                  const boost::property_tree::ptree &pt) const {
+  if (Generator)
+    return Generator;
+  auto helkin = std::dynamic_pointer_cast<HelicityKinematics>(kin);
+  if (!helkin)
+    throw BadConfig("IntensityBuilderXML::getGenerator(): generator is not "
+                    "set!");
+  auto KinInfo = helkin->getParticleStateTransitionKinematicsInfo();
+  return std::make_shared<ComPWA::PhspGenerator>(
+      KinInfo.getInitialStateFourMomentum(), KinInfo.getFinalStateMasses(),
+      pt.get<int>("<xmlattr>.Seed", 1234));
+}
+
 std::shared_ptr<NamedAmplitude> IntensityBuilderXML::createAmplitude(
     std::shared_ptr<PartList> partL, std::shared_ptr<Kinematics> kin,
     const boost::property_tree::ptree &pt) const {
@@ -359,7 +398,8 @@ std::shared_ptr<NamedAmplitude> IntensityBuilderXML::createNormalizedAmplitude(
   Integrator = createIntegrationStrategy(partL, kin, IntegratorPT);
 
   return std::make_shared<NormalizationAmplitudeDecorator>(
-      name, UndecoratedAmplitude, Integrator);
+      name, UndecoratedAmplitude, Integrator,
+      IntegratorPT.get<double>("<xmlattr>.TargetPrecision", 0.0));
 }
 
 std::shared_ptr<NamedAmplitude> IntensityBuilderXML::createCoefficientAmplitude(
@@ -428,9 +468,6 @@ std::shared_ptr<NamedAmplitude> IntensityBuilderXML::createHelicityDecay(
     const boost::property_tree::ptree &pt) const {
 
   LOG(TRACE) << "HelicityDecay::load() |";
-  unsigned int SubSystemIndex(kin->addSubSystem(SubSystem(pt)));
-  // SubSys = kin->subSystem(SubSystemIndex);
-  unsigned int DataPosition = 3 * SubSystemIndex;
 
   auto ampname = pt.get<std::string>("<xmlattr>.Name");
   // Name = pt.get<std::string>("<xmlattr>.Name", "empty");
@@ -441,6 +478,11 @@ std::shared_ptr<NamedAmplitude> IntensityBuilderXML::createHelicityDecay(
     throw std::runtime_error("HelicityDecay::load | Particle " + name +
                              " not found in list!");
   ComPWA::Spin J = partItr->second.GetSpinQuantumNumber("Spin");
+  // the WignerD function of a spin zero resonance is constant, so the
+  // helicity angles are not needed
+  unsigned int SubSystemIndex(
+      kin->addSubSystem(SubSystem(pt), (double)J != 0));
+  unsigned int DataPosition = 3 * SubSystemIndex;
   ComPWA::Spin mu(pt.get<double>("DecayParticle.<xmlattr>.Helicity"));
   // if the node OrbitalAngularMomentum does not exist, set it to spin J as
   // default value
@@ -16,6 +16,7 @@
 namespace ComPWA {
 class Kinematics;
 class Intensity;
+class Generator;
 
 namespace Data {
 class DataSet;
@@ -34,7 +35,11 @@ class HelicityKinematics;
 
 class IntensityBuilderXML {
 public:
-  IntensityBuilderXML(std::shared_ptr<ComPWA::Data::DataSet> phspsample = {});
+  /// The phase space sample \p phspsample is used by MCIntegrationStrategy,
+  /// the \p generator by VegasIntegrationStrategy and QMCIntegrationStrategy.
+  /// If no generator is given, a PhspGenerator of the kinematics is used.
+  IntensityBuilderXML(std::shared_ptr<ComPWA::Data::DataSet> phspsample = {},
+                      std::shared_ptr<ComPWA::Generator> generator = {});
 
   std::tuple<std::shared_ptr<Intensity>,
              std::shared_ptr<HelicityFormalism::HelicityKinematics>>
@@ -105,7 +110,14 @@ public:
       const boost::property_tree::ptree &pt) const;
 
 private:
+  /// The generator of the constructor, or a PhspGenerator of \p kin with the
+  /// seed of the Seed attribute of \p pt
+  std::shared_ptr<ComPWA::Generator>
+  getGenerator(std::shared_ptr<Kinematics> kin,
+               const boost::property_tree::ptree &pt) const;
+
   std::shared_ptr<ComPWA::Data::DataSet> PhspSample;
+  std::shared_ptr<ComPWA::Generator> Generator;
 };
 
 } // namespace Physics
@@ -14,24 +14,37 @@ namespace Physics {
 
 NormalizationAmplitudeDecorator::NormalizationAmplitudeDecorator(
     const std::string &name, std::shared_ptr<NamedAmplitude> amplitude,
-    std::shared_ptr<ComPWA::Tools::IntegrationStrategy> integrator)
+    std::shared_ptr<ComPWA::Tools::IntegrationStrategy> integrator,
+    double targetprecision)
     : NamedAmplitude(name), UnnormalizedAmplitude(amplitude),
       NormedAmplitude(std::make_shared<CoherentIntensity>(
           amplitude->getName(),
           std::vector<std::shared_ptr<NamedAmplitude>>{amplitude})),
-      PreviousFitParameters(), Integrator(integrator) {
+      PreviousFitParameters(), Integrator(integrator),
+      TargetPrecision(targetprecision) {
+  // fix the points of the integrator, e.g. adapt the grid of VEGAS to the
+  // start parameters
+  Integrator->freeze(NormedAmplitude, TargetPrecision);
   Normalization = std::sqrt(1.0 / Integrator->integrate(NormedAmplitude));
   UnnormalizedAmplitude->addFitParametersTo(PreviousFitParameters);
 }
 
 std::complex<double> NormalizationAmplitudeDecorator::evaluate(
     const ComPWA::DataPoint &point) const {
+  std::vector<double> FitParameters;
+  UnnormalizedAmplitude->addFitParametersTo(FitParameters);
 
-  double Norm(Normalization);
-  if (checkParametersChanged()) {
-    LOG(DEBUG) << "NormalizationAmplitudeDecorator::evaluate(): recalculating "
-                  "normalization for amplitude";
-    Norm = 1.0 / Integrator->integrate(NormedAmplitude);
+  double Norm;
+  {
+    std::lock_guard<std::mutex> Lock(NormalizationMutex);
+    if (FitParameters != PreviousFitParameters) {
+      LOG(DEBUG) << "NormalizationAmplitudeDecorator::evaluate(): "
+                    "recalculating normalization for amplitude";
+      Normalization = std::sqrt(
+          1.0 / Tools::integrateIsolated(*Integrator, NormedAmplitude));
+      PreviousFitParameters = FitParameters;
+    }
+    Norm = Normalization;
   }
 
   return Norm * UnnormalizedAmplitude->evaluate(point);
@@ -78,17 +91,5 @@ NormalizationAmplitudeDecorator::getUnnormalizedAmplitude() const {
   return UnnormalizedAmplitude;
 }
 
-bool NormalizationAmplitudeDecorator::checkParametersChanged() const {
-  std::vector<double> TempParList;
-  UnnormalizedAmplitude->addFitParametersTo(TempParList);
-  for (unsigned int i = 0; i < TempParList.size(); ++i) {
-    if (TempParList[i] != PreviousFitParameters[i]) {
-      *const_cast<std::vector<double> *>(&PreviousFitParameters) = TempParList;
-      return true;
-    }
-  }
-  return false;
-}
-
 } // namespace Physics
 } // namespace ComPWA
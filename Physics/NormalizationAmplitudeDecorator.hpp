@@ -5,6 +5,8 @@
 #ifndef PHYSICS_NORMALIZATIONAMPLITUDEDECORATOR_HPP_
 #define PHYSICS_NORMALIZATIONAMPLITUDEDECORATOR_HPP_
 
+#include <mutex>
+
 #include "Physics/Amplitude.hpp"
 
 namespace ComPWA {
@@ -19,7 +21,8 @@ class NormalizationAmplitudeDecorator : public NamedAmplitude {
 public:
   NormalizationAmplitudeDecorator(
       const std::string &name, std::shared_ptr<NamedAmplitude> amplitude,
-      std::shared_ptr<ComPWA::Tools::IntegrationStrategy> integrator);
+      std::shared_ptr<ComPWA::Tools::IntegrationStrategy> integrator,
+      double targetprecision = 0.0);
 
   std::complex<double> evaluate(const ComPWA::DataPoint &point) const final;
 
@@ -34,15 +37,20 @@ public:
   std::shared_ptr<const Amplitude> getUnnormalizedAmplitude() const;
 
 private:
-  bool checkParametersChanged() const;
-
   std::shared_ptr<Amplitude> UnnormalizedAmplitude;
   std::shared_ptr<Intensity> NormedAmplitude;
 
-  double Normalization;
-  std::vector<double> PreviousFitParameters;
+  /// Normalization and the parameters it was calculated with. They are
+  /// updated lazily by evaluate() under NormalizationMutex, so evaluate() can
+  /// be called concurrently.
+  mutable double Normalization;
+  mutable std::vector<double> PreviousFitParameters;
+  mutable std::mutex NormalizationMutex;
   /// Phsp sample for numerical integration
   std::shared_ptr<ComPWA::Tools::IntegrationStrategy> Integrator;
+  /// Relative precision of the pilot integration which fixes the number of
+  /// points of the integrator, all points are used if it is 0
+  double TargetPrecision;
 };
 
 } // namespace Physics
@@ -11,22 +11,36 @@ namespace Physics {
 
 NormalizationIntensityDecorator::NormalizationIntensityDecorator(
     const std::string &name, std::shared_ptr<ComPWA::Intensity> intensity,
-    std::shared_ptr<ComPWA::Tools::IntegrationStrategy> integrator)
+    std::shared_ptr<ComPWA::Tools::IntegrationStrategy> integrator,
+    double targetprecision)
     : Name(name), UnnormalizedIntensity(intensity), PreviousFitParameters(),
-      Integrator(integrator) {
+      Integrator(integrator), TargetPrecision(targetprecision) {
 
+  // fix the points of the integrator, e.g. adapt the grid of VEGAS to the
+  // start parameters
+  Integrator->freeze(UnnormalizedIntensity, TargetPrecision);
   Normalization = 1.0 / Integrator->integrate(UnnormalizedIntensity);
   UnnormalizedIntensity->addFitParametersTo(PreviousFitParameters);
 }
 
 double NormalizationIntensityDecorator::evaluate(
     const ComPWA::DataPoint &point) const {
+  std::vector<double> FitParameters;
+  UnnormalizedIntensity->addFitParametersTo(FitParameters);
 
-  double Norm(Normalization);
-  if (checkParametersChanged()) {
-    LOG(DEBUG) << "NormalizationIntensityDecorator::evaluate(): recalculating "
-                  "normalization for intensity";
-    Norm = 1.0 / Integrator->integrate(UnnormalizedIntensity);
+  double Norm;
+  {
+    std::lock_guard<std::mutex> Lock(NormalizationMutex);
+    if (FitParameters != PreviousFitParameters) {
+      LOG(DEBUG) << "NormalizationIntensityDecorator::evaluate(): "
+                    "recalculating normalization for intensity";
+      // while this thread waits for the parallel integration, it must not run
+      // other evaluations, which would see the old normalization
+      Normalization =
+          1.0 / Tools::integrateIsolated(*Integrator, UnnormalizedIntensity);
+      PreviousFitParameters = FitParameters;
+    }
+    Norm = Normalization;
   }
 
   return Norm * UnnormalizedIntensity->evaluate(point);
@@ -71,17 +85,5 @@ NormalizationIntensityDecorator::getUnnormalizedIntensity() const {
   return UnnormalizedIntensity;
 }
 
-bool NormalizationIntensityDecorator::checkParametersChanged() const {
-  std::vector<double> TempParList;
-  UnnormalizedIntensity->addFitParametersTo(TempParList);
-  for (unsigned int i = 0; i < TempParList.size(); ++i) {
-    if (TempParList[i] != PreviousFitParameters[i]) {
-      *const_cast<std::vector<double> *>(&PreviousFitParameters) = TempParList;
-      return true;
-    }
-  }
-  return false;
-}
-
 } // namespace Physics
 } // namespace ComPWA
@@ -5,6 +5,8 @@
 #ifndef PHYSICS_NORMALIZATIONINTENSITYDECORATOR_HPP_
 #define PHYSICS_NORMALIZATIONINTENSITYDECORATOR_HPP_
 
+#include <mutex>
+
 #include "Core/Intensity.hpp"
 
 namespace ComPWA {
@@ -19,7 +21,8 @@ class NormalizationIntensityDecorator : public ComPWA::Intensity {
 public:
   NormalizationIntensityDecorator(
       const std::string &name, std::shared_ptr<ComPWA::Intensity> intensity,
-      std::shared_ptr<ComPWA::Tools::IntegrationStrategy> integrator);
+      std::shared_ptr<ComPWA::Tools::IntegrationStrategy> integrator,
+      double targetprecision = 0.0);
 
   double evaluate(const ComPWA::DataPoint &point) const final;
 
@@ -34,15 +37,20 @@ public:
   std::shared_ptr<const ComPWA::Intensity> getUnnormalizedIntensity() const;
 
 private:
-  bool checkParametersChanged() const;
-
   std::string Name;
   std::shared_ptr<ComPWA::Intensity> UnnormalizedIntensity;
 
-  double Normalization;
-  std::vector<double> PreviousFitParameters;
+  /// Normalization and the parameters it was calculated with. They are
+  /// updated lazily by evaluate() under NormalizationMutex, so evaluate() can
+  /// be called concurrently.
+  mutable double Normalization;
+  mutable std::vector<double> PreviousFitParameters;
+  mutable std::mutex NormalizationMutex;
   /// Phsp sample for numerical integration
   std::shared_ptr<ComPWA::Tools::IntegrationStrategy> Integrator;
+  /// Relative precision of the pilot integration which fixes the number of
+  /// points of the integrator, all points are used if it is 0
+  double TargetPrecision;
 };
 
 } // namespace Physics
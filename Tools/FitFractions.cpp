@@ -0,0 +1,96 @@
+// Copyright (c) 2017 The ComPWA Team.
+// This file is part of the ComPWA framework, check
+// https://github.com/ComPWA/ComPWA/license.txt for details.
+
+#include <algorithm>
+#include <numeric>
+
+#include "Tools/FitFractions.hpp"
+
+#include "ThirdParty/parallelstl/include/pstl/algorithm"
+#include "ThirdParty/parallelstl/include/pstl/execution"
+
+namespace ComPWA {
+namespace Tools {
+
+double InterferenceMatrix::total() const {
+  double Sum(0.0);
+  for (auto const &Row : Integrals)
+    for (auto const &x : Row)
+      Sum += x.real();
+  return Sum;
+}
+
+double InterferenceMatrix::fitFraction(size_t i) const {
+  return Integrals[i][i].real() / total();
+}
+
+double InterferenceMatrix::interferenceFraction(size_t i, size_t j) const {
+  return 2.0 * Integrals[i][j].real() / total();
+}
+
+InterferenceMatrix calculateInterferenceMatrix(
+    std::shared_ptr<const ComPWA::Physics::CoherentIntensity> intensity,
+    std::shared_ptr<ComPWA::Data::DataSet> sample) {
+  auto const &Amplitudes = intensity->getAmplitudes();
+  const size_t n(Amplitudes.size());
+  InterferenceMatrix Matrix;
+  for (auto const &x : Amplitudes)
+    Matrix.Names.push_back(x->getName());
+  Matrix.Integrals.assign(n, std::vector<std::complex<double>>(n));
+
+  const std::vector<DataPoint> &Points = sample->getDataPointList();
+  if (Points.empty() || n == 0) {
+    LOG(WARNING) << "Tools::calculateInterferenceMatrix(): sample or "
+                    "intensity is empty!";
+    return Matrix;
+  }
+
+  // Each chunk evaluates the columns of the amplitudes at its points and sums
+  // the upper triangle of w * A_i * A_j^*. The chunk sums are added in a
+  // fixed order, so the result does not depend on the number of threads.
+  const size_t ChunkSize(1000);
+  const size_t NumberOfChunks((Points.size() + ChunkSize - 1) / ChunkSize);
+  std::vector<std::vector<std::complex<double>>> ChunkSums(
+      NumberOfChunks, std::vector<std::complex<double>>(n * n));
+  std::vector<double> ChunkWeights(NumberOfChunks, 0.0);
+  auto sumChunk = [&](size_t Chunk) {
+    size_t First(Chunk * ChunkSize);
+    size_t Size(std::min(Points.size(), First + ChunkSize) - First);
+    std::vector<std::complex<double>> Values(n * Size);
+    for (size_t i = 0; i < n; ++i)
+      for (size_t k = 0; k < Size; ++k)
+        Values[i * Size + k] = Amplitudes[i]->evaluate(Points[First + k]);
+    auto &Sums = ChunkSums[Chunk];
+    for (size_t k = 0; k < Size; ++k) {
+      double Weight(Points[First + k].Weight);
+      ChunkWeights[Chunk] += Weight;
+      for (size_t i = 0; i < n; ++i) {
+        std::complex<double> WeightedValue(Weight * Values[i * Size + k]);
+        for (size_t j = i; j < n; ++j)
+          Sums[i * n + j] += WeightedValue * std::conj(Values[j * Size + k]);
+      }
+    }
+  };
+  std::vector<size_t> Chunks(NumberOfChunks);
+  std::iota(Chunks.begin(), Chunks.end(), 0);
+  std::for_each(pstl::execution::par, Chunks.begin(), Chunks.end(), sumChunk);
+
+  double WeightSum(0.0);
+  for (size_t c = 0; c < NumberOfChunks; ++c) {
+    WeightSum += ChunkWeights[c];
+    for (size_t i = 0; i < n; ++i)
+      for (size_t j = i; j < n; ++j)
+        Matrix.Integrals[i][j] += ChunkSums[c][i * n + j];
+  }
+  for (size_t i = 0; i < n; ++i) {
+    for (size_t j = i; j < n; ++j) {
+      Matrix.Integrals[i][j] /= WeightSum;
+      Matrix.Integrals[j][i] = std::conj(Matrix.Integrals[i][j]);
+    }
+  }
+  return Matrix;
+}
+
+} // namespace Tools
+} // namespace ComPWA
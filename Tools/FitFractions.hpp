@@ -5,7 +5,9 @@
 #ifndef COMPWA_TOOLS_FITFRACTIONS_HPP_
 #define COMPWA_TOOLS_FITFRACTIONS_HPP_
 
+#include <complex>
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "Core/ProgressBar.hpp"
@@ -111,60 +113,77 @@ inline void multivariateGaussian(const gsl_rng *rnd, const unsigned int vecSize,
   gsl_matrix_free(tmpM);
 };
 
+///
+/// \struct InterferenceMatrix
+/// Integrals \f$ M_{ij} = \int A_i A_j^* \f$ of all pairs of amplitudes
+/// \f$ A_i \f$ (including their coefficients) of a CoherentIntensity. The
+/// integral of the intensity, the fit fractions and the interference terms
+/// follow from it without further evaluations of the amplitudes.
+///
+struct InterferenceMatrix {
+  /// Names of the amplitudes
+  std::vector<std::string> Names;
+  /// Integrals[i][j] is \f$ M_{ij} \f$, the matrix is hermitian
+  std::vector<std::vector<std::complex<double>>> Integrals;
+
+  /// Integral of the intensity \f$ \sum_{ij} M_{ij} \f$
+  double total() const;
+
+  /// Fit fraction \f$ M_{ii} / \sum_{lm} M_{lm} \f$ of amplitude \p i
+  double fitFraction(size_t i) const;
+
+  /// Interference term \f$ 2 \mathrm{Re} M_{ij} / \sum_{lm} M_{lm} \f$ of
+  /// the amplitudes \p i != \p j. The fit fractions and the interference
+  /// terms of all pairs i < j add up to one.
+  double interferenceFraction(size_t i, size_t j) const;
+};
+
+/// Calculates the interference matrix of the amplitudes of \p intensity with
+/// Monte Carlo integration over \p sample. The amplitudes are evaluated once
+/// per point, in parallel.
+InterferenceMatrix calculateInterferenceMatrix(
+    std::shared_ptr<const ComPWA::Physics::CoherentIntensity> intensity,
+    std::shared_ptr<ComPWA::Data::DataSet> sample);
+
 /// Calculates the fit fractions using the formula:
 /// \f[
 ///  f_i = \frac{|c_i|^2 \int A_i A_i^*}{\int \sum c_l c_m^* A_l A_m^*}
 /// \f]
 /// The \f$c_i\f$ are the complex coefficient of the amplitudes \f$A_i\f$ and
 /// the denominator is the integral over the whole intensity.
-/// The integrals are performed via Monte Carlo integration method.
-ComPWA::ParameterList calculateFitFractions(
+/// Both are taken from the interference matrix of the amplitudes (see
+/// calculateInterferenceMatrix()), which needs only one pass over the sample.
+inline ComPWA::ParameterList calculateFitFractions(
     std::shared_ptr<const ComPWA::Physics::CoherentIntensity> intensity,
     std::shared_ptr<ComPWA::Data::DataSet> sample,
     const std::vector<std::string> &components = {}) {
   LOG(DEBUG) << "calculating fit fractions...";
   ComPWA::ParameterList FitFractionsList;
 
-  // calculate denominator
-  double IntegralDenominator = ComPWA::Tools::integrate(intensity, sample);
+  InterferenceMatrix Matrix = calculateInterferenceMatrix(intensity, sample);
 
-  // TODO: ultimately we want to have all combinations of amplitudes
-  // A_i x A_j*
-  // so loop over the amplitudes and in the second loop start with the same
-  // index
-  // -in that way we will only calculate one half of the matrix, plus the
-  // diagonal
-  // -then we need a complexconjugate amplitudedecorator, which we can
-  // use here to perform the operation!
-
-  // create list of numerators
-  std::vector<std::shared_ptr<ComPWA::Physics::NamedAmplitude>> Amps;
+  // indices of the requested components, or of all amplitudes
+  std::vector<size_t> Amps;
   for (auto const &AmpName : components) {
-    for (auto x : intensity->getAmplitudes()) {
-      if (x->getName() == AmpName) {
-        Amps.push_back(x);
+    for (size_t i = 0; i < Matrix.Names.size(); ++i) {
+      if (Matrix.Names[i] == AmpName) {
+        Amps.push_back(i);
       }
     }
   }
   if (0 == Amps.size()) {
-    for (auto x : intensity->getAmplitudes()) {
-      Amps.push_back(x);
+    for (size_t i = 0; i < Matrix.Names.size(); ++i) {
+      Amps.push_back(i);
     }
   }
 
-  // calculate nominators
-  for (auto x : Amps) {
-    auto ci = std::make_shared<ComPWA::Physics::CoherentIntensity>(
-        "TempIntensity",
-        std::vector<std::shared_ptr<ComPWA::Physics::NamedAmplitude>>{x});
-    double IntegralNumerator = ComPWA::Tools::integrate(ci, sample);
-
-    double fitfraction = IntegralNumerator / IntegralDenominator;
-    LOG(TRACE) << "calculateFitFractions(): fit fraction for (" << x->getName()
-               << ") is " << fitfraction;
+  for (auto i : Amps) {
+    double fitfraction = Matrix.fitFraction(i);
+    LOG(TRACE) << "calculateFitFractions(): fit fraction for ("
+               << Matrix.Names[i] << ") is " << fitfraction;
 
-    FitFractionsList.addParameter(
-        std::make_shared<ComPWA::FitParameter>(x->getName(), fitfraction, 0.0));
+    FitFractionsList.addParameter(std::make_shared<ComPWA::FitParameter>(
+        Matrix.Names[i], fitfraction, 0.0));
   }
   LOG(DEBUG) << "finished fit fraction calculation!";
   return FitFractionsList;
@@ -311,7 +330,8 @@ inline ParameterList calculateFitFractionsWithSampledError(
 /// \f[
 /// f´(x) = \frac{f(x+h) - f(x-h)}{2h} + O(h^2)
 /// \f]
-ComPWA::ParameterList calculateFitFractionsWithCovarianceErrorPropagation(
+inline ComPWA::ParameterList
+calculateFitFractionsWithCovarianceErrorPropagation(
     std::shared_ptr<const ComPWA::Physics::CoherentIntensity> CohIntensity,
     std::shared_ptr<ComPWA::Data::DataSet> Sample,
     const std::vector<std::vector<double>> &CovarianceMatrix,
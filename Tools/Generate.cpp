@@ -1,12 +1,19 @@
 #include <algorithm>
+#include <chrono>
+#include <functional>
+#include <numeric>
 
 #include "Core/Exceptions.hpp"
 #include "Core/Generator.hpp"
 #include "Core/Intensity.hpp"
 #include "Core/Kinematics.hpp"
 #include "Core/ProgressBar.hpp"
+#include "Core/SobolSequence.hpp"
+#include "Data/ChunkedDataSet.hpp"
 #include "Data/DataSet.hpp"
 #include "Tools/Generate.hpp"
+#include "Tools/IntensityEnvelope.hpp"
+#include "Tools/Integration.hpp"
 
 #include "ThirdParty/parallelstl/include/pstl/algorithm"
 #include "ThirdParty/parallelstl/include/pstl/execution"
@@ -14,43 +21,204 @@
 namespace ComPWA {
 namespace Tools {
 
-std::shared_ptr<ComPWA::Data::DataSet>
-generate(unsigned int NumberOfEvents,
-         std::shared_ptr<ComPWA::Kinematics> Kinematics,
-         std::shared_ptr<ComPWA::Generator> Generator,
-         std::shared_ptr<ComPWA::Intensity> Intensity) {
-  std::vector<ComPWA::Event> events;
-  if (NumberOfEvents <= 0)
-    return std::make_shared<ComPWA::Data::DataSet>(events);
-  // initialize generator output vector
-  unsigned int EventBunchSize(5000);
-  events.reserve(NumberOfEvents);
+/// Generates the events \p FirstIndex, ... of a bunch and uniform random
+/// numbers in [0, 1) for their hit-and-miss. If the generator supports random
+/// number streams, the events are generated in parallel and the bunch only
+/// depends on the seed and \p FirstIndex. Otherwise the sequential random
+/// number generators of the generator are used.
+static void generateEventBunch(ComPWA::Generator &Generator,
+                               uint64_t FirstIndex,
+                               std::vector<ComPWA::Event> &Events,
+                               std::vector<double> &RandomNumbers) {
+  RandomNumbers.resize(Events.size());
+  if (!Generator.hasRandomStreams()) {
+    std::generate(Events.begin(), Events.end(),
+                  [&Generator]() { return Generator.generate(); });
+    // no multithreading here, to ensure deterministic behavior independent
+    // on the number of threads
+    std::generate(RandomNumbers.begin(), RandomNumbers.end(),
+                  [&Generator]() { return Generator.uniform(0, 1); });
+    return;
+  }
+  // generate chunks of events in parallel, a generator may generate the
+  // events of a chunk at once
+  const size_t ChunkSize(1024);
+  std::vector<size_t> Chunks((Events.size() + ChunkSize - 1) / ChunkSize);
+  std::iota(Chunks.begin(), Chunks.end(), 0);
+  std::for_each(pstl::execution::par, Chunks.begin(), Chunks.end(),
+                [&](size_t Chunk) {
+                  auto First = Events.begin() + Chunk * ChunkSize;
+                  auto Last = Events.begin() +
+                              std::min(Events.size(), (Chunk + 1) * ChunkSize);
+                  Generator.generateEvents(FirstIndex + Chunk * ChunkSize,
+                                           First, Last);
+                });
+  std::vector<uint64_t> Indices(Events.size());
+  std::iota(Indices.begin(), Indices.end(), FirstIndex);
+  std::transform(Indices.begin(), Indices.end(), RandomNumbers.begin(),
+                 [&Generator](uint64_t Index) {
+                   return Generator
+                       .randomStream(Index,
+                                     ComPWA::Generator::AcceptanceSubstream)
+                       .uniform();
+                 });
+}
 
+
+///
+/// Events accepted by the hit-and-miss procedure. An event with intensity f
+/// and uniform random number u is accepted if u * Maximum < f. If the maximum
+/// is raised during the generation, thin() removes the events which are
+/// rejected with the new maximum. The result is the same as if the generation
+/// was restarted with the new maximum and the same random numbers, because
+/// the events of the previous bunches have intensities below the old maximum.
+///
+/// The events are ordered by their index in the sequence of generated events.
+/// Points is empty if the kinematic variables of the events are not needed.
+///
+struct HitAndMissSample {
+  std::vector<ComPWA::Event> Events;
+  /// Kinematic variables of the events
+  std::vector<ComPWA::DataPoint> Points;
+  std::vector<double> Intensities;
+  std::vector<double> RandomNumbers;
+  std::vector<uint64_t> Indices;
+
+  /// \p Index has to be larger than the indices of the accepted events.
+  bool accept(const ComPWA::Event &Event, double Intensity, double RandomNumber,
+              double Maximum, uint64_t Index) {
+    if (!(RandomNumber * Maximum < Intensity))
+      return false;
+    Events.push_back(Event);
+    Intensities.push_back(Intensity);
+    RandomNumbers.push_back(RandomNumber);
+    Indices.push_back(Index);
+    return true;
+  }
+
+  /// As accept() above, but the kinematic variables \p Point of the event are
+  /// kept as well.
+  bool accept(const ComPWA::Event &Event, const ComPWA::DataPoint &Point,
+              double Intensity, double RandomNumber, double Maximum,
+              uint64_t Index) {
+    if (!accept(Event, Intensity, RandomNumber, Maximum, Index))
+      return false;
+    Points.push_back(Point);
+    return true;
+  }
+
+  /// Removes the events which are rejected with \p Maximum and returns their
+  /// number.
+  size_t thin(double Maximum) {
+    size_t Size(0);
+    for (size_t i = 0; i < Indices.size(); ++i) {
+      if (!(RandomNumbers[i] * Maximum < Intensities[i]))
+        continue;
+      if (Size != i) {
+        if (!Events.empty())
+          Events[Size] = std::move(Events[i]);
+        if (!Points.empty())
+          Points[Size] = std::move(Points[i]);
+        Intensities[Size] = Intensities[i];
+        RandomNumbers[Size] = RandomNumbers[i];
+        Indices[Size] = Indices[i];
+      }
+      ++Size;
+    }
+    size_t NumberOfRemovedEvents(Indices.size() - Size);
+    truncate(Size);
+    return NumberOfRemovedEvents;
+  }
+
+  /// Keeps the first \p Size events.
+  void truncate(size_t Size) {
+    Size = std::min(Size, Indices.size());
+    Events.resize(std::min(Size, Events.size()));
+    Points.resize(std::min(Size, Points.size()));
+    Intensities.resize(Size);
+    RandomNumbers.resize(Size);
+    Indices.resize(Size);
+  }
+
+  void clear() { truncate(0); }
+};
+
+/// Hit-and-miss generation of \p NumberOfEvents events with the distribution
+/// Intensity * event weight of the events of the generator. If the generator
+/// supports Generator::mapUnitHypercube(), the maximum is estimated with
+/// Tools::maximum() before the generation, so that narrow peaks are found
+/// before the first events are flushed. Otherwise, or if it is larger, the
+/// maximum of the first bunch is used, which is larger than the following
+/// ones. If a later bunch exceeds the maximum, it is raised and the accepted
+/// events are thinned, see HitAndMissSample.
+///
+/// \p Flush is called with the accepted events whenever there are \p ChunkSize
+/// of them and at the end, afterwards they are removed from the sample. Only
+/// the number of flushed events is kept. If the maximum is raised after events
+/// were flushed, \p ThinFlushed is called with the number of flushed events
+/// and the ratio of the old and the new maximum. It has to keep each flushed
+/// event with this probability and return the number of kept events. Since
+/// the flushed events were accepted with the probability intensity / old
+/// maximum, the kept ones are accepted with intensity / new maximum, as the
+/// events of the following bunches. If \p ThinFlushed is empty, \p Rewind is
+/// called and the generation is restarted with the seed of the generator
+/// instead.
+static void
+hitAndMiss(size_t NumberOfEvents,
+           std::shared_ptr<ComPWA::Kinematics> Kinematics,
+           std::shared_ptr<ComPWA::Generator> Generator,
+           std::shared_ptr<ComPWA::Intensity> Intensity, size_t ChunkSize,
+           const std::function<void(HitAndMissSample &)> &Flush,
+           const std::function<void()> &Rewind,
+           const std::function<size_t(size_t, double)> &ThinFlushed) {
+  HitAndMissSample Sample;
+  ChunkSize = std::max<size_t>(1, std::min(ChunkSize, NumberOfEvents));
+  Sample.Events.reserve(ChunkSize);
+  Sample.Points.reserve(ChunkSize);
+  Sample.Intensities.reserve(ChunkSize);
+  Sample.RandomNumbers.reserve(ChunkSize);
+  Sample.Indices.reserve(ChunkSize);
+
+  const unsigned int Seed(Generator->getSeed());
+  unsigned int EventBunchSize(5000);
+  unsigned int FirstEventBunchSize(10 * EventBunchSize);
   double SafetyMargin(0.05);
   double generationMaxValue(0.0);
-  unsigned int initialSeed = Generator->getSeed();
+  uint64_t CurrentIndex(0);
+  if (Generator->unitHypercubeDimension() > 0 &&
+      Generator->unitHypercubeDimension() <= SobolSequence::MaximumDimension) {
+    generationMaxValue =
+        (1.0 + SafetyMargin) * maximum(Intensity, Kinematics, Generator);
+  }
+  size_t NumberOfFlushedEvents(0);
 
-  std::vector<ComPWA::Event> tmp_events(EventBunchSize);
-  std::vector<double> Intensities(tmp_events.size());
-  std::vector<double> RandomNumbers(Intensities.size());
+  std::vector<ComPWA::Event> tmp_events(FirstEventBunchSize);
+  std::vector<ComPWA::DataPoint> Points;
+  std::vector<double> Intensities;
+  std::vector<double> RandomNumbers;
 
-  LOG(INFO) << "Generating hit-and-miss sample: [" << NumberOfEvents
-            << " events] ";
   ComPWA::ProgressBar bar(NumberOfEvents);
+  size_t Progress(0);
   while (true) {
     // generate events
-    std::generate(
-        tmp_events.begin(), tmp_events.end(),
-        [Generator]() -> ComPWA::Event { return Generator->generate(); });
+    generateEventBunch(*Generator, CurrentIndex, tmp_events, RandomNumbers);
+    CurrentIndex += tmp_events.size();
 
     // evaluate function
     // Note: some event generators create events outside of the phase space
     // boundary (due to numerical instability and precision). These events have
     // to be ignored!
+    Points.resize(tmp_events.size());
     std::transform(pstl::execution::par_unseq, tmp_events.begin(),
-                   tmp_events.end(), Intensities.begin(),
-                   [Kinematics, Intensity](const ComPWA::Event &evt) -> double {
-                     ComPWA::DataPoint point(Kinematics->convert(evt));
+                   tmp_events.end(), Points.begin(),
+                   [Kinematics](const ComPWA::Event &evt) {
+                     return Kinematics->convert(evt);
+                   });
+    Intensities.resize(tmp_events.size());
+    std::transform(pstl::execution::par_unseq, tmp_events.begin(),
+                   tmp_events.end(), Points.begin(), Intensities.begin(),
+                   [Kinematics, Intensity](const ComPWA::Event &evt,
+                                           const ComPWA::DataPoint &point) {
                      if (!Kinematics->isWithinPhaseSpace(point))
                        return 0.0;
                      return evt.Weight * Intensity->evaluate(point);
@@ -58,44 +226,164 @@ generate(unsigned int NumberOfEvents,
     // determine maximum
     double BunchMax(*std::max_element(pstl::execution::par_unseq,
                                       Intensities.begin(), Intensities.end()));
-    // restart generation if we got above the current maximum
+    // raise the maximum and thin the accepted events if we got above it
     if (BunchMax > generationMaxValue) {
+      double OldMaxValue(generationMaxValue);
       generationMaxValue = (1.0 + SafetyMargin) * BunchMax;
-      if (events.size() > 0) {
-        events.clear();
-        Generator->setSeed(initialSeed);
-        bar = ComPWA::ProgressBar(NumberOfEvents);
-        LOG(INFO) << "Tools::generate() | Error in HitMiss "
-                     "procedure: Maximum value of random number generation "
-                     "smaller then amplitude maximum! We raise the maximum "
-                     "to "
-                  << generationMaxValue << " value and restart generation!";
-        continue;
+      size_t NumberOfRemovedEvents(Sample.thin(generationMaxValue));
+      size_t NumberOfRemovedFlushedEvents(0);
+      if (NumberOfFlushedEvents > 0) {
+        if (!ThinFlushed) {
+          LOG(WARNING) << "Tools::generate() | Maximum value of random number "
+                          "generation smaller then amplitude maximum! We "
+                          "raise the maximum to "
+                       << generationMaxValue << " and restart the generation, "
+                       << NumberOfFlushedEvents
+                       << " events were already written.";
+          Rewind();
+          Generator->setSeed(Seed);
+          NumberOfFlushedEvents = 0;
+          Sample.clear();
+          CurrentIndex = 0;
+          tmp_events.resize(FirstEventBunchSize);
+          continue;
+        }
+        size_t NumberOfKeptEvents(ThinFlushed(
+            NumberOfFlushedEvents, OldMaxValue / generationMaxValue));
+        NumberOfRemovedFlushedEvents =
+            NumberOfFlushedEvents - NumberOfKeptEvents;
+        NumberOfFlushedEvents = NumberOfKeptEvents;
       }
+      if (NumberOfRemovedEvents + NumberOfRemovedFlushedEvents > 0)
+        LOG(INFO) << "Tools::generate() | Maximum value of random number "
+                     "generation smaller then amplitude maximum! We raise the "
+                     "maximum to "
+                  << generationMaxValue << " and remove "
+                  << NumberOfRemovedEvents + NumberOfRemovedFlushedEvents
+                  << " of the accepted events (" << NumberOfRemovedFlushedEvents
+                  << " were already written).";
     }
-    // do hit and miss
-    // first generate random numbers (no multithreading here, to ensure
-    // deterministic behavior independent on the number of threads)
-    std::generate(RandomNumbers.begin(), RandomNumbers.end(),
-                  [Generator, generationMaxValue]() -> double {
-                    return Generator->uniform(0, generationMaxValue);
-                  });
 
+    // do hit and miss
     for (unsigned int i = 0; i < tmp_events.size(); ++i) {
-      if (RandomNumbers[i] < Intensities[i]) {
-        events.push_back(tmp_events[i]);
-        events.back().Weight = 1.0;
+      if (!Sample.accept(tmp_events[i], Points[i], Intensities[i],
+                         RandomNumbers[i], generationMaxValue,
+                         CurrentIndex - tmp_events.size() + i))
+        continue;
+      size_t NumberOfAcceptedEvents(NumberOfFlushedEvents +
+                                    Sample.Events.size());
+      if (NumberOfAcceptedEvents > Progress) {
+        ++Progress;
         bar.next();
-        if (events.size() == NumberOfEvents)
-          break;
       }
+      if (Sample.Events.size() == ChunkSize ||
+          NumberOfAcceptedEvents == NumberOfEvents) {
+        NumberOfFlushedEvents += Sample.Events.size();
+        Flush(Sample);
+        Sample.clear();
+      }
+      if (NumberOfFlushedEvents == NumberOfEvents)
+        return;
     }
-    if (events.size() == NumberOfEvents)
-      break;
+    tmp_events.resize(EventBunchSize);
   }
-  auto DataSample = std::make_shared<ComPWA::Data::DataSet>(events);
-  DataSample->convertEventsToDataPoints(Kinematics);
-  return DataSample;
+}
+
+/// Hit-and-miss sample of \p NumberOfEvents events, which is kept in memory.
+static HitAndMissSample
+hitAndMiss(unsigned int NumberOfEvents,
+           std::shared_ptr<ComPWA::Kinematics> Kinematics,
+           std::shared_ptr<ComPWA::Generator> Generator,
+           std::shared_ptr<ComPWA::Intensity> Intensity) {
+  HitAndMissSample Result;
+  // the sample is flushed once at the end, so it is never rewound
+  hitAndMiss(NumberOfEvents, Kinematics, Generator, Intensity, NumberOfEvents,
+             [&Result](HitAndMissSample &Sample) { std::swap(Result, Sample); },
+             [&Result]() { Result.clear(); }, {});
+  return Result;
+}
+
+std::shared_ptr<ComPWA::Data::DataSet>
+generate(unsigned int NumberOfEvents,
+         std::shared_ptr<ComPWA::Kinematics> Kinematics,
+         std::shared_ptr<ComPWA::Generator> Generator,
+         std::shared_ptr<ComPWA::Intensity> Intensity) {
+  std::vector<ComPWA::Event> events;
+  if (NumberOfEvents <= 0)
+    return std::make_shared<ComPWA::Data::DataSet>(events);
+
+  LOG(INFO) << "Generating hit-and-miss sample: [" << NumberOfEvents
+            << " events] ";
+  auto Sample(hitAndMiss(NumberOfEvents, Kinematics, Generator, Intensity));
+  for (auto &evt : Sample.Events)
+    evt.Weight = 1.0;
+
+  // the kinematic variables of the evaluation of the intensity are reused
+  return std::make_shared<ComPWA::Data::DataSet>(
+      std::move(Sample.Events), Sample.Points,
+      Kinematics->getKinematicVariableNames());
+}
+
+void generate(size_t NumberOfEvents,
+              std::shared_ptr<ComPWA::Kinematics> Kinematics,
+              std::shared_ptr<ComPWA::Generator> Generator,
+              std::shared_ptr<ComPWA::Intensity> Intensity,
+              ComPWA::Data::EventChunkWriter &Writer, size_t ChunkSize) {
+  // Rewinds the writer and writes the written events again, each one with
+  // probability \p Probability. The random numbers of the n-th thinning are
+  // taken from the streams (position in the file, ThinningSubstream + n).
+  uint32_t NumberOfThinnings(0);
+  auto ThinWrittenEvents = [&](size_t NumberOfWrittenEvents,
+                               double Probability) {
+    uint32_t Substream(ComPWA::Generator::ThinningSubstream +
+                       NumberOfThinnings++);
+    Writer.rewind();
+    size_t NumberOfKeptEvents(0);
+    for (size_t First = 0; First < NumberOfWrittenEvents; First += ChunkSize) {
+      auto Events = Writer.readEvents(
+          First, std::min(ChunkSize, NumberOfWrittenEvents - First));
+      size_t Size(0);
+      for (size_t i = 0; i < Events.size(); ++i) {
+        double RandomNumber(
+            Generator->hasRandomStreams()
+                ? Generator->randomStream(First + i, Substream).uniform()
+                : Generator->uniform(0, 1));
+        if (!(RandomNumber < Probability))
+          continue;
+        if (Size != i)
+          Events[Size] = std::move(Events[i]);
+        ++Size;
+      }
+      Events.resize(Size);
+      std::vector<ComPWA::DataPoint> Points(Size);
+      std::transform(pstl::execution::par_unseq, Events.begin(), Events.end(),
+                     Points.begin(), [Kinematics](const ComPWA::Event &evt) {
+                       return Kinematics->convert(evt);
+                     });
+      // the kept events are never written behind the ones which are not read
+      // yet
+      Writer.writeEvents(Events, Points);
+      NumberOfKeptEvents += Size;
+    }
+    return NumberOfKeptEvents;
+  };
+
+  if (NumberOfEvents > 0) {
+    LOG(INFO) << "Generating hit-and-miss sample: [" << NumberOfEvents
+              << " events, written in chunks of " << ChunkSize << "] ";
+    ChunkSize = std::max<size_t>(1, ChunkSize);
+    hitAndMiss(NumberOfEvents, Kinematics, Generator, Intensity, ChunkSize,
+               [&Writer](HitAndMissSample &Sample) {
+                 for (auto &evt : Sample.Events)
+                   evt.Weight = 1.0;
+                 Writer.writeEvents(Sample.Events, Sample.Points);
+               },
+               [&Writer]() { Writer.rewind(); },
+               Writer.canReadEvents()
+                   ? std::function<size_t(size_t, double)>(ThinWrittenEvents)
+                   : std::function<size_t(size_t, double)>());
+  }
+  Writer.close();
 }
 
 std::shared_ptr<ComPWA::Data::DataSet>
@@ -139,7 +427,6 @@ generate(unsigned int NumberOfEvents,
   if (maxSampleWeight <= 0.0)
     throw std::runtime_error("Tools::generate() Sample maximum value is zero!");
   double generationMaxValue(maxSampleWeight * (1.0 + SafetyMargin));
-  unsigned int initialSeed = Generator->getSeed();
 
   LOG(INFO) << "Tools::generate() | Using " << generationMaxValue
             << " as maximum value of the intensity.";
@@ -162,6 +449,8 @@ generate(unsigned int NumberOfEvents,
   LOG(INFO) << "Generating hit-and-miss sample: [" << NumberOfEvents
             << " events] ";
   ComPWA::ProgressBar bar(NumberOfEvents);
+  size_t Progress(0);
+  HitAndMissSample Sample;
   while (true) {
     if (CurrentStartIndex + EventBunchSize > limit)
       EventBunchSize = limit - CurrentStartIndex;
@@ -182,56 +471,65 @@ generate(unsigned int NumberOfEvents,
 
     // determine maximum
     double BunchMax(*std::max_element(pstl::execution::par_unseq,
-                                      Intensities.begin(), Intensities.end()));
-    // restart generation if we got above the current maximum
+                                      Intensities.begin(),
+                                      Intensities.begin() + EventBunchSize));
+    // raise the maximum and thin the accepted events if we got above it
     if (maxSampleWeight * BunchMax > generationMaxValue) {
       generationMaxValue = maxSampleWeight * (1.0 + SafetyMargin) * BunchMax;
       LOG(INFO) << "We raise the maximum to " << generationMaxValue;
-      if (events.size() > 0) {
-        events.clear();
-        Generator->setSeed(initialSeed);
-        CurrentStartIterator = PhspEvents.begin();
-        CurrentTrueStartIterator = PhspEvents.begin();
-        if (phspTrue)
-          CurrentTrueStartIterator = phspTrue->getEventList().begin();
-        CurrentStartIndex = 0;
-        bar = ComPWA::ProgressBar(NumberOfEvents);
-        LOG(INFO) << "Tools::generate() | Error in HitMiss "
-                     "procedure: Maximum value of random number generation "
-                     "smaller then amplitude maximum! Restarting generation!";
+      if (Sample.Events.size() > 0) {
+        size_t NumberOfRemovedEvents(Sample.thin(generationMaxValue));
+        LOG(INFO) << "Tools::generate() | Maximum value of random number "
+                     "generation smaller then amplitude maximum! Removed "
+                  << NumberOfRemovedEvents << " of the accepted events.";
       }
-      continue;
     }
 
     // do hit and miss
     // first generate random numbers (no multithreading here, to ensure
     // deterministic behavior independent on the number of threads)
-    std::generate(RandomNumbers.begin(), RandomNumbers.end(),
-                  [Generator, generationMaxValue]() -> double {
-                    return Generator->uniform(0, generationMaxValue);
-                  });
+    if (Generator->hasRandomStreams()) {
+      for (unsigned int i = 0; i < EventBunchSize; ++i)
+        RandomNumbers[i] =
+            Generator
+                ->randomStream(CurrentStartIndex + i,
+                               ComPWA::Generator::AcceptanceSubstream)
+                .uniform();
+    } else {
+      std::generate(RandomNumbers.begin(),
+                    RandomNumbers.begin() + EventBunchSize,
+                    [Generator]() -> double {
+                      return Generator->uniform(0, 1);
+                    });
+    }
 
-    for (unsigned int i = 0; i < TrueEventsBunch.size(); ++i) {
-      if (RandomNumbers[i] < CurrentStartIterator->Weight * Intensities[i]) {
-        events.push_back(*CurrentStartIterator);
-        events.back().Weight = 1.0;
+    for (unsigned int i = 0; i < EventBunchSize; ++i) {
+      if (Sample.accept(*CurrentStartIterator,
+                        CurrentStartIterator->Weight * Intensities[i],
+                        RandomNumbers[i], generationMaxValue,
+                        CurrentStartIndex + i) &&
+          Sample.Events.size() > Progress) {
+        ++Progress;
         bar.next();
-        if (events.size() == NumberOfEvents)
-          break;
       }
       ++CurrentStartIterator;
+      if (Sample.Events.size() == NumberOfEvents)
+        break;
     }
 
     // increment true iterator
     std::advance(CurrentTrueStartIterator, EventBunchSize);
     CurrentStartIndex += EventBunchSize;
 
-    if (events.size() == NumberOfEvents)
+    if (Sample.Events.size() == NumberOfEvents)
       break;
 
     if (CurrentStartIndex >= limit)
       break;
   }
+  events = std::move(Sample.Events);
+  for (auto &evt : events)
+    evt.Weight = 1.0;
   double gen_eff = (double)events.size() / NumberOfEvents;
   if (CurrentStartIndex > NumberOfEvents) {
     gen_eff = (double)events.size() / CurrentStartIndex;
@@ -250,6 +548,27 @@ generatePhsp(unsigned int nEvents, std::shared_ptr<ComPWA::Generator> gen) {
   LOG(INFO) << "Generating phase-space MC: [" << nEvents << " events] ";
 
   ComPWA::ProgressBar bar(nEvents);
+  if (gen->hasRandomStreams()) {
+    sample.reserve(nEvents);
+    uint64_t CurrentIndex(0);
+    std::vector<ComPWA::Event> Events(5000);
+    std::vector<double> RandomNumbers;
+    while (sample.size() < nEvents) {
+      generateEventBunch(*gen, CurrentIndex, Events, RandomNumbers);
+      CurrentIndex += Events.size();
+      for (unsigned int i = 0; i < Events.size(); ++i) {
+        if (RandomNumbers[i] > Events[i].Weight)
+          continue;
+        sample.push_back(Events[i]);
+        sample.back().Weight = 1.0;
+        bar.next();
+        if (sample.size() == nEvents)
+          break;
+      }
+    }
+    return std::make_shared<ComPWA::Data::DataSet>(sample);
+  }
+
   for (unsigned int i = 0; i < nEvents; ++i) {
     ComPWA::Event tmp = gen->generate();
     double ampRnd = gen->uniform(0, 1);
@@ -276,88 +595,198 @@ generateImportanceSampledPhsp(unsigned int NumberOfEvents,
   std::vector<ComPWA::Event> events;
   if (NumberOfEvents <= 0)
     return std::make_shared<ComPWA::Data::DataSet>(events);
-  // initialize generator output vector
-  unsigned int EventBunchSize(5000);
-  events.reserve(NumberOfEvents);
 
-  double SafetyMargin(0.05);
-  double generationMaxValue(0.0);
-  unsigned int initialSeed = Generator->getSeed();
-  double WeightSum(0.0);
-
-  std::vector<ComPWA::Event> tmp_events(EventBunchSize);
-  std::vector<double> Intensities(tmp_events.size());
-  std::vector<double> RandomNumbers(Intensities.size());
   LOG(INFO)
       << "Generating phase space sample (hit-and-miss importance sampled): ["
       << NumberOfEvents << " events] ";
+  auto Sample(hitAndMiss(NumberOfEvents, Kinematics, Generator, Intensity));
+  events = std::move(Sample.Events);
+  double WeightSum(0.0);
+  for (size_t i = 0; i < events.size(); ++i) {
+    double weight(events[i].Weight / Sample.Intensities[i]);
+    events[i].Weight = weight;
+    WeightSum += weight;
+  }
+  // now just rescale the event weights so that sum(event weights) = # events
+  double rescale_factor(NumberOfEvents / WeightSum);
+  for (auto &evt : events) {
+    evt.Weight = evt.Weight * rescale_factor;
+  }
+
+  // the kinematic variables of the evaluation of the intensity are reused
+  return std::make_shared<ComPWA::Data::DataSet>(
+      std::move(events), Sample.Points,
+      Kinematics->getKinematicVariableNames());
+}
+
+std::shared_ptr<ComPWA::Data::DataSet>
+generateAdaptive(unsigned int NumberOfEvents,
+                 std::shared_ptr<ComPWA::Kinematics> Kinematics,
+                 std::shared_ptr<ComPWA::Generator> Generator,
+                 std::shared_ptr<ComPWA::Intensity> Intensity,
+                 unsigned int NumberOfPilotEvents) {
+  std::vector<ComPWA::Event> events;
+  if (NumberOfEvents <= 0)
+    return std::make_shared<ComPWA::Data::DataSet>(events);
+  if (NumberOfPilotEvents <= 0)
+    throw std::runtime_error(
+        "Tools::generateAdaptive() | No pilot events requested!");
+  const unsigned int Dimension(Generator->unitHypercubeDimension());
+  if (Dimension == 0 || !Generator->hasRandomStreams()) {
+    LOG(WARNING) << "Tools::generateAdaptive() | The generator can't map the "
+                    "unit hypercube to events, we generate against the "
+                    "global maximum instead.";
+    return generate(NumberOfEvents, Kinematics, Generator, Intensity);
+  }
+  auto StartTime = std::chrono::steady_clock::now();
+  auto seconds = [](std::chrono::steady_clock::time_point Start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                         Start)
+        .count();
+  };
+
+  // Maps the coordinates of the points [First, Last) in the unit hypercube to
+  // events and evaluates the intensity times the event weight, which is the
+  // density in the unit hypercube.
+  // Note: some event generators create events outside of the phase space
+  // boundary (due to numerical instability and precision). These events have
+  // to be ignored!
+  std::vector<double> Coordinates;
+  std::vector<ComPWA::Event> Events;
+  std::vector<double> Intensities;
+  auto evaluate = [&](size_t NumberOfPoints) {
+    Events.resize(NumberOfPoints);
+    Intensities.resize(NumberOfPoints);
+    const size_t ChunkSize(1024);
+    std::vector<size_t> Chunks((NumberOfPoints + ChunkSize - 1) / ChunkSize);
+    std::iota(Chunks.begin(), Chunks.end(), 0);
+    std::for_each(
+        pstl::execution::par, Chunks.begin(), Chunks.end(), [&](size_t Chunk) {
+          size_t First(Chunk * ChunkSize);
+          size_t Last(std::min(NumberOfPoints, First + ChunkSize));
+          std::vector<double> ChunkCoordinates(
+              Coordinates.begin() + First * Dimension,
+              Coordinates.begin() + Last * Dimension);
+          Generator->mapUnitHypercube(ChunkCoordinates, Events.begin() + First,
+                                      Events.begin() + Last);
+          for (size_t i = First; i < Last; ++i) {
+            ComPWA::DataPoint Point(Kinematics->convert(Events[i]));
+            Intensities[i] = 0.0;
+            if (Kinematics->isWithinPhaseSpace(Point))
+              Intensities[i] = Events[i].Weight * Intensity->evaluate(Point);
+          }
+        });
+  };
+
+  // build the envelope in the unit hypercube from the pilot points
+  Coordinates.resize(NumberOfPilotEvents * Dimension);
+  for (size_t i = 0; i < NumberOfPilotEvents; ++i) {
+    auto Stream =
+        Generator->randomStream(i, ComPWA::Generator::EventSubstream);
+    for (size_t k = 0; k < Dimension; ++k)
+      Coordinates[i * Dimension + k] = Stream.uniform();
+  }
+  evaluate(NumberOfPilotEvents);
+  std::vector<ComPWA::DataPoint> PilotPoints(NumberOfPilotEvents);
+  for (size_t i = 0; i < NumberOfPilotEvents; ++i)
+    PilotPoints[i].KinematicVariableList.assign(
+        Coordinates.begin() + i * Dimension,
+        Coordinates.begin() + (i + 1) * Dimension);
+  IntensityEnvelope Envelope(PilotPoints, Intensities);
+  double PilotMaximum(
+      *std::max_element(Intensities.begin(), Intensities.end()));
+  LOG(INFO) << "Tools::generateAdaptive() | Built envelope with "
+            << Envelope.numberOfCells() << " cells from "
+            << NumberOfPilotEvents << " events in " << seconds(StartTime)
+            << "s. Expected efficiency: " << Envelope.efficiency()
+            << " (with the global maximum: "
+            << std::accumulate(Intensities.begin(), Intensities.end(), 0.0) /
+                   NumberOfPilotEvents / PilotMaximum
+            << ")";
+
+  // The event with index i is drawn from the envelope with the random number
+  // stream (i, EventSubstream): a cell with a probability proportional to the
+  // integral of its envelope and a uniform point in the cell. It is accepted
+  // if u * envelope < intensity for the uniform random number u of the
+  // stream (i, AcceptanceSubstream). So the sample only depends on the seed
+  // and the envelope.
+  //
+  // If the intensity exceeds the envelope of its cell, the accepted events are
+  // biased, since the events of the cell were drawn and accepted with a too
+  // small envelope. The envelope is raised and the generation is restarted,
+  // so that the sample is the one of the raised envelope.
+  LOG(INFO) << "Generating hit-and-miss sample with adaptive envelope: ["
+            << NumberOfEvents << " events] ";
   ComPWA::ProgressBar bar(NumberOfEvents);
-  while (true) {
-    // generate events
-    std::generate(
-        tmp_events.begin(), tmp_events.end(),
-        [Generator]() -> ComPWA::Event { return Generator->generate(); });
+  size_t Progress(0);
+  const uint64_t FirstIndex(NumberOfPilotEvents);
+  uint64_t CurrentIndex(FirstIndex);
+  size_t NumberOfEvaluations(NumberOfPilotEvents);
+  size_t NumberOfCorrections(0);
+  unsigned int EventBunchSize(5000);
+  std::vector<size_t> Cells(EventBunchSize);
+  std::vector<uint64_t> Indices(EventBunchSize);
+  Coordinates.resize(EventBunchSize * Dimension);
+  while (events.size() < NumberOfEvents) {
+    std::iota(Indices.begin(), Indices.end(), CurrentIndex);
+    std::for_each(pstl::execution::par_unseq, Indices.begin(), Indices.end(),
+                  [&](uint64_t Index) {
+                    size_t i(Index - CurrentIndex);
+                    auto Stream = Generator->randomStream(
+                        Index, ComPWA::Generator::EventSubstream);
+                    Cells[i] = Envelope.drawCell(Stream.uniform());
+                    auto Point = Coordinates.begin() + i * Dimension;
+                    for (size_t k = 0; k < Dimension; ++k)
+                      Point[k] = Stream.uniform();
+                    Envelope.mapToCell(Cells[i], Point);
+                  });
+    evaluate(EventBunchSize);
+    NumberOfEvaluations += EventBunchSize;
 
-    // evaluate function
-    // Note: some event generators create events outside of the phase space
-    // boundary (due to numerical instability and precision). These events have
-    // to be ignored!
-    std::transform(pstl::execution::par_unseq, tmp_events.begin(),
-                   tmp_events.end(), Intensities.begin(),
-                   [Kinematics, Intensity](const ComPWA::Event &evt) -> double {
-                     ComPWA::DataPoint point(Kinematics->convert(evt));
-                     if (!Kinematics->isWithinPhaseSpace(point))
-                       return 0.0;
-                     return evt.Weight * Intensity->evaluate(point);
-                   });
-    // determine maximum
-    double BunchMax(*std::max_element(pstl::execution::par_unseq,
-                                      Intensities.begin(), Intensities.end()));
-    // restart generation if we got above the current maximum
-    if (BunchMax > generationMaxValue) {
-      generationMaxValue = (1.0 + SafetyMargin) * BunchMax;
-      if (events.size() > 0) {
-        events.clear();
-        WeightSum = 0.0;
-        Generator->setSeed(initialSeed);
-        bar = ComPWA::ProgressBar(NumberOfEvents);
-        LOG(INFO)
-            << "Tools::generateImportanceSampledPhsp() | Error in HitMiss "
-               "procedure: Maximum value of random number generation "
-               "smaller then amplitude maximum! We raise the maximum "
-               "to "
-            << generationMaxValue << " value and restart generation!";
+    size_t NumberOfViolations(0);
+    for (size_t i = 0; i < EventBunchSize; ++i) {
+      if (Intensities[i] <= Envelope.value(Cells[i]))
         continue;
-      }
+      ++NumberOfViolations;
+      Envelope.raise(Cells[i], Intensities[i]);
+    }
+    if (NumberOfViolations > 0) {
+      ++NumberOfCorrections;
+      LOG(INFO) << "Tools::generateAdaptive() | Envelope exceeded by "
+                << NumberOfViolations
+                << " events! We raise it and restart the generation.";
+      events.clear();
+      CurrentIndex = FirstIndex;
+      continue;
     }
-    // do hit and miss
-    // first generate random numbers (no multithreading here, to ensure
-    // deterministic behavior independent on the number of threads)
-    std::generate(RandomNumbers.begin(), RandomNumbers.end(),
-                  [Generator, generationMaxValue]() -> double {
-                    return Generator->uniform(0, generationMaxValue);
-                  });
 
-    for (unsigned int i = 0; i < tmp_events.size(); ++i) {
-      if (RandomNumbers[i] < Intensities[i]) {
-        events.push_back(tmp_events[i]);
-        double weight(tmp_events[i].Weight / Intensities[i]);
-        events.back().Weight = weight;
-        WeightSum += weight;
-        bar.next();
-        if (events.size() == NumberOfEvents)
-          break;
+    for (size_t i = 0; i < EventBunchSize && events.size() < NumberOfEvents;
+         ++i) {
+      double RandomNumber(
+          Generator
+              ->randomStream(Indices[i], ComPWA::Generator::AcceptanceSubstream)
+              .uniform());
+      if (RandomNumber * Envelope.value(Cells[i]) < Intensities[i]) {
+        events.push_back(Events[i]);
+        events.back().Weight = 1.0;
       }
     }
-    if (events.size() == NumberOfEvents)
-      break;
-  }
-  // now just rescale the event weights so that sum(event weights) = # events
-  double rescale_factor(NumberOfEvents / WeightSum);
-  for (auto &evt : events) {
-    evt.Weight = evt.Weight * rescale_factor;
+    CurrentIndex += EventBunchSize;
+    for (; Progress < events.size(); ++Progress)
+      bar.next();
   }
 
+  LOG(INFO) << "Tools::generateAdaptive() | Generated " << events.size()
+            << " events in " << seconds(StartTime)
+            << "s. Corrections of the envelope: " << NumberOfCorrections
+            << ", intensity evaluations: " << NumberOfEvaluations
+            << ", efficiency of the hit-and-miss: "
+            << (double)events.size() / (CurrentIndex - FirstIndex)
+            << " (expected with the global maximum: "
+            << Envelope.integral() / Envelope.maximum() *
+                   (double)events.size() / (CurrentIndex - FirstIndex)
+            << ")";
+
   auto DataSample = std::make_shared<ComPWA::Data::DataSet>(events);
   DataSample->convertEventsToDataPoints(Kinematics);
   return DataSample;
@@ -10,6 +10,7 @@
 #ifndef COMPWA_TOOLS_GENERATE_HPP_
 #define COMPWA_TOOLS_GENERATE_HPP_
 
+#include <cstddef>
 #include <memory>
 
 namespace ComPWA {
@@ -20,6 +21,7 @@ class Intensity;
 
 namespace Data {
 class DataSet;
+class EventChunkWriter;
 }
 
 namespace Tools {
@@ -30,6 +32,23 @@ generate(unsigned int NumberOfEvents,
          std::shared_ptr<ComPWA::Generator> Generator,
          std::shared_ptr<ComPWA::Intensity> Intensity);
 
+/// Hit-and-miss sample as generate() above, which is written to \p Writer in
+/// chunks of \p ChunkSize events instead of being kept in memory. Only the
+/// number of written events and the current maximum of the intensity are
+/// kept. The kinematic variables of the evaluation of the intensity are passed
+/// to the writer with the events. If the maximum has to be raised after events
+/// were written, the writer is rewound, and the written events are read back
+/// chunk by chunk and each one is written again with the probability old
+/// maximum / new maximum (see EventChunkWriter::readEvents()). Writers which
+/// can't read their events restart the generation with the seed of the
+/// generator instead. The writer is closed at the end.
+void generate(size_t NumberOfEvents,
+              std::shared_ptr<ComPWA::Kinematics> Kinematics,
+              std::shared_ptr<ComPWA::Generator> Generator,
+              std::shared_ptr<ComPWA::Intensity> Intensity,
+              ComPWA::Data::EventChunkWriter &Writer,
+              size_t ChunkSize = 100000);
+
 std::shared_ptr<ComPWA::Data::DataSet>
 generate(unsigned int NumberOfEvents,
          std::shared_ptr<ComPWA::Kinematics> Kinematics,
@@ -47,6 +66,25 @@ generateImportanceSampledPhsp(unsigned int NumberOfEvents,
                               std::shared_ptr<ComPWA::Generator> Generator,
                               std::shared_ptr<ComPWA::Intensity> Intensity);
 
+/// Hit-and-miss sample with an adaptive envelope of the intensity. The
+/// envelope is built in the unit hypercube of the generator from
+/// \p NumberOfPilotEvents uniform points, see IntensityEnvelope. The points
+/// are drawn from the envelope, mapped to events with
+/// Generator::mapUnitHypercube() and accepted with the probability
+/// intensity / envelope. For narrow structures this saves most of the
+/// intensity evaluations of the hit-and-miss against the global maximum. If
+/// the intensity of an event exceeds the envelope, the envelope is raised and
+/// the generation is restarted. The sample only depends on the seed of the
+/// generator, not on the number of threads. Generators without random number
+/// streams or unit hypercube mapping fall back to generate(). The efficiency
+/// and timing are reported in the log.
+std::shared_ptr<ComPWA::Data::DataSet>
+generateAdaptive(unsigned int NumberOfEvents,
+                 std::shared_ptr<ComPWA::Kinematics> Kinematics,
+                 std::shared_ptr<ComPWA::Generator> Generator,
+                 std::shared_ptr<ComPWA::Intensity> Intensity,
+                 unsigned int NumberOfPilotEvents = 100000);
+
 } // namespace Tools
 } // namespace ComPWA
 #endif
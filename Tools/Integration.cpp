@@ -6,15 +6,21 @@
 #include <cmath>
 #include <complex>
 #include <functional>
+#include <limits>
+#include <numeric>
 
+#include "Core/Generator.hpp"
 #include "Core/Intensity.hpp"
 #include "Core/Kinematics.hpp"
 #include "Core/Logging.hpp"
+#include "Core/SobolSequence.hpp"
+#include "Data/ChunkedDataSet.hpp"
 #include "Data/DataSet.hpp"
 #include "Integration.hpp"
 
 #include "ThirdParty/parallelstl/include/pstl/algorithm"
 #include "ThirdParty/parallelstl/include/pstl/execution"
+#include <tbb/task_arena.h>
 
 namespace ComPWA {
 namespace Tools {
@@ -79,45 +85,132 @@ protected:
 
 MCIntegrationStrategy::MCIntegrationStrategy(
     std::shared_ptr<const ComPWA::Data::DataSet> phspsample, double phspvolume)
-    : PhspSample(phspsample), PhspVolume(phspvolume) {}
+    : PhspSample(phspsample), PhspVolume(phspvolume), FrozenNumberOfPoints(0) {
+}
+
+/// Evaluates weight * \p intensity at the points [\p First, \p Last) in
+/// parallel.
+static std::vector<double>
+evaluateIntensities(const ComPWA::Intensity &intensity,
+                    std::vector<DataPoint>::const_iterator First,
+                    std::vector<DataPoint>::const_iterator Last) {
+  std::vector<double> Intensities(Last - First);
+  std::transform(pstl::execution::par, First, Last, Intensities.begin(),
+                 [&intensity](const ComPWA::DataPoint &point) -> double {
+                   return point.Weight * intensity.evaluate(point);
+                 });
+  return Intensities;
+}
+
+///
+/// Sums of the ratio estimator sum(w_i f_i) / sum(w_i) of an integral and of
+/// its variance.
+///
+struct MCSums {
+  size_t Count = 0;
+  double Values = 0.0;
+  double ValuesSquared = 0.0;
+  double Weights = 0.0;
+  double WeightsSquared = 0.0;
+  double Products = 0.0;
+
+  /// Adds a point with weight \p Weight and weight * intensity \p Value.
+  void add(double Value, double Weight) {
+    ++Count;
+    Values += Value;
+    ValuesSquared += Value * Value;
+    Weights += Weight;
+    WeightsSquared += Weight * Weight;
+    Products += Value * Weight;
+  }
+
+  /// Integral and its uncertainty for the phase space volume \p Volume
+  std::pair<double, double> result(double Volume) const {
+    double Ratio(Values / Weights);
+    if (Count < 2)
+      return std::make_pair(Volume * Ratio, 0.0);
+    // variance of the linearized estimator sum(w_i f_i - Ratio * w_i)
+    double Deviations(ValuesSquared - 2.0 * Ratio * Products +
+                      Ratio * Ratio * WeightsSquared);
+    double Error(std::sqrt(std::max(0.0, Deviations) * Count / (Count - 1)) /
+                 Weights);
+    return std::make_pair(Volume * Ratio, Volume * Error);
+  }
+};
+
+const size_t MCIntegrationStrategy::BatchSize;
 
-double MCIntegrationStrategy::integrate(
-    std::shared_ptr<const Intensity> intensity) const{
+/// Sums of the first \p Size \p Points, in batches of \p BatchSize points.
+/// If \p TargetPrecision is positive, the summation stops after the first
+/// batch at which the relative uncertainty is below it.
+static MCSums sumIntensities(const ComPWA::Intensity &intensity,
+                             const std::vector<DataPoint> &Points, size_t Size,
+                             size_t BatchSize, double TargetPrecision) {
+  MCSums Sums;
+  for (size_t First = 0; First < Size; First += BatchSize) {
+    auto Begin = Points.begin() + First;
+    auto End = Points.begin() + std::min(Size, First + BatchSize);
+    std::vector<double> Intensities(evaluateIntensities(intensity, Begin, End));
+    for (size_t i = 0; i < Intensities.size(); ++i)
+      Sums.add(Intensities[i], Begin[i].Weight);
+
+    auto Result = Sums.result(1.0);
+    if (TargetPrecision > 0.0 &&
+        Result.second < TargetPrecision * std::abs(Result.first))
+      break;
+  }
+  return Sums;
+}
+
+std::pair<double, double> MCIntegrationStrategy::integrateWithError(
+    std::shared_ptr<const Intensity> intensity, double TargetPrecision) const {
   const std::vector<DataPoint> &PhspDataPoints = PhspSample->getDataPointList();
   if (!PhspDataPoints.size()) {
     LOG(DEBUG) << "Tools::integrate(): Integral can not be calculated "
                   "since phsp sample is empty.";
-    return 1.0;
+    return std::make_pair(1.0, 0.0);
   }
-  // Note: once c++17 is set as standard for this project use
-  // std::transform_reduce and std::reduce instead of std::accumulate
-  /*double IntensitySum = std::transform_reduce(
-      pstl::execution::par_unseq, sample.begin(), sample.end(), 0.0,
-      std::plus<double>(), [&intensity](const ComPWA::DataPoint &p) -> double {
-        return p.Weight * intensity->evaluate(p);
-      });*/
-  std::vector<double> Intensities(PhspDataPoints.size());
-  // TODO: once the evaluation of the intensity is thread safe, use the
-  // par_unseq execution policy
-  std::transform(pstl::execution::seq, PhspDataPoints.begin(),
-                 PhspDataPoints.end(), Intensities.begin(),
-                 [&intensity](const ComPWA::DataPoint &point) -> double {
-                   return point.Weight * intensity->evaluate(point);
-                 });
-  double IntensitySum(
-      std::accumulate(Intensities.begin(), Intensities.end(), 0.0));
-  double WeightSum(
-      std::accumulate(PhspDataPoints.begin(), PhspDataPoints.end(), 0.0,
-                      [](const double &a, const ComPWA::DataPoint &b) {
-                        return a + b.Weight;
-                      }));
 
-  return (IntensitySum * PhspVolume / WeightSum);
+  if (FrozenNumberOfPoints)
+    return sumIntensities(*intensity, PhspDataPoints, FrozenNumberOfPoints,
+                          BatchSize, 0.0)
+        .result(PhspVolume);
+  MCSums Sums(sumIntensities(*intensity, PhspDataPoints, PhspDataPoints.size(),
+                             BatchSize, TargetPrecision));
+  if (Sums.Count < PhspDataPoints.size())
+    LOG(DEBUG) << "MCIntegrationStrategy::integrate(): target precision "
+                  "reached after "
+               << Sums.Count << " of " << PhspDataPoints.size() << " points";
+  return Sums.result(PhspVolume);
+}
+
+void MCIntegrationStrategy::freeze(std::shared_ptr<const Intensity> intensity,
+                                   double TargetPrecision) {
+  const std::vector<DataPoint> &PhspDataPoints = PhspSample->getDataPointList();
+  FrozenNumberOfPoints = 0;
+  if (!(TargetPrecision > 0.0) || !PhspDataPoints.size())
+    return;
+  MCSums Sums(sumIntensities(*intensity, PhspDataPoints, PhspDataPoints.size(),
+                             BatchSize, TargetPrecision));
+  FrozenNumberOfPoints = Sums.Count;
+  LOG(INFO) << "MCIntegrationStrategy::freeze(): the integration continues "
+               "with "
+            << FrozenNumberOfPoints << " of " << PhspDataPoints.size()
+            << " points";
 }
 
 std::shared_ptr<ComPWA::FunctionTree> MCIntegrationStrategy::createFunctionTree(
     std::shared_ptr<const ComPWA::Intensity> intensity,
     const std::string &suffix) const {
+  const std::vector<DataPoint> &PhspDataPoints = PhspSample->getDataPointList();
+  if (FrozenNumberOfPoints && FrozenNumberOfPoints < PhspDataPoints.size()) {
+    // the tree uses the same points as integrate()
+    auto FrozenSample = std::make_shared<ComPWA::Data::DataSet>(
+        std::vector<DataPoint>(PhspDataPoints.begin(),
+                               PhspDataPoints.begin() + FrozenNumberOfPoints));
+    return MCIntegrationStrategy(FrozenSample, PhspVolume)
+        .createFunctionTree(intensity, suffix);
+  }
 
   const ParameterList &PhspDataSampleList = PhspSample->getParameterList();
 
@@ -153,6 +246,467 @@ std::shared_ptr<ComPWA::FunctionTree> MCIntegrationStrategy::createFunctionTree(
   return tr;
 }
 
+/// DataSet of the variables of \p Kinematics of the \p Points. Only the
+/// variables which are used by the model are stored.
+static std::shared_ptr<ComPWA::Data::DataSet>
+createDataSet(const std::vector<DataPoint> &Points,
+              const ComPWA::Kinematics &Kinematics) {
+  std::vector<std::string> Names(Kinematics.getKinematicVariableNames());
+  std::vector<bool> UsedVariables(Kinematics.getUsedKinematicVariables());
+  std::vector<std::vector<double>> Columns(Names.size());
+  std::vector<double> Weights;
+  for (auto const &Point : Points) {
+    for (size_t j = 0; j < Columns.size(); ++j) {
+      if (UsedVariables[j])
+        Columns[j].push_back(Point.KinematicVariableList[j]);
+    }
+    Weights.push_back(Point.Weight);
+  }
+  return std::make_shared<ComPWA::Data::DataSet>(
+      std::move(Columns), std::move(Weights), std::move(Names));
+}
+
+/// Data points of the [\p First, \p Last) events. Only the variables which
+/// are used by the model (see Kinematics::getUsedKinematicVariables()) are
+/// calculated, the others are NaN.
+static std::vector<DataPoint>
+convertEvents(const ComPWA::Kinematics &Kinematics,
+              std::vector<ComPWA::Event>::const_iterator First,
+              std::vector<ComPWA::Event>::const_iterator Last) {
+  std::vector<std::vector<double>> Columns;
+  std::vector<double> Weights;
+  Kinematics.convert(std::vector<ComPWA::Event>(First, Last),
+                     Kinematics.getUsedKinematicVariables(), Columns, Weights);
+  std::vector<DataPoint> Points(Weights.size());
+  for (size_t i = 0; i < Points.size(); ++i) {
+    Points[i].KinematicVariableList.resize(
+        Columns.size(), std::numeric_limits<double>::quiet_NaN());
+    for (size_t j = 0; j < Columns.size(); ++j) {
+      if (Columns[j].size())
+        Points[i].KinematicVariableList[j] = Columns[j][i];
+    }
+    Points[i].Weight = Weights[i];
+  }
+  return Points;
+}
+
+///
+/// Separable grid of the VEGAS algorithm in the unit hypercube. Each
+/// coordinate is divided into bins of equal probability, so the density of a
+/// coordinate in a bin is inversely proportional to the bin width.
+///
+struct VegasGrid {
+  /// Bin edges of each coordinate
+  std::vector<std::vector<double>> Edges;
+
+  /// Creates equal bins in each of the \p Dimension coordinates.
+  VegasGrid(unsigned int Dimension, unsigned int NumberOfBins)
+      : Edges(Dimension, std::vector<double>(NumberOfBins + 1)) {
+    for (auto &e : Edges)
+      for (unsigned int i = 0; i <= NumberOfBins; ++i)
+        e[i] = double(i) / NumberOfBins;
+  }
+
+  /// Maps the uniform random number \p y of coordinate \p d to the grid. The
+  /// bin is stored in \p Bin and \p Jacobian is multiplied with the inverse
+  /// density of the grid.
+  double map(size_t d, double y, unsigned int &Bin, double &Jacobian) const {
+    auto const &e = Edges[d];
+    size_t n(e.size() - 1);
+    double z(y * n);
+    size_t i(std::min(n - 1, size_t(z)));
+    double Width(e[i + 1] - e[i]);
+    Bin = i;
+    Jacobian *= n * Width;
+    return e[i] + (z - i) * Width;
+  }
+
+  /// Moves the edges of coordinate \p d, such that the bins get equal shares of
+  /// the smoothed and damped \p Contributions of the old bins, as in the
+  /// original VEGAS algorithm.
+  void refine(size_t d, const std::vector<double> &Contributions,
+              double Alpha) {
+    size_t n(Contributions.size());
+    if (n < 2)
+      return;
+    std::vector<double> Smoothed(n);
+    Smoothed[0] = 0.5 * (Contributions[0] + Contributions[1]);
+    Smoothed[n - 1] = 0.5 * (Contributions[n - 2] + Contributions[n - 1]);
+    for (size_t i = 1; i < n - 1; ++i)
+      Smoothed[i] = (Contributions[i - 1] + Contributions[i] +
+                     Contributions[i + 1]) /
+                    3.0;
+    double Sum(std::accumulate(Smoothed.begin(), Smoothed.end(), 0.0));
+    if (!(Sum > 0.0))
+      return;
+
+    std::vector<double> Weights(n, 0.0);
+    for (size_t i = 0; i < n; ++i) {
+      if (!(Smoothed[i] > 0.0))
+        continue;
+      double Ratio(Sum / Smoothed[i]);
+      Weights[i] =
+          Ratio > 1.0 + 1e-12
+              ? std::pow((Ratio - 1.0) / Ratio / std::log(Ratio), Alpha)
+              : 1.0;
+    }
+    double WeightPerBin(std::accumulate(Weights.begin(), Weights.end(), 0.0) /
+                        n);
+
+    auto &e = Edges[d];
+    std::vector<double> NewEdges(e);
+    double Accumulated(0.0);
+    size_t NewEdge(1);
+    for (size_t i = 0; i < n; ++i) {
+      Accumulated += Weights[i];
+      for (; Accumulated > WeightPerBin && NewEdge < n; ++NewEdge) {
+        Accumulated -= WeightPerBin;
+        NewEdges[NewEdge] =
+            e[i + 1] - (e[i + 1] - e[i]) * Accumulated / Weights[i];
+      }
+    }
+    e = NewEdges;
+  }
+};
+
+/// Combination of the results of VEGAS iterations, weighted with their
+/// inverse variances
+static std::pair<double, double>
+combine(const std::vector<std::pair<double, double>> &Results) {
+  double InverseVarianceSum(0.0), WeightedSum(0.0);
+  for (auto const &x : Results) {
+    if (x.second > 0.0) {
+      InverseVarianceSum += 1.0 / (x.second * x.second);
+      WeightedSum += x.first / (x.second * x.second);
+    }
+  }
+  if (!(InverseVarianceSum > 0.0))
+    return Results.back();
+  return std::make_pair(WeightedSum / InverseVarianceSum,
+                        1.0 / std::sqrt(InverseVarianceSum));
+}
+
+VegasIntegrationStrategy::VegasIntegrationStrategy(
+    std::shared_ptr<ComPWA::Kinematics> Kinematics_,
+    std::shared_ptr<ComPWA::Generator> Generator_, double PhspVolume_,
+    unsigned int NumberOfEvaluations_, unsigned int NumberOfIterations_,
+    unsigned int NumberOfBins_, double Alpha_)
+    : Kinematics(Kinematics_), Generator(Generator_), PhspVolume(PhspVolume_),
+      NumberOfEvaluations(std::max(2u, NumberOfEvaluations_)),
+      NumberOfIterations(std::max(1u, NumberOfIterations_)),
+      NumberOfBins(std::max(2u, NumberOfBins_)), Alpha(Alpha_),
+      FrozenPhspVolume(0.0) {
+  if (!Kinematics || !Generator)
+    throw std::runtime_error("VegasIntegrationStrategy::"
+                             "VegasIntegrationStrategy(): kinematics and "
+                             "generator are required!");
+  if (Generator->unitHypercubeDimension() == 0)
+    throw std::runtime_error("VegasIntegrationStrategy::"
+                             "VegasIntegrationStrategy(): the generator has "
+                             "no unit hypercube parametrization!");
+}
+
+std::pair<double, double> VegasIntegrationStrategy::run(
+    std::shared_ptr<const ComPWA::Intensity> intensity,
+    std::vector<DataPoint> *Sample, double *SampleVolume,
+    double TargetPrecision) const {
+  const unsigned int Dimension(Generator->unitHypercubeDimension());
+  const size_t NumberOfPoints(NumberOfEvaluations);
+  VegasGrid Grid(Dimension, NumberOfBins);
+  uint64_t NextIndex(0);
+  std::vector<double> Coordinates(NumberOfPoints * Dimension);
+  std::vector<unsigned int> Bins(NumberOfPoints * Dimension);
+  std::vector<double> Jacobians(NumberOfPoints);
+  std::vector<ComPWA::Event> Events(NumberOfPoints);
+  std::vector<DataPoint> Points(NumberOfPoints);
+  std::vector<double> Values(NumberOfPoints);
+
+  std::vector<std::pair<double, double>> Results;
+  for (unsigned int Iteration = 0; Iteration < NumberOfIterations;
+       ++Iteration) {
+    // draw the points from the grid and map them to events, the weights of
+    // the events are multiplied with the inverse density of the grid
+    auto drawPoints = [&](size_t First, size_t Last) {
+      for (size_t i = First; i < Last; ++i) {
+        Jacobians[i] = 1.0;
+        if (Generator->hasRandomStreams()) {
+          auto Stream = Generator->randomStream(
+              NextIndex + i, ComPWA::Generator::EventSubstream);
+          for (size_t d = 0; d < Dimension; ++d)
+            Coordinates[i * Dimension + d] = Grid.map(
+                d, Stream.uniform(), Bins[i * Dimension + d], Jacobians[i]);
+        } else {
+          for (size_t d = 0; d < Dimension; ++d)
+            Coordinates[i * Dimension + d] =
+                Grid.map(d, Generator->uniform(0, 1), Bins[i * Dimension + d],
+                         Jacobians[i]);
+        }
+      }
+      std::vector<double> ChunkCoordinates(
+          Coordinates.begin() + First * Dimension,
+          Coordinates.begin() + Last * Dimension);
+      Generator->mapUnitHypercube(ChunkCoordinates, Events.begin() + First,
+                                  Events.begin() + Last);
+    };
+    if (Generator->hasRandomStreams()) {
+      const size_t ChunkSize(1024);
+      std::vector<size_t> Chunks((NumberOfPoints + ChunkSize - 1) /
+                                 ChunkSize);
+      std::iota(Chunks.begin(), Chunks.end(), 0);
+      std::for_each(pstl::execution::par, Chunks.begin(), Chunks.end(),
+                    [&](size_t Chunk) {
+                      drawPoints(Chunk * ChunkSize,
+                                 std::min(NumberOfPoints,
+                                          (Chunk + 1) * ChunkSize));
+                    });
+    } else {
+      drawPoints(0, NumberOfPoints);
+    }
+    NextIndex += NumberOfPoints;
+
+    Points = convertEvents(*Kinematics, Events.begin(), Events.end());
+    for (size_t i = 0; i < NumberOfPoints; ++i)
+      Points[i].Weight *= Jacobians[i];
+    // events outside of the phase space contribute zero
+    std::transform(pstl::execution::par, Points.begin(), Points.end(),
+                   Values.begin(), [&](const DataPoint &Point) -> double {
+                     if (!Kinematics->isWithinPhaseSpace(Point))
+                       return 0.0;
+                     return Point.Weight * intensity->evaluate(Point);
+                   });
+    MCSums Sums;
+    for (size_t i = 0; i < NumberOfPoints; ++i)
+      Sums.add(Values[i], Points[i].Weight);
+    Results.push_back(Sums.result(PhspVolume));
+    LOG(DEBUG) << "VegasIntegrationStrategy::integrate(): iteration "
+               << Iteration << ": " << Results.back().first << " +- "
+               << Results.back().second;
+
+    bool Last(Iteration + 1 == NumberOfIterations);
+    if (TargetPrecision > 0.0 && Results.size() > 1) {
+      auto Combined = combine(Results);
+      if (Combined.second < TargetPrecision * std::abs(Combined.first)) {
+        LOG(DEBUG) << "VegasIntegrationStrategy::integrate(): target "
+                      "precision reached after "
+                   << Results.size() << " iterations";
+        Last = true;
+      }
+    }
+
+    if (Last) {
+      if (Sample) {
+        // the points outside of the phase space are dropped, the volume
+        // keeps their share of the weights
+        Sample->clear();
+        double InsideWeights(0.0);
+        for (size_t i = 0; i < NumberOfPoints; ++i) {
+          if (!Kinematics->isWithinPhaseSpace(Points[i]))
+            continue;
+          Sample->push_back(Points[i]);
+          InsideWeights += Points[i].Weight;
+        }
+        *SampleVolume = PhspVolume * InsideWeights / Sums.Weights;
+      }
+      break;
+    }
+
+    // adapt the grid to the squared contributions
+    for (size_t d = 0; d < Dimension; ++d) {
+      std::vector<double> BinContributions(NumberOfBins, 0.0);
+      for (size_t i = 0; i < NumberOfPoints; ++i)
+        BinContributions[Bins[i * Dimension + d]] += Values[i] * Values[i];
+      Grid.refine(d, BinContributions, Alpha);
+    }
+  }
+
+  auto Result = combine(Results);
+  double Chi2(0.0);
+  for (auto const &x : Results)
+    if (x.second > 0.0)
+      Chi2 += std::pow((x.first - Result.first) / x.second, 2);
+  if (Results.size() > 1 && Chi2 / (Results.size() - 1) > 5.0)
+    LOG(WARNING) << "VegasIntegrationStrategy::integrate(): the results of "
+                    "the iterations are inconsistent (chi2/ndf = "
+                 << Chi2 / (Results.size() - 1)
+                 << "). Consider more evaluations per iteration.";
+  return Result;
+}
+
+void VegasIntegrationStrategy::freeze(
+    std::shared_ptr<const ComPWA::Intensity> intensity,
+    double TargetPrecision) {
+  auto Result = run(intensity, &FrozenSample, &FrozenPhspVolume,
+                    TargetPrecision);
+  if (FrozenSample.empty())
+    throw std::runtime_error("VegasIntegrationStrategy::freeze(): no point is "
+                             "within the phase space!");
+  LOG(INFO) << "VegasIntegrationStrategy::freeze(): adapted grid gives "
+            << Result.first << " +- " << Result.second
+            << ", the integration continues with the fixed sample of "
+            << FrozenSample.size() << " points";
+}
+
+std::pair<double, double> VegasIntegrationStrategy::integrateWithError(
+    std::shared_ptr<const ComPWA::Intensity> intensity,
+    double TargetPrecision) const {
+  std::pair<double, double> Result;
+  if (FrozenSample.empty()) {
+    Result = run(intensity, nullptr, nullptr, TargetPrecision);
+  } else {
+    std::vector<double> Intensities(evaluateIntensities(
+        *intensity, FrozenSample.begin(), FrozenSample.end()));
+    MCSums Sums;
+    for (size_t i = 0; i < Intensities.size(); ++i)
+      Sums.add(Intensities[i], FrozenSample[i].Weight);
+    Result = Sums.result(FrozenPhspVolume);
+  }
+  LOG(DEBUG) << "VegasIntegrationStrategy::integrate(): integral is "
+             << Result.first << " +- " << Result.second;
+  return Result;
+}
+
+std::shared_ptr<ComPWA::FunctionTree>
+VegasIntegrationStrategy::createFunctionTree(
+    std::shared_ptr<const ComPWA::Intensity> intensity,
+    const std::string &suffix) const {
+  std::vector<DataPoint> Points(FrozenSample);
+  double Volume(FrozenPhspVolume);
+  if (Points.empty())
+    run(intensity, &Points, &Volume, 0.0);
+  if (Points.empty())
+    throw std::runtime_error("VegasIntegrationStrategy::createFunctionTree():"
+                             " no point is within the phase space!");
+
+  // the sample of the last iteration as weighted phase space sample
+  return MCIntegrationStrategy(createDataSet(Points, *Kinematics), Volume)
+      .createFunctionTree(intensity, suffix);
+}
+
+QMCIntegrationStrategy::QMCIntegrationStrategy(
+    std::shared_ptr<ComPWA::Kinematics> Kinematics_,
+    std::shared_ptr<ComPWA::Generator> Generator_, double PhspVolume_,
+    unsigned int NumberOfPoints_, unsigned int NumberOfReplicas_)
+    : Kinematics(Kinematics_), Generator(Generator_), PhspVolume(PhspVolume_),
+      NumberOfPoints(std::max(1u, NumberOfPoints_)),
+      NumberOfReplicas(std::max(2u, NumberOfReplicas_)),
+      FrozenNumberOfReplicas(0) {
+  if (!Kinematics || !Generator)
+    throw std::runtime_error("QMCIntegrationStrategy::QMCIntegrationStrategy():"
+                             " kinematics and generator are required!");
+  unsigned int Dimension(Generator->unitHypercubeDimension());
+  if (Dimension == 0 || Dimension > SobolSequence::MaximumDimension)
+    throw std::runtime_error(
+        "QMCIntegrationStrategy::QMCIntegrationStrategy(): the generator has "
+        "no unit hypercube parametrization of a supported dimension!");
+  if (NumberOfPoints & (NumberOfPoints - 1))
+    LOG(WARNING) << "QMCIntegrationStrategy::QMCIntegrationStrategy(): the "
+                    "Sobol sequence works best with a power of two as number "
+                    "of points, not "
+                 << NumberOfPoints;
+}
+
+std::vector<DataPoint>
+QMCIntegrationStrategy::generatePoints(unsigned int Replica) const {
+  const unsigned int Dimension(Generator->unitHypercubeDimension());
+  SobolSequence Sequence(Dimension,
+                         (uint64_t(Generator->getSeed()) << 32) | Replica);
+  std::vector<ComPWA::Event> Events(NumberOfPoints);
+  const size_t ChunkSize(1024);
+  std::vector<size_t> Chunks((Events.size() + ChunkSize - 1) / ChunkSize);
+  std::iota(Chunks.begin(), Chunks.end(), 0);
+  std::for_each(pstl::execution::par, Chunks.begin(), Chunks.end(),
+                [&](size_t Chunk) {
+                  size_t First(Chunk * ChunkSize);
+                  size_t Last(std::min(Events.size(), First + ChunkSize));
+                  std::vector<double> Coordinates((Last - First) * Dimension);
+                  Sequence.generate(First, Last - First, Coordinates.data());
+                  Generator->mapUnitHypercube(Coordinates,
+                                              Events.begin() + First,
+                                              Events.begin() + Last);
+                });
+  return convertEvents(*Kinematics, Events.begin(), Events.end());
+}
+
+/// Mean of the \p Results and its uncertainty
+static std::pair<double, double> mean(const std::vector<double> &Results) {
+  double Mean(std::accumulate(Results.begin(), Results.end(), 0.0) /
+              Results.size());
+  if (Results.size() < 2)
+    return std::make_pair(Mean, 0.0);
+  double SquaredDeviations(0.0);
+  for (auto x : Results)
+    SquaredDeviations += (x - Mean) * (x - Mean);
+  return std::make_pair(
+      Mean,
+      std::sqrt(SquaredDeviations / (Results.size() * (Results.size() - 1))));
+}
+
+std::vector<double> QMCIntegrationStrategy::integrateReplicas(
+    std::shared_ptr<const ComPWA::Intensity> intensity,
+    double TargetPrecision) const {
+  std::vector<double> Results;
+  unsigned int Replicas(FrozenNumberOfReplicas ? FrozenNumberOfReplicas
+                                               : NumberOfReplicas);
+  for (unsigned int Replica = 0; Replica < Replicas; ++Replica) {
+    auto Points = generatePoints(Replica);
+    std::vector<double> Intensities(
+        evaluateIntensities(*intensity, Points.begin(), Points.end()));
+    double IntensitySum(
+        std::accumulate(Intensities.begin(), Intensities.end(), 0.0));
+    double WeightSum(std::accumulate(
+        Points.begin(), Points.end(), 0.0,
+        [](double a, const ComPWA::DataPoint &b) { return a + b.Weight; }));
+    Results.push_back(PhspVolume * IntensitySum / WeightSum);
+
+    auto Result = mean(Results);
+    if (!FrozenNumberOfReplicas && TargetPrecision > 0.0 &&
+        Results.size() >= 3 &&
+        Result.second < TargetPrecision * std::abs(Result.first))
+      break;
+  }
+  return Results;
+}
+
+std::pair<double, double> QMCIntegrationStrategy::integrateWithError(
+    std::shared_ptr<const ComPWA::Intensity> intensity,
+    double TargetPrecision) const {
+  std::vector<double> Results(integrateReplicas(intensity, TargetPrecision));
+  auto Result = mean(Results);
+  LOG(DEBUG) << "QMCIntegrationStrategy::integrate(): integral is "
+             << Result.first << " +- " << Result.second << " ("
+             << Results.size() << " replicas)";
+  return Result;
+}
+
+void QMCIntegrationStrategy::freeze(
+    std::shared_ptr<const ComPWA::Intensity> intensity,
+    double TargetPrecision) {
+  FrozenNumberOfReplicas = 0;
+  if (!(TargetPrecision > 0.0))
+    return;
+  FrozenNumberOfReplicas =
+      integrateReplicas(intensity, TargetPrecision).size();
+  LOG(INFO) << "QMCIntegrationStrategy::freeze(): the integration continues "
+               "with "
+            << FrozenNumberOfReplicas << " of " << NumberOfReplicas
+            << " replicas";
+}
+
+std::shared_ptr<ComPWA::FunctionTree>
+QMCIntegrationStrategy::createFunctionTree(
+    std::shared_ptr<const ComPWA::Intensity> intensity,
+    const std::string &suffix) const {
+  std::vector<DataPoint> Points;
+  unsigned int Replicas(FrozenNumberOfReplicas ? FrozenNumberOfReplicas
+                                               : NumberOfReplicas);
+  for (unsigned int Replica = 0; Replica < Replicas; ++Replica) {
+    auto ReplicaPoints = generatePoints(Replica);
+    Points.insert(Points.end(), ReplicaPoints.begin(), ReplicaPoints.end());
+  }
+  return MCIntegrationStrategy(createDataSet(Points, *Kinematics), PhspVolume)
+      .createFunctionTree(intensity, suffix);
+}
+
 double integrate(std::shared_ptr<const Intensity> intensity,
                  std::shared_ptr<const ComPWA::Data::DataSet> phspsample,
                  double phspVolume) {
@@ -160,6 +714,31 @@ double integrate(std::shared_ptr<const Intensity> intensity,
   return MCIntegrator.integrate(intensity);
 }
 
+double integrate(std::shared_ptr<const Intensity> intensity,
+                 const ComPWA::Data::ChunkedDataSet &phspsample,
+                 double phspVolume) {
+  if (!phspsample.numberOfEvents()) {
+    LOG(DEBUG) << "Tools::integrate(): Integral can not be calculated "
+                  "since phsp sample is empty.";
+    return 1.0;
+  }
+  double IntensitySum(0.0);
+  double WeightSum(0.0);
+  phspsample.forEachDataPoint([&](const ComPWA::DataPoint &point) {
+    IntensitySum += point.Weight * intensity->evaluate(point);
+    WeightSum += point.Weight;
+  });
+  return (IntensitySum * phspVolume / WeightSum);
+}
+
+double integrateIsolated(const IntegrationStrategy &integrator,
+                         std::shared_ptr<const Intensity> intensity) {
+  double Integral(0.0);
+  tbb::this_task_arena::isolate(
+      [&]() { Integral = integrator.integrate(intensity); });
+  return Integral;
+}
+
 double maximum(std::shared_ptr<const Intensity> intensity,
                const std::vector<DataPoint> &sample) {
 
@@ -169,11 +748,12 @@ double maximum(std::shared_ptr<const Intensity> intensity,
     return 1.0;
   }
 
-  std::vector<double> Intensities;
-  Intensities.reserve(sample.size());
-  std::transform(sample.begin(), sample.end(), Intensities.begin(),
+  std::vector<double> Intensities(sample.size());
+  std::transform(pstl::execution::par_unseq, sample.begin(), sample.end(),
+                 Intensities.begin(),
                  [&intensity](const ComPWA::DataPoint &point) -> double {
-                   return point.Weight * intensity->evaluate(point);
+                   double Value(point.Weight * intensity->evaluate(point));
+                   return std::isfinite(Value) ? Value : 0.0;
                  });
   // determine maximum
   double max(*std::max_element(Intensities.begin(), Intensities.end()));
@@ -184,9 +764,193 @@ double maximum(std::shared_ptr<const Intensity> intensity,
 double maximum(std::shared_ptr<const Intensity> intensity,
                std::shared_ptr<const Data::DataSet> sample,
                std::shared_ptr<Kinematics> kin) {
-
   return maximum(intensity, sample->getDataPointList());
 }
 
+/// Maximizes \p Function with the Nelder-Mead simplex method. The initial
+/// simplex consists of \p Position and \p Position + \p Steps[i] * e_i
+/// (or - \p Steps[i] * e_i, if the first one has value -infinity). Points
+/// with value -infinity, e.g. outside of the phase space, are never accepted.
+/// \p Function must not return NaN. The iteration stops if the values of the
+/// simplex agree within the relative \p Tolerance or after
+/// \p MaximalNumberOfEvaluations evaluations.
+///
+/// Returns the largest value found and sets \p Position to its position.
+static double
+nelderMead(const std::function<double(const std::vector<double> &)> &Function,
+           std::vector<double> &Position, const std::vector<double> &Steps,
+           double Tolerance, unsigned int MaximalNumberOfEvaluations) {
+  size_t n(Position.size());
+  std::vector<std::vector<double>> Vertices(n + 1, Position);
+  std::vector<double> Values(n + 1);
+  Values[0] = Function(Position);
+  for (size_t i = 0; i < n; ++i) {
+    Vertices[i + 1][i] += Steps[i];
+    Values[i + 1] = Function(Vertices[i + 1]);
+    if (std::isinf(Values[i + 1])) {
+      Vertices[i + 1][i] = Position[i] - Steps[i];
+      Values[i + 1] = Function(Vertices[i + 1]);
+    }
+  }
+  unsigned int NumberOfEvaluations(2 * n + 1);
+
+  std::vector<size_t> Order(n + 1);
+  std::vector<double> Centroid(n), Trial(n), Trial2(n);
+  auto pointOnLine = [&](double t, std::vector<double> &Point) {
+    // Centroid + t * (Centroid - worst vertex)
+    for (size_t j = 0; j < n; ++j)
+      Point[j] = Centroid[j] + t * (Centroid[j] - Vertices[Order[n]][j]);
+    ++NumberOfEvaluations;
+    return Function(Point);
+  };
+  while (true) {
+    std::iota(Order.begin(), Order.end(), 0);
+    std::sort(Order.begin(), Order.end(),
+              [&Values](size_t a, size_t b) { return Values[a] > Values[b]; });
+    double Best(Values[Order[0]]), Worst(Values[Order[n]]);
+    if (NumberOfEvaluations >= MaximalNumberOfEvaluations ||
+        std::abs(Best - Worst) <= Tolerance * std::abs(Best))
+      break;
+
+    std::fill(Centroid.begin(), Centroid.end(), 0.0);
+    for (size_t i = 0; i < n; ++i)
+      for (size_t j = 0; j < n; ++j)
+        Centroid[j] += Vertices[Order[i]][j] / n;
+
+    double Reflected(pointOnLine(1.0, Trial));
+    if (Reflected > Best) {
+      double Expanded(pointOnLine(2.0, Trial2));
+      if (Expanded > Reflected) {
+        Vertices[Order[n]] = Trial2;
+        Values[Order[n]] = Expanded;
+      } else {
+        Vertices[Order[n]] = Trial;
+        Values[Order[n]] = Reflected;
+      }
+      continue;
+    }
+    if (Reflected > Values[Order[n - 1]]) {
+      Vertices[Order[n]] = Trial;
+      Values[Order[n]] = Reflected;
+      continue;
+    }
+    // contract outside or inside of the simplex
+    double Contracted(pointOnLine(Reflected > Worst ? 0.5 : -0.5, Trial2));
+    if (Contracted > std::max(Reflected, Worst)) {
+      Vertices[Order[n]] = Trial2;
+      Values[Order[n]] = Contracted;
+      continue;
+    }
+    // shrink towards the best vertex
+    for (size_t i = 1; i <= n; ++i) {
+      auto &Vertex = Vertices[Order[i]];
+      for (size_t j = 0; j < n; ++j)
+        Vertex[j] = 0.5 * (Vertex[j] + Vertices[Order[0]][j]);
+      Values[Order[i]] = Function(Vertex);
+    }
+    NumberOfEvaluations += n;
+  }
+  Position = Vertices[Order[0]];
+  return Values[Order[0]];
+}
+
+double maximum(std::shared_ptr<const Intensity> intensity,
+               std::shared_ptr<Kinematics> kin,
+               std::shared_ptr<Generator> generator,
+               unsigned int NumberOfPoints, unsigned int NumberOfCandidates) {
+  const unsigned int Dimension(generator->unitHypercubeDimension());
+  if (Dimension == 0 || Dimension > SobolSequence::MaximumDimension) {
+    LOG(DEBUG) << "Tools::maximum(): the generator has no unit hypercube "
+                  "parametrization of a supported dimension.";
+    return 0.0;
+  }
+  NumberOfPoints = std::max(1u, NumberOfPoints);
+
+  // weight * intensity of the events of the unit hypercube coordinates
+  // [First, First + Dimension * Number), non-physical points and non-finite
+  // values are -infinity
+  auto evaluate = [&](const double *First, size_t Number, double *Values) {
+    std::vector<double> Coordinates(First, First + Dimension * Number);
+    std::vector<ComPWA::Event> Events(Number);
+    generator->mapUnitHypercube(Coordinates, Events.begin(), Events.end());
+    std::vector<DataPoint> Points(
+        convertEvents(*kin, Events.begin(), Events.end()));
+    for (size_t i = 0; i < Number; ++i) {
+      Values[i] = -std::numeric_limits<double>::infinity();
+      if (!kin->isWithinPhaseSpace(Points[i]))
+        continue;
+      double Value(Events[i].Weight * intensity->evaluate(Points[i]));
+      if (std::isfinite(Value))
+        Values[i] = Value;
+    }
+  };
+
+  // coarse scan with a Sobol sequence
+  SobolSequence Sequence(Dimension, uint64_t(generator->getSeed()) << 32);
+  std::vector<double> Coordinates(size_t(NumberOfPoints) * Dimension);
+  std::vector<double> Intensities(NumberOfPoints);
+  const size_t ChunkSize(1024);
+  std::vector<size_t> Chunks((NumberOfPoints + ChunkSize - 1) / ChunkSize);
+  std::iota(Chunks.begin(), Chunks.end(), 0);
+  std::for_each(pstl::execution::par, Chunks.begin(), Chunks.end(),
+                [&](size_t Chunk) {
+                  size_t First(Chunk * ChunkSize);
+                  size_t Last(std::min<size_t>(NumberOfPoints,
+                                               First + ChunkSize));
+                  double *x = &Coordinates[First * Dimension];
+                  Sequence.generate(First, Last - First, x);
+                  evaluate(x, Last - First, &Intensities[First]);
+                });
+  size_t NumberOfStartPoints(
+      std::min<size_t>(std::max(1u, NumberOfCandidates), NumberOfPoints));
+  std::vector<size_t> Candidates(NumberOfPoints);
+  std::iota(Candidates.begin(), Candidates.end(), 0);
+  // the values are never NaN, so the ordering is strict weak
+  std::partial_sort(Candidates.begin(),
+                    Candidates.begin() + NumberOfStartPoints, Candidates.end(),
+                    [&Intensities](size_t a, size_t b) {
+                      return Intensities[a] > Intensities[b];
+                    });
+  Candidates.resize(NumberOfStartPoints);
+  double SampleMaximum(Intensities[Candidates.front()]);
+  if (std::isinf(SampleMaximum)) {
+    LOG(WARNING) << "Tools::maximum(): no point of the scan is within the "
+                    "phase space and has a finite intensity!";
+    return 0.0;
+  }
+
+  // local optimization from each candidate in the unit hypercube, the initial
+  // step is about the distance of the points of the scan
+  std::vector<double> Steps(
+      Dimension, std::min(0.05, std::pow(double(NumberOfPoints),
+                                         -1.0 / Dimension)));
+  std::vector<double> Maxima(NumberOfStartPoints, SampleMaximum);
+  std::transform(
+      pstl::execution::par, Candidates.begin(), Candidates.end(),
+      Maxima.begin(), [&](size_t Candidate) -> double {
+        auto Function = [&](const std::vector<double> &x) -> double {
+          for (auto u : x)
+            if (!(u >= 0.0 && u < 1.0))
+              return -std::numeric_limits<double>::infinity();
+          double Value;
+          evaluate(x.data(), 1, &Value);
+          return Value;
+        };
+        std::vector<double> Position(
+            Coordinates.begin() + Candidate * Dimension,
+            Coordinates.begin() + (Candidate + 1) * Dimension);
+        return std::max(Intensities[Candidate],
+                        nelderMead(Function, Position, Steps, 1e-8,
+                                   200 * (Dimension + 1)));
+      });
+  double Maximum(*std::max_element(Maxima.begin(), Maxima.end()));
+
+  LOG(INFO) << "Tools::maximum(): maximum of the scan of " << NumberOfPoints
+            << " points is " << SampleMaximum << ", local optimization from "
+            << NumberOfStartPoints << " candidates found " << Maximum
+            << " (an estimate, not an upper bound).";
+  return Maximum;
+}
+
 } // namespace Tools
 } // namespace ComPWA
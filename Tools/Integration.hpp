@@ -6,19 +6,22 @@
 #define COMPWA_TOOLS_INTEGRATION_HPP_
 
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include "Core/FunctionTree.hpp"
 
 namespace ComPWA {
 
+class Generator;
 class Intensity;
 struct DataPoint;
 class Kinematics;
 
 namespace Data {
+class ChunkedDataSet;
 class DataSet;
-}
+} // namespace Data
 
 namespace Tools {
 
@@ -27,40 +30,244 @@ public:
   virtual ~IntegrationStrategy() = default;
 
   virtual double
-  integrate(std::shared_ptr<const ComPWA::Intensity> intensity) const = 0;
+  integrate(std::shared_ptr<const ComPWA::Intensity> intensity) const {
+    return integrateWithError(intensity).first;
+  }
+
+  /// Integral of \p intensity and its statistical uncertainty. If \p
+  /// TargetPrecision is positive, the integration may stop early, once the
+  /// relative uncertainty is below \p TargetPrecision. Then the number of
+  /// points depends on the parameters and the integral is a step function of
+  /// them, so fits should fix the points with freeze() instead.
+  virtual std::pair<double, double>
+  integrateWithError(std::shared_ptr<const ComPWA::Intensity> intensity,
+                     double TargetPrecision = 0.0) const = 0;
 
   virtual std::shared_ptr<ComPWA::FunctionTree>
   createFunctionTree(std::shared_ptr<const ComPWA::Intensity> intensity,
                      const std::string &suffix) const = 0;
+
+  /// Fixes the points of the following integrations, e.g. the points of an
+  /// adaptive strategy after its adaptation to \p intensity, or the number of
+  /// points which a pilot integration of \p intensity with \p
+  /// TargetPrecision needs. Then the integral is a smooth function of the
+  /// parameters of the intensity, as the minimization of a fit requires, and
+  /// the following integrations ignore their target precision. The default
+  /// does nothing.
+  virtual void freeze(std::shared_ptr<const ComPWA::Intensity> intensity,
+                      double TargetPrecision = 0.0) {}
 };
 
+///
+/// \class MCIntegrationStrategy
+/// Monte Carlo integration with a phase space sample. The sample is
+/// evaluated in parallel, in batches of BatchSize points. With a target
+/// precision, the integration stops after the first batch at which the
+/// relative uncertainty is below the target. freeze() fixes this number of
+/// points for the following integrations and function trees.
+///
 class MCIntegrationStrategy : public IntegrationStrategy {
 public:
+  /// Number of points which are evaluated between the checks of the
+  /// precision
+  static const size_t BatchSize = 10000;
+
   MCIntegrationStrategy(std::shared_ptr<const ComPWA::Data::DataSet> phspsample,
                         double phspvolume = 1.0);
-  double
-  integrate(std::shared_ptr<const ComPWA::Intensity> intensity) const final;
+
+  std::pair<double, double>
+  integrateWithError(std::shared_ptr<const ComPWA::Intensity> intensity,
+                     double TargetPrecision = 0.0) const final;
 
   std::shared_ptr<ComPWA::FunctionTree>
   createFunctionTree(std::shared_ptr<const ComPWA::Intensity> intensity,
                      const std::string &suffix) const final;
 
+  void freeze(std::shared_ptr<const ComPWA::Intensity> intensity,
+              double TargetPrecision = 0.0) final;
+
 private:
   std::shared_ptr<const ComPWA::Data::DataSet> PhspSample;
   double PhspVolume;
+  /// Number of points of freeze(), all points are used if it is 0
+  size_t FrozenNumberOfPoints;
+};
+
+///
+/// \class VegasIntegrationStrategy
+/// Adaptive Monte Carlo integration with the VEGAS algorithm (G. P. Lepage,
+/// J. Comput. Phys. 27 (1978) 192). The grid is defined in the unit
+/// hypercube of Generator::mapUnitHypercube(): the sampling density g is a
+/// product of piecewise constant densities of the coordinates. Their bins are
+/// adapted iteratively, such that the points are concentrated where weight *
+/// intensity is large. The points are drawn from g directly and mapped to
+/// events by \p Generator, their weights are divided by g.
+///
+/// Each iteration evaluates the intensity at \p NumberOfEvaluations points.
+/// The results of the iterations are combined with the inverse of their
+/// variances as weights. For a generator with random number streams the
+/// result only depends on the seed and the intensity.
+///
+/// The grid depends on the intensity, so the integral of a new adaptation is
+/// not a smooth function of the parameters. For fits, freeze() adapts the
+/// grid once and keeps the points of the last iteration as a fixed weighted
+/// sample for the following integrations.
+///
+class VegasIntegrationStrategy : public IntegrationStrategy {
+public:
+  VegasIntegrationStrategy(std::shared_ptr<ComPWA::Kinematics> Kinematics,
+                           std::shared_ptr<ComPWA::Generator> Generator,
+                           double PhspVolume = 1.0,
+                           unsigned int NumberOfEvaluations = 10000,
+                           unsigned int NumberOfIterations = 5,
+                           unsigned int NumberOfBins = 50,
+                           double Alpha = 1.5);
+
+  /// The iterations stop early, once the relative uncertainty of their
+  /// combination is below \p TargetPrecision. After freeze() the fixed sample
+  /// is used and \p TargetPrecision is ignored.
+  std::pair<double, double>
+  integrateWithError(std::shared_ptr<const ComPWA::Intensity> intensity,
+                     double TargetPrecision = 0.0) const final;
+
+  /// The tree calculates the integral with a fixed sample: the one of
+  /// freeze(), or one drawn from the grid adapted to \p intensity with its
+  /// current parameters.
+  std::shared_ptr<ComPWA::FunctionTree>
+  createFunctionTree(std::shared_ptr<const ComPWA::Intensity> intensity,
+                     const std::string &suffix) const final;
+
+  /// Adapts the grid to \p intensity and keeps the points of the last
+  /// iteration.
+  void freeze(std::shared_ptr<const ComPWA::Intensity> intensity,
+              double TargetPrecision = 0.0) final;
+
+private:
+  /// Runs the iterations and returns the integral and its uncertainty. The
+  /// points of the last iteration within the phase space are stored in
+  /// \p Sample with weights event weight / g, if it is given, and the phase
+  /// space volume which they represent in \p SampleVolume.
+  std::pair<double, double>
+  run(std::shared_ptr<const ComPWA::Intensity> intensity,
+      std::vector<DataPoint> *Sample, double *SampleVolume,
+      double TargetPrecision) const;
+
+  std::shared_ptr<ComPWA::Kinematics> Kinematics;
+  std::shared_ptr<ComPWA::Generator> Generator;
+  double PhspVolume;
+  unsigned int NumberOfEvaluations;
+  unsigned int NumberOfIterations;
+  unsigned int NumberOfBins;
+  double Alpha;
+
+  /// Sample of freeze() and the phase space volume it represents
+  std::vector<DataPoint> FrozenSample;
+  double FrozenPhspVolume;
+};
+
+///
+/// \class QMCIntegrationStrategy
+/// Randomized quasi Monte Carlo integration. The points of scrambled Sobol
+/// sequences (see SobolSequence) are mapped to phase space events with
+/// Generator::mapUnitHypercube(). For smooth intensities the error decreases
+/// almost as 1 / N instead of 1 / sqrt(N) for N points, so a much smaller
+/// sample gives the same precision as MCIntegrationStrategy.
+///
+/// The integral is the mean of \p NumberOfReplicas independently scrambled
+/// sequences of \p NumberOfPoints points each, and the error is estimated from
+/// their spread. The scrambling only depends on the seed of \p Generator.
+///
+class QMCIntegrationStrategy : public IntegrationStrategy {
+public:
+  QMCIntegrationStrategy(std::shared_ptr<ComPWA::Kinematics> Kinematics,
+                         std::shared_ptr<ComPWA::Generator> Generator,
+                         double PhspVolume = 1.0,
+                         unsigned int NumberOfPoints = 4096,
+                         unsigned int NumberOfReplicas = 8);
+
+  /// The replicas are processed until the relative uncertainty of their mean
+  /// is below \p TargetPrecision, but at least three of them.
+  std::pair<double, double>
+  integrateWithError(std::shared_ptr<const ComPWA::Intensity> intensity,
+                     double TargetPrecision = 0.0) const final;
+
+  /// Function tree of the integral over the points of the used replicas.
+  std::shared_ptr<ComPWA::FunctionTree>
+  createFunctionTree(std::shared_ptr<const ComPWA::Intensity> intensity,
+                     const std::string &suffix) const final;
+
+  /// Fixes the number of replicas to the one a pilot integration with \p
+  /// TargetPrecision needs.
+  void freeze(std::shared_ptr<const ComPWA::Intensity> intensity,
+              double TargetPrecision = 0.0) final;
+
+private:
+  /// Data points of replica \p Replica
+  std::vector<DataPoint> generatePoints(unsigned int Replica) const;
+
+  /// Integrals of the replicas, until the relative uncertainty of their mean
+  /// is below \p TargetPrecision
+  std::vector<double>
+  integrateReplicas(std::shared_ptr<const ComPWA::Intensity> intensity,
+                    double TargetPrecision) const;
+
+  std::shared_ptr<ComPWA::Kinematics> Kinematics;
+  std::shared_ptr<ComPWA::Generator> Generator;
+  double PhspVolume;
+  unsigned int NumberOfPoints;
+  unsigned int NumberOfReplicas;
+  /// Number of replicas of freeze(), all are used if it is 0
+  unsigned int FrozenNumberOfReplicas;
 };
 
 double integrate(std::shared_ptr<const Intensity> intensity,
                  std::shared_ptr<const ComPWA::Data::DataSet> phspsample,
                  double phspVolume = 1.0);
 
+/// Monte Carlo integral using a phase space sample which is read chunk by
+/// chunk. The memory consumption is limited by the budget of \p phspsample.
+double integrate(std::shared_ptr<const Intensity> intensity,
+                 const ComPWA::Data::ChunkedDataSet &phspsample,
+                 double phspVolume = 1.0);
+
+/// Integral of \p intensity with \p integrator for a caller which holds a
+/// lock, e.g. for the lazy update of a normalization. While the calling thread
+/// waits for the parallel evaluation of the integral, it only takes part in
+/// this evaluation. It never picks up tasks of an enclosing parallel
+/// algorithm, which could need the same lock.
+double integrateIsolated(const IntegrationStrategy &integrator,
+                         std::shared_ptr<const Intensity> intensity);
+
+/// Largest finite value of weight * \p intensity of the points of \p sample.
 double maximum(std::shared_ptr<const Intensity> intensity,
                const std::vector<DataPoint> &sample);
 
+/// Largest finite value of weight * \p intensity of the points of \p sample,
+/// see above. \p kin is not used.
 double maximum(std::shared_ptr<const Intensity> intensity,
                std::shared_ptr<const Data::DataSet> sample,
                std::shared_ptr<Kinematics> kin);
 
+/// Estimate of the maximum of event weight * \p intensity over the phase
+/// space of \p generator, e.g. for the hit-and-miss of Tools::generate().
+/// The intensity is evaluated on \p NumberOfPoints points of a Sobol sequence
+/// in the unit hypercube of Generator::mapUnitHypercube() first. Starting from
+/// the \p NumberOfCandidates points with the largest values, the maximum is
+/// searched with the Nelder-Mead method in the unit hypercube coordinates.
+/// Hence every point of the search is an event of the generator, and not an
+/// unphysical combination of the kinematic variables. Points outside of
+/// Kinematics::isWithinPhaseSpace() and non-finite values are rejected.
+///
+/// The result is an estimate and not an upper bound: as any local search it
+/// can miss a maximum which is not close to one of the candidates. Users of
+/// the result have to add a safety margin and handle larger values. Returns 0
+/// if the generator has no unit hypercube parametrization.
+double maximum(std::shared_ptr<const Intensity> intensity,
+               std::shared_ptr<Kinematics> kin,
+               std::shared_ptr<Generator> generator,
+               unsigned int NumberOfPoints = 1 << 15,
+               unsigned int NumberOfCandidates = 10);
+
 } // namespace Tools
 } // namespace ComPWA
 
@@ -0,0 +1,183 @@
+// Copyright (c) 2013, 2017 The ComPWA Team.
+// This file is part of the ComPWA framework, check
+// https://github.com/ComPWA/ComPWA/license.txt for details.
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+#include "Tools/IntensityEnvelope.hpp"
+
+namespace ComPWA {
+namespace Tools {
+
+/// Lower limit of the envelope relative to its maximum. Cells without a
+/// non-zero value in the sample keep a small envelope, so that values above it
+/// are still detected.
+static const double MinimalRelativeEnvelope = 1e-3;
+
+IntensityEnvelope::IntensityEnvelope(const std::vector<DataPoint> &Points,
+                                     const std::vector<double> &Values,
+                                     unsigned int MinimalNumberOfPoints_,
+                                     double SafetyMargin_)
+    : Dimension(0),
+      MinimalNumberOfPoints(std::max(1u, MinimalNumberOfPoints_)),
+      SafetyMargin(SafetyMargin_), Efficiency(0.0) {
+  if (Points.size() != Values.size() || Points.empty())
+    throw std::runtime_error("IntensityEnvelope::IntensityEnvelope(): number "
+                             "of points and values do not match or are zero");
+  Dimension = Points.front().KinematicVariableList.size();
+  std::vector<size_t> Indices(Points.size());
+  std::iota(Indices.begin(), Indices.end(), 0);
+  build(Indices, Points, Values, std::vector<double>(Dimension, 0.0),
+        std::vector<double>(Dimension, 1.0));
+
+  double Maximum(maximum());
+  for (auto &x : Envelope)
+    x = std::max(x, MinimalRelativeEnvelope * Maximum);
+  CumulativeIntegral.resize(Envelope.size());
+  updateIntegral(0);
+
+  double ValueSum(0.0), EnvelopeSum(0.0);
+  for (size_t i = 0; i < Points.size(); ++i) {
+    ValueSum += Values[i];
+    EnvelopeSum += Envelope[cell(Points[i])];
+  }
+  if (EnvelopeSum > 0.0)
+    Efficiency = ValueSum / EnvelopeSum;
+}
+
+int IntensityEnvelope::build(std::vector<size_t> &Indices,
+                             const std::vector<DataPoint> &Points,
+                             const std::vector<double> &Values,
+                             std::vector<double> Lower,
+                             std::vector<double> Upper) {
+  size_t n(Indices.size());
+  double CellMaximum(0.0);
+  for (auto i : Indices)
+    CellMaximum = std::max(CellMaximum, Values[i]);
+
+  // find the split with the smallest integral of the envelope, which is
+  // proportional to the number of function evaluations
+  double BestCost(n * CellMaximum);
+  unsigned int BestVariable(0);
+  size_t BestPosition(0);
+  double BestThreshold(0.0);
+  std::vector<double> PrefixMaximum(n), SuffixMaximum(n);
+  if (n >= 2 * MinimalNumberOfPoints && CellMaximum > 0.0) {
+    for (unsigned int v = 0; v < Dimension; ++v) {
+      auto Less = [&Points, v](size_t a, size_t b) {
+        return Points[a].KinematicVariableList[v] <
+               Points[b].KinematicVariableList[v];
+      };
+      std::sort(Indices.begin(), Indices.end(), Less);
+      PrefixMaximum[0] = Values[Indices[0]];
+      for (size_t k = 1; k < n; ++k)
+        PrefixMaximum[k] = std::max(PrefixMaximum[k - 1], Values[Indices[k]]);
+      SuffixMaximum[n - 1] = Values[Indices[n - 1]];
+      for (size_t k = n - 1; k > 0; --k)
+        SuffixMaximum[k - 1] =
+            std::max(SuffixMaximum[k], Values[Indices[k - 1]]);
+      for (size_t k = MinimalNumberOfPoints; k <= n - MinimalNumberOfPoints;
+           ++k) {
+        double Low(Points[Indices[k - 1]].KinematicVariableList[v]);
+        double High(Points[Indices[k]].KinematicVariableList[v]);
+        if (Low == High)
+          continue;
+        double Cost = k * PrefixMaximum[k - 1] + (n - k) * SuffixMaximum[k];
+        if (Cost < BestCost) {
+          BestCost = Cost;
+          BestVariable = v;
+          BestPosition = k;
+          BestThreshold = 0.5 * (Low + High);
+          if (!(BestThreshold > Low))
+            BestThreshold = High;
+        }
+      }
+    }
+  }
+
+  int NodeIndex(Nodes.size());
+  Nodes.push_back(Node{BestVariable, BestThreshold, -1, -1, -1});
+  // only split if the integral is reduced noticeably
+  if (BestPosition == 0 || BestCost > 0.99 * n * CellMaximum) {
+    Nodes[NodeIndex].Cell = Envelope.size();
+    Envelope.push_back((1.0 + SafetyMargin) * CellMaximum);
+    LowerEdges.insert(LowerEdges.end(), Lower.begin(), Lower.end());
+    UpperEdges.insert(UpperEdges.end(), Upper.begin(), Upper.end());
+    return NodeIndex;
+  }
+
+  auto Middle = std::partition(
+      Indices.begin(), Indices.end(), [&](size_t i) {
+        return Points[i].KinematicVariableList[BestVariable] < BestThreshold;
+      });
+  std::vector<size_t> Right(Middle, Indices.end());
+  Indices.erase(Middle, Indices.end());
+  std::vector<double> LeftUpper(Upper);
+  LeftUpper[BestVariable] = BestThreshold;
+  std::vector<double> RightLower(Lower);
+  RightLower[BestVariable] = BestThreshold;
+  int Left = build(Indices, Points, Values, Lower, LeftUpper);
+  Nodes[NodeIndex].Left = Left;
+  int RightNode = build(Right, Points, Values, RightLower, Upper);
+  Nodes[NodeIndex].Right = RightNode;
+  return NodeIndex;
+}
+
+size_t IntensityEnvelope::cell(const DataPoint &Point) const {
+  const Node *n = &Nodes.front();
+  while (n->Cell < 0) {
+    if (Point.KinematicVariableList[n->Variable] < n->Threshold)
+      n = &Nodes[n->Left];
+    else
+      n = &Nodes[n->Right];
+  }
+  return n->Cell;
+}
+
+void IntensityEnvelope::raise(size_t Cell, double Value) {
+  if (Value * (1.0 + SafetyMargin) <= Envelope[Cell])
+    return;
+  Envelope[Cell] = (1.0 + SafetyMargin) * Value;
+  updateIntegral(Cell);
+}
+
+double IntensityEnvelope::maximum() const {
+  return *std::max_element(Envelope.begin(), Envelope.end());
+}
+
+double IntensityEnvelope::volume(size_t Cell) const {
+  double Volume(1.0);
+  for (unsigned int k = 0; k < Dimension; ++k)
+    Volume *=
+        UpperEdges[Cell * Dimension + k] - LowerEdges[Cell * Dimension + k];
+  return Volume;
+}
+
+void IntensityEnvelope::updateIntegral(size_t FirstCell) {
+  double Integral(FirstCell > 0 ? CumulativeIntegral[FirstCell - 1] : 0.0);
+  for (size_t i = FirstCell; i < Envelope.size(); ++i) {
+    Integral += Envelope[i] * volume(i);
+    CumulativeIntegral[i] = Integral;
+  }
+}
+
+size_t IntensityEnvelope::drawCell(double RandomNumber) const {
+  auto Cell = std::upper_bound(CumulativeIntegral.begin(),
+                               CumulativeIntegral.end(),
+                               RandomNumber * CumulativeIntegral.back());
+  return std::min<size_t>(Cell - CumulativeIntegral.begin(),
+                          Envelope.size() - 1);
+}
+
+void IntensityEnvelope::mapToCell(size_t Cell,
+                                  std::vector<double>::iterator Point) const {
+  for (unsigned int k = 0; k < Dimension; ++k, ++Point) {
+    double Lower(LowerEdges[Cell * Dimension + k]);
+    *Point = Lower + *Point * (UpperEdges[Cell * Dimension + k] - Lower);
+  }
+}
+
+} // namespace Tools
+} // namespace ComPWA
@@ -0,0 +1,121 @@
+// Copyright (c) 2013, 2017 The ComPWA Team.
+// This file is part of the ComPWA framework, check
+// https://github.com/ComPWA/ComPWA/license.txt for details.
+
+///
+/// \file
+/// Piecewise constant envelope of an intensity.
+///
+
+#ifndef COMPWA_TOOLS_INTENSITYENVELOPE_HPP_
+#define COMPWA_TOOLS_INTENSITYENVELOPE_HPP_
+
+#include <vector>
+
+#include "Core/Event.hpp"
+
+namespace ComPWA {
+namespace Tools {
+
+///
+/// \class IntensityEnvelope
+/// Piecewise constant upper bound of a function over the unit hypercube,
+/// similar to the cells of Foam. The hypercube is split recursively into
+/// boxes (the cells) by planes perpendicular to one of the coordinates. Each
+/// split is placed such that the integral of the envelope, estimated with a
+/// sample of points and function values, is reduced the most. The envelope of
+/// a cell is the maximum of the sample values in the cell plus a safety
+/// margin.
+///
+/// Points can be drawn from the envelope with drawCell() and mapToCell(), so
+/// that a hit-and-miss against the envelope gives the distribution of the
+/// function, see Tools::generateAdaptive(). Since the maxima are estimated
+/// from a finite sample, the envelope can be exceeded. Use raise() to adapt
+/// the envelope in that case.
+///
+class IntensityEnvelope {
+public:
+  /// Builds the envelope of the \p Values at the \p Points, whose kinematic
+  /// variables are the coordinates in the unit hypercube. A cell is only
+  /// split if both parts contain at least \p MinimalNumberOfPoints points.
+  IntensityEnvelope(const std::vector<DataPoint> &Points,
+                    const std::vector<double> &Values,
+                    unsigned int MinimalNumberOfPoints = 100,
+                    double SafetyMargin = 0.1);
+
+  /// Index of the cell which contains \p Point
+  size_t cell(const DataPoint &Point) const;
+
+  /// Envelope of the cell \p Cell
+  double value(size_t Cell) const { return Envelope[Cell]; }
+
+  /// Raises the envelope of the cell \p Cell, so that it is above \p Value.
+  void raise(size_t Cell, double Value);
+
+  /// Maximum of the envelope
+  double maximum() const;
+
+  /// Volume of the cell \p Cell
+  double volume(size_t Cell) const;
+
+  /// Integral of the envelope over the unit hypercube
+  double integral() const { return CumulativeIntegral.back(); }
+
+  /// Cell which is drawn with a probability proportional to the integral of
+  /// its envelope, for a uniform random number \p RandomNumber in [0, 1).
+  size_t drawCell(double RandomNumber) const;
+
+  /// Maps the uniform coordinates [\p Point, \p Point + dimension()) in the
+  /// unit hypercube to the box of the cell \p Cell.
+  void mapToCell(size_t Cell, std::vector<double>::iterator Point) const;
+
+  /// Dimension of the unit hypercube
+  unsigned int dimension() const { return Dimension; }
+
+  size_t numberOfCells() const { return Envelope.size(); }
+
+  /// Ratio of the mean of the values and the mean of the envelope of the
+  /// sample the envelope was built from, which is the expected efficiency of
+  /// the hit-and-miss against the envelope.
+  double efficiency() const { return Efficiency; }
+
+private:
+  /// Node of the binary tree of cells. For a leaf Cell is the index of the
+  /// cell, otherwise Cell is -1 and the child nodes are Left (Variable <
+  /// Threshold) and Right.
+  struct Node {
+    unsigned int Variable;
+    double Threshold;
+    int Left;
+    int Right;
+    int Cell;
+  };
+
+  /// Splits the cell of the points \p Indices, which is the box [\p Lower,
+  /// \p Upper), recursively and returns the index of its node.
+  int build(std::vector<size_t> &Indices, const std::vector<DataPoint> &Points,
+            const std::vector<double> &Values, std::vector<double> Lower,
+            std::vector<double> Upper);
+
+  /// Updates CumulativeIntegral from the first cell on whose envelope
+  /// changed.
+  void updateIntegral(size_t FirstCell);
+
+  unsigned int Dimension;
+  unsigned int MinimalNumberOfPoints;
+  double SafetyMargin;
+  std::vector<Node> Nodes;
+  std::vector<double> Envelope;
+  /// Lower and upper edges of the boxes of the cells, dimension() values per
+  /// cell
+  std::vector<double> LowerEdges;
+  std::vector<double> UpperEdges;
+  /// Integral of the envelope of the cells [0, i]
+  std::vector<double> CumulativeIntegral;
+  double Efficiency;
+};
+
+} // namespace Tools
+} // namespace ComPWA
+
+#endif
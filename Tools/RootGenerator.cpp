@@ -13,9 +13,10 @@ namespace Tools {
 RootGenerator::RootGenerator(const ComPWA::FourMomentum &CMSP4_,
                              const std::vector<double> &FinalStateMasses_,
                              int seed)
-    : CMSP4(CMSP4_), FinalStateMasses(FinalStateMasses_),
-      CMSBoostVector(0.0, 0.0, 0.0) {
+    : UseRandomStreams(true), CMSP4(CMSP4_),
+      FinalStateMasses(FinalStateMasses_), CMSBoostVector(0.0, 0.0, 0.0) {
   gRandom = new TRandom3(0);
+  Seed = gRandom->GetSeed();
   if (seed != -1)
     setSeed(seed);
 
@@ -63,10 +64,8 @@ RootGenerator::RootGenerator(
 
 void RootGenerator::init() {
   CMSEnergyMinusMasses = CMSP4.invMass();
-  for (double fsmass : FinalStateMasses) {
+  for (double fsmass : FinalStateMasses)
     CMSEnergyMinusMasses -= fsmass;
-    FinalStateLorentzVectors.push_back(TLorentzVector());
-  }
 
   if (CMSEnergyMinusMasses <= 0)
     throw std::runtime_error(
@@ -103,8 +102,11 @@ void RootGenerator::init() {
   }
 }
 
-ComPWA::Event RootGenerator::generate() {
+template <typename RandomFunction>
+ComPWA::Event RootGenerator::generateEvent(RandomFunction &Random) const {
   ComPWA::Event evt;
+  // local vectors, so that events can be generated concurrently
+  std::vector<TLorentzVector> FinalStateLorentzVectors(FinalStateMasses.size());
 
   size_t NumberOfFinalStateParticles(FinalStateMasses.size());
   std::vector<double> OrderedRandomNumbers;
@@ -113,7 +115,7 @@ ComPWA::Event RootGenerator::generate() {
 
   if (NumberOfFinalStateParticles > 2) {
     for (unsigned int n = 1; n < NumberOfFinalStateParticles - 1; ++n)
-      OrderedRandomNumbers.push_back(gRandom->Rndm()); // N-2 random numbers
+      OrderedRandomNumbers.push_back(Random()); // N-2 random numbers
     std::sort(OrderedRandomNumbers.begin(), OrderedRandomNumbers.end());
   }
   OrderedRandomNumbers.push_back(1.0);
@@ -143,9 +145,9 @@ ComPWA::Event RootGenerator::generate() {
         0.0, -pd[i - 1], 0.0,
         std::sqrt(std::pow(pd[i - 1], 2) + std::pow(FinalStateMasses[i], 2)));
 
-    double cZ = 2.0 * gRandom->Rndm() - 1.0;
+    double cZ = 2.0 * Random() - 1.0;
     double sZ = std::sqrt(1.0 - std::pow(cZ, 2));
-    double angY = 2.0 * TMath::Pi() * gRandom->Rndm();
+    double angY = 2.0 * TMath::Pi() * Random();
     double cY = std::cos(angY);
     double sY = std::sin(angY);
     for (unsigned int j = 0; j <= i; ++j) {
@@ -180,6 +182,17 @@ ComPWA::Event RootGenerator::generate() {
   return evt;
 }
 
+ComPWA::Event RootGenerator::generate() {
+  auto Random = []() { return gRandom->Rndm(); };
+  return generateEvent(Random);
+}
+
+ComPWA::Event RootGenerator::generateEvent(uint64_t Index) const {
+  RandomStream Stream(randomStream(Index, EventSubstream));
+  auto Random = [&Stream]() { return Stream.uniform(); };
+  return generateEvent(Random);
+}
+
 void RootGenerator::BoostAlongY(TLorentzVector &vec,
                                 double beta_squared) const {
   // Boost this Lorentz vector
@@ -199,11 +212,12 @@ double RootGenerator::PDK(double a, double b, double c) const {
 }
 
 void RootGenerator::setSeed(unsigned int seed) {
+  Seed = seed;
   gRandom->SetSeed(seed);
   UniformRandomGen.SetSeed(seed + 1024);
 }
 
-unsigned int RootGenerator::getSeed() const { return gRandom->GetSeed(); }
+unsigned int RootGenerator::getSeed() const { return Seed; }
 
 double RootGenerator::gauss(double mu, double sigma) const {
   return gRandom->Gaus(mu, sigma);
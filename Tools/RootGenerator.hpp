@@ -24,11 +24,27 @@ class ParticleStateTransitionKinematicsInfo;
 
 namespace Tools {
 
+///
+/// \class RootGenerator
+/// Phase space generator based on ROOT's TGenPhaseSpace algorithm.
+///
+/// generate() draws the random numbers sequentially from gRandom. The event
+/// with a given index (generateEvent(uint64_t)) is generated from a
+/// counter-based random number stream instead, which Tools::generate() and
+/// Tools::generatePhsp() use to generate in parallel. Hence, for the same seed
+/// these samples differ from the ones generated sequentially by earlier
+/// versions. useRandomStreams(false) restores the sequential generation with
+/// the old sequence of events.
+///
 class RootGenerator : public Generator {
   /// These functions are copied from ROOT
   double PDK(double a, double b, double c) const;
   void BoostAlongY(TLorentzVector &vec, double beta_squared) const;
 
+  /// Generates an event using the uniform random numbers of \p Random
+  template <typename RandomFunction>
+  ComPWA::Event generateEvent(RandomFunction &Random) const;
+
 public:
   /// Constructor for a three particle decay with given masses
   RootGenerator(const ComPWA::FourMomentum &CMSP4_,
@@ -56,14 +72,26 @@ public:
 
   double gauss(double mu, double sigma) const;
 
+  bool hasRandomStreams() const { return UseRandomStreams; }
+
+  /// If false, the events are always generated sequentially via generate()
+  /// (e.g. to reproduce samples of earlier versions). True by default.
+  void useRandomStreams(bool Use) { UseRandomStreams = Use; }
+
+  ComPWA::Event generateEvent(uint64_t Index) const;
+
 protected:
   void init();
 
   TRandom3 UniformRandomGen;
 
+  /// Seed of the generators and of the random number streams
+  unsigned int Seed;
+
+  bool UseRandomStreams;
+
   ComPWA::FourMomentum CMSP4;
   std::vector<double> FinalStateMasses;
-  std::vector<TLorentzVector> FinalStateLorentzVectors;
   double MaximumWeight;
   TVector3 CMSBoostVector;
   // total energy in C.M. minus the sum of the masses
@@ -77,6 +105,11 @@ public:
       int seed, double minSq_, double maxSq_)
       : RootGenerator(KinematicsInfo, seed), minSq(minSq_), maxSq(maxSq_) {}
   virtual ComPWA::Event generate();
+  /// The CMS energy is changed for each event, which is not thread safe
+  bool hasRandomStreams() const { return false; }
+  ComPWA::Event generateEvent(uint64_t Index) const {
+    return Generator::generateEvent(Index);
+  }
   virtual UniformTwoBodyGenerator *clone() {
     return (new UniformTwoBodyGenerator(*this));
   }
@@ -0,0 +1,110 @@
+#define BOOST_TEST_MODULE FitFractionsTest
+
+#include "Data/DataSet.hpp"
+#include "Physics/CoherentIntensity.hpp"
+#include "Tools/FitFractions.hpp"
+#include "Tools/Integration.hpp"
+#include <boost/test/unit_test.hpp>
+#include <random>
+
+namespace {
+
+/// Breit-Wigner of the first kinematic variable with a complex coefficient
+class BreitWigner : public ComPWA::Physics::NamedAmplitude {
+public:
+  BreitWigner(const std::string &name, double mass, double width,
+              std::complex<double> coefficient)
+      : NamedAmplitude(name), Mass(mass), Width(width),
+        Coefficient(coefficient) {}
+  std::complex<double> evaluate(const ComPWA::DataPoint &point) const {
+    return Coefficient / std::complex<double>(Mass * Mass -
+                                                  point.KinematicVariableList[0],
+                                              -Mass * Width);
+  }
+  void updateParametersFrom(const ComPWA::ParameterList &list) {}
+  void addUniqueParametersTo(ComPWA::ParameterList &list) {}
+  void addFitParametersTo(std::vector<double> &FitParameters) {}
+  std::shared_ptr<ComPWA::FunctionTree>
+  createFunctionTree(const ComPWA::ParameterList &DataSample,
+                     const std::string &suffix) const {
+    return nullptr;
+  }
+
+private:
+  double Mass, Width;
+  std::complex<double> Coefficient;
+};
+
+/// Integral of the coherent sum of \p Amplitudes over \p Sample
+double
+integrate(const std::vector<std::shared_ptr<ComPWA::Physics::NamedAmplitude>>
+              &Amplitudes,
+          std::shared_ptr<ComPWA::Data::DataSet> Sample) {
+  return ComPWA::Tools::integrate(
+      std::make_shared<ComPWA::Physics::CoherentIntensity>("Sum", Amplitudes),
+      Sample);
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(ToolsTest)
+
+BOOST_AUTO_TEST_CASE(InterferenceMatrixAgreesWithComponentIntegrals) {
+  std::vector<std::shared_ptr<ComPWA::Physics::NamedAmplitude>> Amplitudes{
+      std::make_shared<BreitWigner>("a", 0.8, 0.1, 1.0),
+      std::make_shared<BreitWigner>("b", 1.0, 0.05,
+                                    std::complex<double>(0.3, 0.5)),
+      std::make_shared<BreitWigner>("c", 1.2, 0.3,
+                                    std::complex<double>(-0.5, 0.2))};
+  auto Intensity =
+      std::make_shared<ComPWA::Physics::CoherentIntensity>("I", Amplitudes);
+
+  // weighted sample with more points than a chunk of the matrix calculation
+  std::mt19937 Random(1234);
+  std::uniform_real_distribution<double> Uniform(0.2, 2.0);
+  std::vector<ComPWA::DataPoint> Points(25000);
+  for (auto &Point : Points) {
+    Point.KinematicVariableList = {Uniform(Random)};
+    Point.Weight = 0.5 + Uniform(Random);
+  }
+  auto Sample = std::make_shared<ComPWA::Data::DataSet>(Points);
+
+  auto Matrix = ComPWA::Tools::calculateInterferenceMatrix(Intensity, Sample);
+  BOOST_REQUIRE_EQUAL(Matrix.Names.size(), Amplitudes.size());
+  double Total(ComPWA::Tools::integrate(Intensity, Sample));
+  BOOST_CHECK_CLOSE(Matrix.total(), Total, 1e-9);
+
+  // the fit fractions and the interference terms of the integrals of the
+  // single amplitudes and of the pairs
+  double Sum(0.0);
+  for (size_t i = 0; i < Amplitudes.size(); ++i) {
+    BOOST_CHECK_EQUAL(Matrix.Names[i], Amplitudes[i]->getName());
+    double Single(integrate({Amplitudes[i]}, Sample));
+    BOOST_CHECK_CLOSE(Matrix.fitFraction(i), Single / Total, 1e-9);
+    Sum += Matrix.fitFraction(i);
+    for (size_t j = i + 1; j < Amplitudes.size(); ++j) {
+      double Pair(integrate({Amplitudes[i], Amplitudes[j]}, Sample));
+      double Interference(
+          (Pair - Single - integrate({Amplitudes[j]}, Sample)) / Total);
+      BOOST_CHECK_SMALL(Matrix.interferenceFraction(i, j) - Interference,
+                        1e-10);
+      BOOST_CHECK_CLOSE(Matrix.interferenceFraction(j, i),
+                        Matrix.interferenceFraction(i, j), 1e-12);
+      Sum += Matrix.interferenceFraction(i, j);
+    }
+  }
+  BOOST_CHECK_CLOSE(Sum, 1.0, 1e-9);
+
+  // the requested components in the requested order
+  auto FitFractions =
+      ComPWA::Tools::calculateFitFractions(Intensity, Sample, {"c", "a"});
+  BOOST_REQUIRE_EQUAL(FitFractions.doubleParameters().size(), 2u);
+  BOOST_CHECK_EQUAL(FitFractions.doubleParameter(0)->name(), "c");
+  BOOST_CHECK_CLOSE(FitFractions.doubleParameter(0)->value(),
+                    Matrix.fitFraction(2), 1e-12);
+  BOOST_CHECK_EQUAL(FitFractions.doubleParameter(1)->name(), "a");
+  BOOST_CHECK_CLOSE(FitFractions.doubleParameter(1)->value(),
+                    Matrix.fitFraction(0), 1e-12);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
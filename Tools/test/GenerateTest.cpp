@@ -0,0 +1,311 @@
+#define BOOST_TEST_MODULE GenerateTest
+
+#include "Core/Generator.hpp"
+#include "Core/Intensity.hpp"
+#include "Core/Kinematics.hpp"
+#include "Data/BinaryIO/BinaryDataIO.hpp"
+#include "Data/ChunkedDataSet.hpp"
+#include "Data/DataSet.hpp"
+#include "Tools/Generate.hpp"
+#include "Tools/test/UnitSquare.hpp"
+#include <algorithm>
+#include <atomic>
+#include <boost/test/unit_test.hpp>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <tbb/global_control.h>
+#include <tbb/task_arena.h>
+
+namespace {
+
+using ComPWA::Tools::Test::SquareGenerator;
+using ComPWA::Tools::Test::SquareKinematics;
+
+/// Points in the unit square with the weight 0.5 + 0.5 * x, so that the
+/// phase space events are generated with hit-and-miss as well
+class WeightedSquareGenerator : public SquareGenerator {
+protected:
+  ComPWA::Event event(double u0, double u1) const {
+    ComPWA::Event Event(SquareGenerator::event(u0, u1));
+    Event.Weight = 0.5 + 0.5 * u0;
+    return Event;
+  }
+};
+
+/// Gaussian peak at (0.3, 0.6) on a flat background. The integral of the peak
+/// does not depend on the width \p Sigma.
+class PeakIntensity : public ComPWA::Intensity {
+public:
+  PeakIntensity(double sigma = 0.05) : Sigma(sigma) {}
+  double evaluate(const ComPWA::DataPoint &point) const {
+    double x(point.KinematicVariableList[0] - 0.3);
+    double y(point.KinematicVariableList[1] - 0.6);
+    return 0.125 / (Sigma * Sigma) *
+               std::exp(-0.5 * (x * x + y * y) / (Sigma * Sigma)) +
+           1.0;
+  }
+  void updateParametersFrom(const ComPWA::ParameterList &list) {}
+  void addUniqueParametersTo(ComPWA::ParameterList &list) {}
+  void addFitParametersTo(std::vector<double> &FitParameters) {}
+  std::shared_ptr<ComPWA::FunctionTree>
+  createFunctionTree(const ComPWA::ParameterList &DataSample,
+                     const std::string &suffix) const {
+    return nullptr;
+  }
+
+private:
+  double Sigma;
+};
+
+/// PeakIntensity which counts its evaluations
+class CountingIntensity : public PeakIntensity {
+public:
+  CountingIntensity() : Evaluations(0) {}
+  double evaluate(const ComPWA::DataPoint &point) const {
+    ++Evaluations;
+    return PeakIntensity::evaluate(point);
+  }
+  mutable std::atomic<size_t> Evaluations;
+};
+
+/// Uniform events in the unit square, except for the first 50000 events (the
+/// first bunch of Tools::generate()), which have x > 0.5. So the maximum of a
+/// StepIntensity is only found after events were accepted. The maximum is not
+/// estimated in advance, since the unit hypercube mapping is not provided.
+class DelayedPeakGenerator : public SquareGenerator {
+public:
+  ComPWA::Event generateEvent(uint64_t Index) const {
+    auto Stream = randomStream(Index, EventSubstream);
+    double x(Stream.uniform());
+    if (Index < 50000)
+      x = 0.5 + 0.5 * x;
+    ComPWA::Event Event;
+    Event.ParticleList = {ComPWA::Particle(x, Stream.uniform(), 0, 0)};
+    return Event;
+  }
+  unsigned int unitHypercubeDimension() const { return 0; }
+};
+
+/// 10 for x < 0.4 and 1 otherwise
+class StepIntensity : public PeakIntensity {
+public:
+  double evaluate(const ComPWA::DataPoint &point) const {
+    return point.KinematicVariableList[0] < 0.4 ? 10.0 : 1.0;
+  }
+};
+
+/// Hit-and-miss sample of the first \p NumberOfEvents events of \p Generator,
+/// which are accepted with the fixed maximum \p Maximum
+std::shared_ptr<ComPWA::Data::DataSet>
+generateWithMaximum(size_t NumberOfEvents, double Maximum,
+                    const ComPWA::Kinematics &Kinematics,
+                    const ComPWA::Generator &Generator,
+                    const ComPWA::Intensity &Intensity) {
+  std::vector<ComPWA::Event> Events;
+  for (uint64_t Index = 0; Events.size() < NumberOfEvents; ++Index) {
+    ComPWA::Event Event(Generator.generateEvent(Index));
+    double RandomNumber(
+        Generator.randomStream(Index, ComPWA::Generator::AcceptanceSubstream)
+            .uniform());
+    if (RandomNumber * Maximum < Intensity.evaluate(Kinematics.convert(Event)))
+      Events.push_back(Event);
+  }
+  return std::make_shared<ComPWA::Data::DataSet>(Events);
+}
+
+/// Keeps the written events in memory. The events can't be read back, so
+/// that Tools::generate() restarts if it raises the maximum.
+class VectorEventChunkWriter : public ComPWA::Data::EventChunkWriter {
+public:
+  void writeEvents(const std::vector<ComPWA::Event> &Events) {
+    this->Events.insert(this->Events.end(), Events.begin(), Events.end());
+  }
+  void rewind() {
+    ++NumberOfRewinds;
+    Events.clear();
+  }
+  void close() {}
+
+  std::vector<ComPWA::Event> Events;
+  unsigned int NumberOfRewinds = 0;
+};
+
+/// Calls \p Generate with \p NumberOfThreads threads, also if the machine
+/// has fewer cores.
+std::shared_ptr<ComPWA::Data::DataSet> generateWithThreads(
+    int NumberOfThreads,
+    const std::function<std::shared_ptr<ComPWA::Data::DataSet>()> &Generate) {
+  tbb::global_control Control(tbb::global_control::max_allowed_parallelism,
+                              NumberOfThreads);
+  tbb::task_arena Arena(NumberOfThreads);
+  std::shared_ptr<ComPWA::Data::DataSet> Sample;
+  Arena.execute([&]() { Sample = Generate(); });
+  return Sample;
+}
+
+void checkEqual(const ComPWA::Data::DataSet &Sample,
+                const ComPWA::Data::DataSet &Expected) {
+  auto const &Events = Sample.getEventList();
+  auto const &ExpectedEvents = Expected.getEventList();
+  BOOST_REQUIRE_EQUAL(Events.size(), ExpectedEvents.size());
+  for (size_t i = 0; i < Events.size(); ++i) {
+    BOOST_CHECK_EQUAL(Events[i].Weight, ExpectedEvents[i].Weight);
+    BOOST_CHECK(Events[i].ParticleList[0].fourMomentum() ==
+                ExpectedEvents[i].ParticleList[0].fourMomentum());
+  }
+}
+
+/// Histogram of the kinematic variables x and y with 10 x 10 bins
+std::vector<double> histogram(const ComPWA::Data::DataSet &Sample) {
+  std::vector<double> Bins(100, 0.0);
+  for (auto const &Point : Sample.getDataPointList()) {
+    int x(10 * Point.KinematicVariableList[0]);
+    int y(10 * Point.KinematicVariableList[1]);
+    Bins[10 * std::min(x, 9) + std::min(y, 9)] += 1.0;
+  }
+  return Bins;
+}
+
+/// Checks that the histograms of two samples of the same size agree with a
+/// chi-square test.
+void checkSameDistribution(const ComPWA::Data::DataSet &Sample,
+                           const ComPWA::Data::DataSet &Expected) {
+  BOOST_REQUIRE_EQUAL(Sample.getEventList().size(),
+                      Expected.getEventList().size());
+  auto Bins(histogram(Sample));
+  auto ExpectedBins(histogram(Expected));
+  double ChiSquare(0.0);
+  size_t NumberOfBins(0);
+  for (size_t i = 0; i < Bins.size(); ++i) {
+    if (Bins[i] + ExpectedBins[i] == 0.0)
+      continue;
+    ChiSquare += (Bins[i] - ExpectedBins[i]) * (Bins[i] - ExpectedBins[i]) /
+                 (Bins[i] + ExpectedBins[i]);
+    ++NumberOfBins;
+  }
+  // five standard deviations above the mean
+  BOOST_CHECK_LT(ChiSquare, NumberOfBins + 5.0 * std::sqrt(2.0 * NumberOfBins));
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(ToolsTest)
+
+BOOST_AUTO_TEST_CASE(GenerationIndependentOfThreads) {
+  auto Kinematics = std::make_shared<SquareKinematics>();
+  auto Generator = std::make_shared<WeightedSquareGenerator>();
+  auto Intensity = std::make_shared<PeakIntensity>();
+
+  std::vector<std::function<std::shared_ptr<ComPWA::Data::DataSet>()>>
+      Generations{
+          [&]() {
+            return ComPWA::Tools::generate(2000, Kinematics, Generator,
+                                           Intensity);
+          },
+          [&]() { return ComPWA::Tools::generatePhsp(20000, Generator); },
+          [&]() {
+            return ComPWA::Tools::generateImportanceSampledPhsp(
+                2000, Kinematics, Generator, Intensity);
+          }};
+  for (auto const &Generate : Generations) {
+    auto Sample = generateWithThreads(1, Generate);
+    BOOST_CHECK(Sample->getEventList().size() > 0);
+    checkEqual(*generateWithThreads(4, Generate), *Sample);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(ThinningEqualsRestart) {
+  auto Kinematics = std::make_shared<SquareKinematics>();
+  auto Generator = std::make_shared<DelayedPeakGenerator>();
+  auto Intensity = std::make_shared<StepIntensity>();
+
+  // the maximum of the first bunch is 1 and most of its events are accepted,
+  // the second bunch raises the maximum to 1.05 * 10 and the accepted events
+  // are thinned
+  auto Sample(
+      ComPWA::Tools::generate(50000, Kinematics, Generator, Intensity));
+  checkEqual(*Sample, *generateWithMaximum(50000, 10.5, *Kinematics,
+                                           *Generator, *Intensity));
+}
+
+BOOST_AUTO_TEST_CASE(StreamingGeneration) {
+  auto Kinematics = std::make_shared<SquareKinematics>();
+  auto Generator = std::make_shared<DelayedPeakGenerator>();
+  auto Intensity = std::make_shared<StepIntensity>();
+  auto Expected(
+      generateWithMaximum(50000, 10.5, *Kinematics, *Generator, *Intensity));
+
+  // most events of the first bunch are written before the second bunch raises
+  // the maximum, the writer can't read them back, so the generation restarts
+  VectorEventChunkWriter VectorWriter;
+  ComPWA::Tools::generate(50000, Kinematics, Generator, Intensity,
+                          VectorWriter, 1000);
+  BOOST_CHECK_EQUAL(VectorWriter.NumberOfRewinds, 1);
+  checkEqual(ComPWA::Data::DataSet(VectorWriter.Events), *Expected);
+
+  // the written events are read back and thinned instead
+  {
+    ComPWA::Data::BinaryEventChunkWriter Writer("GenerateTest-written.bin",
+                                                50000);
+    ComPWA::Tools::generate(50000, Kinematics, Generator, Intensity, Writer,
+                            1000);
+  }
+  auto Sample(
+      ComPWA::Data::BinaryDataIO().readData("GenerateTest-written.bin"));
+  std::remove("GenerateTest-written.bin");
+  BOOST_CHECK_EQUAL(Sample->getEventList().size(), 50000);
+  Sample->convertEventsToDataPoints(Kinematics);
+  Expected->convertEventsToDataPoints(Kinematics);
+  checkSameDistribution(*Sample, *Expected);
+  // most of the events with x > 0.5 stem from the thinned first bunch
+  auto countRightHalf = [](const ComPWA::Data::DataSet &Sample) {
+    auto const &Points = Sample.getDataPointList();
+    return std::count_if(Points.begin(), Points.end(),
+                         [](const ComPWA::DataPoint &Point) {
+                           return Point.KinematicVariableList[0] > 0.5;
+                         });
+  };
+  double Count(countRightHalf(*Sample));
+  double ExpectedCount(countRightHalf(*Expected));
+  BOOST_CHECK_LT(std::abs(Count - ExpectedCount),
+                 5.0 * std::sqrt(Count + ExpectedCount));
+}
+
+BOOST_AUTO_TEST_CASE(AdaptiveGeneration) {
+  auto Kinematics = std::make_shared<SquareKinematics>();
+  auto Generator = std::make_shared<WeightedSquareGenerator>();
+  auto Intensity = std::make_shared<CountingIntensity>();
+
+  auto Sample(ComPWA::Tools::generate(20000, Kinematics, Generator, Intensity));
+  size_t Evaluations(Intensity->Evaluations);
+  Intensity->Evaluations = 0;
+  auto AdaptiveSample(ComPWA::Tools::generateAdaptive(
+      20000, Kinematics, Generator, Intensity, 20000));
+  // most of the events which are drawn from the envelope are accepted
+  BOOST_CHECK_LT(Intensity->Evaluations, 0.25 * Evaluations);
+  checkSameDistribution(*AdaptiveSample, *Sample);
+
+  // the same sample for any number of threads
+  auto Generate = [&]() {
+    return ComPWA::Tools::generateAdaptive(2000, Kinematics, Generator,
+                                           Intensity, 2000);
+  };
+  checkEqual(*generateWithThreads(4, Generate),
+             *generateWithThreads(1, Generate));
+}
+
+BOOST_AUTO_TEST_CASE(AdaptiveGenerationWithExceededEnvelope) {
+  auto Kinematics = std::make_shared<SquareKinematics>();
+  auto Generator = std::make_shared<WeightedSquareGenerator>();
+
+  // the envelope of 300 pilot events misses most of the narrow peak, it is
+  // raised during the generation
+  auto Intensity = std::make_shared<PeakIntensity>(0.01);
+  auto Sample(ComPWA::Tools::generate(20000, Kinematics, Generator, Intensity));
+  auto AdaptiveSample(ComPWA::Tools::generateAdaptive(
+      20000, Kinematics, Generator, Intensity, 300));
+  checkSameDistribution(*AdaptiveSample, *Sample);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,128 @@
+#define BOOST_TEST_MODULE IntegrationTest
+
+#include "Core/Generator.hpp"
+#include "Core/Intensity.hpp"
+#include "Core/Kinematics.hpp"
+#include "Data/DataSet.hpp"
+#include "Tools/Integration.hpp"
+#include "Tools/test/UnitSquare.hpp"
+#include <boost/test/unit_test.hpp>
+#include <cmath>
+#include <random>
+
+namespace {
+
+using ComPWA::Tools::Test::SquareGenerator;
+using ComPWA::Tools::Test::SquareKinematics;
+
+/// Normalized Gaussian peak with a width of 0.02 on a flat background, the
+/// integral over the unit square is 2
+class PeakIntensity : public ComPWA::Intensity {
+public:
+  double evaluate(const ComPWA::DataPoint &point) const {
+    double x(point.KinematicVariableList[0] - 0.3);
+    double y(point.KinematicVariableList[1] - 0.6);
+    double Sigma(0.02);
+    return std::exp(-0.5 * (x * x + y * y) / (Sigma * Sigma)) /
+               (2.0 * M_PI * Sigma * Sigma) +
+           1.0;
+  }
+  void updateParametersFrom(const ComPWA::ParameterList &list) {}
+  void addUniqueParametersTo(ComPWA::ParameterList &list) {}
+  void addFitParametersTo(std::vector<double> &FitParameters) {}
+  std::shared_ptr<ComPWA::FunctionTree>
+  createFunctionTree(const ComPWA::ParameterList &DataSample,
+                     const std::string &suffix) const {
+    return nullptr;
+  }
+};
+
+/// Smooth intensity 1 + x * y, the integral over the unit square is 1.25
+class SmoothIntensity : public PeakIntensity {
+public:
+  double evaluate(const ComPWA::DataPoint &point) const {
+    return 1.0 + point.KinematicVariableList[0] * point.KinematicVariableList[1];
+  }
+};
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(ToolsTest)
+
+BOOST_AUTO_TEST_CASE(MCIntegrationWithTargetPrecision) {
+  std::mt19937 Random(1234);
+  std::uniform_real_distribution<double> Uniform(0.0, 1.0);
+  std::vector<ComPWA::DataPoint> Points(200000);
+  for (auto &Point : Points)
+    Point.KinematicVariableList = {Uniform(Random), Uniform(Random)};
+  auto Intensity = std::make_shared<SmoothIntensity>();
+  ComPWA::Tools::MCIntegrationStrategy MC(
+      std::make_shared<ComPWA::Data::DataSet>(Points));
+
+  auto All = MC.integrateWithError(Intensity);
+  BOOST_CHECK_SMALL(All.first - 1.25, 4.0 * All.second);
+  BOOST_CHECK_CLOSE(All.second, std::sqrt(7.0 / 144.0 / 200000), 5.0);
+  BOOST_CHECK_EQUAL(MC.integrate(Intensity), All.first);
+
+  // the error of 10000 points is about 2e-3, so the first batch is enough
+  auto Result = MC.integrateWithError(Intensity, 2e-3);
+  BOOST_CHECK_SMALL(Result.first - 1.25, 4.0 * Result.second);
+  BOOST_CHECK(Result.second < 2e-3 * Result.first);
+  BOOST_CHECK(Result.second > 3.0 * All.second);
+
+  // freeze() fixes the number of points of the pilot integration
+  MC.freeze(Intensity, 2e-3);
+  BOOST_CHECK_EQUAL(MC.integrate(Intensity), Result.first);
+  BOOST_CHECK_EQUAL(MC.integrateWithError(Intensity, 0.1).first, Result.first);
+}
+
+BOOST_AUTO_TEST_CASE(VegasIntegration) {
+  auto Intensity = std::make_shared<PeakIntensity>();
+  ComPWA::Tools::VegasIntegrationStrategy Vegas(
+      std::make_shared<SquareKinematics>(),
+      std::make_shared<SquareGenerator>(), 1.0, 10000, 5);
+
+  auto Result = Vegas.integrateWithError(Intensity);
+  BOOST_CHECK_SMALL(Result.first - 2.0, 4.0 * Result.second);
+  // plain MC with the same number of evaluations (about 40000) has an error
+  // of about 0.07
+  BOOST_CHECK(Result.second < 0.04);
+  // the integral only depends on the seed
+  BOOST_CHECK_EQUAL(Vegas.integrate(Intensity), Result.first);
+}
+
+BOOST_AUTO_TEST_CASE(FrozenVegasIntegration) {
+  auto Intensity = std::make_shared<PeakIntensity>();
+  ComPWA::Tools::VegasIntegrationStrategy Vegas(
+      std::make_shared<SquareKinematics>(),
+      std::make_shared<SquareGenerator>(), 1.0, 10000, 5);
+  Vegas.freeze(Intensity);
+
+  auto Result = Vegas.integrateWithError(Intensity);
+  BOOST_CHECK_SMALL(Result.first - 2.0, 4.0 * Result.second);
+  BOOST_CHECK(Result.second < 0.04);
+  // the frozen sample is a weighted phase space sample for other intensities
+  auto Smooth = Vegas.integrateWithError(std::make_shared<SmoothIntensity>());
+  BOOST_CHECK_SMALL(Smooth.first - 1.25, 4.0 * Smooth.second);
+  BOOST_CHECK_EQUAL(Vegas.integrate(Intensity), Result.first);
+}
+
+BOOST_AUTO_TEST_CASE(QMCIntegration) {
+  auto Intensity = std::make_shared<SmoothIntensity>();
+  ComPWA::Tools::QMCIntegrationStrategy QMC(
+      std::make_shared<SquareKinematics>(),
+      std::make_shared<SquareGenerator>(), 1.0, 4096, 8);
+
+  auto Result = QMC.integrateWithError(Intensity);
+  BOOST_CHECK_SMALL(Result.first - 1.25, 4.0 * Result.second);
+  // plain MC with 32768 points has an error of about 1e-3
+  BOOST_CHECK(Result.second < 1e-4);
+
+  // a pilot integration needs the minimum of three replicas
+  QMC.freeze(Intensity, 1e-2);
+  auto Frozen = QMC.integrateWithError(Intensity);
+  BOOST_CHECK_EQUAL(Frozen.first, QMC.integrateWithError(Intensity, 1e-2).first);
+  BOOST_CHECK(Frozen.second > Result.second);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
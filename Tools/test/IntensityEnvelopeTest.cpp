@@ -0,0 +1,87 @@
+#define BOOST_TEST_MODULE IntensityEnvelopeTest
+
+#include "Tools/IntensityEnvelope.hpp"
+#include <boost/test/unit_test.hpp>
+#include <cmath>
+#include <random>
+
+BOOST_AUTO_TEST_SUITE(ToolsTest)
+
+BOOST_AUTO_TEST_CASE(IntensityEnvelopeBoundsSample) {
+  // narrow peak on a flat background
+  auto Function = [](double x, double y) {
+    return 1.0 / ((x - 0.3) * (x - 0.3) + 1e-4) + 1.0 + y;
+  };
+  std::mt19937 Random(1234);
+  std::uniform_real_distribution<double> Uniform(0.0, 1.0);
+  std::vector<ComPWA::DataPoint> Points(20000);
+  std::vector<double> Values(Points.size());
+  double Maximum(0.0), Sum(0.0);
+  for (size_t i = 0; i < Points.size(); ++i) {
+    Points[i].KinematicVariableList = {Uniform(Random), Uniform(Random)};
+    Values[i] = Function(Points[i].KinematicVariableList[0],
+                         Points[i].KinematicVariableList[1]);
+    Maximum = std::max(Maximum, Values[i]);
+    Sum += Values[i];
+  }
+  ComPWA::Tools::IntensityEnvelope Envelope(Points, Values, 100, 0.1);
+  BOOST_CHECK(Envelope.numberOfCells() > 1);
+  for (size_t i = 0; i < Points.size(); ++i)
+    BOOST_CHECK(Values[i] <= Envelope.value(Envelope.cell(Points[i])));
+  BOOST_CHECK(Envelope.maximum() >= Maximum);
+  // the envelope is much more efficient than the global maximum
+  BOOST_CHECK(Envelope.efficiency() > 5.0 * Sum / Points.size() / Maximum);
+
+  size_t Cell(Envelope.cell(Points[0]));
+  Envelope.raise(Cell, 2.0 * Envelope.value(Cell));
+  BOOST_CHECK(Envelope.value(Cell) >= 2.0 * Values[0]);
+}
+
+BOOST_AUTO_TEST_CASE(IntensityEnvelopeSampling) {
+  auto Function = [](double x, double y) {
+    return 1.0 / ((x - 0.3) * (x - 0.3) + 1e-2) + y;
+  };
+  std::mt19937 Random(1234);
+  std::uniform_real_distribution<double> Uniform(0.0, 1.0);
+  std::vector<ComPWA::DataPoint> Points(20000);
+  std::vector<double> Values(Points.size());
+  for (size_t i = 0; i < Points.size(); ++i) {
+    Points[i].KinematicVariableList = {Uniform(Random), Uniform(Random)};
+    Values[i] = Function(Points[i].KinematicVariableList[0],
+                         Points[i].KinematicVariableList[1]);
+  }
+  ComPWA::Tools::IntensityEnvelope Envelope(Points, Values);
+  BOOST_CHECK_EQUAL(Envelope.dimension(), 2);
+
+  // the cells cover the unit square
+  double Volume(0.0), Integral(0.0);
+  for (size_t i = 0; i < Envelope.numberOfCells(); ++i) {
+    Volume += Envelope.volume(i);
+    Integral += Envelope.value(i) * Envelope.volume(i);
+  }
+  BOOST_CHECK_CLOSE(Volume, 1.0, 1e-10);
+  BOOST_CHECK_CLOSE(Envelope.integral(), Integral, 1e-10);
+
+  // the cells are drawn proportional to their integral, the mapped points are
+  // within the cells
+  std::vector<double> Frequencies(Envelope.numberOfCells(), 0.0);
+  for (size_t i = 0; i < 100000; ++i) {
+    size_t Cell(Envelope.drawCell(Uniform(Random)));
+    Frequencies[Cell] += 1e-5;
+    ComPWA::DataPoint Point;
+    Point.KinematicVariableList = {Uniform(Random), Uniform(Random)};
+    Envelope.mapToCell(Cell, Point.KinematicVariableList.begin());
+    BOOST_CHECK_EQUAL(Envelope.cell(Point), Cell);
+  }
+  for (size_t i = 0; i < Envelope.numberOfCells(); ++i) {
+    double Probability(Envelope.value(i) * Envelope.volume(i) / Integral);
+    BOOST_CHECK_SMALL(Frequencies[i] - Probability,
+                      5.0 * std::sqrt(Probability * 1e-5) + 1e-4);
+  }
+
+  // raising a cell changes the integral
+  Envelope.raise(0, 2.0 * Envelope.value(0));
+  BOOST_CHECK(Envelope.integral() > Integral);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
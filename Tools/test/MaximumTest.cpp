@@ -0,0 +1,104 @@
+#define BOOST_TEST_MODULE MaximumTest
+
+#include "Core/Generator.hpp"
+#include "Core/Intensity.hpp"
+#include "Core/Kinematics.hpp"
+#include "Data/DataSet.hpp"
+#include "Tools/Integration.hpp"
+#include "Tools/test/UnitSquare.hpp"
+#include <boost/test/unit_test.hpp>
+#include <cmath>
+#include <limits>
+#include <random>
+
+namespace {
+
+using ComPWA::Tools::Test::SquareGenerator;
+using ComPWA::Tools::Test::SquareKinematics;
+
+/// Points (x, y) = (u0, (1 - u0) * u1) in the triangle x + y < 1. The
+/// kinematics only checks the bounds of x and y, as the kinematics of a decay
+/// checks those of each invariant mass.
+class TriangleGenerator : public SquareGenerator {
+protected:
+  ComPWA::Event event(double u0, double u1) const {
+    return SquareGenerator::event(u0, (1.0 - u0) * u1);
+  }
+};
+
+/// Narrow peak on a flat background at (X, Y), the maximum is 10001. Not a
+/// number for x < \p NaNBelow.
+class PeakIntensity : public ComPWA::Intensity {
+public:
+  PeakIntensity(double x, double y, double nanBelow = 0.0)
+      : X(x), Y(y), NaNBelow(nanBelow) {}
+  double evaluate(const ComPWA::DataPoint &point) const {
+    if (point.KinematicVariableList[0] < NaNBelow)
+      return std::numeric_limits<double>::quiet_NaN();
+    double x(point.KinematicVariableList[0] - X);
+    double y(point.KinematicVariableList[1] - Y);
+    return 1.0 / (x * x + 2.0 * y * y + 1e-4) + 1.0;
+  }
+  void updateParametersFrom(const ComPWA::ParameterList &list) {}
+  void addUniqueParametersTo(ComPWA::ParameterList &list) {}
+  void addFitParametersTo(std::vector<double> &FitParameters) {}
+  std::shared_ptr<ComPWA::FunctionTree>
+  createFunctionTree(const ComPWA::ParameterList &DataSample,
+                     const std::string &suffix) const {
+    return nullptr;
+  }
+
+private:
+  double X, Y, NaNBelow;
+};
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(ToolsTest)
+
+BOOST_AUTO_TEST_CASE(MaximumOfSample) {
+  std::mt19937 Random(1234);
+  std::uniform_real_distribution<double> Uniform(0.0, 1.0);
+  std::vector<ComPWA::DataPoint> Points(1000);
+  for (auto &Point : Points)
+    Point.KinematicVariableList = {Uniform(Random), Uniform(Random)};
+  auto Intensity = std::make_shared<PeakIntensity>(0.3, 0.6, 0.05);
+
+  double SampleMaximum(ComPWA::Tools::maximum(Intensity, Points));
+  BOOST_CHECK(std::isfinite(SampleMaximum));
+  BOOST_CHECK(SampleMaximum < 0.5 * 10001.0);
+  BOOST_CHECK_EQUAL(
+      ComPWA::Tools::maximum(Intensity,
+                             std::make_shared<ComPWA::Data::DataSet>(Points),
+                             std::make_shared<SquareKinematics>()),
+      SampleMaximum);
+}
+
+BOOST_AUTO_TEST_CASE(MaximumOfPeak) {
+  auto Kinematics = std::make_shared<SquareKinematics>();
+  auto Intensity = std::make_shared<PeakIntensity>(0.3, 0.6);
+  double Maximum(ComPWA::Tools::maximum(
+      Intensity, Kinematics, std::make_shared<SquareGenerator>(), 1000, 5));
+  BOOST_CHECK_CLOSE(Maximum, 10001.0, 1e-3);
+
+  // non-finite values are ignored
+  Intensity = std::make_shared<PeakIntensity>(0.3, 0.6, 0.05);
+  Maximum = ComPWA::Tools::maximum(Intensity, Kinematics,
+                                   std::make_shared<SquareGenerator>(), 1000);
+  BOOST_CHECK_CLOSE(Maximum, 10001.0, 1e-3);
+}
+
+BOOST_AUTO_TEST_CASE(MaximumWithinPhaseSpace) {
+  // the peak at (0.9, 0.9) is within the bounds of x and y, but not in the
+  // triangle; the maximum in the triangle is at (11/30, 19/30) on x + y = 1
+  auto Intensity = std::make_shared<PeakIntensity>(0.9, 0.9);
+  double Maximum(ComPWA::Tools::maximum(Intensity,
+                                        std::make_shared<SquareKinematics>(),
+                                        std::make_shared<TriangleGenerator>(),
+                                        1000, 5));
+  double Expected(1.0 / (32.0 / 75.0 + 1e-4) + 1.0);
+  BOOST_CHECK(Maximum <= Expected * (1.0 + 1e-12));
+  BOOST_CHECK_CLOSE(Maximum, Expected, 1e-3);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,89 @@
+// Copyright (c) 2013, 2017 The ComPWA Team.
+// This file is part of the ComPWA framework, check
+// https://github.com/ComPWA/ComPWA/license.txt for details.
+
+///
+/// \file
+/// Unit square as phase space for the tests of the integration and generation
+/// tools.
+///
+
+#ifndef COMPWA_TOOLS_TEST_UNITSQUARE_HPP_
+#define COMPWA_TOOLS_TEST_UNITSQUARE_HPP_
+
+#include <vector>
+
+#include "Core/Generator.hpp"
+#include "Core/Kinematics.hpp"
+
+namespace ComPWA {
+namespace Tools {
+namespace Test {
+
+/// Unit square as phase space, the variables are the x and y components of
+/// the momentum of the first particle
+class SquareKinematics : public ComPWA::Kinematics {
+public:
+  ComPWA::DataPoint convert(const ComPWA::Event &event) const {
+    ComPWA::DataPoint point;
+    auto p4 = event.ParticleList[0].fourMomentum();
+    point.KinematicVariableList = {p4.px(), p4.py()};
+    point.Weight = event.Weight;
+    return point;
+  }
+  std::vector<std::string> getKinematicVariableNames() const {
+    return {"x", "y"};
+  }
+  bool isWithinPhaseSpace(const ComPWA::DataPoint &point) const {
+    for (auto x : point.KinematicVariableList)
+      if (x < 0.0 || x > 1.0)
+        return false;
+    return true;
+  }
+  double phspVolume() const { return 1.0; }
+};
+
+/// Uniform points (x, y) = (u0, u1) in the unit square with weight 1. The
+/// points are generated from the random number streams or mapped from the
+/// unit hypercube. Derived generators change the event of a point with
+/// event().
+class SquareGenerator : public ComPWA::Generator {
+public:
+  ComPWA::Event generate() { return generateEvent(NextIndex++); }
+  void setSeed(unsigned int seed) { Seed = seed; }
+  unsigned int getSeed() const { return Seed; }
+  double uniform(double min, double max) {
+    return randomStream(NextIndex++, AcceptanceSubstream).uniform(min, max);
+  }
+  bool hasRandomStreams() const { return true; }
+  ComPWA::Event generateEvent(uint64_t Index) const {
+    auto Stream = randomStream(Index, EventSubstream);
+    double u0(Stream.uniform());
+    return event(u0, Stream.uniform());
+  }
+  unsigned int unitHypercubeDimension() const { return 2; }
+  void mapUnitHypercube(const std::vector<double> &Points,
+                        std::vector<ComPWA::Event>::iterator First,
+                        std::vector<ComPWA::Event>::iterator Last) const {
+    for (auto Point = Points.begin(); First != Last; ++First, Point += 2)
+      *First = event(Point[0], Point[1]);
+  }
+
+protected:
+  /// Event of the point (\p u0, \p u1) in the unit hypercube
+  virtual ComPWA::Event event(double u0, double u1) const {
+    ComPWA::Event Event;
+    Event.ParticleList = {ComPWA::Particle(u0, u1, 0, 0)};
+    return Event;
+  }
+
+private:
+  unsigned int Seed = 1234;
+  uint64_t NextIndex = 0;
+};
+
+} // namespace Test
+} // namespace Tools
+} // namespace ComPWA
+
+#endif
@@ -189,7 +189,9 @@ PYBIND11_MODULE(ui, m) {
            "Internally convert the events to data points.",
            py::arg("kinematics"))
       .def("convert_events_to_parameterlist",
-           &ComPWA::Data::DataSet::convertEventsToParameterList,
+           (void (ComPWA::Data::DataSet::*)(
+               std::shared_ptr<ComPWA::Kinematics>)) &
+               ComPWA::Data::DataSet::convertEventsToParameterList,
            "Internally convert the events to a horizontal data structure.",
            py::arg("kinematics"));
 